@@ -4,9 +4,13 @@
 Common code for unit testing of rules generated with Snakemake 6.0.0.
 """
 
+import fcntl
 import gzip
+import hashlib
+import itertools
 import os
 import re
+import shutil
 import subprocess as sp
 from pathlib import Path
 
@@ -24,6 +28,8 @@ class OutputChecker:
         comparators,
         extra_comparison_exclusions,
         workdir,
+        digest_manifest=None,
+        compressed_manifest=None,
     ):
         self.data_path = data_path
         self.expected_path = expected_path
@@ -31,6 +37,18 @@ class OutputChecker:
         self.comparators = comparators
         self.extra_comparison_exclusions = extra_comparison_exclusions
         self.workdir = workdir
+        self.expected_digests = (
+            read_digest_manifest(digest_manifest) if digest_manifest is not None else {}
+        )
+        self.compressed_expected = set(
+            path.relative_to("expected")
+            for path in (
+                read_compressed_manifest(compressed_manifest)
+                if compressed_manifest is not None
+                else []
+            )
+            if path.parts[0] == "expected"
+        )
 
     def check(self):
         input_files = set(
@@ -53,8 +71,17 @@ class OutputChecker:
                     continue
                 if any(m in str(f) for m in self.extra_comparison_exclusions):
                     continue
-                if f in expected_files:
+                if f in self.compressed_expected:
+                    self.compare_files(
+                        self.workdir / f, self.expected_path / f, expected_compressed=True
+                    )
+                elif f in expected_files:
                     self.compare_files(self.workdir / f, self.expected_path / f)
+                elif f in self.expected_digests:
+                    method, digest = self.expected_digests[f]
+                    assert file_digest(self.workdir / f, method) == digest, (
+                        "{}: contents differ ({} digest)".format(f, method)
+                    )
                 elif f in input_files:
                     # ignore input files
                     continue
@@ -65,7 +92,7 @@ class OutputChecker:
                 "Unexpected files: {}".format(";".join(sorted(map(str, unexpected_files))))
             )
 
-    def compare_files(self, generated_file, expected_file):
+    def compare_files(self, generated_file, expected_file, expected_compressed=False):
         """Compare input files.
 
         Logic chain is as follows:
@@ -76,6 +103,9 @@ class OutputChecker:
 
         If the files are plain text, then strip comment lines and compare (to
         circumvent datestamps causing assert failures).
+
+        If expected_compressed, the expected file was stored gzipped under
+        its own name by --compress-test-data, and is decompressed as it is read.
         """
         f = magic.Magic(uncompress=True, mime=True)
         found_handler = False
@@ -87,17 +117,19 @@ class OutputChecker:
                 ):
                     found_handler = True
                     if comparator["type"] == "byte":
-                        sp.check_output(["cmp", generated_file, expected_file])
+                        assert_bytes_equal(generated_file, expected_file, expected_compressed)
                     elif comparator["type"] == "frame":
                         pandas_assert_frame_equal(
                             generated_file,
                             expected_file,
                             comparator["args"] if "args" in comparator else {},
+                            expected_compressed,
                         )
                     elif comparator["type"] == "plaintext":
-                        gen = process_file(generated_file)
-                        exp = process_file(expected_file)
-                        assert gen == exp
+                        difference = first_difference(
+                            generated_file, expected_file, expected_compressed
+                        )
+                        assert difference is None, difference
                     else:
                         raise LookupError(
                             "comparator type {} is not defined in snakemake_unit_tests".format(
@@ -106,19 +138,35 @@ class OutputChecker:
                         )
         if not found_handler:
             if f.from_file(str(generated_file)) != "text/plain":
-                sp.check_output(["cmp", generated_file, expected_file])
+                assert_bytes_equal(generated_file, expected_file, expected_compressed)
             else:
-                gen = process_file(generated_file)
-                exp = process_file(expected_file)
-                assert gen == exp
+                difference = first_difference(generated_file, expected_file, expected_compressed)
+                assert difference is None, difference
 
 
-def pandas_assert_frame_equal(infile1, infile2, args):
+def assert_bytes_equal(generated_file, expected_file, expected_compressed=False):
+    if not expected_compressed:
+        sp.check_output(["cmp", generated_file, expected_file])
+        return
+    # cmp cannot see through the compression, so compare a chunk at a time
+    with open(generated_file, "rb") as gen, gzip.open(expected_file, "rb") as exp:
+        for gen_chunk in iter(lambda: gen.read(1 << 20), b""):
+            assert gen_chunk == exp.read(len(gen_chunk)), "{}: contents differ".format(
+                generated_file
+            )
+        assert exp.read(1) == b"", "{}: contents differ".format(generated_file)
+
+
+def pandas_assert_frame_equal(infile1, infile2, args, infile2_compressed=False):
     df1 = pd.read_table(
         infile1, sep=args["sep"], header=args["header"], index_col=args["index_col"]
     )
     df2 = pd.read_table(
-        infile2, sep=args["sep"], header=args["header"], index_col=args["index_col"]
+        infile2,
+        sep=args["sep"],
+        header=args["header"],
+        index_col=args["index_col"],
+        compression="gzip" if infile2_compressed else "infer",
     )
     pd.testing.assert_frame_equal(
         df1,
@@ -130,6 +178,161 @@ def pandas_assert_frame_equal(infile1, infile2, args):
     )
 
 
+def open_text(infile, gzipped=False):
+    if gzipped or str(infile).lower().endswith(".gz"):
+        return gzip.open(infile, mode="rt")
+    return open(infile, "r")
+
+
+def comment_prefix(infile):
+    return "##" if str(infile).lower().endswith((".vcf", ".vcf.gz")) else "#"
+
+
+def first_difference(generated_file, expected_file, expected_compressed=False):
+    """Compare text files line by line, without comment lines.
+
+    Both files are read in lockstep, so memory use does not depend on file size.
+    Returns None if the files match, or a description of the first differing lines.
+    """
+    with open_text(generated_file) as gen, open_text(expected_file, expected_compressed) as exp:
+        gen_lines = (
+            (n, line)
+            for n, line in enumerate(gen, 1)
+            if not line.startswith(comment_prefix(generated_file))
+        )
+        exp_lines = (
+            (n, line)
+            for n, line in enumerate(exp, 1)
+            if not line.startswith(comment_prefix(expected_file))
+        )
+        for (gen_n, gen_line), (exp_n, exp_line) in itertools.zip_longest(
+            gen_lines, exp_lines, fillvalue=(None, None)
+        ):
+            if gen_line != exp_line:
+                return (
+                    "first difference at line {} of generated file, line {} of expected file\n"
+                    "  generated: {}\n  expected:  {}"
+                ).format(
+                    gen_n if gen_n is not None else "end",
+                    exp_n if exp_n is not None else "end",
+                    gen_line.rstrip("\n")[:200] if gen_line is not None else "<end of file>",
+                    exp_line.rstrip("\n")[:200] if exp_line is not None else "<end of file>",
+                )
+    return None
+
+
+def file_digest(infile, method):
+    """SHA-256 of a file, as --digest-outputs recorded it.
+
+    "byte" digests the raw contents; "plaintext" digests the lines that
+    first_difference would compare, so comment lines are ignored.
+    """
+    hasher = hashlib.sha256()
+    if method == "byte":
+        with open(infile, "rb") as f:
+            for chunk in iter(lambda: f.read(1 << 20), b""):
+                hasher.update(chunk)
+    elif method == "plaintext":
+        with open_text(infile) as f:
+            for line in f:
+                if not line.startswith(comment_prefix(infile)):
+                    hasher.update(line.encode("utf-8"))
+    else:
+        raise LookupError("digest method {} is not byte or plaintext".format(method))
+    return hasher.hexdigest()
+
+
+def read_digest_manifest(manifest):
+    """Map each path in a digest manifest to its (method, digest)."""
+    digests = {}
+    with open(manifest, "r") as f:
+        for line in f:
+            if line.strip():
+                digest, method, path = line.rstrip("\n").split("  ", 2)
+                digests[Path(path)] = (method, digest)
+    return digests
+
+
+def read_compressed_manifest(manifest):
+    """Paths, relative to the test directory, that --compress-test-data gzipped."""
+    with open(manifest, "r") as f:
+        return [Path(line.rstrip("\n")) for line in f if line.strip()]
+
+
+def decompress_workspace(manifest, rundir):
+    """Decompress, in place, the gzipped workspace files of a copy of the workspace."""
+    for path in read_compressed_manifest(manifest):
+        if path.parts[0] != "workspace":
+            continue
+        target = Path(rundir) / path.relative_to("workspace")
+        partial = target.with_name(target.name + ".decompressing")
+        with gzip.open(target, "rb") as compressed, open(partial, "wb") as decompressed:
+            shutil.copyfileobj(compressed, decompressed, 1 << 20)
+        os.replace(partial, target)
+
+
+# ioctl request for a copy-on-write clone of a whole file, from linux/fs.h
+FICLONE = 0x40049409
+
+
+class UnsupportedRunDirStrategy(Exception):
+    """Raised, instead of OSError, so that copytree stops at the first file it cannot place."""
+
+
+def reflink_file(src, dst):
+    """Clone a file without copying its data, where the filesystem supports it."""
+    try:
+        with open(src, "rb") as fsrc, open(dst, "wb") as fdst:
+            fcntl.ioctl(fdst.fileno(), FICLONE, fsrc.fileno())
+        shutil.copystat(src, dst)
+    except OSError as e:
+        raise UnsupportedRunDirStrategy(e)
+
+
+def hardlink_file(src, dst):
+    """Link a file into the run directory.
+
+    The link shares its inode, and so its mode and contents, with the workspace
+    file: it stays writable, and a rule that modifies an input in place modifies
+    the test's workspace as well.
+    """
+    try:
+        os.link(src, dst)
+    except OSError as e:
+        raise UnsupportedRunDirStrategy(e)
+
+
+RUN_DIR_STRATEGIES = [
+    ("reflink", reflink_file),
+    ("hardlink", hardlink_file),
+    ("copy", shutil.copy2),
+]
+
+
+def setup_run_dir(workspace_path, rundir, strategy="reflink"):
+    """Populate a test's run directory from its workspace.
+
+    The configured run-dir-strategy is tried first, and full copies are
+    made if the filesystem does not support it. Hard links are only used
+    when configured, as they share the workspace files with the run.
+    Returns the strategy that was used.
+    """
+    names = [name for name, _ in RUN_DIR_STRATEGIES]
+    if strategy not in names:
+        raise ValueError(
+            "run-dir-strategy {} is not one of {}".format(strategy, ", ".join(names))
+        )
+    for name, copy_function in RUN_DIR_STRATEGIES:
+        if name != strategy and name != "copy":
+            continue
+        try:
+            shutil.copytree(workspace_path, rundir, copy_function=copy_function)
+            return name
+        except UnsupportedRunDirStrategy:
+            shutil.rmtree(rundir, ignore_errors=True)
+    raise AssertionError("copy is always supported")
+
+
 def process_file(infile):
     rmv = "##" if str(infile).lower().endswith((".vcf", ".vcf.gz")) else "#"
     if str(infile).lower().endswith(".gz"):
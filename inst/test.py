@@ -20,6 +20,11 @@ with open("{}/unit/config.yaml".format(testdir), "r") as f:
 if config["exclude-patterns"] is not None:
     exclude_patterns.extend(config["exclude-patterns"])
 comparators = config["comparators"] if "comparators" in config else {}
+run_dir_strategy = config.get("run-dir-strategy") or "reflink"
+# compare outputs with the generator's native checker where it is available
+compare_binary = os.environ.get(
+    "SNAKEMAKE_UNIT_TESTS_BINARY", shutil.which("snakemake_unit_tests.out")
+)
 
 
 def test_function():
@@ -28,9 +33,19 @@ def test_function():
         rundir = PurePosixPath("{}/unit/{}/output".format(testdir, rulename))
         workspace_path = PurePosixPath("{}/unit/{}/workspace".format(testdir, rulename))
         expected_path = PurePosixPath("{}/unit/{}/expected".format(testdir, rulename))
+        # outputs emitted with --digest-outputs are recorded here instead of in expected_path
+        digest_manifest = PurePosixPath("{}/unit/{}/expected.sha256".format(testdir, rulename))
+        if not os.path.isfile(digest_manifest):
+            digest_manifest = None
+        # test data emitted with --compress-test-data are gzipped under their own names
+        compressed_manifest = PurePosixPath("{}/unit/{}/compressed.txt".format(testdir, rulename))
+        if not os.path.isfile(compressed_manifest):
+            compressed_manifest = None
 
-        # Copy data to the temporary workdir.
-        shutil.copytree(workspace_path, rundir)
+        # Copy data to the temporary workdir, without copying file contents where possible.
+        common.setup_run_dir(workspace_path, rundir, run_dir_strategy)
+        if compressed_manifest:
+            common.decompress_workspace(compressed_manifest, rundir)
 
         # Run the test job.
         sp.check_output(
@@ -40,12 +55,16 @@ def test_function():
                 "snakemake",
                 "all",
                 "-f",
-                "-j1",
+                "-j{}".format(threads),
                 "--notemp",
                 "--keep-target-files",
                 "--use-conda",
                 "--conda-frontend",
                 "mamba",
+            ]
+            # environments are shared between tests when the generator was given --conda-prefix
+            + (["--conda-prefix", conda_prefix] if conda_prefix else [])
+            + [
                 "--snakefile",
                 "{}/{}".format(rundir, snakefile_relative_path),
                 "--allowed-rules",
@@ -58,7 +77,32 @@ def test_function():
         # Check the output using assorted comparators.
         # To modify this behavior, you can inherit from common.OutputChecker in here
         # and overwrite the method `compare_files(generated_file, expected_file),
-        # also see common.py.
+        # also see common.py; then unset compare_binary above.
+
+        if compare_binary is not None:
+            result = sp.run(
+                [
+                    compare_binary,
+                    "compare",
+                    "--config={}/unit/config.yaml".format(testdir),
+                    "--workspace-dir={}".format(workspace_path),
+                    "--expected-dir={}".format(expected_path),
+                    "--run-dir={}".format(rundir),
+                    "--jobs={}".format(threads),
+                ]
+                + ["--comparison-exclusions={}".format(m) for m in extra_comparison_exclusions]
+                + (["--expected-digests={}".format(digest_manifest)] if digest_manifest else [])
+                + (
+                    ["--compressed-files={}".format(compressed_manifest)]
+                    if compressed_manifest
+                    else []
+                ),
+                stdout=sp.PIPE,
+                stderr=sp.STDOUT,
+                universal_newlines=True,
+            )
+            assert result.returncode == 0, result.stdout
+            return
 
         common.OutputChecker(
             workspace_path,
@@ -67,4 +111,6 @@ def test_function():
             comparators,
             extra_comparison_exclusions,
             rundir,
+            digest_manifest,
+            compressed_manifest,
         ).check()
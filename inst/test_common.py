@@ -1,9 +1,12 @@
 #!/usr/bin/env python
 
+import gzip
+import os
 from unittest import mock
 
 import common
 import pytest
+import yaml
 
 
 @pytest.mark.parametrize(
@@ -30,6 +33,141 @@ def test_remove_headers(test_in, test_param, exp_out):
     assert common.remove_headers(test_in, test_param) == exp_out
 
 
+@pytest.mark.parametrize(
+    "gen_content, exp_content, exp_out",
+    [
+        ("##date=today\n#CHROM\nchr1\n", "##date=then\n#CHROM\nchr1\n", None),
+        (
+            "##date=today\n#CHROM\nchr1\n",
+            "##date=today\n#CHROM\nchr2\n",
+            "first difference at line 3 of generated file, line 3 of expected file\n"
+            "  generated: chr1\n  expected:  chr2",
+        ),
+        (
+            "#CHROM\n",
+            "#CHROM\nchr1\n",
+            "first difference at line end of generated file, line 2 of expected file\n"
+            "  generated: <end of file>\n  expected:  chr1",
+        ),
+    ],
+)
+def test_first_difference(tmp_path, gen_content, exp_content, exp_out):
+    gen = tmp_path / "gen.vcf.gz"
+    exp = tmp_path / "exp.vcf.gz"
+    with gzip.open(gen, "wt") as f:
+        f.write(gen_content)
+    with gzip.open(exp, "wt") as f:
+        f.write(exp_content)
+    assert common.first_difference(gen, exp) == exp_out
+
+
+@pytest.mark.parametrize(
+    "content, method, exp_out",
+    [
+        # matches the native checker: comment lines are not digested
+        (
+            b"# made today\r\nabc\r\n",
+            "plaintext",
+            "edeaaff3f1774ad2888673770c6d64097e391bc362d7d6fb34982ddf0efd18cb",
+        ),
+        (b"", "byte", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"),
+    ],
+)
+def test_file_digest(tmp_path, content, method, exp_out):
+    infile = tmp_path / "file.txt"
+    infile.write_bytes(content)
+    assert common.file_digest(infile, method) == exp_out
+
+
+def test_read_digest_manifest(tmp_path):
+    manifest = tmp_path / "expected.sha256"
+    manifest.write_text("{}  byte  results/a file.bin\n".format("0" * 64))
+    assert common.read_digest_manifest(manifest) == {
+        common.Path("results/a file.bin"): ("byte", "0" * 64)
+    }
+
+
+def test_decompress_workspace(tmp_path):
+    (tmp_path / "run" / "results").mkdir(parents=True)
+    with gzip.open(tmp_path / "run" / "results" / "a.txt", "wb") as f:
+        f.write(b"abc\n")
+    manifest = tmp_path / "compressed.txt"
+    manifest.write_text("expected/results/b.txt\nworkspace/results/a.txt\n")
+    common.decompress_workspace(manifest, tmp_path / "run")
+    assert (tmp_path / "run" / "results" / "a.txt").read_bytes() == b"abc\n"
+
+
+@pytest.mark.parametrize(
+    "gen_content, exp_content, equal",
+    [(b"\0abc", b"\0abc", True), (b"\0abc", b"\0abd", False), (b"\0abc", b"\0ab", False)],
+)
+def test_assert_bytes_equal_compressed(tmp_path, gen_content, exp_content, equal):
+    (tmp_path / "gen").write_bytes(gen_content)
+    with gzip.open(tmp_path / "exp", "wb") as f:
+        f.write(exp_content)
+    if equal:
+        common.assert_bytes_equal(tmp_path / "gen", tmp_path / "exp", True)
+    else:
+        with pytest.raises(AssertionError):
+            common.assert_bytes_equal(tmp_path / "gen", tmp_path / "exp", True)
+
+
+@pytest.mark.parametrize("strategy", ["reflink", "hardlink", "copy"])
+def test_setup_run_dir(tmp_path, strategy):
+    (tmp_path / "workspace" / "results").mkdir(parents=True)
+    (tmp_path / "workspace" / "results" / "a.txt").write_text("abc\n")
+    mode = os.stat(tmp_path / "workspace" / "results" / "a.txt").st_mode
+    used = common.setup_run_dir(tmp_path / "workspace", tmp_path / "run", strategy)
+    # the configured strategy falls back only to copying, which always works
+    assert used in (strategy, "copy")
+    assert (tmp_path / "run" / "results" / "a.txt").read_text() == "abc\n"
+    linked = os.path.samefile(
+        tmp_path / "workspace" / "results" / "a.txt", tmp_path / "run" / "results" / "a.txt"
+    )
+    assert linked == (used == "hardlink")
+    # the test's own workspace is left as it was
+    assert os.stat(tmp_path / "workspace" / "results" / "a.txt").st_mode == mode
+
+
+def test_setup_run_dir_reflink_fallback(tmp_path):
+    (tmp_path / "workspace").mkdir()
+    (tmp_path / "workspace" / "a.txt").write_text("abc\n")
+    with mock.patch("fcntl.ioctl", side_effect=OSError("not supported")):
+        used = common.setup_run_dir(tmp_path / "workspace", tmp_path / "run", "reflink")
+    # hard links are never chosen automatically
+    assert used == "copy"
+    assert not os.path.samefile(tmp_path / "workspace" / "a.txt", tmp_path / "run" / "a.txt")
+
+
+def test_setup_run_dir_unknown_strategy(tmp_path):
+    with pytest.raises(ValueError):
+        common.setup_run_dir(tmp_path / "workspace", tmp_path / "run", "symlink")
+
+
+def test_schema_run_dir_strategy():
+    # the configured strategy is checked by the installed schema before tests are emitted
+    with open(os.path.join(os.path.dirname(__file__), "user_config_schema.yaml"), "r") as f:
+        schema = yaml.safe_load(f)
+    assert schema["properties"]["run-dir-strategy"]["enum"] == [
+        name for name, _ in common.RUN_DIR_STRATEGIES
+    ]
+
+
+def test_schema_documented_keys():
+    # every key config.example.yaml documents must pass the schema's additionalProperties
+    inst_dir = os.path.dirname(os.path.abspath(__file__))
+    with open(os.path.join(inst_dir, "user_config_schema.yaml"), "r") as f:
+        schema = yaml.safe_load(f)
+    with open(os.path.join(inst_dir, "..", "config.example.yaml"), "r") as f:
+        documented = [
+            line[2:].split(":")[0]
+            for line in f
+            if line.startswith("# ") and line.rstrip().endswith("]") and ": [" in line
+        ]
+    assert "conda-prefix" in documented
+    assert [key for key in documented if key not in schema["properties"]] == []
+
+
 # @pytest.mark.parametrize("test_in, exp_out", [(), ()])
 # def test_process_file():
 #     m = mock.mock_open(read_data="##head1\n##head2\n#CHROM\nother stuff")
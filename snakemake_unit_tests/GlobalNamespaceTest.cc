@@ -7,6 +7,11 @@
 
 #include "snakemake_unit_tests/GlobalNamespaceTest.h"
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <csignal>
+
 void snakemake_unit_tests::GlobalNamespaceTest::setUp() {
   _test_map["a"] = true;
   _test_map["b"] = true;
@@ -672,6 +677,139 @@ void snakemake_unit_tests::GlobalNamespaceTest::test_lexical_parse() {
   for (unsigned i = 0; i < output.size(); ++i) {
     CPPUNIT_ASSERT(!output.at(i).compare(expected.at(i)));
   }
+
+  // a bare line extension at the end of the file adds no logical line
+  input.clear();
+  input.push_back("a = 1");
+  input.push_back("\\");
+  output = lexical_parse(input);
+  CPPUNIT_ASSERT(output.size() == 1);
+  CPPUNIT_ASSERT(!output.at(0).compare("a = 1"));
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_find_lexical_special() {
+  std::string line = "plain text that is long enough to cover a vector stride # comment";
+  CPPUNIT_ASSERT(find_lexical_special(line, 0) == line.find('#'));
+  CPPUNIT_ASSERT(find_lexical_special(line, line.find('#') + 1) == std::string_view::npos);
+  CPPUNIT_ASSERT(find_lexical_special("", 0) == std::string_view::npos);
+  CPPUNIT_ASSERT(find_lexical_special("'", 0) == 0);
+  CPPUNIT_ASSERT(find_lexical_special("ab\\c", 1) == 2);
+  CPPUNIT_ASSERT(find_lexical_special("abcdefghijklmnopqrstuvwxyzABCDEFGHIJ\"", 3) == 36);
+  CPPUNIT_ASSERT(find_lexical_special("abc", 3) == std::string_view::npos);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_find_lexical_special_differential() {
+  // vector scanning must agree with the scalar reference for every start position,
+  // across line lengths that exercise full strides and partial tails
+  std::mt19937 generator(20231016);
+  const std::string alphabet = "abc \t'\"#\\\n";
+  std::uniform_int_distribution<unsigned> length_dist(0, 150), char_dist(0, alphabet.size() - 1),
+      sparse_dist(0, 40);
+  for (unsigned trial = 0; trial < 2000; ++trial) {
+    std::string line(length_dist(generator), 'x');
+    // alternate dense and sparse special characters
+    for (unsigned i = 0; i < line.size(); ++i) {
+      if (trial % 2 || !sparse_dist(generator)) line.at(i) = alphabet.at(char_dist(generator));
+    }
+    for (unsigned start = 0; start <= line.size(); ++start) {
+      CPPUNIT_ASSERT(find_lexical_special(line, start) == find_lexical_special_scalar(line, start));
+    }
+  }
+}
+
+std::vector<std::string> snakemake_unit_tests::GlobalNamespaceTest::baseline_lexical_parse(
+    const std::vector<std::string> &lines) const {
+  unsigned current_line = 0;
+  bool string_open = false, literal_open = false;
+  std::string aggregated_line = "", resolved_line = "";
+  std::vector<std::string> results;
+  quote_type active_quote_type = none;
+  while (current_line < lines.size()) {
+    unsigned parse_index = 0;
+    if (!string_open && !literal_open) {
+      parse_index = lines.at(current_line).find_first_not_of(" \t");
+    }
+    bool line_consumed = false;
+    while (parse_index < lines.at(current_line).size()) {
+      if (lines.at(current_line).at(parse_index) == '\\') {
+        if (parse_index == lines.at(current_line).size() - 1 && !string_open && !literal_open) {
+          resolved_line = lines.at(current_line).substr(0, lines.at(current_line).size() - 1);
+          aggregated_line += resolved_line;
+          ++current_line;
+          line_consumed = true;
+          break;
+        } else if (parse_index < lines.at(current_line).size() - 1) {
+          parse_index += 2;
+        } else {
+          ++parse_index;
+        }
+      } else if (lines.at(current_line).at(parse_index) == '\'' || lines.at(current_line).at(parse_index) == '"') {
+        resolve_string_delimiter(lines.at(current_line), &active_quote_type, &parse_index, &string_open, &literal_open);
+      } else if (lines.at(current_line).at(parse_index) == '#' && !string_open && !literal_open) {
+        resolved_line = lines.at(current_line).substr(0, parse_index);
+        append_resolved_line(resolved_line, &aggregated_line, &results);
+        ++current_line;
+        line_consumed = true;
+        break;
+      } else {
+        ++parse_index;
+      }
+    }
+    if (!line_consumed) {
+      if (string_open || literal_open) {
+        aggregated_line += lines.at(current_line) + "\n";
+      } else {
+        resolved_line = lines.at(current_line);
+        append_resolved_line(resolved_line, &aggregated_line, &results);
+      }
+      ++current_line;
+    }
+  }
+  if (!aggregated_line.empty()) {
+    resolved_line = aggregated_line;
+    aggregated_line = "";
+    append_resolved_line(resolved_line, &aggregated_line, &results);
+  }
+  return results;
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_lexical_parse_differential() {
+  // lexical_parse must produce the same logical lines as the line-based parser
+  // it replaced, on random snakefile text built from the tokens the lexer cares about
+  std::mt19937 generator(20231017);
+  const std::vector<std::string> tokens = {"rule a:", "input:", "x = 1", "    ", "\t", " ", "\"", "'", "\"\"\"",
+                                           "'''", "#", "\\", "\\\"", "\\'", "\\\\", "\"a # b\"", "'c'", "f(\"d\")",
+                                           "plain words long enough to fill a vector stride"};
+  std::uniform_int_distribution<unsigned> line_count_dist(1, 12), token_count_dist(0, 10),
+      token_dist(0, tokens.size() - 1), continuation_dist(0, 5);
+  unsigned compared = 0;
+  for (unsigned trial = 0; trial < 3000; ++trial) {
+    std::vector<std::string> lines(line_count_dist(generator));
+    for (std::vector<std::string>::iterator iter = lines.begin(); iter != lines.end(); ++iter) {
+      for (unsigned count = token_count_dist(generator); count; --count) {
+        *iter += tokens.at(token_dist(generator));
+      }
+      // exercise line extension
+      if (!continuation_dist(generator)) *iter += "\\";
+    }
+    std::vector<std::string> expected, observed;
+    bool expected_threw = false, observed_threw = false;
+    try {
+      expected = baseline_lexical_parse(lines);
+    } catch (const std::exception &) {
+      expected_threw = true;
+    }
+    try {
+      observed = lexical_parse(lines);
+    } catch (const std::exception &) {
+      observed_threw = true;
+    }
+    CPPUNIT_ASSERT(expected_threw == observed_threw);
+    if (!expected_threw) ++compared;
+    CPPUNIT_ASSERT(observed == expected);
+  }
+  // make sure the generator is not dominated by malformed input
+  CPPUNIT_ASSERT(compared > 1000);
 }
 
 void snakemake_unit_tests::GlobalNamespaceTest::test_exec() {
@@ -687,4 +825,342 @@ void snakemake_unit_tests::GlobalNamespaceTest::test_exec_fail_on_error() {
   std::vector<std::string> result = exec("python33333333___43324 2> /dev/null", true, false);
 }
 
+void snakemake_unit_tests::GlobalNamespaceTest::test_exec_streaming() {
+  std::vector<std::string> args, lines;
+  std::function<void(std::string_view)> collect = [&](std::string_view line) { lines.push_back(std::string(line)); };
+  // arguments are passed directly, without shell interpretation
+  args.push_back("printf");
+  args.push_back("%s\\n%s");
+  args.push_back("a b $HOME");
+  args.push_back("no newline");
+  CPPUNIT_ASSERT_EQUAL(0, exec_streaming(args, "", true, collect));
+  CPPUNIT_ASSERT(lines.size() == 2u);
+  CPPUNIT_ASSERT(!lines.at(0).compare("a b $HOME\n"));
+  CPPUNIT_ASSERT(!lines.at(1).compare("no newline"));
+  // working directory
+  std::string tmp_dir = boost::filesystem::canonical(boost::filesystem::temp_directory_path()).string();
+  args.clear();
+  lines.clear();
+  args.push_back("pwd");
+  exec_streaming(args, tmp_dir, true, collect);
+  CPPUNIT_ASSERT(lines.size() == 1u);
+  CPPUNIT_ASSERT(!lines.at(0).compare(tmp_dir + "\n"));
+  // output larger than the read buffer is delivered whole and in order
+  args.clear();
+  lines.clear();
+  args.push_back("seq");
+  args.push_back("100000");
+  exec_streaming(args, "", true, collect);
+  CPPUNIT_ASSERT(lines.size() == 100000u);
+  for (unsigned i = 0; i < lines.size(); ++i) {
+    CPPUNIT_ASSERT(!lines.at(i).compare(std::to_string(i + 1) + "\n"));
+  }
+  // failures are reported through the exit status when not fatal
+  args.clear();
+  args.push_back("sh");
+  args.push_back("-c");
+  args.push_back("exit 3");
+  CPPUNIT_ASSERT_EQUAL(3, exec_streaming(args, "", false, collect, false));
+  args.clear();
+  args.push_back("python33333333___43324");
+  CPPUNIT_ASSERT_EQUAL(127, exec_streaming(args, "", false, collect, false));
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_exec_streaming_fail_on_error() {
+  std::vector<std::string> args;
+  args.push_back("false");
+  exec_streaming(args, "", true, [](std::string_view line) {}, false);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_run_subprocess() {
+  std::vector<std::string> args, out_lines, err_lines;
+  subprocess_options options;
+  options.stdout_callback = [&](std::string_view line) { out_lines.push_back(std::string(line)); };
+  options.stderr_callback = [&](std::string_view line) { err_lines.push_back(std::string(line)); };
+  // both streams are captured, separately
+  args.push_back("sh");
+  args.push_back("-c");
+  args.push_back("echo out1; echo err1 1>&2; echo out2; echo err2 1>&2; exit 4");
+  options.fail_on_error = false;
+  subprocess_result result = run_subprocess(args, options);
+  CPPUNIT_ASSERT_EQUAL(4, result.exit_status);
+  CPPUNIT_ASSERT(!result.timed_out);
+  CPPUNIT_ASSERT(out_lines.size() == 2u);
+  CPPUNIT_ASSERT(!out_lines.at(0).compare("out1\n"));
+  CPPUNIT_ASSERT(!out_lines.at(1).compare("out2\n"));
+  CPPUNIT_ASSERT(err_lines.size() == 2u);
+  CPPUNIT_ASSERT(!err_lines.at(0).compare("err1\n"));
+  CPPUNIT_ASSERT(!err_lines.at(1).compare("err2\n"));
+  // resource use is reported for the reaped child
+  CPPUNIT_ASSERT(result.wall_seconds >= 0.0);
+  CPPUNIT_ASSERT(result.user_seconds >= 0.0);
+  CPPUNIT_ASSERT(result.system_seconds >= 0.0);
+  CPPUNIT_ASSERT(result.max_rss_kb > 0);
+  // a generous timeout does not interfere with a quick program
+  out_lines.clear();
+  args.clear();
+  args.push_back("echo");
+  args.push_back("quick");
+  options.timeout_seconds = 30.0;
+  options.fail_on_error = true;
+  result = run_subprocess(args, options);
+  CPPUNIT_ASSERT_EQUAL(0, result.exit_status);
+  CPPUNIT_ASSERT(!result.timed_out);
+  CPPUNIT_ASSERT(out_lines.size() == 1u);
+  CPPUNIT_ASSERT(!out_lines.at(0).compare("quick\n"));
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_run_subprocess_timeout() {
+  std::vector<std::string> args;
+  subprocess_options options;
+  options.fail_on_error = false;
+  options.timeout_seconds = 0.2;
+  // the shell's own child is in the killed process group, so output closes promptly
+  args.push_back("sh");
+  args.push_back("-c");
+  args.push_back("sleep 10; echo finished");
+  std::vector<std::string> lines;
+  options.stdout_callback = [&](std::string_view line) { lines.push_back(std::string(line)); };
+  subprocess_result result = run_subprocess(args, options);
+  CPPUNIT_ASSERT(result.timed_out);
+  CPPUNIT_ASSERT_EQUAL(128 + SIGKILL, result.exit_status);
+  CPPUNIT_ASSERT(result.wall_seconds >= 0.2);
+  CPPUNIT_ASSERT(result.wall_seconds < 5.0);
+  CPPUNIT_ASSERT(lines.empty());
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_run_subprocess_timeout_fail_on_error() {
+  std::vector<std::string> args;
+  subprocess_options options;
+  options.timeout_seconds = 0.1;
+  options.emit_error_logging = false;
+  args.push_back("sleep");
+  args.push_back("10");
+  run_subprocess(args, options);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_run_subprocess_timeout_closed_output() {
+  std::vector<std::string> args;
+  subprocess_options options;
+  options.fail_on_error = false;
+  options.timeout_seconds = 1.0;
+  // output reaches end of file immediately, but the program keeps running
+  args.push_back("sh");
+  args.push_back("-c");
+  args.push_back("exec >/dev/null 2>&1; sleep 30");
+  options.stderr_callback = [](std::string_view) {};
+  subprocess_result result = run_subprocess(args, options);
+  CPPUNIT_ASSERT(result.timed_out);
+  CPPUNIT_ASSERT_EQUAL(128 + SIGKILL, result.exit_status);
+  CPPUNIT_ASSERT(result.wall_seconds >= 1.0);
+  CPPUNIT_ASSERT(result.wall_seconds < 10.0);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_run_subprocess_forwards_termination() {
+  // a timed program runs outside this process's group; terminating this process,
+  // here a forked copy, must terminate the program too
+  int report_fds[2] = {-1, -1};
+  CPPUNIT_ASSERT(!pipe(report_fds));
+  pid_t runner = fork();
+  CPPUNIT_ASSERT(runner >= 0);
+  if (!runner) {
+    close(report_fds[0]);
+    std::vector<std::string> args;
+    subprocess_options options;
+    options.fail_on_error = false;
+    options.timeout_seconds = 60.0;
+    args.push_back("sh");
+    args.push_back("-c");
+    args.push_back("echo $$; exec sleep 30");
+    options.stdout_callback = [&](std::string_view line) {
+      if (write(report_fds[1], line.data(), line.size()) < 0) _exit(2);
+    };
+    run_subprocess(args, options);
+    _exit(1);
+  }
+  close(report_fds[1]);
+  std::string reported = "";
+  char c = 0;
+  while (read(report_fds[0], &c, 1) == 1 && c != '\n') reported += c;
+  close(report_fds[0]);
+  CPPUNIT_ASSERT(!reported.empty());
+  pid_t program = static_cast<pid_t>(std::stol(reported));
+  CPPUNIT_ASSERT(!kill(runner, SIGTERM));
+  int status = 0;
+  CPPUNIT_ASSERT(waitpid(runner, &status, 0) == runner);
+  CPPUNIT_ASSERT(WIFSIGNALED(status) && WTERMSIG(status) == SIGTERM);
+  // the orphaned program is reaped by init, or left as a zombie until it is
+  bool terminated = false;
+  for (unsigned attempt = 0; attempt < 500 && !terminated; ++attempt) {
+    std::ifstream input(("/proc/" + std::to_string(program) + "/stat").c_str());
+    std::string pid_field = "", command_field = "", state = "";
+    terminated = !(input >> pid_field >> command_field >> state) || state == "Z";
+    if (!terminated) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  CPPUNIT_ASSERT(terminated);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_run_subprocess_error_log_lines() {
+  std::vector<std::string> args;
+  subprocess_options options;
+  args.push_back("sh");
+  args.push_back("-c");
+  args.push_back("echo first; seq 2000; exit 1");
+  CPPUNIT_ASSERT(options.error_log_lines == 1000);
+  std::ostringstream observed;
+  std::streambuf *previous_buffer(std::cerr.rdbuf(observed.rdbuf()));
+  // by default, the report is capped, and says so
+  bool threw = false;
+  try {
+    run_subprocess(args, options);
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  std::cerr.rdbuf(previous_buffer);
+  CPPUNIT_ASSERT(threw);
+  CPPUNIT_ASSERT(observed.str().find("[1001 earlier lines of output not shown]\n") == 0);
+  CPPUNIT_ASSERT(observed.str().find("first\n") == std::string::npos);
+  CPPUNIT_ASSERT(observed.str().find("\n2000\n") != std::string::npos);
+  // or all of the output is reported
+  options.error_log_lines = 0;
+  observed.str("");
+  previous_buffer = std::cerr.rdbuf(observed.rdbuf());
+  threw = false;
+  try {
+    run_subprocess(args, options);
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  std::cerr.rdbuf(previous_buffer);
+  CPPUNIT_ASSERT(threw);
+  CPPUNIT_ASSERT(observed.str().find("first\n1\n2\n") == 0);
+  CPPUNIT_ASSERT(observed.str().find("not shown") == std::string::npos);
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_report_subprocess_summary() {
+  std::vector<subprocess_record> records;
+  subprocess_record record;
+  record.label = "dry run for rule rule1";
+  record.working_directory = "tests/rule1/workspace";
+  record.result.exit_status = 1;
+  record.result.wall_seconds = 2.5;
+  record.result.user_seconds = 1.25;
+  record.result.system_seconds = 0.5;
+  record.result.max_rss_kb = 1024;
+  records.push_back(record);
+  record.label = "dry run for rule rule2";
+  record.result.timed_out = true;
+  records.push_back(record);
+  std::string filename = (boost::filesystem::temp_directory_path() /
+                          boost::filesystem::unique_path("sutRSSXXXX-%%%%-%%%%-%%%%"))
+                             .string();
+  report_subprocess_summary(records, filename);
+  std::ifstream input(filename.c_str());
+  CPPUNIT_ASSERT(input.is_open());
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(input, line)) lines.push_back(line);
+  input.close();
+  boost::filesystem::remove(filename);
+  CPPUNIT_ASSERT(lines.size() == 3u);
+  CPPUNIT_ASSERT(!lines.at(0).compare(
+      "label\tworking_directory\texit_status\ttimed_out\twall_seconds\tuser_seconds\tsystem_seconds\tmax_rss_kb"));
+  CPPUNIT_ASSERT(!lines.at(1).compare("dry run for rule rule1\ttests/rule1/workspace\t1\tno\t2.5\t1.25\t0.5\t1024"));
+  CPPUNIT_ASSERT(!lines.at(2).compare("dry run for rule rule2\ttests/rule1/workspace\t1\tyes\t2.5\t1.25\t0.5\t1024"));
+  // single line description for verbose logging
+  std::ostringstream o;
+  report_subprocess_usage(records.at(1), o);
+  CPPUNIT_ASSERT(!o.str().compare(
+      "\tdry run for rule rule2: exit status 1 (timed out), 2.5s wall, 1.75s cpu, 1024 KiB max rss\n"));
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_json_escape() {
+  CPPUNIT_ASSERT(!json_escape("plain rule_name").compare("plain rule_name"));
+  CPPUNIT_ASSERT(!json_escape("a \"b\" c\\d").compare("a \\\"b\\\" c\\\\d"));
+  CPPUNIT_ASSERT(!json_escape("line\n\ttab\r").compare("line\\n\\ttab\\r"));
+  CPPUNIT_ASSERT(!json_escape(std::string("\x01", 1)).compare("\\u0001"));
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_python_escape() {
+  CPPUNIT_ASSERT(!python_escape("mem_mb").compare("mem_mb"));
+  CPPUNIT_ASSERT(!python_escape("it's a\\b \"c\"").compare("it\\'s a\\\\b \"c\""));
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_run_in_parallel() {
+  // every task index should be visited exactly once, regardless of thread count
+  for (unsigned n_threads = 0; n_threads < 5; ++n_threads) {
+    std::vector<unsigned> visits(100, 0);
+    run_in_parallel(visits.size(), n_threads, [&](unsigned i) { ++visits.at(i); });
+    for (unsigned i = 0; i < visits.size(); ++i) {
+      CPPUNIT_ASSERT(visits.at(i) == 1);
+    }
+  }
+  // no tasks is not an error
+  run_in_parallel(0, 4, [](unsigned i) { throw std::logic_error("task called with no tasks requested"); });
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_run_in_parallel_task_error() {
+  run_in_parallel(20, 4, [](unsigned i) {
+    if (i == 7) throw std::runtime_error("task failure");
+  });
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_write_segments() {
+  // more buffers than a single writev call accepts
+  std::vector<std::string> storage;
+  std::string expected = "";
+  for (unsigned i = 0; i < 3000; ++i) {
+    storage.push_back(i % 7 ? std::to_string(i) + "\n" : "");
+    expected += storage.back();
+  }
+  std::vector<std::string_view> segments(storage.begin(), storage.end());
+  std::string filename = (boost::filesystem::temp_directory_path() /
+                          boost::filesystem::unique_path("sutWSXXXX-%%%%-%%%%-%%%%"))
+                             .string();
+  write_segments(filename, segments);
+  std::ifstream input(filename.c_str());
+  CPPUNIT_ASSERT(input.is_open());
+  std::ostringstream observed;
+  observed << input.rdbuf();
+  input.close();
+  boost::filesystem::remove(filename);
+  CPPUNIT_ASSERT(!observed.str().compare(expected));
+}
+
+void snakemake_unit_tests::GlobalNamespaceTest::test_write_segments_if_changed() {
+  std::vector<std::string> storage;
+  for (unsigned i = 0; i < 20000; ++i) {
+    storage.push_back(std::to_string(i) + "\n");
+  }
+  std::vector<std::string_view> segments(storage.begin(), storage.end());
+  std::string filename = (boost::filesystem::temp_directory_path() /
+                          boost::filesystem::unique_path("sutWSXXXX-%%%%-%%%%-%%%%"))
+                             .string();
+  // new file
+  CPPUNIT_ASSERT(write_segments_if_changed(filename, segments));
+  // identical content is left in place, including its modification time
+  boost::filesystem::last_write_time(filename, 1000);
+  CPPUNIT_ASSERT(!write_segments_if_changed(filename, segments));
+  CPPUNIT_ASSERT(boost::filesystem::last_write_time(filename) == 1000);
+  // same size, different content near the end of the file
+  storage.at(19990) = "x" + storage.at(19990).substr(1);
+  segments = std::vector<std::string_view>(storage.begin(), storage.end());
+  CPPUNIT_ASSERT(write_segments_if_changed(filename, segments));
+  CPPUNIT_ASSERT(!write_segments_if_changed(filename, segments));
+  // different size
+  segments.pop_back();
+  CPPUNIT_ASSERT(write_segments_if_changed(filename, segments));
+  std::string expected = "";
+  for (std::vector<std::string_view>::const_iterator iter = segments.begin(); iter != segments.end(); ++iter) {
+    expected += *iter;
+  }
+  std::ifstream input(filename.c_str());
+  CPPUNIT_ASSERT(input.is_open());
+  std::ostringstream observed;
+  observed << input.rdbuf();
+  input.close();
+  boost::filesystem::remove(filename);
+  CPPUNIT_ASSERT(!observed.str().compare(expected));
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::GlobalNamespaceTest);
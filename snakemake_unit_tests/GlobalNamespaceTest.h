@@ -13,6 +13,7 @@
 #include <cppunit/ui/text/TestRunner.h>
 
 #include <map>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -66,8 +67,26 @@ class GlobalNamespaceTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_EXCEPTION(test_resolve_string_delimiter_index_oob, std::runtime_error);
   CPPUNIT_TEST_EXCEPTION(test_resolve_string_delimiter_index_not_mark, std::runtime_error);
   CPPUNIT_TEST(test_lexical_parse);
+  CPPUNIT_TEST(test_find_lexical_special);
+  CPPUNIT_TEST(test_find_lexical_special_differential);
+  CPPUNIT_TEST(test_lexical_parse_differential);
   CPPUNIT_TEST(test_exec);
   CPPUNIT_TEST_EXCEPTION(test_exec_fail_on_error, std::runtime_error);
+  CPPUNIT_TEST(test_exec_streaming);
+  CPPUNIT_TEST_EXCEPTION(test_exec_streaming_fail_on_error, std::runtime_error);
+  CPPUNIT_TEST(test_run_subprocess);
+  CPPUNIT_TEST(test_run_subprocess_timeout);
+  CPPUNIT_TEST_EXCEPTION(test_run_subprocess_timeout_fail_on_error, std::runtime_error);
+  CPPUNIT_TEST(test_run_subprocess_timeout_closed_output);
+  CPPUNIT_TEST(test_run_subprocess_forwards_termination);
+  CPPUNIT_TEST(test_run_subprocess_error_log_lines);
+  CPPUNIT_TEST(test_report_subprocess_summary);
+  CPPUNIT_TEST(test_json_escape);
+  CPPUNIT_TEST(test_python_escape);
+  CPPUNIT_TEST(test_write_segments);
+  CPPUNIT_TEST(test_write_segments_if_changed);
+  CPPUNIT_TEST(test_run_in_parallel);
+  CPPUNIT_TEST_EXCEPTION(test_run_in_parallel_task_error, std::runtime_error);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -118,10 +137,36 @@ class GlobalNamespaceTest : public CppUnit::TestFixture {
   void test_resolve_string_delimiter_index_oob();
   void test_resolve_string_delimiter_index_not_mark();
   void test_lexical_parse();
+  void test_find_lexical_special();
+  void test_find_lexical_special_differential();
+  void test_lexical_parse_differential();
   void test_exec();
   void test_exec_fail_on_error();
+  void test_exec_streaming();
+  void test_exec_streaming_fail_on_error();
+  void test_run_subprocess();
+  void test_run_subprocess_timeout();
+  void test_run_subprocess_timeout_fail_on_error();
+  void test_run_subprocess_timeout_closed_output();
+  void test_run_subprocess_forwards_termination();
+  void test_run_subprocess_error_log_lines();
+  void test_report_subprocess_summary();
+  void test_json_escape();
+  void test_python_escape();
+  void test_write_segments();
+  void test_write_segments_if_changed();
+  void test_run_in_parallel();
+  void test_run_in_parallel_task_error();
 
  private:
+  /*!
+    \brief line-based lexical parse, as implemented before in-place lexing
+    @param lines physical lines of a snakefile
+    @return logical lines with comments pruned
+
+    kept as the reference for differential testing of lexical_parse
+   */
+  std::vector<std::string> baseline_lexical_parse(const std::vector<std::string> &lines) const;
   std::map<std::string, bool> _test_map;
   std::vector<std::string> _test_vec;
 };
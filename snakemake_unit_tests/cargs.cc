@@ -17,14 +17,33 @@ snakemake_unit_tests::params::params()
       update_outputs(false),
       update_pytest(false),
       include_entire_dag(false),
+      digest_outputs(false),
+      compress_test_data(false),
+      build_conda_envs(false),
+      ignore_cache(false),
       skip_validation(false),
+      subprocess_timeout(0.0),
+      subprocess_summary(""),
+      profile_json(""),
+      trace(""),
+      plan_only(false),
+      plan_json(""),
+      jobs(0),
+      memory_mb(0),
       config_filename(""),
       output_test_dir(""),
       snakefile(""),
       pipeline_top_dir(""),
       pipeline_run_dir(""),
       inst_dir(""),
-      snakemake_log("") {}
+      snakemake_log(""),
+      run_dir_strategy(""),
+      conda_prefix(""),
+      workspace_dir(""),
+      expected_dir(""),
+      expected_digests(""),
+      compressed_files(""),
+      run_dir("") {}
 
 snakemake_unit_tests::params::params(const params &obj)
     : verbose(obj.verbose),
@@ -36,7 +55,19 @@ snakemake_unit_tests::params::params(const params &obj)
       update_outputs(obj.update_outputs),
       update_pytest(obj.update_pytest),
       include_entire_dag(obj.include_entire_dag),
+      digest_outputs(obj.digest_outputs),
+      compress_test_data(obj.compress_test_data),
+      build_conda_envs(obj.build_conda_envs),
+      ignore_cache(obj.ignore_cache),
       skip_validation(obj.skip_validation),
+      subprocess_timeout(obj.subprocess_timeout),
+      subprocess_summary(obj.subprocess_summary),
+      profile_json(obj.profile_json),
+      trace(obj.trace),
+      plan_only(obj.plan_only),
+      plan_json(obj.plan_json),
+      jobs(obj.jobs),
+      memory_mb(obj.memory_mb),
       config_filename(obj.config_filename),
       config(obj.config),
       output_test_dir(obj.output_test_dir),
@@ -50,7 +81,15 @@ snakemake_unit_tests::params::params(const params &obj)
       include_rules(obj.include_rules),
       exclude_rules(obj.exclude_rules),
       exclude_patterns(obj.exclude_patterns),
-      comparators(obj.comparators) {}
+      comparators(obj.comparators),
+      run_dir_strategy(obj.run_dir_strategy),
+      conda_prefix(obj.conda_prefix),
+      workspace_dir(obj.workspace_dir),
+      expected_dir(obj.expected_dir),
+      expected_digests(obj.expected_digests),
+      compressed_files(obj.compressed_files),
+      run_dir(obj.run_dir),
+      comparison_exclusions(obj.comparison_exclusions) {}
 
 snakemake_unit_tests::params::~params() throw() {}
 
@@ -89,8 +128,55 @@ void snakemake_unit_tests::cargs::initialize_options() {
       "include-entire-dag",
       "add entire DAG to test snakefiles, instead of choosing target rules "
       "only (not recommended)")(
+      "digest-outputs",
+      "with --update-outputs: store SHA-256 digests of rule outputs in each test's expected.sha256, "
+      "instead of copies of the outputs")(
+      "compress-test-data",
+      "with --update-inputs or --update-outputs: gzip copied rule inputs and outputs under their own names, "
+      "listing them in each test's compressed.txt")(
       "disable-config-validation",
-      "skip validation of user configuration yaml (if provided) with json schema (not recommended)");
+      "skip validation of user configuration yaml (if provided) with json schema (not recommended)")(
+      "subprocess-timeout", boost::program_options::value<double>(),
+      "kill any snakemake subprocess still running after this many seconds; 0 or unset for no limit")(
+      "subprocess-summary", boost::program_options::value<std::string>(),
+      "write wall time, cpu time, and peak memory of each snakemake subprocess to this tab-delimited file")(
+      "profile-json", boost::program_options::value<std::string>(),
+      "write wall time, cpu time, peak memory, i/o volume, and subprocess counts for each phase and each "
+      "emitted rule to this JSON file")(
+      "trace", boost::program_options::value<std::string>(),
+      "write a trace of generator activity to this file, for chrome://tracing or Perfetto")(
+      "plan-only",
+      "report the rules that would be tested, their dependent rules, and the files that would be copied, "
+      "without copying files or running dry runs")(
+      "plan-json", boost::program_options::value<std::string>(),
+      "write the --plan-only report to this JSON file instead of the screen; implies --plan-only")(
+      "conda-prefix", boost::program_options::value<std::string>(),
+      "with --update-pytest: shared directory in which emitted tests create conda environments")(
+      "build-conda-envs",
+      "with 'run': create the conda environments that tests share in their --conda-prefix, each once, "
+      "before running any test")(
+      "ignore-cache",
+      "with 'run': run every test, including those whose fingerprint passed before; passes are still recorded")(
+      "jobs,j", boost::program_options::value<unsigned>(),
+      "with 'run': number of cores tests may use at once, counting each test's logged threads; "
+      "with 'compare': number of files to compare at once; with --digest-outputs: number of outputs to "
+      "digest at once; with --compress-test-data: number of files to compress at once; with "
+      "--build-conda-envs: number of environments to create at once; when emitting tests: number of files "
+      "to hash at once for each test's fingerprint, which reads all of its workspace/ and expected/ data; "
+      "0 or unset for every core")(
+      "memory-mb", boost::program_options::value<unsigned long long>(),
+      "with 'run': MB of memory tests may use at once, counting each test's logged mem_mb; "
+      "0 or unset for all physical memory")(
+      "workspace-dir", boost::program_options::value<std::string>(), "with 'compare': directory of a test's inputs")(
+      "expected-dir", boost::program_options::value<std::string>(),
+      "with 'compare': directory of a test's expected outputs")(
+      "expected-digests", boost::program_options::value<std::string>(),
+      "with 'compare': manifest of digests of expected outputs, as written by --digest-outputs")(
+      "compressed-files", boost::program_options::value<std::string>(),
+      "with 'compare': list of a test's gzipped files, as written by --compress-test-data")(
+      "run-dir", boost::program_options::value<std::string>(), "with 'compare': directory in which a test ran")(
+      "comparison-exclusions", boost::program_options::value<std::vector<std::string> >(),
+      "with 'compare': substrings of paths to skip when comparing outputs");
 }
 
 snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool use_schema_validation) const {
@@ -181,6 +267,17 @@ snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool us
       if (p.config.query_valid("comparators")) {
         p.comparators = p.config.get_node("comparators");
       }
+      if (p.config.query_valid("conda-prefix")) {
+        p.conda_prefix = p.config.get_entry("conda-prefix");
+      }
+      if (p.config.query_valid("run-dir-strategy")) {
+        p.run_dir_strategy = p.config.get_entry("run-dir-strategy");
+        if (p.run_dir_strategy.compare("reflink") && p.run_dir_strategy.compare("hardlink") &&
+            p.run_dir_strategy.compare("copy")) {
+          throw std::runtime_error("run-dir-strategy \"" + p.run_dir_strategy +
+                                   "\" is not one of \"reflink\", \"hardlink\", or \"copy\"");
+        }
+      }
     } else {
       throw std::runtime_error("configuration file \"" + p.config_filename.string() + "\" is not a regular file");
     }
@@ -198,11 +295,24 @@ snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool us
   p.update_outputs = update_outputs();
   p.update_pytest = update_pytest();
   p.include_entire_dag = include_entire_dag();
+  p.digest_outputs = digest_outputs();
+  p.compress_test_data = compress_test_data();
+  // run monitoring: just accept CLI, as these describe this run rather than the tests
+  p.subprocess_timeout = get_subprocess_timeout();
+  p.subprocess_summary = get_subprocess_summary();
+  p.profile_json = get_profile_json();
+  p.trace = get_trace();
+  p.plan_json = get_plan_json();
+  p.plan_only = plan_only() || !p.plan_json.string().empty();
+  p.jobs = get_jobs();
 
   // output_test_dir: override if specified
   p.output_test_dir = override_if_specified(get_output_test_dir(), p.output_test_dir);
   // snakefile: override if specified
   p.snakefile = override_if_specified(get_snakefile(), p.snakefile);
+  // conda_prefix: override if specified; tests run from elsewhere, so it is made absolute
+  p.conda_prefix = override_if_specified(get_conda_prefix(), p.conda_prefix);
+  if (!p.conda_prefix.empty()) p.conda_prefix = boost::filesystem::absolute(p.conda_prefix);
   // pipeline_run_dir: override if specified, but then handle differently
   p.pipeline_top_dir = override_if_specified(get_pipeline_top_dir(), p.pipeline_top_dir);
   if (p.pipeline_top_dir.string().empty()) {
@@ -240,6 +350,10 @@ snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool us
 
   // consistency checks
   // verbose is fine regardless
+  // subprocess_timeout: should not be negative
+  if (p.subprocess_timeout < 0.0) {
+    throw std::runtime_error("subprocess timeout should be zero (no limit) or a positive number of seconds");
+  }
   // output_test_dir: doesn't have trailing separator, but doesn't have to exist
   p.output_test_dir = p.output_test_dir.remove_trailing_separator();
   // but it should at least be nonempty
@@ -293,6 +407,74 @@ snakemake_unit_tests::params snakemake_unit_tests::cargs::set_parameters(bool us
   return p;
 }
 
+snakemake_unit_tests::params snakemake_unit_tests::cargs::set_run_parameters() const {
+  params p;
+  p.config_filename = get_config_yaml();
+  if (!p.config_filename.string().empty()) {
+    if (!boost::filesystem::is_regular_file(p.config_filename)) {
+      throw std::runtime_error("configuration file \"" + p.config_filename.string() + "\" is not a regular file");
+    }
+    p.config.load_file(p.config_filename.string());
+    if (p.config.query_valid("output-test-dir")) {
+      p.output_test_dir = p.config.get_entry("output-test-dir");
+    }
+    if (p.config.query_valid("include-rules")) {
+      p.include_rules = vector_to_map<std::string>(p.config.get_sequence("include-rules"));
+    }
+    if (p.config.query_valid("exclude-rules")) {
+      p.exclude_rules = vector_to_map<std::string>(p.config.get_sequence("exclude-rules"));
+    }
+  }
+  p.verbose = verbose();
+  p.subprocess_timeout = get_subprocess_timeout();
+  p.subprocess_summary = get_subprocess_summary();
+  p.trace = get_trace();
+  p.jobs = get_jobs();
+  p.memory_mb = get_memory_mb();
+  p.build_conda_envs = build_conda_envs();
+  p.ignore_cache = ignore_cache();
+  p.output_test_dir = override_if_specified(get_output_test_dir(), p.output_test_dir);
+  add_contents<std::string>(get_include_rules(), &p.include_rules);
+  add_contents<std::string>(get_exclude_rules(), &p.exclude_rules);
+
+  if (p.subprocess_timeout < 0.0) {
+    throw std::runtime_error("subprocess timeout should be zero (no limit) or a positive number of seconds");
+  }
+  p.output_test_dir = p.output_test_dir.remove_trailing_separator();
+  check_nonempty(p.output_test_dir, "output-test-dir");
+  check_and_fix_dir(&p.output_test_dir, "", "output-test-dir");
+  return p;
+}
+
+snakemake_unit_tests::params snakemake_unit_tests::cargs::set_compare_parameters() const {
+  params p;
+  p.config_filename = get_config_yaml();
+  if (!p.config_filename.string().empty()) {
+    if (!boost::filesystem::is_regular_file(p.config_filename)) {
+      throw std::runtime_error("configuration file \"" + p.config_filename.string() + "\" is not a regular file");
+    }
+    p.config.load_file(p.config_filename.string());
+    if (p.config.query_valid("exclude-patterns")) {
+      p.exclude_patterns = vector_to_map<std::string>(p.config.get_sequence("exclude-patterns"));
+    }
+    if (p.config.query_valid("comparators")) {
+      p.comparators = p.config.get_node("comparators");
+    }
+  }
+  p.verbose = verbose();
+  p.jobs = get_jobs();
+  p.workspace_dir = get_workspace_dir();
+  p.expected_dir = get_expected_dir();
+  p.expected_digests = get_expected_digests();
+  p.compressed_files = get_compressed_files();
+  p.run_dir = get_run_dir();
+  p.comparison_exclusions = get_comparison_exclusions();
+  check_nonempty(p.workspace_dir, "workspace-dir");
+  check_nonempty(p.expected_dir, "expected-dir");
+  check_nonempty(p.run_dir, "run-dir");
+  return p;
+}
+
 boost::filesystem::path snakemake_unit_tests::cargs::override_if_specified(
     const std::string &cli_entry, const boost::filesystem::path &params_entry) const {
   return cli_entry.empty() ? params_entry : boost::filesystem::path(cli_entry);
@@ -375,6 +557,10 @@ void snakemake_unit_tests::params::report_settings(const boost::filesystem::path
   if (comparators.size()) {
     out << YAML::Key << "comparators" << YAML::Value << comparators;
   }
+  // run-dir-strategy
+  if (!run_dir_strategy.empty()) {
+    out << YAML::Key << "run-dir-strategy" << YAML::Value << run_dir_strategy;
+  }
   // end the content
   out << YAML::EndMap;
   // write to output file
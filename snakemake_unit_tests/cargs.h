@@ -144,6 +144,22 @@ class params {
    the actual tests.
    */
   bool include_entire_dag;
+  /*!
+    @brief store digests of rule outputs in a manifest, instead of copies of the outputs
+   */
+  bool digest_outputs;
+  /*!
+    @brief gzip copied rule inputs and outputs under their own names
+   */
+  bool compress_test_data;
+  /*!
+    @brief with run: create the conda environments tests share before running them
+   */
+  bool build_conda_envs;
+  /*!
+    @brief with run: run tests even if their fingerprint passed before
+   */
+  bool ignore_cache;
   /*!
     @brief do not attempt to validate user configuration file, if provided,
     agaist json schema in inst/user_config_schema.yaml
@@ -152,6 +168,38 @@ class params {
     but doesn't want to update the json schema to support it
    */
   bool skip_validation;
+  /*!
+    @brief wall-clock limit, in seconds, for each snakemake subprocess; 0 for no limit
+   */
+  double subprocess_timeout;
+  /*!
+    @brief optional tab-delimited report of resource use of each snakemake subprocess
+   */
+  boost::filesystem::path subprocess_summary;
+  /*!
+    @brief optional JSON report of resource use per phase and per emitted rule
+   */
+  boost::filesystem::path profile_json;
+  /*!
+    @brief optional Chrome trace event file of generator activity
+   */
+  boost::filesystem::path trace;
+  /*!
+    @brief report what tests would be emitted, without emitting them
+   */
+  bool plan_only;
+  /*!
+    @brief optional JSON file for the plan; implies plan_only
+   */
+  boost::filesystem::path plan_json;
+  /*!
+    @brief number of cores the run subcommand's tests may use at once; 0 for every core
+   */
+  unsigned jobs;
+  /*!
+    @brief MB of memory the run subcommand's tests may use at once; 0 for all physical memory
+   */
+  unsigned long long memory_mb;
   /*!
     @brief name of yaml configuration file
    */
@@ -209,6 +257,39 @@ class params {
     @brief user-defined file extensions to flag as needing binary comparison
    */
   YAML::Node comparators;
+  /*!
+    @brief how tests populate their run directories: "reflink", "hardlink", or "copy";
+    empty to leave the choice to the tests
+   */
+  std::string run_dir_strategy;
+  /*!
+    @brief shared prefix in which emitted tests create conda environments; empty for none
+   */
+  boost::filesystem::path conda_prefix;
+  /*!
+    @brief with compare: directory of a test's inputs
+   */
+  boost::filesystem::path workspace_dir;
+  /*!
+    @brief with compare: directory of a test's expected outputs
+   */
+  boost::filesystem::path expected_dir;
+  /*!
+    @brief with compare: optional manifest of digests of expected outputs not stored in expected_dir
+   */
+  boost::filesystem::path expected_digests;
+  /*!
+    @brief with compare: optional list of a test's files that are stored gzipped under their own names
+   */
+  boost::filesystem::path compressed_files;
+  /*!
+    @brief with compare: directory in which a test ran
+   */
+  boost::filesystem::path run_dir;
+  /*!
+    @brief with compare: substrings of paths to skip, beyond exclude_patterns
+   */
+  std::vector<std::string> comparison_exclusions;
 };
 
 /*!
@@ -229,6 +310,10 @@ class cargs {
     _permitted_flags["help"] = true;
     _permitted_flags["verbose"] = true;
     _permitted_flags["include-entire-dag"] = true;
+    _permitted_flags["digest-outputs"] = true;
+    _permitted_flags["compress-test-data"] = true;
+    _permitted_flags["build-conda-envs"] = true;
+    _permitted_flags["ignore-cache"] = true;
     _permitted_flags["disable-config-validation"] = true;
     _permitted_flags["update-all"] = true;
     _permitted_flags["update-pytest"] = true;
@@ -237,6 +322,7 @@ class cargs {
     _permitted_flags["update-config"] = true;
     _permitted_flags["update-inputs"] = true;
     _permitted_flags["update-outputs"] = true;
+    _permitted_flags["plan-only"] = true;
   }
   /*!
     @brief copy constructor
@@ -269,6 +355,25 @@ class cargs {
    */
   params set_parameters(bool use_schema_validation = true) const;
 
+  /*!
+    @brief deal with parameter settings for the run subcommand
+    @return params object with the settings needed to run existing tests
+
+    only output-test-dir, include-rules, exclude-rules and the run controls
+    are resolved; the config yaml, if provided, is read without schema validation,
+    as none of the pipeline settings are needed
+   */
+  params set_run_parameters() const;
+
+  /*!
+    @brief deal with parameter settings for the compare subcommand
+    @return params object with the settings needed to check one test's outputs
+
+    exclude-patterns and comparators are taken from the config yaml, if provided,
+    read without schema validation; everything else comes from the command line
+   */
+  params set_compare_parameters() const;
+
   /*!
     @brief determine whether the user has requested help documentation
     @return whether the user has requested help documentation
@@ -409,6 +514,26 @@ class cargs {
     they arise with changing snakemake supported features.
    */
   bool include_entire_dag() const { return compute_flag("include-entire-dag"); }
+  /*!
+    @brief get user flag for storing digests of rule outputs instead of copies
+    @return whether the user wants digests of outputs
+   */
+  bool digest_outputs() const { return compute_flag("digest-outputs"); }
+  /*!
+    @brief get user flag for gzipping copied rule inputs and outputs
+    @return whether the user wants test data compressed
+   */
+  bool compress_test_data() const { return compute_flag("compress-test-data"); }
+  /*!
+    @brief get user flag for creating shared conda environments before running tests
+    @return whether the user wants environments built first
+   */
+  bool build_conda_envs() const { return compute_flag("build-conda-envs"); }
+  /*!
+    @brief get user flag for running tests whose fingerprint passed before
+    @return whether the user wants every test run
+   */
+  bool ignore_cache() const { return compute_flag("ignore-cache"); }
 
   /*!
     @brief get user flag for overriding schema validation of user-specified
@@ -477,6 +602,89 @@ class cargs {
    */
   bool verbose() const { return compute_flag("verbose"); }
 
+  /*!
+    @brief get user-specified wall-clock limit for each snakemake subprocess
+    @return limit in seconds, or 0 if no limit was requested
+   */
+  double get_subprocess_timeout() const { return compute_parameter<double>("subprocess-timeout", true); }
+
+  /*!
+    @brief get user-specified file for subprocess resource use report
+    @return name of report file, or empty string if no report was requested
+   */
+  std::string get_subprocess_summary() const { return compute_parameter<std::string>("subprocess-summary", true); }
+
+  /*!
+    @brief get user-specified file for per-phase and per-rule profiling report
+    @return name of report file, or empty string if no report was requested
+   */
+  std::string get_profile_json() const { return compute_parameter<std::string>("profile-json", true); }
+
+  /*!
+    @brief get user-specified file for trace event output
+    @return name of trace file, or empty string if no trace was requested
+   */
+  std::string get_trace() const { return compute_parameter<std::string>("trace", true); }
+
+  /*!
+    @brief get user flag for reporting planned tests instead of emitting them
+    @return whether the user wants only a plan
+   */
+  bool plan_only() const { return compute_flag("plan-only"); }
+
+  /*!
+    @brief get user-specified file for a JSON test plan
+    @return name of plan file, or empty string if no JSON plan was requested
+   */
+  std::string get_plan_json() const { return compute_parameter<std::string>("plan-json", true); }
+  /*!
+    @brief get user-specified shared prefix for conda environments of emitted tests
+    @return name of prefix directory, or empty string if not specified
+   */
+  std::string get_conda_prefix() const { return compute_parameter<std::string>("conda-prefix", true); }
+  /*!
+    @brief get user-specified number of cores for concurrent tests
+    @return number of cores, or 0 for every core
+   */
+  unsigned get_jobs() const { return compute_parameter<unsigned>("jobs", true); }
+  /*!
+    @brief get user-specified memory budget for concurrent tests
+    @return memory in MB, or 0 for all physical memory
+   */
+  unsigned long long get_memory_mb() const { return compute_parameter<unsigned long long>("memory-mb", true); }
+  /*!
+    @brief get user-specified directory of a test's inputs
+    @return name of directory, or empty string if not specified
+   */
+  std::string get_workspace_dir() const { return compute_parameter<std::string>("workspace-dir", true); }
+  /*!
+    @brief get user-specified directory of a test's expected outputs
+    @return name of directory, or empty string if not specified
+   */
+  std::string get_expected_dir() const { return compute_parameter<std::string>("expected-dir", true); }
+  /*!
+    @brief get user-specified manifest of digests of a test's expected outputs
+    @return name of manifest, or empty string if not specified
+   */
+  std::string get_expected_digests() const { return compute_parameter<std::string>("expected-digests", true); }
+  /*!
+    @brief get user-specified list of a test's files stored gzipped under their own names
+    @return name of list, or empty string if not specified
+   */
+  std::string get_compressed_files() const { return compute_parameter<std::string>("compressed-files", true); }
+  /*!
+    @brief get user-specified directory in which a test ran
+    @return name of directory, or empty string if not specified
+   */
+  std::string get_run_dir() const { return compute_parameter<std::string>("run-dir", true); }
+  /*!
+    @brief get user-specified substrings of paths to skip during comparison
+    @return substrings, or an empty vector if none were specified
+   */
+  std::vector<std::string> get_comparison_exclusions() const {
+    return compute_parameter<std::vector<std::string> >("comparison-exclusions", true);
+  }
+
   /*!
     @brief find status of arbitrary flag
     @param tag name of flag
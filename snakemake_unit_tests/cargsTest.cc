@@ -45,7 +45,12 @@ void snakemake_unit_tests::cargsTest::setUp() {
       "--pipeline-top-dir project --pipeline-run-dir rundir --snakefile Snakefile "
       "--verbose --update-all --update-snakefiles --update-added-content "
       "--update-config --update-inputs --update-outputs --update-pytest --include-entire-dag "
-      "--disable-config-validation";
+      "--disable-config-validation --subprocess-timeout 30.5 --subprocess-summary summary.tsv "
+      "--profile-json profile.json --trace trace.json --plan-only --plan-json plan.json --jobs 8 "
+      "--memory-mb 16000 --workspace-dir workspace --expected-dir expected --run-dir output "
+      "--comparison-exclusions benchmarks --digest-outputs --expected-digests expected.sha256 "
+      "--compress-test-data --compressed-files compressed.txt --conda-prefix conda --build-conda-envs "
+      "--ignore-cache";
   std::string shortform =
       "./snakemake_unit_tests.out -c configname.yaml "
       "-d added_dir -n keepme -e rulename -f added_file "
@@ -92,7 +97,19 @@ void snakemake_unit_tests::cargsTest::test_params_default_constructor() {
   CPPUNIT_ASSERT(!p.update_outputs);
   CPPUNIT_ASSERT(!p.update_pytest);
   CPPUNIT_ASSERT(!p.include_entire_dag);
+  CPPUNIT_ASSERT(!p.digest_outputs);
+  CPPUNIT_ASSERT(!p.compress_test_data);
+  CPPUNIT_ASSERT(!p.build_conda_envs);
+  CPPUNIT_ASSERT(!p.ignore_cache);
   CPPUNIT_ASSERT(!p.skip_validation);
+  CPPUNIT_ASSERT(p.subprocess_timeout == 0.0);
+  CPPUNIT_ASSERT(p.subprocess_summary.string().empty());
+  CPPUNIT_ASSERT(p.profile_json.string().empty());
+  CPPUNIT_ASSERT(p.trace.string().empty());
+  CPPUNIT_ASSERT(!p.plan_only);
+  CPPUNIT_ASSERT(p.plan_json.string().empty());
+  CPPUNIT_ASSERT(!p.jobs);
+  CPPUNIT_ASSERT(!p.memory_mb);
   CPPUNIT_ASSERT(p.config_filename.string().empty());
   CPPUNIT_ASSERT(p.config == yaml_reader());
   CPPUNIT_ASSERT(p.output_test_dir.string().empty());
@@ -107,13 +124,29 @@ void snakemake_unit_tests::cargsTest::test_params_default_constructor() {
   CPPUNIT_ASSERT(p.exclude_rules.empty());
   CPPUNIT_ASSERT(p.exclude_patterns.empty());
   CPPUNIT_ASSERT(!p.comparators.size());
+  CPPUNIT_ASSERT(p.run_dir_strategy.empty());
+  CPPUNIT_ASSERT(p.conda_prefix.string().empty());
+  CPPUNIT_ASSERT(p.workspace_dir.string().empty());
+  CPPUNIT_ASSERT(p.expected_dir.string().empty());
+  CPPUNIT_ASSERT(p.expected_digests.string().empty());
+  CPPUNIT_ASSERT(p.compressed_files.string().empty());
+  CPPUNIT_ASSERT(p.run_dir.string().empty());
+  CPPUNIT_ASSERT(p.comparison_exclusions.empty());
 }
 
 void snakemake_unit_tests::cargsTest::test_params_copy_constructor() {
   params p;
   p.verbose = p.update_all = p.update_snakefiles = p.update_added_content = true;
   p.update_config = p.update_inputs = p.update_outputs = p.update_pytest = p.include_entire_dag = p.skip_validation =
-      true;
+      p.digest_outputs = p.compress_test_data = p.build_conda_envs = p.ignore_cache = true;
+  p.subprocess_timeout = 12.5;
+  p.subprocess_summary = "thing0";
+  p.profile_json = "thing0a";
+  p.trace = "thing0b";
+  p.plan_only = true;
+  p.plan_json = "thing0c";
+  p.jobs = 3;
+  p.memory_mb = 4000;
   p.config_filename = "thing1";
   p.config._data = YAML::Load("[1, 2, 3]");
   p.output_test_dir = "thing2";
@@ -128,6 +161,14 @@ void snakemake_unit_tests::cargsTest::test_params_copy_constructor() {
   p.exclude_rules["thing10"] = true;
   p.exclude_patterns["thing11"] = true;
   p.comparators = YAML::Load("{comp1: {type: byte}}");
+  p.run_dir_strategy = "hardlink";
+  p.conda_prefix = "thing11a";
+  p.workspace_dir = "thing12";
+  p.expected_dir = "thing13";
+  p.expected_digests = "thing13a";
+  p.compressed_files = "thing13b";
+  p.run_dir = "thing14";
+  p.comparison_exclusions.push_back("thing15");
   params q(p);
   CPPUNIT_ASSERT(p.verbose == q.verbose);
   CPPUNIT_ASSERT(p.update_all = q.update_all);
@@ -138,7 +179,19 @@ void snakemake_unit_tests::cargsTest::test_params_copy_constructor() {
   CPPUNIT_ASSERT(p.update_outputs == q.update_outputs);
   CPPUNIT_ASSERT(p.update_pytest == q.update_pytest);
   CPPUNIT_ASSERT(p.include_entire_dag == q.include_entire_dag);
+  CPPUNIT_ASSERT(p.digest_outputs == q.digest_outputs);
+  CPPUNIT_ASSERT(p.compress_test_data == q.compress_test_data);
+  CPPUNIT_ASSERT(p.build_conda_envs == q.build_conda_envs);
+  CPPUNIT_ASSERT(p.ignore_cache == q.ignore_cache);
   CPPUNIT_ASSERT(p.skip_validation == q.skip_validation);
+  CPPUNIT_ASSERT(p.subprocess_timeout == q.subprocess_timeout);
+  CPPUNIT_ASSERT(p.subprocess_summary == q.subprocess_summary);
+  CPPUNIT_ASSERT(p.profile_json == q.profile_json);
+  CPPUNIT_ASSERT(p.trace == q.trace);
+  CPPUNIT_ASSERT(p.plan_only == q.plan_only);
+  CPPUNIT_ASSERT(p.plan_json == q.plan_json);
+  CPPUNIT_ASSERT(p.jobs == q.jobs);
+  CPPUNIT_ASSERT(p.memory_mb == q.memory_mb);
   CPPUNIT_ASSERT(p.config_filename == q.config_filename);
   CPPUNIT_ASSERT(p.config == q.config);
   CPPUNIT_ASSERT(p.output_test_dir == q.output_test_dir);
@@ -152,6 +205,14 @@ void snakemake_unit_tests::cargsTest::test_params_copy_constructor() {
   CPPUNIT_ASSERT(p.exclude_rules == q.exclude_rules);
   CPPUNIT_ASSERT(p.exclude_patterns == q.exclude_patterns);
   CPPUNIT_ASSERT(p.comparators == q.comparators);
+  CPPUNIT_ASSERT(p.run_dir_strategy == q.run_dir_strategy);
+  CPPUNIT_ASSERT(p.conda_prefix == q.conda_prefix);
+  CPPUNIT_ASSERT(p.workspace_dir == q.workspace_dir);
+  CPPUNIT_ASSERT(p.expected_dir == q.expected_dir);
+  CPPUNIT_ASSERT(p.expected_digests == q.expected_digests);
+  CPPUNIT_ASSERT(p.compressed_files == q.compressed_files);
+  CPPUNIT_ASSERT(p.run_dir == q.run_dir);
+  CPPUNIT_ASSERT(p.comparison_exclusions == q.comparison_exclusions);
 }
 void snakemake_unit_tests::cargsTest::test_params_report_settings() {
   boost::filesystem::path output_filename =
@@ -176,6 +237,7 @@ void snakemake_unit_tests::cargsTest::test_params_report_settings() {
   p.exclude_rules["rulename2"] = true;
   p.exclude_patterns["path1"] = true;
   p.comparators = YAML::Load("{comp1: {type: byte, patterns: ext1, args: {arg1: arg2}}}");
+  p.run_dir_strategy = "copy";
   p.report_settings(output_filename);
   std::string pwd = boost::filesystem::current_path().string();
   std::string expected_contents = "output-test-dir: " + pwd +
@@ -200,7 +262,8 @@ void snakemake_unit_tests::cargsTest::test_params_report_settings() {
                                   "include-rules:\n  - keepme1\n  - keepme2\n"
                                   "exclude-rules:\n  - rulename1\n  - rulename2\n"
                                   "exclude-patterns:\n  - path1\n"
-                                  "comparators: {comp1: {type: byte, patterns: ext1, args: {arg1: arg2}}}\n";
+                                  "comparators: {comp1: {type: byte, patterns: ext1, args: {arg1: arg2}}}\n"
+                                  "run-dir-strategy: copy\n";
   std::ifstream input;
   std::string line = "";
   std::ostringstream observed_contents;
@@ -317,6 +380,21 @@ void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_inst_dir_missing
   cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
   ap.set_parameters(true);
 }
+void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_run_dir_strategy_invalid() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path configfile = tmp_parent / "sprdsi_config.yaml";
+  boost::filesystem::path instdir = tmp_parent / "sprdsi_inst";
+  boost::filesystem::create_directories(instdir);
+  std::ofstream output;
+  output.open(configfile.string().c_str());
+  output << "run-dir-strategy: symlink\n";
+  output.close();
+  std::string command =
+      "./snakemake_unit_tests.out --update-all -c " + configfile.string() + " --inst-dir " + instdir.string();
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  ap.set_parameters(false);
+}
 void snakemake_unit_tests::cargsTest::test_cargs_validate_config_schema_violation() {
   boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
   boost::filesystem::path configfile = tmp_parent / "spidsv_config.yaml";
@@ -373,10 +451,19 @@ void snakemake_unit_tests::cargsTest::test_cargs_copy_constructor() {
                              ap2._vm.count(prev));
       // handle multiple value parameters separately
       if (!prev.compare("added-directories") || !prev.compare("added-files") || !prev.compare("include-rules") ||
-          !prev.compare("exclude-rules")) {
+          !prev.compare("exclude-rules") || !prev.compare("comparison-exclusions")) {
         std::vector<std::string> result = ap2._vm[prev].as<std::vector<std::string> >();
         CPPUNIT_ASSERT_MESSAGE("cargs copy constructor key->value: " + prev + " -> " + current,
                                result.size() == 1 && !result.at(0).compare(current));
+      } else if (!prev.compare("subprocess-timeout")) {
+        CPPUNIT_ASSERT_MESSAGE("cargs copy constructor key->value: " + prev + " -> " + current,
+                               ap2._vm[prev].as<double>() == std::stod(current));
+      } else if (!prev.compare("jobs")) {
+        CPPUNIT_ASSERT_MESSAGE("cargs copy constructor key->value: " + prev + " -> " + current,
+                               ap2._vm[prev].as<unsigned>() == std::stoul(current));
+      } else if (!prev.compare("memory-mb")) {
+        CPPUNIT_ASSERT_MESSAGE("cargs copy constructor key->value: " + prev + " -> " + current,
+                               ap2._vm[prev].as<unsigned long long>() == std::stoull(current));
       } else {
         std::string result = ap2._vm[prev].as<std::string>();
         CPPUNIT_ASSERT_MESSAGE("cargs copy constructor key->value: " + prev + " -> " + current,
@@ -422,6 +509,11 @@ void snakemake_unit_tests::cargsTest::test_cargs_initialize_options() {
   CPPUNIT_ASSERT(o.str().find("--update-outputs") != std::string::npos);
   CPPUNIT_ASSERT(o.str().find("--update-pytest") != std::string::npos);
   CPPUNIT_ASSERT(o.str().find("--include-entire-dag") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--digest-outputs") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--compress-test-data") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--conda-prefix") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--build-conda-envs") != std::string::npos);
+  CPPUNIT_ASSERT(o.str().find("--ignore-cache") != std::string::npos);
   CPPUNIT_ASSERT(o.str().find("--disable-config-validation") != std::string::npos);
 }
 void snakemake_unit_tests::cargsTest::test_cargs_set_parameters() {
@@ -445,6 +537,8 @@ void snakemake_unit_tests::cargsTest::test_cargs_set_parameters() {
     - (update-outputs, NA, update_outputs)
     - (update-pytest, NA, update_pytest)
     - (include-entire-dag, NA, include_entire_dag)
+    - (digest-outputs, NA, digest_outputs)
+    - (compress-test-data, NA, compress_test_data)
     - (disable-config-validation, NA, skip_validation)
 
     parameters that override when present on the CLI:
@@ -456,6 +550,8 @@ void snakemake_unit_tests::cargsTest::test_cargs_set_parameters() {
     -   if this is NOT specified, it should be set to '.'
     - (inst-dir, inst-dir, inst_dir)
     - (snakemake-log, snakemake-log, snakemake_log)
+    - (conda-prefix, conda-prefix, conda_prefix)
+    -   made absolute, as tests run from elsewhere
 
     parameters that augment when present on the CLI:
     - (added-files, added-files, added_files)
@@ -1136,6 +1232,81 @@ void snakemake_unit_tests::cargsTest::test_cargs_set_parameters_added_directorie
   params p = ap.set_parameters(false);
 }
 
+void snakemake_unit_tests::cargsTest::test_cargs_set_run_parameters() {
+  // only the test directory and run controls are needed
+  boost::filesystem::path prefix = std::string(_tmp_dir);
+  boost::filesystem::path output_dir = prefix / "tests";
+  std::filesystem::create_directory(output_dir.string().c_str());
+  boost::filesystem::path config = prefix / "config.yaml";
+  std::ofstream output(config.string().c_str());
+  output << "output-test-dir: " << (prefix / "other").string() << "\n"
+         << "snakefile: not/a/real/Snakefile\n"
+         << "exclude-rules:\n  - rule1\n";
+  output.close();
+  std::string command = "run --config " + config.string() + " --output-test-dir " + output_dir.string() +
+                        "/ --exclude-rules rule2 --include-rules rule3 --jobs 4 --memory-mb 2000 "
+                        "--subprocess-timeout 10 --build-conda-envs --ignore-cache -v";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  params p = ap.set_run_parameters();
+  CPPUNIT_ASSERT(p.output_test_dir == output_dir);
+  CPPUNIT_ASSERT(p.exclude_rules.size() == 2);
+  CPPUNIT_ASSERT(p.exclude_rules.find("rule1") != p.exclude_rules.end());
+  CPPUNIT_ASSERT(p.exclude_rules.find("rule2") != p.exclude_rules.end());
+  CPPUNIT_ASSERT(p.include_rules.size() == 1);
+  CPPUNIT_ASSERT(p.jobs == 4);
+  CPPUNIT_ASSERT(p.memory_mb == 2000);
+  CPPUNIT_ASSERT(p.subprocess_timeout == 10.0);
+  CPPUNIT_ASSERT(p.build_conda_envs);
+  CPPUNIT_ASSERT(p.ignore_cache);
+  CPPUNIT_ASSERT(p.verbose);
+  CPPUNIT_ASSERT(p.snakefile.string().empty());
+}
+
+void snakemake_unit_tests::cargsTest::test_cargs_set_run_parameters_output_dir_missing() {
+  boost::filesystem::path prefix = std::string(_tmp_dir);
+  std::string command = "run --output-test-dir " + (prefix / "absent").string();
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  params p = ap.set_run_parameters();
+}
+
+void snakemake_unit_tests::cargsTest::test_cargs_set_compare_parameters() {
+  // only the comparison settings are taken from the config
+  boost::filesystem::path prefix = std::string(_tmp_dir);
+  boost::filesystem::path config = prefix / "config.yaml";
+  std::ofstream output(config.string().c_str());
+  output << "snakefile: not/a/real/Snakefile\n"
+         << "exclude-patterns:\n  - \"\\\\.log$\"\n"
+         << "comparators:\n  - type: byte\n    patterns:\n      - \"\\\\.bam$\"\n";
+  output.close();
+  std::string command = "compare --config " + config.string() +
+                        " --workspace-dir unit/rule/workspace --expected-dir unit/rule/expected "
+                        "--run-dir unit/rule/output --comparison-exclusions benchmarks --comparison-exclusions "
+                        "tmp -j 2";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  params p = ap.set_compare_parameters();
+  CPPUNIT_ASSERT(p.workspace_dir == "unit/rule/workspace");
+  CPPUNIT_ASSERT(p.expected_dir == "unit/rule/expected");
+  CPPUNIT_ASSERT(p.expected_digests.string().empty());
+  CPPUNIT_ASSERT(p.compressed_files.string().empty());
+  CPPUNIT_ASSERT(p.run_dir == "unit/rule/output");
+  CPPUNIT_ASSERT(p.comparison_exclusions.size() == 2);
+  CPPUNIT_ASSERT(p.exclude_patterns.size() == 1);
+  CPPUNIT_ASSERT(p.exclude_patterns.find("\\.log$") != p.exclude_patterns.end());
+  CPPUNIT_ASSERT(p.comparators.IsSequence() && p.comparators.size() == 1);
+  CPPUNIT_ASSERT(p.jobs == 2);
+  CPPUNIT_ASSERT(p.snakefile.string().empty());
+}
+
+void snakemake_unit_tests::cargsTest::test_cargs_set_compare_parameters_run_dir_missing() {
+  std::string command = "compare --workspace-dir workspace --expected-dir expected";
+  populate_arguments(command, &_arg_vec_adhoc, &_argv_adhoc);
+  cargs ap(_arg_vec_adhoc.size(), _argv_adhoc);
+  params p = ap.set_compare_parameters();
+}
+
 void snakemake_unit_tests::cargsTest::test_cargs_help() {
   cargs ap(_arg_vec_long.size(), _argv_long);
   CPPUNIT_ASSERT_MESSAGE("cargs help request detected", ap.help());
@@ -1192,6 +1363,30 @@ void snakemake_unit_tests::cargsTest::test_cargs_include_entire_dag() {
   cargs ap(_arg_vec_long.size(), _argv_long);
   CPPUNIT_ASSERT(ap.include_entire_dag());
 }
+void snakemake_unit_tests::cargsTest::test_cargs_digest_outputs() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap1.digest_outputs());
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap2.digest_outputs());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_compress_test_data() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap1.compress_test_data());
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap2.compress_test_data());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_build_conda_envs() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap1.build_conda_envs());
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap2.build_conda_envs());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_ignore_cache() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap1.ignore_cache());
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap2.ignore_cache());
+}
 void snakemake_unit_tests::cargsTest::test_cargs_skip_validation() {
   cargs ap(_arg_vec_long.size(), _argv_long);
   CPPUNIT_ASSERT(ap.skip_validation());
@@ -1228,6 +1423,97 @@ void snakemake_unit_tests::cargsTest::test_cargs_verbose() {
   cargs ap(_arg_vec_long.size(), _argv_long);
   CPPUNIT_ASSERT(ap.verbose());
 }
+void snakemake_unit_tests::cargsTest::test_cargs_get_subprocess_timeout() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap1.get_subprocess_timeout() == 30.5);
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_subprocess_timeout() == 0.0);
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_subprocess_summary() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap1.get_subprocess_summary().compare("summary.tsv"));
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_subprocess_summary().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_profile_json() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap1.get_profile_json().compare("profile.json"));
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_profile_json().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_trace() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap1.get_trace().compare("trace.json"));
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_trace().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_plan_only() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap1.plan_only());
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap2.plan_only());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_plan_json() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap1.get_plan_json().compare("plan.json"));
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_plan_json().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_conda_prefix() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap1.get_conda_prefix().compare("conda"));
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_conda_prefix().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_jobs() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap1.get_jobs() == 8);
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap2.get_jobs());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_memory_mb() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(ap1.get_memory_mb() == 16000);
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(!ap2.get_memory_mb());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_workspace_dir() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap1.get_workspace_dir().compare("workspace"));
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_workspace_dir().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_expected_dir() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap1.get_expected_dir().compare("expected"));
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_expected_dir().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_expected_digests() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap1.get_expected_digests().compare("expected.sha256"));
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_expected_digests().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_compressed_files() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap1.get_compressed_files().compare("compressed.txt"));
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_compressed_files().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_run_dir() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  CPPUNIT_ASSERT(!ap1.get_run_dir().compare("output"));
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_run_dir().empty());
+}
+void snakemake_unit_tests::cargsTest::test_cargs_get_comparison_exclusions() {
+  cargs ap1(_arg_vec_long.size(), _argv_long);
+  std::vector<std::string> exclusions = ap1.get_comparison_exclusions();
+  CPPUNIT_ASSERT(exclusions.size() == 1 && !exclusions.at(0).compare("benchmarks"));
+  cargs ap2(_arg_vec_short.size(), _argv_short);
+  CPPUNIT_ASSERT(ap2.get_comparison_exclusions().empty());
+}
 void snakemake_unit_tests::cargsTest::test_cargs_compute_flag() {
   // note that a desired behavior might be for this to not behave
   // gracefully but rather crash when an unsupported flag is queried
@@ -1237,6 +1523,10 @@ void snakemake_unit_tests::cargsTest::test_cargs_compute_flag() {
   CPPUNIT_ASSERT_MESSAGE("cargs compute_flag gracefully handles absent tags", !ap.compute_flag("update-all"));
   // make sure all permitted flags are in fact permitted
   CPPUNIT_ASSERT(!ap.compute_flag("include-entire-dag"));
+  CPPUNIT_ASSERT(!ap.compute_flag("digest-outputs"));
+  CPPUNIT_ASSERT(!ap.compute_flag("compress-test-data"));
+  CPPUNIT_ASSERT(!ap.compute_flag("build-conda-envs"));
+  CPPUNIT_ASSERT(!ap.compute_flag("ignore-cache"));
   CPPUNIT_ASSERT(!ap.compute_flag("disable-config-validation"));
   CPPUNIT_ASSERT(!ap.compute_flag("update-all"));
   CPPUNIT_ASSERT(!ap.compute_flag("update-snakefiles"));
@@ -1245,6 +1535,7 @@ void snakemake_unit_tests::cargsTest::test_cargs_compute_flag() {
   CPPUNIT_ASSERT(!ap.compute_flag("update-outputs"));
   CPPUNIT_ASSERT(!ap.compute_flag("update-pytest"));
   CPPUNIT_ASSERT(!ap.compute_flag("update-config"));
+  CPPUNIT_ASSERT(!ap.compute_flag("plan-only"));
 }
 void snakemake_unit_tests::cargsTest::test_cargs_compute_flag_invalid_flag() {
   cargs ap(_arg_vec_short.size(), _argv_short);
@@ -53,7 +53,12 @@ class cargsTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_snakemake_log_missing, std::logic_error);
   CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_added_files_invalid, std::logic_error);
   CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_added_directories_invalid, std::logic_error);
+  CPPUNIT_TEST(test_cargs_set_run_parameters);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_run_parameters_output_dir_missing, std::logic_error);
+  CPPUNIT_TEST(test_cargs_set_compare_parameters);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_compare_parameters_run_dir_missing, std::logic_error);
   CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_inst_dir_missing_schema, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_cargs_set_parameters_run_dir_strategy_invalid, std::runtime_error);
   CPPUNIT_TEST(test_cargs_help);
   CPPUNIT_TEST(test_cargs_get_config_yaml);
   CPPUNIT_TEST(test_cargs_get_snakefile);
@@ -67,6 +72,10 @@ class cargsTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_cargs_get_include_rules);
   CPPUNIT_TEST(test_cargs_get_exclude_rules);
   CPPUNIT_TEST(test_cargs_include_entire_dag);
+  CPPUNIT_TEST(test_cargs_digest_outputs);
+  CPPUNIT_TEST(test_cargs_compress_test_data);
+  CPPUNIT_TEST(test_cargs_build_conda_envs);
+  CPPUNIT_TEST(test_cargs_ignore_cache);
   CPPUNIT_TEST(test_cargs_skip_validation);
   CPPUNIT_TEST(test_cargs_update_all);
   CPPUNIT_TEST(test_cargs_update_snakefiles);
@@ -76,6 +85,21 @@ class cargsTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_cargs_update_outputs);
   CPPUNIT_TEST(test_cargs_update_pytest);
   CPPUNIT_TEST(test_cargs_verbose);
+  CPPUNIT_TEST(test_cargs_get_subprocess_timeout);
+  CPPUNIT_TEST(test_cargs_get_subprocess_summary);
+  CPPUNIT_TEST(test_cargs_get_profile_json);
+  CPPUNIT_TEST(test_cargs_get_trace);
+  CPPUNIT_TEST(test_cargs_plan_only);
+  CPPUNIT_TEST(test_cargs_get_plan_json);
+  CPPUNIT_TEST(test_cargs_get_conda_prefix);
+  CPPUNIT_TEST(test_cargs_get_jobs);
+  CPPUNIT_TEST(test_cargs_get_memory_mb);
+  CPPUNIT_TEST(test_cargs_get_workspace_dir);
+  CPPUNIT_TEST(test_cargs_get_expected_dir);
+  CPPUNIT_TEST(test_cargs_get_expected_digests);
+  CPPUNIT_TEST(test_cargs_get_compressed_files);
+  CPPUNIT_TEST(test_cargs_get_run_dir);
+  CPPUNIT_TEST(test_cargs_get_comparison_exclusions);
   CPPUNIT_TEST(test_cargs_compute_flag);
   CPPUNIT_TEST_EXCEPTION(test_cargs_compute_flag_invalid_flag, std::logic_error);
   CPPUNIT_TEST(test_cargs_compute_parameter);
@@ -128,7 +152,12 @@ class cargsTest : public CppUnit::TestFixture {
   void test_cargs_set_parameters_snakemake_log_missing();
   void test_cargs_set_parameters_added_files_invalid();
   void test_cargs_set_parameters_added_directories_invalid();
+  void test_cargs_set_run_parameters();
+  void test_cargs_set_run_parameters_output_dir_missing();
+  void test_cargs_set_compare_parameters();
+  void test_cargs_set_compare_parameters_run_dir_missing();
   void test_cargs_set_parameters_inst_dir_missing_schema();
+  void test_cargs_set_parameters_run_dir_strategy_invalid();
   void test_cargs_help();
   void test_cargs_get_config_yaml();
   void test_cargs_get_snakefile();
@@ -142,6 +171,10 @@ class cargsTest : public CppUnit::TestFixture {
   void test_cargs_get_include_rules();
   void test_cargs_get_exclude_rules();
   void test_cargs_include_entire_dag();
+  void test_cargs_digest_outputs();
+  void test_cargs_compress_test_data();
+  void test_cargs_build_conda_envs();
+  void test_cargs_ignore_cache();
   void test_cargs_skip_validation();
   void test_cargs_update_all();
   void test_cargs_update_snakefiles();
@@ -151,6 +184,21 @@ class cargsTest : public CppUnit::TestFixture {
   void test_cargs_update_outputs();
   void test_cargs_update_pytest();
   void test_cargs_verbose();
+  void test_cargs_get_subprocess_timeout();
+  void test_cargs_get_subprocess_summary();
+  void test_cargs_get_profile_json();
+  void test_cargs_get_trace();
+  void test_cargs_plan_only();
+  void test_cargs_get_plan_json();
+  void test_cargs_get_conda_prefix();
+  void test_cargs_get_jobs();
+  void test_cargs_get_memory_mb();
+  void test_cargs_get_workspace_dir();
+  void test_cargs_get_expected_dir();
+  void test_cargs_get_expected_digests();
+  void test_cargs_get_compressed_files();
+  void test_cargs_get_run_dir();
+  void test_cargs_get_comparison_exclusions();
   void test_cargs_compute_flag();
   void test_cargs_compute_flag_invalid_flag();
   void test_cargs_compute_parameter();
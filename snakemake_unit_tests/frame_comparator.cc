@@ -0,0 +1,325 @@
+/*!
+  \file frame_comparator.cc
+  \brief implementation of delimited table comparison with numeric tolerance
+  \copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#include "snakemake_unit_tests/frame_comparator.h"
+
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+/*!
+  @brief interpret a configured boolean
+  @param name name of the arg, for error messages
+  @param value configured value
+  @return the value as a boolean
+ */
+bool parse_bool(const std::string &name, const std::string &value) {
+  if (!value.compare("true") || !value.compare("True") || !value.compare("1")) return true;
+  if (value.empty() || !value.compare("false") || !value.compare("False") || !value.compare("0")) return false;
+  throw std::runtime_error("frame comparator arg " + name + " should be true or false, not \"" + value + "\"");
+}
+/*!
+  @brief interpret a configured tolerance
+  @param name name of the arg, for error messages
+  @param value configured value
+  @return the value as a number
+ */
+double parse_tolerance(const std::string &name, const std::string &value) {
+  double result = 0.0;
+  if (!snakemake_unit_tests::frame_comparator::parse_number(value, &result) || result < 0.0) {
+    throw std::runtime_error("frame comparator arg " + name + " should be a nonnegative number, not \"" + value +
+                             "\"");
+  }
+  return result;
+}
+/*!
+  @brief describe a cell for a difference report
+  @param cell text of the cell
+  @return the cell quoted, shortened if long
+ */
+std::string describe_cell(const std::string &cell) {
+  return "\"" + (cell.size() > 100 ? cell.substr(0, 100) + "..." : cell) + "\"";
+}
+}  // namespace
+
+snakemake_unit_tests::frame_comparator::frame_comparator()
+    : _sep("\t"), _has_header(true), _header_row(0), _index_col(""), _check_like(false), _rtol(1e-5), _atol(1e-8) {}
+
+snakemake_unit_tests::frame_comparator::frame_comparator(const std::map<std::string, std::string> &args)
+    : _sep("\t"), _has_header(true), _header_row(0), _index_col(""), _check_like(false), _rtol(1e-5), _atol(1e-8) {
+  std::map<std::string, std::string>::const_iterator finder;
+  if ((finder = args.find("sep")) != args.end()) {
+    if (finder->second.empty()) throw std::runtime_error("frame comparator arg sep cannot be empty");
+    _sep = finder->second;
+    // single-quoted yaml leaves escapes for pandas' regex engine to interpret
+    if (!_sep.compare("\\t")) _sep = "\t";
+  }
+  if ((finder = args.find("header")) != args.end()) {
+    if (finder->second.empty()) {
+      _has_header = false;
+    } else if (finder->second.compare("infer")) {
+      if (finder->second.find_first_not_of("0123456789") != std::string::npos) {
+        throw std::runtime_error("frame comparator arg header should be a row number or null, not \"" +
+                                 finder->second + "\"");
+      }
+      _header_row = std::stoul(finder->second);
+    }
+  }
+  if ((finder = args.find("index_col")) != args.end() && finder->second.compare("False") &&
+      finder->second.compare("false")) {
+    _index_col = finder->second;
+  }
+  if ((finder = args.find("check_like")) != args.end()) _check_like = parse_bool("check_like", finder->second);
+  if ((finder = args.find("rtol")) != args.end()) _rtol = parse_tolerance("rtol", finder->second);
+  if ((finder = args.find("atol")) != args.end()) _atol = parse_tolerance("atol", finder->second);
+}
+
+bool snakemake_unit_tests::frame_comparator::is_missing(const std::string &cell) {
+  static const char *markers[] = {"",       "#N/A", "#N/A N/A", "#NA",  "-1.#IND", "-1.#QNAN", "-NaN",
+                                  "-nan",   "1.#IND", "1.#QNAN", "<NA>", "N/A",     "NA",       "NULL",
+                                  "NaN",    "None", "n/a",      "nan",  "null"};
+  for (unsigned i = 0; i < sizeof(markers) / sizeof(markers[0]); ++i) {
+    if (!cell.compare(markers[i])) return true;
+  }
+  return false;
+}
+
+bool snakemake_unit_tests::frame_comparator::parse_number(const std::string &cell, double *target) {
+  if (!target) throw std::runtime_error("null pointer provided to parse_number");
+  if (cell.empty()) return false;
+  const char *start = cell.c_str(), *end = start + cell.size();
+  // from_chars, unlike pandas, rejects an explicit plus sign
+  if (*start == '+' && ++start != end && (*start == '+' || *start == '-')) return false;
+  if (start == end) return false;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  std::from_chars_result result = std::from_chars(start, end, *target);
+  return result.ec == std::errc() && result.ptr == end;
+#else
+  if (isspace(*start)) return false;
+  char *parsed_end = 0;
+  *target = strtod(start, &parsed_end);
+  return parsed_end == end;
+#endif
+}
+
+bool snakemake_unit_tests::frame_comparator::cells_equal(const std::string &generated,
+                                                         const std::string &expected) const {
+  if (!generated.compare(expected)) return true;
+  bool generated_missing = is_missing(generated), expected_missing = is_missing(expected);
+  if (generated_missing || expected_missing) return generated_missing && expected_missing;
+  double generated_value = 0.0, expected_value = 0.0;
+  if (!parse_number(generated, &generated_value) || !parse_number(expected, &expected_value)) return false;
+  if (std::isnan(generated_value) || std::isnan(expected_value)) {
+    return std::isnan(generated_value) && std::isnan(expected_value);
+  }
+  if (std::isinf(generated_value) || std::isinf(expected_value)) return generated_value == expected_value;
+  return std::fabs(generated_value - expected_value) <= _atol + _rtol * std::fabs(expected_value);
+}
+
+void snakemake_unit_tests::frame_comparator::split_fields(const std::string &line, const std::string &sep,
+                                                          std::vector<std::string> *target) {
+  if (!target) throw std::runtime_error("null pointer provided to split_fields");
+  target->clear();
+  std::string::size_type end = line.size();
+  if (end && line.at(end - 1) == '\n') --end;
+  // pandas reads a separator of runs of whitespace as a regex
+  bool whitespace = !sep.compare("\\s+");
+  std::string current = "";
+  bool quoted = false;
+  for (std::string::size_type i = 0; i < end;) {
+    if (quoted) {
+      if (line.at(i) == '"' && i + 1 < end && line.at(i + 1) == '"') {
+        current += '"';
+        i += 2;
+      } else if (line.at(i) == '"') {
+        quoted = false;
+        ++i;
+      } else {
+        current += line.at(i++);
+      }
+    } else if (line.at(i) == '"' && current.empty()) {
+      quoted = true;
+      ++i;
+    } else if (whitespace && isspace(line.at(i))) {
+      while (i < end && isspace(line.at(i))) ++i;
+      // leading whitespace does not start an empty field
+      if (!target->empty() || !current.empty()) target->push_back(current);
+      current = "";
+    } else if (!whitespace && !line.compare(i, sep.size(), sep)) {
+      target->push_back(current);
+      current = "";
+      i += sep.size();
+    } else {
+      current += line.at(i++);
+    }
+  }
+  if (!whitespace || !current.empty() || target->empty()) target->push_back(current);
+}
+
+bool snakemake_unit_tests::frame_comparator::next_row(table_reader *table) const {
+  std::string line = "";
+  while (table->reader.getline(&line)) {
+    if (!line.compare("\n")) continue;
+    split_fields(line, _sep, &table->fields);
+    return true;
+  }
+  table->fields.clear();
+  return false;
+}
+
+std::string snakemake_unit_tests::frame_comparator::compare_rows(const std::vector<std::string> &generated,
+                                                                 const std::vector<std::string> &expected,
+                                                                 const std::vector<unsigned> &column_map,
+                                                                 const std::vector<std::string> &column_names) const {
+  if (generated.size() != expected.size()) {
+    return "generated row has " + std::to_string(generated.size()) + " fields, expected row has " +
+           std::to_string(expected.size());
+  }
+  for (unsigned i = 0; i < generated.size(); ++i) {
+    // rows wider than the header are compared in order
+    const std::string &expected_cell = i < column_map.size() ? expected.at(column_map.at(i)) : expected.at(i);
+    if (!cells_equal(generated.at(i), expected_cell)) {
+      return "column " + describe_cell(i < column_names.size() ? column_names.at(i) : std::to_string(i)) +
+             ": generated " + describe_cell(generated.at(i)) + ", expected " + describe_cell(expected_cell);
+    }
+  }
+  return "";
+}
+
+std::string snakemake_unit_tests::frame_comparator::compare(const boost::filesystem::path &generated_file,
+                                                            const boost::filesystem::path &expected_file,
+                                                            unsigned threads, bool expected_compressed) const {
+  table_reader generated(generated_file, threads, false), expected(expected_file, threads, expected_compressed);
+  bool generated_more = false, expected_more = false;
+  std::vector<std::string> generated_names, expected_names;
+  if (_has_header) {
+    for (unsigned i = 0; i <= _header_row; ++i) {
+      generated_more = next_row(&generated);
+      expected_more = next_row(&expected);
+    }
+    if (!generated_more && !expected_more) return "";
+    if (generated_more != expected_more) {
+      return std::string(generated_more ? "expected" : "generated") + " table has no header row";
+    }
+    generated_names = generated.fields;
+    expected_names = expected.fields;
+  } else {
+    // columns are numbered, and the first row is data
+    generated_more = next_row(&generated);
+    expected_more = next_row(&expected);
+    for (unsigned i = 0; i < generated.fields.size(); ++i) generated_names.push_back(std::to_string(i));
+    for (unsigned i = 0; i < expected.fields.size(); ++i) expected_names.push_back(std::to_string(i));
+  }
+  if (generated_names.size() != expected_names.size()) {
+    return "generated table has " + std::to_string(generated_names.size()) + " columns, expected table has " +
+           std::to_string(expected_names.size());
+  }
+  // find the expected column matching each generated column
+  std::vector<unsigned> column_map;
+  std::vector<bool> used(expected_names.size(), false);
+  for (unsigned i = 0; i < generated_names.size(); ++i) {
+    unsigned j = i;
+    if (_check_like) {
+      for (j = 0; j < expected_names.size() && (used.at(j) || generated_names.at(i) != expected_names.at(j)); ++j) {
+      }
+      if (j == expected_names.size()) {
+        return "column " + describe_cell(generated_names.at(i)) + " of generated table is not in expected table";
+      }
+    } else if (generated_names.at(i) != expected_names.at(i)) {
+      return "column " + std::to_string(i + 1) + " is " + describe_cell(generated_names.at(i)) +
+             " in generated table, " + describe_cell(expected_names.at(i)) + " in expected table";
+    }
+    used.at(j) = true;
+    column_map.push_back(j);
+  }
+  // find the column labelling rows, by name and then by position
+  unsigned index = generated_names.size();
+  if (!_index_col.empty()) {
+    for (index = 0; index < generated_names.size() && generated_names.at(index) != _index_col; ++index) {
+    }
+    if (index == generated_names.size() && _index_col.find_first_not_of("0123456789") == std::string::npos) {
+      index = std::stoul(_index_col);
+    }
+    if (index >= generated_names.size() && (generated_more || expected_more)) {
+      throw std::runtime_error("frame comparator index_col \"" + _index_col + "\" is not a column of \"" +
+                               generated_file.string() + "\"");
+    }
+  }
+  bool reorder = _check_like && index < generated_names.size();
+  if (_has_header) {
+    generated_more = next_row(&generated);
+    expected_more = next_row(&expected);
+  }
+  std::map<std::string, std::deque<pending_row> > generated_pending, expected_pending;
+  unsigned long long row = 0;
+  while (generated_more || expected_more) {
+    if (!reorder) {
+      if (generated_more != expected_more) {
+        return std::string(generated_more ? "expected" : "generated") + " table ends after " + std::to_string(row) +
+               " rows";
+      }
+      ++row;
+      std::string difference = compare_rows(generated.fields, expected.fields, column_map, generated_names);
+      if (!difference.empty()) {
+        return "row " + std::to_string(row) + " (line " + std::to_string(generated.reader.get_line_number()) +
+               " of generated file, line " + std::to_string(expected.reader.get_line_number()) +
+               " of expected file), " + difference;
+      }
+    } else {
+      // labelled rows may arrive in any order; hold each until its counterpart does
+      if (generated_more) {
+        if (index >= generated.fields.size()) return "generated row has no index column";
+        std::string label = generated.fields.at(index);
+        std::map<std::string, std::deque<pending_row> >::iterator finder = expected_pending.find(label);
+        if (finder == expected_pending.end()) {
+          pending_row pending;
+          pending.fields = generated.fields;
+          pending.line_number = generated.reader.get_line_number();
+          generated_pending[label].push_back(pending);
+        } else {
+          std::string difference =
+              compare_rows(generated.fields, finder->second.front().fields, column_map, generated_names);
+          if (!difference.empty()) return "row " + describe_cell(label) + ", " + difference;
+          finder->second.pop_front();
+          if (finder->second.empty()) expected_pending.erase(finder);
+        }
+      }
+      if (expected_more) {
+        if (column_map.at(index) >= expected.fields.size()) return "expected row has no index column";
+        std::string label = expected.fields.at(column_map.at(index));
+        std::map<std::string, std::deque<pending_row> >::iterator finder = generated_pending.find(label);
+        if (finder == generated_pending.end()) {
+          pending_row pending;
+          pending.fields = expected.fields;
+          pending.line_number = expected.reader.get_line_number();
+          expected_pending[label].push_back(pending);
+        } else {
+          std::string difference =
+              compare_rows(finder->second.front().fields, expected.fields, column_map, generated_names);
+          if (!difference.empty()) return "row " + describe_cell(label) + ", " + difference;
+          finder->second.pop_front();
+          if (finder->second.empty()) generated_pending.erase(finder);
+        }
+      }
+    }
+    generated_more = generated_more && next_row(&generated);
+    expected_more = expected_more && next_row(&expected);
+  }
+  if (!generated_pending.empty()) {
+    return "row " + describe_cell(generated_pending.begin()->first) + " (line " +
+           std::to_string(generated_pending.begin()->second.front().line_number) +
+           " of generated file) is not in expected table";
+  }
+  if (!expected_pending.empty()) {
+    return "row " + describe_cell(expected_pending.begin()->first) + " (line " +
+           std::to_string(expected_pending.begin()->second.front().line_number) +
+           " of expected file) is not in generated table";
+  }
+  return "";
+}
@@ -0,0 +1,189 @@
+/*!
+  @file frame_comparator.h
+  @brief compare delimited tables cell by cell, with numeric tolerance
+  @copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_FRAME_COMPARATOR_H_
+#define SNAKEMAKE_UNIT_TESTS_FRAME_COMPARATOR_H_
+
+#include <deque>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/line_reader.h"
+
+namespace snakemake_unit_tests {
+/*!
+  @class frame_comparator
+  @brief native counterpart of the "frame" comparator in inst/common.py
+
+  the comparator args of user_config_schema.yaml are honored as
+  pandas.read_table and pandas.testing.assert_frame_equal would use
+  them: "sep" splits fields; "header" is the row holding column names,
+  or null for none; "index_col" names the column, by name or position,
+  that labels rows; "check_like" ignores the order of columns, and of
+  rows if they are labelled; and numeric cells match if
+  |generated - expected| <= atol + rtol * |expected|.
+
+  both tables are streamed. only rows that arrive in a different
+  order, which check_like permits, are held until their match is found.
+  blank lines are skipped, double-quoted fields may contain the
+  separator, and pandas' default missing value markers all match each
+  other. unlike pandas, integer and floating point columns are not
+  distinguished.
+ */
+class frame_comparator {
+ public:
+  /*!
+    @brief default constructor: the defaults of read_table and assert_frame_equal
+   */
+  frame_comparator();
+  /*!
+    @brief constructor from configured comparator args
+    @param args map of arg names to values; null values are empty strings
+   */
+  explicit frame_comparator(const std::map<std::string, std::string> &args);
+  /*!
+    @brief copy constructor
+    @param obj existing frame_comparator
+   */
+  frame_comparator(const frame_comparator &obj)
+      : _sep(obj._sep),
+        _has_header(obj._has_header),
+        _header_row(obj._header_row),
+        _index_col(obj._index_col),
+        _check_like(obj._check_like),
+        _rtol(obj._rtol),
+        _atol(obj._atol) {}
+  /*!
+    @brief destructor
+   */
+  ~frame_comparator() throw() {}
+  /*!
+    @brief compare two tables
+    @param generated_file table produced by the test
+    @param expected_file table the test should have produced
+    @param threads number of threads with which to decompress BGZF files
+    @param expected_compressed whether the expected table is stored gzipped, whatever its name
+    @return empty if the tables match, or a description of the first difference
+   */
+  std::string compare(const boost::filesystem::path &generated_file, const boost::filesystem::path &expected_file,
+                      unsigned threads = 1, bool expected_compressed = false) const;
+  /*!
+    @brief determine whether two cells match
+    @param generated cell produced by the test
+    @param expected cell the test should have produced
+    @return whether both are missing, both are numbers within tolerance, or both are the same text
+   */
+  bool cells_equal(const std::string &generated, const std::string &expected) const;
+  /*!
+    @brief split a line into fields
+    @param line line to split, with or without its newline
+    @param sep field separator
+    @param target where to store the fields, unquoted
+   */
+  static void split_fields(const std::string &line, const std::string &sep, std::vector<std::string> *target);
+  /*!
+    @brief parse a cell as a number
+    @param cell text of the cell
+    @param target where to store the number
+    @return whether the whole cell was a number
+   */
+  static bool parse_number(const std::string &cell, double *target);
+  /*!
+    @brief determine whether a cell is one of pandas' default missing value markers
+    @param cell text of the cell
+    @return whether the cell is missing
+   */
+  static bool is_missing(const std::string &cell);
+
+ private:
+  friend class frame_comparatorTest;
+  /*!
+    @brief a table being read one row at a time
+   */
+  struct table_reader {
+    /*!
+      @brief open a table
+      @param filename name of table file
+      @param threads number of threads with which to decompress BGZF files
+      @param gzipped whether to decompress the table whatever its name
+     */
+    table_reader(const boost::filesystem::path &filename, unsigned threads, bool gzipped)
+        : reader(filename, threads, gzipped) {}
+    /*!
+      @brief lines of the table
+     */
+    line_reader reader;
+    /*!
+      @brief fields of the current row
+     */
+    std::vector<std::string> fields;
+  };
+  /*!
+    @brief a labelled row held until its counterpart arrives
+   */
+  struct pending_row {
+    /*!
+      @brief fields of the row
+     */
+    std::vector<std::string> fields;
+    /*!
+      @brief line of the row in its file
+     */
+    unsigned long long line_number;
+  };
+  /*!
+    @brief read the next non-blank row of a table
+    @param table table to read
+    @return whether a row was read
+   */
+  bool next_row(table_reader *table) const;
+  /*!
+    @brief compare two rows
+    @param generated fields of the generated row
+    @param expected fields of the expected row
+    @param column_map expected column of each generated column
+    @param column_names names of generated columns, for reporting
+    @return empty if the rows match, or the first differing cell
+   */
+  std::string compare_rows(const std::vector<std::string> &generated, const std::vector<std::string> &expected,
+                           const std::vector<unsigned> &column_map,
+                           const std::vector<std::string> &column_names) const;
+  /*!
+    @brief field separator
+   */
+  std::string _sep;
+  /*!
+    @brief whether a row holds column names
+   */
+  bool _has_header;
+  /*!
+    @brief index of the row holding column names; earlier rows are skipped
+   */
+  unsigned _header_row;
+  /*!
+    @brief name or position of the column labelling rows; empty for none
+   */
+  std::string _index_col;
+  /*!
+    @brief whether to ignore the order of columns and labelled rows
+   */
+  bool _check_like;
+  /*!
+    @brief relative tolerance for numeric cells
+   */
+  double _rtol;
+  /*!
+    @brief absolute tolerance for numeric cells
+   */
+  double _atol;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_FRAME_COMPARATOR_H_
@@ -0,0 +1,240 @@
+/*!
+  \file frame_comparatorTest.cc
+  \brief implementation of frame_comparator unit tests for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#include "snakemake_unit_tests/frame_comparatorTest.h"
+
+void snakemake_unit_tests::frame_comparatorTest::setUp() {
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutFCTXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("frame_comparatorTest mkdtemp failed");
+  }
+}
+
+void snakemake_unit_tests::frame_comparatorTest::tearDown() {
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
+}
+
+boost::filesystem::path snakemake_unit_tests::frame_comparatorTest::install_file(const std::string &relative_path,
+                                                                                 const std::string &content) const {
+  boost::filesystem::path filename = boost::filesystem::path(_tmp_dir) / relative_path;
+  std::ofstream output(filename.string().c_str(), std::ios_base::binary);
+  output << content;
+  output.close();
+  return filename;
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_default_constructor() {
+  frame_comparator fc;
+  CPPUNIT_ASSERT(!fc._sep.compare("\t"));
+  CPPUNIT_ASSERT(fc._has_header);
+  CPPUNIT_ASSERT(!fc._header_row);
+  CPPUNIT_ASSERT(fc._index_col.empty());
+  CPPUNIT_ASSERT(!fc._check_like);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1e-5, fc._rtol, 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1e-8, fc._atol, 1e-12);
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_args_constructor() {
+  std::map<std::string, std::string> args;
+  args["sep"] = "\\t";
+  args["header"] = "";
+  args["index_col"] = "id";
+  args["check_like"] = "true";
+  args["rtol"] = "0.01";
+  args["atol"] = "0";
+  frame_comparator fc1(args);
+  CPPUNIT_ASSERT(!fc1._sep.compare("\t"));
+  CPPUNIT_ASSERT(!fc1._has_header);
+  CPPUNIT_ASSERT(!fc1._index_col.compare("id"));
+  CPPUNIT_ASSERT(fc1._check_like);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.01, fc1._rtol, 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, fc1._atol, 1e-12);
+  args["sep"] = ",";
+  args["header"] = "2";
+  args["index_col"] = "False";
+  args["check_like"] = "False";
+  frame_comparator fc2(args);
+  CPPUNIT_ASSERT(!fc2._sep.compare(","));
+  CPPUNIT_ASSERT(fc2._has_header);
+  CPPUNIT_ASSERT(fc2._header_row == 2);
+  CPPUNIT_ASSERT(fc2._index_col.empty());
+  CPPUNIT_ASSERT(!fc2._check_like);
+  args["header"] = "infer";
+  frame_comparator fc3(args);
+  CPPUNIT_ASSERT(fc3._has_header);
+  CPPUNIT_ASSERT(!fc3._header_row);
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_args_constructor_invalid_tolerance() {
+  std::map<std::string, std::string> args;
+  args["rtol"] = "tight";
+  frame_comparator fc(args);
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_copy_constructor() {
+  std::map<std::string, std::string> args;
+  args["sep"] = ",";
+  args["header"] = "1";
+  args["index_col"] = "0";
+  args["check_like"] = "true";
+  args["rtol"] = "0.5";
+  args["atol"] = "0.25";
+  frame_comparator fc1(args), fc2(fc1);
+  CPPUNIT_ASSERT(!fc2._sep.compare(","));
+  CPPUNIT_ASSERT(fc2._has_header);
+  CPPUNIT_ASSERT(fc2._header_row == 1);
+  CPPUNIT_ASSERT(!fc2._index_col.compare("0"));
+  CPPUNIT_ASSERT(fc2._check_like);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, fc2._rtol, 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, fc2._atol, 1e-12);
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_split_fields() {
+  std::vector<std::string> fields;
+  frame_comparator::split_fields("a\tb\t\tc\n", "\t", &fields);
+  CPPUNIT_ASSERT(fields.size() == 4);
+  CPPUNIT_ASSERT(!fields.at(0).compare("a"));
+  CPPUNIT_ASSERT(fields.at(2).empty());
+  CPPUNIT_ASSERT(!fields.at(3).compare("c"));
+  // quoted fields may contain the separator and escaped quotes
+  frame_comparator::split_fields("\"x,y\",\"say \"\"hi\"\"\",z", ",", &fields);
+  CPPUNIT_ASSERT(fields.size() == 3);
+  CPPUNIT_ASSERT(!fields.at(0).compare("x,y"));
+  CPPUNIT_ASSERT(!fields.at(1).compare("say \"hi\""));
+  CPPUNIT_ASSERT(!fields.at(2).compare("z"));
+  // separators may be longer than one character
+  frame_comparator::split_fields("a::b", "::", &fields);
+  CPPUNIT_ASSERT(fields.size() == 2);
+  CPPUNIT_ASSERT(!fields.at(1).compare("b"));
+  // or runs of whitespace
+  frame_comparator::split_fields("  a \t b  c\n", "\\s+", &fields);
+  CPPUNIT_ASSERT(fields.size() == 3);
+  CPPUNIT_ASSERT(!fields.at(0).compare("a"));
+  CPPUNIT_ASSERT(!fields.at(2).compare("c"));
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_parse_number() {
+  double value = 0.0;
+  CPPUNIT_ASSERT(frame_comparator::parse_number("1.5", &value));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, value, 1e-12);
+  CPPUNIT_ASSERT(frame_comparator::parse_number("-2e3", &value));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-2000.0, value, 1e-12);
+  CPPUNIT_ASSERT(frame_comparator::parse_number("+7", &value));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(7.0, value, 1e-12);
+  CPPUNIT_ASSERT(!frame_comparator::parse_number("", &value));
+  CPPUNIT_ASSERT(!frame_comparator::parse_number("+-7", &value));
+  CPPUNIT_ASSERT(!frame_comparator::parse_number("1.5x", &value));
+  CPPUNIT_ASSERT(!frame_comparator::parse_number("chr1", &value));
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_is_missing() {
+  CPPUNIT_ASSERT(frame_comparator::is_missing(""));
+  CPPUNIT_ASSERT(frame_comparator::is_missing("NA"));
+  CPPUNIT_ASSERT(frame_comparator::is_missing("NaN"));
+  CPPUNIT_ASSERT(frame_comparator::is_missing("#N/A"));
+  CPPUNIT_ASSERT(!frame_comparator::is_missing("na"));
+  CPPUNIT_ASSERT(!frame_comparator::is_missing("0"));
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_cells_equal() {
+  frame_comparator fc;
+  CPPUNIT_ASSERT(fc.cells_equal("abc", "abc"));
+  CPPUNIT_ASSERT(!fc.cells_equal("abc", "abd"));
+  CPPUNIT_ASSERT(fc.cells_equal("NA", "nan"));
+  CPPUNIT_ASSERT(!fc.cells_equal("NA", "0"));
+  CPPUNIT_ASSERT(fc.cells_equal("1", "1.0"));
+  CPPUNIT_ASSERT(fc.cells_equal("100000", "100000.5"));
+  CPPUNIT_ASSERT(!fc.cells_equal("100000", "100002"));
+  CPPUNIT_ASSERT(fc.cells_equal("0", "1e-9"));
+  CPPUNIT_ASSERT(!fc.cells_equal("0", "1e-7"));
+  CPPUNIT_ASSERT(fc.cells_equal("inf", "inf"));
+  CPPUNIT_ASSERT(!fc.cells_equal("inf", "-inf"));
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_compare() {
+  frame_comparator fc;
+  boost::filesystem::path generated = install_file("generated.tsv", "a\tb\n1.0\tx\n\n2\tNA\n");
+  boost::filesystem::path expected = install_file("expected.tsv", "a\tb\r\n1\tx\r\n2.0000001\t\r\n");
+  CPPUNIT_ASSERT(fc.compare(generated, expected).empty());
+  expected = install_file("expected.tsv", "a\tb\n1\tx\n2\ty\n");
+  CPPUNIT_ASSERT_EQUAL(std::string("row 2 (line 4 of generated file, line 3 of expected file), column \"b\": "
+                                   "generated \"NA\", expected \"y\""),
+                       fc.compare(generated, expected));
+  // empty tables match
+  generated = install_file("generated.tsv", "");
+  expected = install_file("expected.tsv", "\n");
+  CPPUNIT_ASSERT(fc.compare(generated, expected).empty());
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_compare_shape() {
+  frame_comparator fc;
+  boost::filesystem::path generated = install_file("generated.tsv", "a\tb\n1\t2\n");
+  boost::filesystem::path expected = install_file("expected.tsv", "a\tb\tc\n1\t2\t3\n");
+  CPPUNIT_ASSERT_EQUAL(std::string("generated table has 2 columns, expected table has 3"),
+                       fc.compare(generated, expected));
+  expected = install_file("expected.tsv", "b\ta\n2\t1\n");
+  CPPUNIT_ASSERT_EQUAL(std::string("column 1 is \"a\" in generated table, \"b\" in expected table"),
+                       fc.compare(generated, expected));
+  expected = install_file("expected.tsv", "a\tb\n1\t2\n3\t4\n");
+  CPPUNIT_ASSERT_EQUAL(std::string("generated table ends after 1 rows"), fc.compare(generated, expected));
+  expected = install_file("expected.tsv", "");
+  CPPUNIT_ASSERT_EQUAL(std::string("expected table has no header row"), fc.compare(generated, expected));
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_compare_no_header() {
+  std::map<std::string, std::string> args;
+  args["sep"] = ",";
+  args["header"] = "";
+  frame_comparator fc(args);
+  boost::filesystem::path generated = install_file("generated.csv", "1,2\n3,4\n");
+  boost::filesystem::path expected = install_file("expected.csv", "1,2\n3,5\n");
+  CPPUNIT_ASSERT_EQUAL(std::string("row 2 (line 2 of generated file, line 2 of expected file), column \"1\": "
+                                   "generated \"4\", expected \"5\""),
+                       fc.compare(generated, expected));
+  // rows before a later header are skipped
+  args["header"] = "1";
+  frame_comparator fc2(args);
+  generated = install_file("generated.csv", "run 1\na,b\n1,2\n");
+  expected = install_file("expected.csv", "run 2\na,b\n1,2\n");
+  CPPUNIT_ASSERT(fc2.compare(generated, expected).empty());
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_compare_check_like() {
+  std::map<std::string, std::string> args;
+  args["check_like"] = "true";
+  args["index_col"] = "id";
+  frame_comparator fc(args);
+  boost::filesystem::path generated = install_file("generated.tsv", "id\ta\tb\nr1\t1\tx\nr2\t2\ty\nr3\t3\tz\n");
+  boost::filesystem::path expected = install_file("expected.tsv", "b\tid\ta\nz\tr3\t3\ny\tr2\t2\nx\tr1\t1\n");
+  CPPUNIT_ASSERT(fc.compare(generated, expected).empty());
+  expected = install_file("expected.tsv", "b\tid\ta\nz\tr3\t3\ny\tr2\t2.5\nx\tr1\t1\n");
+  CPPUNIT_ASSERT_EQUAL(std::string("row \"r2\", column \"a\": generated \"2\", expected \"2.5\""),
+                       fc.compare(generated, expected));
+  expected = install_file("expected.tsv", "b\tid\ta\nz\tr3\t3\ny\tr4\t2\nx\tr1\t1\n");
+  CPPUNIT_ASSERT_EQUAL(std::string("row \"r2\" (line 3 of generated file) is not in expected table"),
+                       fc.compare(generated, expected));
+  expected = install_file("expected.tsv", "b\tid\tc\nz\tr3\t3\n");
+  CPPUNIT_ASSERT_EQUAL(std::string("column \"a\" of generated table is not in expected table"),
+                       fc.compare(generated, expected));
+}
+
+void snakemake_unit_tests::frame_comparatorTest::test_frame_comparator_compare_missing_index() {
+  std::map<std::string, std::string> args;
+  args["index_col"] = "id";
+  frame_comparator fc(args);
+  boost::filesystem::path generated = install_file("generated.tsv", "a\tb\n1\t2\n");
+  boost::filesystem::path expected = install_file("expected.tsv", "a\tb\n1\t2\n");
+  fc.compare(generated, expected);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::frame_comparatorTest);
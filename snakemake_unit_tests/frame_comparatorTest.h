@@ -0,0 +1,77 @@
+/*!
+  \file frame_comparatorTest.h
+  \brief frame_comparator test fixture for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_FRAME_COMPARATORTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_FRAME_COMPARATORTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/frame_comparator.h"
+
+namespace snakemake_unit_tests {
+class frame_comparatorTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(frame_comparatorTest);
+  CPPUNIT_TEST(test_frame_comparator_default_constructor);
+  CPPUNIT_TEST(test_frame_comparator_args_constructor);
+  CPPUNIT_TEST_EXCEPTION(test_frame_comparator_args_constructor_invalid_tolerance, std::runtime_error);
+  CPPUNIT_TEST(test_frame_comparator_copy_constructor);
+  CPPUNIT_TEST(test_frame_comparator_split_fields);
+  CPPUNIT_TEST(test_frame_comparator_parse_number);
+  CPPUNIT_TEST(test_frame_comparator_is_missing);
+  CPPUNIT_TEST(test_frame_comparator_cells_equal);
+  CPPUNIT_TEST(test_frame_comparator_compare);
+  CPPUNIT_TEST(test_frame_comparator_compare_shape);
+  CPPUNIT_TEST(test_frame_comparator_compare_no_header);
+  CPPUNIT_TEST(test_frame_comparator_compare_check_like);
+  CPPUNIT_TEST_EXCEPTION(test_frame_comparator_compare_missing_index, std::runtime_error);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_frame_comparator_default_constructor();
+  void test_frame_comparator_args_constructor();
+  void test_frame_comparator_args_constructor_invalid_tolerance();
+  void test_frame_comparator_copy_constructor();
+  void test_frame_comparator_split_fields();
+  void test_frame_comparator_parse_number();
+  void test_frame_comparator_is_missing();
+  void test_frame_comparator_cells_equal();
+  void test_frame_comparator_compare();
+  void test_frame_comparator_compare_shape();
+  void test_frame_comparator_compare_no_header();
+  void test_frame_comparator_compare_check_like();
+  void test_frame_comparator_compare_missing_index();
+
+ private:
+  /*!
+    @brief write a file in the temporary directory
+    @param relative_path path of file relative to the temporary directory
+    @param content contents of file
+    @return full path of file
+   */
+  boost::filesystem::path install_file(const std::string &relative_path, const std::string &content) const;
+  char *_tmp_dir;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_FRAME_COMPARATORTEST_H_
@@ -0,0 +1,90 @@
+/*!
+  @file lexed_file.cc
+  @brief implementation of lexed_file class
+  @author Lightning Auriga
+  @copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#include "snakemake_unit_tests/lexed_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void snakemake_unit_tests::lexed_file::load(const boost::filesystem::path &filename, bool verbose) {
+  clear();
+  int fd = open(filename.string().c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("cannot open snakemake file \"" + filename.string() + "\"");
+  struct stat status;
+  if (fstat(fd, &status)) {
+    close(fd);
+    throw std::runtime_error("cannot stat snakemake file \"" + filename.string() + "\"");
+  }
+  // empty files cannot be mapped, but are perfectly valid
+  if (status.st_size > 0) {
+    void *ptr = mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (ptr == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("cannot map snakemake file \"" + filename.string() + "\"");
+    }
+    madvise(ptr, status.st_size, MADV_SEQUENTIAL);
+    _data = static_cast<const char *>(ptr);
+    _size = status.st_size;
+    _mapped = true;
+  }
+  // the mapping persists after the descriptor is closed
+  close(fd);
+  split_physical_lines(get_contents(), &_physical_lines);
+  lexical_parse(_physical_lines, verbose, [this](const std::vector<lexed_piece> &pieces) { add_logical_line(pieces); });
+}
+
+void snakemake_unit_tests::lexed_file::clear() {
+  if (_mapped) {
+    munmap(const_cast<char *>(_data), _size);
+  }
+  _data = 0;
+  _size = 0;
+  _mapped = false;
+  _physical_lines.clear();
+  _lines.clear();
+  _synthesized.clear();
+}
+
+void snakemake_unit_tests::lexed_file::add_logical_line(const std::vector<lexed_piece> &pieces) {
+  if (pieces.empty()) throw std::logic_error("lexer reported a logical line with no content");
+  logical_line result;
+  result.first_physical_line = pieces.begin()->line;
+  result.n_physical_lines = pieces.rbegin()->line - pieces.begin()->line + 1;
+  result.synthesized = false;
+  // contiguous content: every fragment but the last is a complete line followed by
+  // its newline, and the last fragment is a prefix of its line
+  bool contiguous = true;
+  for (unsigned i = 0; i < pieces.size() && contiguous; ++i) {
+    const std::string_view &physical = _physical_lines.at(pieces.at(i).line);
+    contiguous = pieces.at(i).text.data() == physical.data() && pieces.at(i).line == result.first_physical_line + i;
+    if (i + 1 < pieces.size()) {
+      contiguous = contiguous && pieces.at(i).newline && pieces.at(i).text.size() == physical.size();
+    }
+  }
+  const lexed_piece &last = *pieces.rbegin();
+  std::string::size_type end = last.text.data() + last.text.size() - pieces.begin()->text.data();
+  // a trailing newline must actually be present in the file
+  if (contiguous && last.newline) {
+    contiguous = last.text.data() + last.text.size() < _data + _size;
+    ++end;
+  }
+  if (contiguous) {
+    result.text = std::string_view(pieces.begin()->text.data(), end);
+  } else {
+    _synthesized.push_back("");
+    for (std::vector<lexed_piece>::const_iterator iter = pieces.begin(); iter != pieces.end(); ++iter) {
+      _synthesized.rbegin()->append(iter->text);
+      if (iter->newline) *_synthesized.rbegin() += "\n";
+    }
+    result.text = *_synthesized.rbegin();
+    result.synthesized = true;
+  }
+  _lines.push_back(result);
+}
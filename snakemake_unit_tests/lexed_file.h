@@ -0,0 +1,122 @@
+/*!
+ @file lexed_file.h
+ @brief memory-mapped snakefile, expressed as logical lines
+ @author Lightning Auriga
+ @copyright Released under the MIT License.
+ Copyright 2023 Lightning Auriga
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_LEXED_FILE_H_
+#define SNAKEMAKE_UNIT_TESTS_LEXED_FILE_H_
+
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/utilities.h"
+
+namespace snakemake_unit_tests {
+/*!
+  @class lexed_file
+  @brief read-only mapping of a snakefile, lexed into logical lines
+
+  logical lines are views directly into the mapped file whenever their
+  content is contiguous in the source, which is nearly always the case:
+  comments and trailing whitespace only shorten a line, and multiline
+  string literals keep their embedded newlines. only lines joined by
+  backslash extension, or a dangling literal in a file without a final
+  newline, are assembled into separate storage owned by this object.
+
+  all views remain valid for the lifetime of the object.
+ */
+class lexed_file {
+ public:
+  /*!
+    @brief default constructor
+   */
+  lexed_file() : _data(0), _size(0), _mapped(false) {}
+  /*!
+    @brief constructor: map and lex a file
+    @param filename name of snakefile to load
+    @param verbose whether to emit verbose logging output
+   */
+  lexed_file(const boost::filesystem::path &filename, bool verbose) : _data(0), _size(0), _mapped(false) {
+    load(filename, verbose);
+  }
+  /*!
+    @brief copying would duplicate ownership of the mapping
+   */
+  lexed_file(const lexed_file &obj) = delete;
+  /*!
+    @brief copying would duplicate ownership of the mapping
+   */
+  lexed_file &operator=(const lexed_file &obj) = delete;
+  /*!
+    @brief destructor
+   */
+  ~lexed_file() throw() { clear(); }
+  /*!
+    @brief map and lex a file, replacing any existing content
+    @param filename name of snakefile to load
+    @param verbose whether to emit verbose logging output
+   */
+  void load(const boost::filesystem::path &filename, bool verbose);
+  /*!
+    @brief release the mapping and all logical lines
+   */
+  void clear();
+  /*!
+    @brief get the logical lines of the file
+    @return logical lines, in order
+   */
+  const std::vector<logical_line> &get_lines() const { return _lines; }
+  /*!
+    @brief get the raw contents of the file
+    @return view of the entire mapped file
+   */
+  std::string_view get_contents() const { return std::string_view(_data, _size); }
+  /*!
+    @brief get the number of physical lines in the file
+    @return number of physical lines
+   */
+  unsigned get_physical_line_count() const { return _physical_lines.size(); }
+
+ private:
+  /*!
+    @brief convert the fragments of a lexed line into a logical line
+    @param pieces fragments reported by lexical_parse
+   */
+  void add_logical_line(const std::vector<lexed_piece> &pieces);
+  /*!
+    @brief start of file contents
+   */
+  const char *_data;
+  /*!
+    @brief size of file contents in bytes
+   */
+  std::string::size_type _size;
+  /*!
+    @brief whether _data is an active mapping that must be released
+   */
+  bool _mapped;
+  /*!
+    @brief views of each physical line, excluding newlines
+   */
+  std::vector<std::string_view> _physical_lines;
+  /*!
+    @brief logical lines in file order
+   */
+  std::vector<logical_line> _lines;
+  /*!
+    @brief storage for the few lines that are not contiguous in the file
+
+    deque is used so that existing entries are never relocated
+   */
+  std::deque<std::string> _synthesized;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_LEXED_FILE_H_
@@ -0,0 +1,158 @@
+/*!
+  \file lexed_fileTest.cc
+  \brief implementation of lexed file unit tests for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#include "snakemake_unit_tests/lexed_fileTest.h"
+
+void snakemake_unit_tests::lexed_fileTest::setUp() {
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutLFTXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("lexed_fileTest mkdtemp failed");
+  }
+}
+
+void snakemake_unit_tests::lexed_fileTest::tearDown() {
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
+}
+
+boost::filesystem::path snakemake_unit_tests::lexed_fileTest::write_file(const std::string &name,
+                                                                        const std::string &contents) const {
+  boost::filesystem::path filename = boost::filesystem::path(std::string(_tmp_dir)) / name;
+  std::ofstream output;
+  output.open(filename.string().c_str(), std::ios::binary);
+  if (!output.is_open()) {
+    throw std::runtime_error("cannot write " + name + " for lexed file test");
+  }
+  if (!(output << contents)) {
+    throw std::runtime_error("cannot write to " + name + " for lexed file test");
+  }
+  output.close();
+  return filename;
+}
+
+void snakemake_unit_tests::lexed_fileTest::compare_to_lexical_parse(const std::string &contents) const {
+  boost::filesystem::path filename = write_file("compare.smk", contents);
+  // reference implementation: getline-style split and string-based lexer
+  std::vector<std::string> physical;
+  std::istringstream input(contents);
+  std::string line = "";
+  while (input.peek() != EOF) {
+    getline(input, line);
+    physical.push_back(line);
+  }
+  std::vector<std::string> expected = lexical_parse(physical);
+  lexed_file lf(filename, false);
+  CPPUNIT_ASSERT_EQUAL(expected.size(), lf.get_lines().size());
+  CPPUNIT_ASSERT_EQUAL(static_cast<unsigned>(physical.size()), lf.get_physical_line_count());
+  for (unsigned i = 0; i < expected.size(); ++i) {
+    CPPUNIT_ASSERT_EQUAL(expected.at(i), std::string(lf.get_lines().at(i).text));
+  }
+}
+
+void snakemake_unit_tests::lexed_fileTest::test_lexed_file_default_constructor() {
+  lexed_file lf;
+  CPPUNIT_ASSERT(lf.get_lines().empty());
+  CPPUNIT_ASSERT(lf.get_contents().empty());
+  CPPUNIT_ASSERT_EQUAL(0u, lf.get_physical_line_count());
+}
+
+void snakemake_unit_tests::lexed_fileTest::test_lexed_file_load() {
+  std::string contents =
+      "rule myrule:  # comment\n"
+      "    input:\n"
+      "        \"\"\"multiline\n"
+      "        literal\"\"\",\n"
+      "    output: \"a\" \\\n"
+      "        \"b\",\n";
+  boost::filesystem::path filename = write_file("load.smk", contents);
+  lexed_file lf;
+  lf.load(filename, false);
+  CPPUNIT_ASSERT(lf.get_contents() == contents);
+  CPPUNIT_ASSERT_EQUAL(6u, lf.get_physical_line_count());
+  const std::vector<logical_line> &lines = lf.get_lines();
+  CPPUNIT_ASSERT_EQUAL(std::vector<logical_line>::size_type(4), lines.size());
+  // comments and trailing whitespace removed, in place
+  CPPUNIT_ASSERT(lines.at(0).text == "rule myrule:");
+  CPPUNIT_ASSERT(lines.at(0).text.data() == lf.get_contents().data());
+  CPPUNIT_ASSERT(!lines.at(0).synthesized);
+  CPPUNIT_ASSERT_EQUAL(0u, lines.at(0).first_physical_line);
+  CPPUNIT_ASSERT_EQUAL(1u, lines.at(0).n_physical_lines);
+  // multiline literals are contiguous in the file and are not copied
+  CPPUNIT_ASSERT(lines.at(2).text == "        \"\"\"multiline\n        literal\"\"\",");
+  CPPUNIT_ASSERT(!lines.at(2).synthesized);
+  CPPUNIT_ASSERT(lines.at(2).text.data() >= lf.get_contents().data() &&
+                 lines.at(2).text.data() < lf.get_contents().data() + lf.get_contents().size());
+  CPPUNIT_ASSERT_EQUAL(2u, lines.at(2).first_physical_line);
+  CPPUNIT_ASSERT_EQUAL(2u, lines.at(2).n_physical_lines);
+  // line extensions need to be assembled
+  CPPUNIT_ASSERT(lines.at(3).text == "    output: \"a\"         \"b\",");
+  CPPUNIT_ASSERT(lines.at(3).synthesized);
+  CPPUNIT_ASSERT_EQUAL(4u, lines.at(3).first_physical_line);
+  CPPUNIT_ASSERT_EQUAL(2u, lines.at(3).n_physical_lines);
+}
+
+void snakemake_unit_tests::lexed_fileTest::test_lexed_file_load_matches_lexical_parse() {
+  compare_to_lexical_parse(
+      "   standard lines are preserved\n"
+      "   comments are pruned # like me\n"
+      "\n"
+      "\t  \n"
+      "example: \"# not a comment\" # but this is\n"
+      "example: 'nested \"quotes\" are fine' \\\n"
+      "   'and extensions are glued'  \n"
+      "example: \"\"\"literals can\n"
+      "# contain comment characters\n"
+      "and 'other' \"quotes\"\"\"\" # trailing\n"
+      "escaped: \"\\\" quote\" and '\\\\' slash\n"
+      "trailing whitespace is removed    \t\n"
+      "windows line endings are preserved\r\n"
+      "example: ''' dangling literal\n"
+      "   \n");
+}
+
+void snakemake_unit_tests::lexed_fileTest::test_lexed_file_load_no_final_newline() {
+  compare_to_lexical_parse("rule a:\n    input: \"x\"");
+  compare_to_lexical_parse("a = '''open\nliteral   ");
+  compare_to_lexical_parse("a = 1 \\\n   \\");
+  // a dangling literal must gain a newline that isn't in the file
+  boost::filesystem::path filename = write_file("dangling.smk", "x = \"\"\"\n");
+  lexed_file lf(filename, false);
+  CPPUNIT_ASSERT_EQUAL(std::vector<logical_line>::size_type(1), lf.get_lines().size());
+  CPPUNIT_ASSERT(lf.get_lines().at(0).text == "x = \"\"\"\n");
+  CPPUNIT_ASSERT(!lf.get_lines().at(0).synthesized);
+}
+
+void snakemake_unit_tests::lexed_fileTest::test_lexed_file_load_empty_file() {
+  boost::filesystem::path filename = write_file("empty.smk", "");
+  lexed_file lf(filename, false);
+  CPPUNIT_ASSERT(lf.get_lines().empty());
+  CPPUNIT_ASSERT(lf.get_contents().empty());
+}
+
+void snakemake_unit_tests::lexed_fileTest::test_lexed_file_load_missing_file() {
+  lexed_file lf(boost::filesystem::path(std::string(_tmp_dir)) / "missing.smk", false);
+}
+
+void snakemake_unit_tests::lexed_fileTest::test_lexed_file_clear() {
+  boost::filesystem::path filename = write_file("clear.smk", "a = 1\nb = 2 \\\n  + 3\n");
+  lexed_file lf(filename, false);
+  CPPUNIT_ASSERT_EQUAL(std::vector<logical_line>::size_type(2), lf.get_lines().size());
+  lf.clear();
+  CPPUNIT_ASSERT(lf.get_lines().empty());
+  CPPUNIT_ASSERT(lf.get_contents().empty());
+  CPPUNIT_ASSERT_EQUAL(0u, lf.get_physical_line_count());
+  // reloading after clear is fine
+  lf.load(filename, false);
+  CPPUNIT_ASSERT_EQUAL(std::vector<logical_line>::size_type(2), lf.get_lines().size());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::lexed_fileTest);
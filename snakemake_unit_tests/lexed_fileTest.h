@@ -0,0 +1,68 @@
+/*!
+  \file lexed_fileTest.h
+  \brief lexed file test fixture for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_LEXED_FILETEST_H_
+#define SNAKEMAKE_UNIT_TESTS_LEXED_FILETEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/lexed_file.h"
+
+namespace snakemake_unit_tests {
+class lexed_fileTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(lexed_fileTest);
+  CPPUNIT_TEST(test_lexed_file_default_constructor);
+  CPPUNIT_TEST(test_lexed_file_load);
+  CPPUNIT_TEST(test_lexed_file_load_matches_lexical_parse);
+  CPPUNIT_TEST(test_lexed_file_load_no_final_newline);
+  CPPUNIT_TEST(test_lexed_file_load_empty_file);
+  CPPUNIT_TEST_EXCEPTION(test_lexed_file_load_missing_file, std::runtime_error);
+  CPPUNIT_TEST(test_lexed_file_clear);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_lexed_file_default_constructor();
+  void test_lexed_file_load();
+  void test_lexed_file_load_matches_lexical_parse();
+  void test_lexed_file_load_no_final_newline();
+  void test_lexed_file_load_empty_file();
+  void test_lexed_file_load_missing_file();
+  void test_lexed_file_clear();
+
+ private:
+  /*!
+    @brief write a file into the temporary directory
+    @param name name of file
+    @param contents exact contents of file
+    @return full path to file
+   */
+  boost::filesystem::path write_file(const std::string &name, const std::string &contents) const;
+  /*!
+    @brief check lexed_file against the string-based lexer for a given file
+    @param contents exact contents of file
+   */
+  void compare_to_lexical_parse(const std::string &contents) const;
+  char *_tmp_dir;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_LEXED_FILETEST_H_
@@ -0,0 +1,215 @@
+/*!
+  \file line_reader.cc
+  \brief implementation of streaming line reads from plain or gzipped files
+  \copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#include "snakemake_unit_tests/line_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cstring>
+#include <vector>
+
+#include "snakemake_unit_tests/utilities.h"
+
+namespace {
+/*!
+  @brief size of a BGZF block header, through the block size field
+ */
+const unsigned bgzf_header_size = 18;
+/*!
+  @brief determine whether the start of a file is a BGZF block header
+  @param header first bgzf_header_size bytes of the file
+  @return whether the header is gzip with a single "BC" extra field, as bgzip writes
+ */
+bool is_bgzf_header(const unsigned char *header) {
+  return header[0] == 31 && header[1] == 139 && header[2] == 8 && (header[3] & 4) && header[10] == 6 &&
+         header[11] == 0 && header[12] == 'B' && header[13] == 'C' && header[14] == 2 && header[15] == 0;
+}
+/*!
+  @brief read a little-endian unsigned integer
+  @param data first byte of the integer
+  @param n_bytes width of the integer
+  @return the integer
+ */
+unsigned long read_little_endian(const unsigned char *data, unsigned n_bytes) {
+  unsigned long result = 0;
+  for (unsigned i = n_bytes; i > 0; --i) {
+    result = (result << 8) | data[i - 1];
+  }
+  return result;
+}
+/*!
+  @brief inflate a single BGZF block
+  @param block the complete compressed block, header to footer
+  @param target where to store the decompressed content
+  @return whether the block was intact
+ */
+bool inflate_bgzf_block(const std::string &block, std::string *target) {
+  const unsigned char *data = reinterpret_cast<const unsigned char *>(block.data());
+  unsigned long expected_size = read_little_endian(data + block.size() - 4, 4);
+  unsigned long expected_crc = read_little_endian(data + block.size() - 8, 4);
+  // blocks hold at most 64 KiB
+  if (expected_size > 65536) return false;
+  target->resize(expected_size);
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // negative window bits: raw deflate, as the gzip framing is handled here
+  if (inflateInit2(&stream, -15) != Z_OK) return false;
+  stream.next_in = const_cast<unsigned char *>(data + bgzf_header_size);
+  stream.avail_in = block.size() - bgzf_header_size - 8;
+  stream.next_out = reinterpret_cast<unsigned char *>(&(*target)[0]);
+  stream.avail_out = expected_size;
+  int status = inflate(&stream, Z_FINISH);
+  bool intact = (status == Z_STREAM_END || (status == Z_BUF_ERROR && !expected_size)) && !stream.avail_out;
+  inflateEnd(&stream);
+  return intact &&
+         crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const unsigned char *>(target->data()), expected_size) ==
+             expected_crc;
+}
+}  // namespace
+
+snakemake_unit_tests::line_reader::line_reader(const boost::filesystem::path &filename, unsigned threads,
+                                               bool gzipped)
+    : _filename(filename),
+      _gz(0),
+      _bgzf(0),
+      _threads(threads),
+      _buffer_offset(0),
+      _data(0),
+      _size(0),
+      _offset(0),
+      _line_number(0) {
+  if (gzipped || is_gzipped(filename)) {
+    if (_threads > 1) {
+      _bgzf = fopen(filename.string().c_str(), "rb");
+      if (!_bgzf) throw std::runtime_error("cannot open \"" + filename.string() + "\" for reading");
+      unsigned char header[bgzf_header_size];
+      if (fread(header, 1, bgzf_header_size, _bgzf) == bgzf_header_size && is_bgzf_header(header)) {
+        rewind(_bgzf);
+        return;
+      }
+      // plain gzip cannot be split into blocks, so is read serially
+      fclose(_bgzf);
+      _bgzf = 0;
+    }
+    _gz = gzopen(filename.string().c_str(), "rb");
+    if (!_gz) throw std::runtime_error("cannot open \"" + filename.string() + "\" for reading");
+    gzbuffer(_gz, 1 << 17);
+    return;
+  }
+  int fd = open(filename.string().c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("cannot open \"" + filename.string() + "\" for reading");
+  struct stat info;
+  if (fstat(fd, &info)) {
+    close(fd);
+    throw std::runtime_error("cannot query size of \"" + filename.string() + "\"");
+  }
+  _size = info.st_size;
+  // mmap rejects empty mappings; empty files simply have no lines
+  if (_size) {
+    void *mapped = mmap(0, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("cannot map \"" + filename.string() + "\" for reading");
+    }
+    madvise(mapped, _size, MADV_SEQUENTIAL);
+    _data = static_cast<const char *>(mapped);
+  }
+  close(fd);
+}
+
+snakemake_unit_tests::line_reader::~line_reader() throw() {
+  if (_gz) gzclose(_gz);
+  if (_bgzf) fclose(_bgzf);
+  if (_data) munmap(const_cast<char *>(_data), _size);
+}
+
+bool snakemake_unit_tests::line_reader::is_gzipped(const boost::filesystem::path &filename) {
+  std::string name = filename.string();
+  return name.size() >= 3 && name.at(name.size() - 3) == '.' && tolower(name.at(name.size() - 2)) == 'g' &&
+         tolower(name.at(name.size() - 1)) == 'z';
+}
+
+bool snakemake_unit_tests::line_reader::read_bgzf_blocks() {
+  // enough blocks to keep every thread busy, while holding only a few MB
+  std::vector<std::string> blocks;
+  for (unsigned i = 0; i < _threads * 4; ++i) {
+    unsigned char header[bgzf_header_size];
+    size_t n_read = fread(header, 1, bgzf_header_size, _bgzf);
+    if (!n_read) break;
+    if (n_read != bgzf_header_size || !is_bgzf_header(header)) {
+      throw std::runtime_error("\"" + _filename.string() + "\" is not a valid BGZF file");
+    }
+    std::string::size_type block_size = read_little_endian(header + 16, 2) + 1;
+    if (block_size < bgzf_header_size + 8) {
+      throw std::runtime_error("\"" + _filename.string() + "\" is not a valid BGZF file");
+    }
+    blocks.push_back(std::string(reinterpret_cast<const char *>(header), bgzf_header_size));
+    blocks.back().resize(block_size);
+    if (fread(&blocks.back()[bgzf_header_size], 1, block_size - bgzf_header_size, _bgzf) !=
+        block_size - bgzf_header_size) {
+      throw std::runtime_error("\"" + _filename.string() + "\" is truncated");
+    }
+  }
+  if (blocks.empty()) return false;
+  std::vector<std::string> inflated(blocks.size());
+  std::vector<char> intact(blocks.size(), 0);
+  run_in_parallel(blocks.size(), _threads,
+                  [&](unsigned i) { intact.at(i) = inflate_bgzf_block(blocks.at(i), &inflated.at(i)); });
+  for (unsigned i = 0; i < blocks.size(); ++i) {
+    if (!intact.at(i)) throw std::runtime_error("cannot decompress \"" + _filename.string() + "\"");
+    _buffer += inflated.at(i);
+  }
+  return true;
+}
+
+bool snakemake_unit_tests::line_reader::getline(std::string *line) {
+  if (!line) throw std::runtime_error("null pointer provided to line_reader::getline");
+  line->clear();
+  if (_bgzf) {
+    std::string::size_type newline = std::string::npos;
+    while ((newline = _buffer.find('\n', _buffer_offset)) == std::string::npos) {
+      // drop what has been returned before reading more
+      _buffer.erase(0, _buffer_offset);
+      _buffer_offset = 0;
+      if (!read_bgzf_blocks()) break;
+    }
+    std::string::size_type end = newline == std::string::npos ? _buffer.size() : newline + 1;
+    line->assign(_buffer, _buffer_offset, end - _buffer_offset);
+    _buffer_offset = end;
+  } else if (_gz) {
+    char buffer[65536];
+    // long lines arrive in pieces
+    while (line->empty() || line->at(line->size() - 1) != '\n') {
+      if (!gzgets(_gz, buffer, sizeof(buffer))) {
+        int error = Z_OK;
+        gzerror(_gz, &error);
+        if (error != Z_OK && error != Z_STREAM_END) {
+          throw std::runtime_error("cannot decompress \"" + _filename.string() + "\"");
+        }
+        break;
+      }
+      line->append(buffer);
+    }
+  } else {
+    if (_offset >= _size) return false;
+    const char *start = _data + _offset;
+    const char *end = static_cast<const char *>(memchr(start, '\n', _size - _offset));
+    std::string::size_type length = end ? end - start + 1 : _size - _offset;
+    line->assign(start, length);
+    _offset += length;
+  }
+  if (line->empty()) return false;
+  ++_line_number;
+  if (line->size() > 1 && line->at(line->size() - 1) == '\n' && line->at(line->size() - 2) == '\r') {
+    line->erase(line->size() - 2, 1);
+  }
+  return true;
+}
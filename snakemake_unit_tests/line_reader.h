@@ -0,0 +1,124 @@
+/*!
+  @file line_reader.h
+  @brief stream lines from plain or gzipped text files
+  @copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_LINE_READER_H_
+#define SNAKEMAKE_UNIT_TESTS_LINE_READER_H_
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include "boost/filesystem.hpp"
+
+namespace snakemake_unit_tests {
+/*!
+  @class line_reader
+  @brief read a text file one line at a time, without loading all of it
+
+  files whose names end in ".gz", or that the caller knows to be
+  gzipped, are decompressed as they are read; all others are memory
+  mapped. lines keep their newline, but windows
+  line endings are reported as plain newlines, matching python's
+  text mode. memory use is bounded by the longest line, not the size
+  of the file.
+
+  given more than one thread, BGZF files (as written by bgzip and
+  htslib) are decompressed a batch of blocks at a time, with the
+  blocks of each batch inflated in parallel.
+ */
+class line_reader {
+ public:
+  /*!
+    @brief open a file for reading
+    @param filename name of file to open
+    @param threads number of threads with which to decompress BGZF files
+    @param gzipped whether to decompress the file whatever its name
+   */
+  explicit line_reader(const boost::filesystem::path &filename, unsigned threads = 1, bool gzipped = false);
+  /*!
+    @brief destructor: release the file
+   */
+  ~line_reader() throw();
+  /*!
+    @brief read the next line
+    @param line where to store the line, including its newline if present
+    @return whether a line was read; false at end of file
+   */
+  bool getline(std::string *line);
+  /*!
+    @brief get the number of lines read so far
+    @return number of lines read; the line most recently read has this number
+   */
+  unsigned long long get_line_number() const { return _line_number; }
+  /*!
+    @brief determine whether the file is being read as BGZF blocks
+    @return whether BGZF blocks are decompressed in parallel
+   */
+  bool is_bgzf() const { return _bgzf != 0; }
+  /*!
+    @brief determine whether a file should be read through gzip
+    @param filename name of file
+    @return whether the file's name ends in ".gz", in any case
+   */
+  static bool is_gzipped(const boost::filesystem::path &filename);
+
+ private:
+  /*!
+    @brief readers own an open file, and cannot be copied
+   */
+  line_reader(const line_reader &obj);
+  /*!
+    @brief decompress the next batch of BGZF blocks onto the end of _buffer
+    @return whether any blocks remained
+   */
+  bool read_bgzf_blocks();
+  /*!
+    @brief name of the file being read, for error messages
+   */
+  boost::filesystem::path _filename;
+  /*!
+    @brief zlib handle for gzipped files; null otherwise
+   */
+  gzFile _gz;
+  /*!
+    @brief raw handle for BGZF files read in parallel; null otherwise
+   */
+  FILE *_bgzf;
+  /*!
+    @brief number of threads with which to decompress BGZF blocks
+   */
+  unsigned _threads;
+  /*!
+    @brief decompressed BGZF content not yet returned as lines
+   */
+  std::string _buffer;
+  /*!
+    @brief offset of the next unread byte of _buffer
+   */
+  std::string::size_type _buffer_offset;
+  /*!
+    @brief mapped contents of plain files; null for gzipped or empty files
+   */
+  const char *_data;
+  /*!
+    @brief size of mapped contents
+   */
+  std::string::size_type _size;
+  /*!
+    @brief offset of the next unread byte of mapped contents
+   */
+  std::string::size_type _offset;
+  /*!
+    @brief number of lines read so far
+   */
+  unsigned long long _line_number;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_LINE_READER_H_
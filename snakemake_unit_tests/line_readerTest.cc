@@ -0,0 +1,180 @@
+/*!
+  \file line_readerTest.cc
+  \brief implementation of line_reader unit tests for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#include "snakemake_unit_tests/line_readerTest.h"
+
+void snakemake_unit_tests::line_readerTest::setUp() {
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutLRTXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("line_readerTest mkdtemp failed");
+  }
+}
+
+void snakemake_unit_tests::line_readerTest::tearDown() {
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
+}
+
+void snakemake_unit_tests::line_readerTest::install_bgzf(const boost::filesystem::path &filename,
+                                                        const std::string &content, unsigned block_size) const {
+  std::ofstream output(filename.string().c_str(), std::ios_base::binary);
+  // the final block is empty, marking the end of the file
+  for (std::string::size_type start = 0; start <= content.size(); start += block_size) {
+    std::string chunk = content.substr(start, block_size);
+    std::string compressed(compressBound(chunk.size()) + 16, '\0');
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    stream.next_in = reinterpret_cast<unsigned char *>(&chunk[0]);
+    stream.avail_in = chunk.size();
+    stream.next_out = reinterpret_cast<unsigned char *>(&compressed[0]);
+    stream.avail_out = compressed.size();
+    deflate(&stream, Z_FINISH);
+    compressed.resize(stream.total_out);
+    deflateEnd(&stream);
+    unsigned block_total = 18 + compressed.size() + 8 - 1;
+    unsigned long crc =
+        crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const unsigned char *>(chunk.data()), chunk.size());
+    unsigned char header[18] = {31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0,
+                                static_cast<unsigned char>(block_total & 255),
+                                static_cast<unsigned char>(block_total >> 8)};
+    output.write(reinterpret_cast<const char *>(header), 18);
+    output << compressed;
+    for (unsigned i = 0; i < 4; ++i) output.put(static_cast<char>((crc >> (8 * i)) & 255));
+    for (unsigned i = 0; i < 4; ++i) output.put(static_cast<char>((chunk.size() >> (8 * i)) & 255));
+    if (start == content.size()) break;
+  }
+  output.close();
+}
+
+void snakemake_unit_tests::line_readerTest::test_line_reader_is_gzipped() {
+  CPPUNIT_ASSERT(line_reader::is_gzipped("path/to/file.gz"));
+  CPPUNIT_ASSERT(line_reader::is_gzipped("file.vcf.GZ"));
+  CPPUNIT_ASSERT(!line_reader::is_gzipped("file.tsv"));
+  CPPUNIT_ASSERT(!line_reader::is_gzipped("file.tgz"));
+  CPPUNIT_ASSERT(!line_reader::is_gzipped("gz"));
+}
+
+void snakemake_unit_tests::line_readerTest::test_line_reader_getline() {
+  boost::filesystem::path filename = boost::filesystem::path(_tmp_dir) / "file.txt";
+  std::ofstream output(filename.string().c_str(), std::ios_base::binary);
+  output << "line1\nline2\r\n\nline4";
+  output.close();
+  line_reader reader(filename);
+  std::string line = "";
+  CPPUNIT_ASSERT(!reader.get_line_number());
+  CPPUNIT_ASSERT(!reader.is_bgzf());
+  CPPUNIT_ASSERT(reader.getline(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("line1\n"), line);
+  CPPUNIT_ASSERT(reader.get_line_number() == 1);
+  // windows line endings are reported as newlines
+  CPPUNIT_ASSERT(reader.getline(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("line2\n"), line);
+  CPPUNIT_ASSERT(reader.getline(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("\n"), line);
+  // a final line need not have a newline
+  CPPUNIT_ASSERT(reader.getline(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("line4"), line);
+  CPPUNIT_ASSERT(!reader.getline(&line));
+  CPPUNIT_ASSERT(line.empty());
+  CPPUNIT_ASSERT(reader.get_line_number() == 4);
+}
+
+void snakemake_unit_tests::line_readerTest::test_line_reader_getline_empty() {
+  boost::filesystem::path filename = boost::filesystem::path(_tmp_dir) / "file.txt";
+  std::ofstream output(filename.string().c_str());
+  output.close();
+  line_reader reader(filename);
+  std::string line = "";
+  CPPUNIT_ASSERT(!reader.getline(&line));
+}
+
+void snakemake_unit_tests::line_readerTest::test_line_reader_getline_gzipped() {
+  boost::filesystem::path filename = boost::filesystem::path(_tmp_dir) / "file.txt.gz";
+  // longer than one read, to exercise reassembly of long lines
+  std::string long_line(100000, 'x');
+  std::string content = "line1\n" + long_line + "\nline3\n";
+  gzFile output = gzopen(filename.string().c_str(), "wb");
+  CPPUNIT_ASSERT(output);
+  CPPUNIT_ASSERT(gzwrite(output, content.c_str(), content.size()) == static_cast<int>(content.size()));
+  gzclose(output);
+  line_reader reader(filename);
+  std::string line = "";
+  CPPUNIT_ASSERT(reader.getline(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("line1\n"), line);
+  CPPUNIT_ASSERT(reader.getline(&line));
+  CPPUNIT_ASSERT_EQUAL(long_line + "\n", line);
+  CPPUNIT_ASSERT(reader.getline(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("line3\n"), line);
+  CPPUNIT_ASSERT(!reader.getline(&line));
+  // plain gzip cannot be read in parallel
+  line_reader threaded(filename, 4);
+  CPPUNIT_ASSERT(!threaded.is_bgzf());
+  CPPUNIT_ASSERT(threaded.getline(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("line1\n"), line);
+}
+
+void snakemake_unit_tests::line_readerTest::test_line_reader_getline_forced_gzip() {
+  // compressed test data keep their original names
+  boost::filesystem::path filename = boost::filesystem::path(_tmp_dir) / "file.txt";
+  std::string content = "line1\nline2\n";
+  gzFile output = gzopen(filename.string().c_str(), "wb");
+  CPPUNIT_ASSERT(output);
+  CPPUNIT_ASSERT(gzwrite(output, content.c_str(), content.size()) == static_cast<int>(content.size()));
+  gzclose(output);
+  line_reader reader(filename, 1, true);
+  std::string line = "";
+  CPPUNIT_ASSERT(reader.getline(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("line1\n"), line);
+  CPPUNIT_ASSERT(reader.getline(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("line2\n"), line);
+  CPPUNIT_ASSERT(!reader.getline(&line));
+}
+
+void snakemake_unit_tests::line_readerTest::test_line_reader_getline_bgzf() {
+  boost::filesystem::path filename = boost::filesystem::path(_tmp_dir) / "file.txt.gz";
+  // small blocks, so that lines span blocks and batches
+  std::string content = "";
+  for (unsigned i = 0; i < 1000; ++i) {
+    content += "line" + std::to_string(i) + "\tvalue\n";
+  }
+  content += "last";
+  install_bgzf(filename, content, 100);
+  line_reader serial(filename), parallel(filename, 3);
+  CPPUNIT_ASSERT(!serial.is_bgzf());
+  CPPUNIT_ASSERT(parallel.is_bgzf());
+  std::string line1 = "", line2 = "", last = "";
+  bool more1 = false, more2 = false;
+  while ((more1 = serial.getline(&line1)) | (more2 = parallel.getline(&line2))) {
+    CPPUNIT_ASSERT(more1 && more2);
+    CPPUNIT_ASSERT_EQUAL(line1, line2);
+    last = line2;
+  }
+  CPPUNIT_ASSERT_EQUAL(std::string("last"), last);
+  CPPUNIT_ASSERT(parallel.get_line_number() == 1001);
+}
+
+void snakemake_unit_tests::line_readerTest::test_line_reader_getline_bgzf_truncated() {
+  boost::filesystem::path filename = boost::filesystem::path(_tmp_dir) / "file.txt.gz";
+  install_bgzf(filename, "line1\nline2\n", 6);
+  boost::filesystem::resize_file(filename, boost::filesystem::file_size(filename) - 30);
+  line_reader reader(filename, 2);
+  std::string line = "";
+  while (reader.getline(&line)) {
+  }
+}
+
+void snakemake_unit_tests::line_readerTest::test_line_reader_missing_file() {
+  line_reader reader(boost::filesystem::path(_tmp_dir) / "absent.txt");
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::line_readerTest);
@@ -0,0 +1,66 @@
+/*!
+  \file line_readerTest.h
+  \brief line_reader test fixture for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_LINE_READERTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_LINE_READERTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <zlib.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/line_reader.h"
+
+namespace snakemake_unit_tests {
+class line_readerTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(line_readerTest);
+  CPPUNIT_TEST(test_line_reader_is_gzipped);
+  CPPUNIT_TEST(test_line_reader_getline);
+  CPPUNIT_TEST(test_line_reader_getline_empty);
+  CPPUNIT_TEST(test_line_reader_getline_gzipped);
+  CPPUNIT_TEST(test_line_reader_getline_forced_gzip);
+  CPPUNIT_TEST(test_line_reader_getline_bgzf);
+  CPPUNIT_TEST_EXCEPTION(test_line_reader_getline_bgzf_truncated, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_line_reader_missing_file, std::runtime_error);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_line_reader_is_gzipped();
+  void test_line_reader_getline();
+  void test_line_reader_getline_empty();
+  void test_line_reader_getline_gzipped();
+  void test_line_reader_getline_forced_gzip();
+  void test_line_reader_getline_bgzf();
+  void test_line_reader_getline_bgzf_truncated();
+  void test_line_reader_missing_file();
+
+ private:
+  /*!
+    @brief write content as a BGZF file, as bgzip would
+    @param filename name of file to create
+    @param content content to compress
+    @param block_size bytes of content per block
+   */
+  void install_bgzf(const boost::filesystem::path &filename, const std::string &content, unsigned block_size) const;
+  char *_tmp_dir;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_LINE_READERTEST_H_
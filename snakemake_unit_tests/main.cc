@@ -7,6 +7,8 @@
   2021 Lightning Auriga
  */
 
+#include <stdlib.h>
+
 #include <algorithm>
 #include <cmath>
 #include <fstream>
@@ -20,12 +22,115 @@
 #include <vector>
 
 #include "boost/filesystem.hpp"
+#include "boost/smart_ptr.hpp"
 #include "snakemake_unit_tests/cargs.h"
+#include "snakemake_unit_tests/output_checker.h"
+#include "snakemake_unit_tests/profiler.h"
 #include "snakemake_unit_tests/rule_block.h"
 #include "snakemake_unit_tests/snakemake_file.h"
 #include "snakemake_unit_tests/solved_rules.h"
+#include "snakemake_unit_tests/test_runner.h"
 #include "snakemake_unit_tests/yaml_reader.h"
 
+/*!
+  @brief run previously emitted unit tests concurrently
+  @param argc number of command line entries, including the subcommand
+  @param argv array of command line entries, starting with the subcommand
+  @return exit code: 0 if every test passed, nonzero otherwise
+ */
+int run_subcommand(int argc, const char** const argv) {
+  snakemake_unit_tests::cargs ap(argc, argv);
+  if (ap.help()) {
+    std::cout << "usage: snakemake_unit_tests.out run [options]" << std::endl;
+    ap.print_help(std::cout);
+    return 0;
+  }
+  snakemake_unit_tests::params p = ap.set_run_parameters();
+  // have the tests compare their outputs with this same build
+  if (boost::filesystem::exists("/proc/self/exe")) {
+    setenv("SNAKEMAKE_UNIT_TESTS_BINARY", boost::filesystem::canonical("/proc/self/exe").string().c_str(), 0);
+  }
+  snakemake_unit_tests::test_runner runner;
+  runner.set_jobs(p.jobs);
+  runner.set_memory_mb(p.memory_mb);
+  runner.set_timeout(p.subprocess_timeout);
+  runner.set_use_cache(!p.ignore_cache);
+  boost::shared_ptr<snakemake_unit_tests::tracer> trace;
+  if (!p.trace.string().empty()) {
+    trace.reset(new snakemake_unit_tests::tracer);
+    runner.set_tracer(trace);
+  }
+  std::vector<std::string> rules;
+  runner.discover_tests(p.output_test_dir, p.include_rules, p.exclude_rules, &rules);
+  if (p.build_conda_envs) {
+    std::cout << "creating shared conda environments" << std::endl;
+    unsigned failures = runner.build_conda_envs(p.output_test_dir, rules, std::cout);
+    // tests create any environment that could not be built, and report errors in context
+    if (failures) std::cout << failures << " conda environments could not be created" << std::endl;
+  }
+  std::cout << "running " << rules.size() << " tests from " << (p.output_test_dir / "unit").string() << std::endl;
+  std::vector<snakemake_unit_tests::test_result> results;
+  runner.run_tests(p.output_test_dir, rules, p.verbose, std::cout, &results);
+  snakemake_unit_tests::test_runner::report_results(results, std::cout);
+  if (!p.subprocess_summary.string().empty()) {
+    std::vector<snakemake_unit_tests::subprocess_record> records;
+    for (std::vector<snakemake_unit_tests::test_result>::const_iterator iter = results.begin(); iter != results.end();
+         ++iter) {
+      // cached tests were not run
+      if (iter->cached) continue;
+      snakemake_unit_tests::subprocess_record record;
+      record.label = "test " + iter->rule_name;
+      record.working_directory = (p.output_test_dir / "unit").string();
+      record.result = iter->result;
+      records.push_back(record);
+    }
+    snakemake_unit_tests::report_subprocess_summary(records, p.subprocess_summary.string());
+  }
+  if (trace) {
+    trace->report_json(p.trace.string());
+  }
+  for (std::vector<snakemake_unit_tests::test_result>::const_iterator iter = results.begin(); iter != results.end();
+       ++iter) {
+    if (!iter->passed()) return 1;
+  }
+  return 0;
+}
+
+/*!
+  @brief compare one test's outputs against its expected outputs
+  @param argc number of command line entries, including the subcommand
+  @param argv array of command line entries, starting with the subcommand
+  @return exit code: 0 if the outputs matched, nonzero otherwise
+ */
+int compare_subcommand(int argc, const char** const argv) {
+  snakemake_unit_tests::cargs ap(argc, argv);
+  if (ap.help()) {
+    std::cout << "usage: snakemake_unit_tests.out compare [options]" << std::endl;
+    ap.print_help(std::cout);
+    return 0;
+  }
+  snakemake_unit_tests::params p = ap.set_compare_parameters();
+  snakemake_unit_tests::output_checker checker;
+  checker.set_jobs(p.jobs);
+  for (std::map<std::string, bool>::const_iterator iter = p.exclude_patterns.begin();
+       iter != p.exclude_patterns.end(); ++iter) {
+    checker.add_exclude_pattern(iter->first);
+  }
+  for (std::vector<std::string>::const_iterator iter = p.comparison_exclusions.begin();
+       iter != p.comparison_exclusions.end(); ++iter) {
+    checker.add_comparison_exclusion(*iter);
+  }
+  checker.add_comparators(p.comparators);
+  if (!p.expected_digests.string().empty()) checker.load_expected_digests(p.expected_digests);
+  if (!p.compressed_files.string().empty()) checker.load_compressed_files(p.compressed_files);
+  std::vector<std::string> failures;
+  checker.check(p.workspace_dir, p.expected_dir, p.run_dir, &failures);
+  for (std::vector<std::string>::const_iterator iter = failures.begin(); iter != failures.end(); ++iter) {
+    std::cout << *iter << std::endl;
+  }
+  return failures.empty() ? 0 : 1;
+}
+
 /*!
   @brief main program implementation
   @param argc number of command line entries, including program name
@@ -33,6 +138,14 @@
   @return exit code: 0 on success, nonzero otherwise
  */
 int main(int argc, const char** const argv) {
+  // subcommand: run existing tests instead of emitting them
+  if (argc > 1 && !std::string(argv[1]).compare("run")) {
+    return run_subcommand(argc - 1, argv + 1);
+  }
+  // subcommand: check one test's outputs, on behalf of the emitted test
+  if (argc > 1 && !std::string(argv[1]).compare("compare")) {
+    return compare_subcommand(argc - 1, argv + 1);
+  }
   // parse command line input
   snakemake_unit_tests::cargs ap(argc, argv);
   snakemake_unit_tests::params p;
@@ -44,9 +157,16 @@ int main(int argc, const char** const argv) {
   }
 
   p = ap.set_parameters();
+  // measure each phase of the run; reported only if requested
+  boost::shared_ptr<snakemake_unit_tests::profiler> prof(new snakemake_unit_tests::profiler);
+  if (!p.trace.string().empty()) {
+    prof->set_tracer(boost::shared_ptr<snakemake_unit_tests::tracer>(new snakemake_unit_tests::tracer));
+  }
 
   // parse the top-level snakefile and all include files (hopefully)
   snakemake_unit_tests::snakemake_file sf;
+  sf.set_subprocess_timeout(p.subprocess_timeout);
+  sf.set_profiler(prof);
   // express snakefile as path relative to top-level pipeline dir
   std::string snakefile_str = boost::filesystem::canonical(boost::filesystem::absolute(p.snakefile)).string();
   std::string pipeline_str = boost::filesystem::canonical(boost::filesystem::absolute(p.pipeline_top_dir)).string();
@@ -63,11 +183,27 @@ int main(int argc, const char** const argv) {
   if (p.verbose) {
     std::cout << "computed snakefile is \"" << snakefile_str << "\"" << std::endl;
   }
+  prof->begin_phase("load_everything");
   sf.load_everything(boost::filesystem::path(snakefile_str), p.pipeline_top_dir, p.verbose);
+  prof->end_phase();
 
   // parse the log file to determine the solved system of rules and outputs
   snakemake_unit_tests::solved_rules sr;
+  sr.set_subprocess_timeout(p.subprocess_timeout);
+  sr.set_profiler(prof);
+  if (p.digest_outputs) {
+    // outputs are normalized as the tests' own comparators will see them
+    boost::shared_ptr<snakemake_unit_tests::output_checker> digests(new snakemake_unit_tests::output_checker);
+    digests->add_comparators(p.comparators);
+    digests->set_jobs(p.jobs);
+    sr.set_output_digests(digests);
+  }
+  sr.set_compress_test_data(p.compress_test_data, p.jobs);
+  sr.set_fingerprint_threads(p.jobs);
+  sr.set_conda_prefix(p.conda_prefix);
+  prof->begin_phase("load_file");
   sr.load_file(p.snakemake_log.string());
+  prof->end_phase();
 
   // new feature: python integration to resolve ambiguous rules
   // create empty workspace for run
@@ -76,10 +212,16 @@ int main(int argc, const char** const argv) {
   // TODO(lightning-auriga): determine if workspace requires inputs or outputs?
   //   probably not, as this isn't rule-specific, I hope
   std::map<std::string, std::vector<std::string> > files_outside_workspace;
+  prof->begin_phase("create_empty_workspace");
   sr.create_empty_workspace(p.output_test_dir, p.pipeline_top_dir, p.added_files, p.added_directories,
                             &files_outside_workspace);
+  prof->end_phase();
   // do things in this location
+  prof->begin_phase("resolve_with_python");
+  unsigned resolution_pass = 0;
   do {
+    snakemake_unit_tests::tracer::span pass_span(prof->get_tracer(),
+                                                 "resolution pass " + std::to_string(++resolution_pass), "resolve");
     // scan the rule set for blockers
     if (p.verbose) {
       std::cout << "running a python/snakemake logic resolution pass" << std::endl;
@@ -87,19 +229,59 @@ int main(int argc, const char** const argv) {
     sf.resolve_with_python(p.output_test_dir / ".snakemake_unit_tests", p.pipeline_top_dir, p.pipeline_run_dir,
                            p.verbose, false);
   } while (sf.contains_blockers());
+  prof->end_phase();
 
   // remove the location
   sr.remove_empty_workspace(p.output_test_dir);
 
   // refactor: move postflight snakefile checks to after the python passes
+  prof->begin_phase("postflight_checks");
   sf.postflight_checks(p.include_rules, p.exclude_rules);
+  prof->end_phase();
 
-  // iterate over the solved rules, emitting them with modifiers as desired
-  sr.emit_tests(sf, p.output_test_dir, p.pipeline_top_dir, p.pipeline_run_dir, p.inst_dir, p.include_rules,
-                p.exclude_rules, p.added_files, p.added_directories, p.update_snakefiles || p.update_all,
-                p.update_added_content || p.update_all, p.update_inputs || p.update_all,
-                p.update_outputs || p.update_all, p.update_pytest || p.update_all, p.include_entire_dag,
-                &files_outside_workspace);
+  if (p.plan_only) {
+    // report what would be emitted, and touch nothing
+    prof->begin_phase("plan_tests");
+    std::vector<snakemake_unit_tests::rule_plan> plans;
+    sr.plan_tests(sf, p.output_test_dir, p.pipeline_top_dir, p.pipeline_run_dir, p.include_rules, p.exclude_rules,
+                  p.added_files, p.added_directories, p.include_entire_dag, &plans);
+    prof->end_phase();
+    if (p.plan_json.string().empty()) {
+      snakemake_unit_tests::solved_rules::report_plans(plans, std::cout);
+    } else {
+      std::ofstream output(p.plan_json.string().c_str());
+      if (!output.is_open()) throw std::runtime_error("cannot write plan file \"" + p.plan_json.string() + "\"");
+      snakemake_unit_tests::solved_rules::report_plans_json(plans, output);
+      output.close();
+      std::cout << "planned " << plans.size() << " tests; plan written to " << p.plan_json.string() << std::endl;
+    }
+  } else {
+    // iterate over the solved rules, emitting them with modifiers as desired
+    prof->begin_phase("emit_tests");
+    sr.emit_tests(sf, p.output_test_dir, p.pipeline_top_dir, p.pipeline_run_dir, p.inst_dir, p.include_rules,
+                  p.exclude_rules, p.added_files, p.added_directories, p.update_snakefiles || p.update_all,
+                  p.update_added_content || p.update_all, p.update_inputs || p.update_all,
+                  p.update_outputs || p.update_all, p.update_pytest || p.update_all, p.include_entire_dag,
+                  &files_outside_workspace);
+    prof->end_phase();
+    std::cout << "emitted files: " << sr.get_files_written() << " written, " << sr.get_files_unchanged()
+              << " unchanged" << std::endl;
+  }
+
+  // report resource use of snakemake runs, to find slow rule workspaces
+  std::vector<snakemake_unit_tests::subprocess_record> subprocess_records = sf.get_subprocess_records();
+  subprocess_records.insert(subprocess_records.end(), sr.get_subprocess_records().begin(),
+                            sr.get_subprocess_records().end());
+  if (p.verbose) {
+    std::cout << "snakemake subprocess resource use:" << std::endl;
+    for (std::vector<snakemake_unit_tests::subprocess_record>::const_iterator iter = subprocess_records.begin();
+         iter != subprocess_records.end(); ++iter) {
+      snakemake_unit_tests::report_subprocess_usage(*iter, std::cout);
+    }
+  }
+  if (!p.subprocess_summary.string().empty()) {
+    snakemake_unit_tests::report_subprocess_summary(subprocess_records, p.subprocess_summary.string());
+  }
 
   if (!files_outside_workspace.empty()) {
     std::cout << "warning: file from outside of contained workspace detected."
@@ -126,9 +308,15 @@ int main(int argc, const char** const argv) {
   }
 
   // if requested, report final configuration settings to test directory
-  if (p.update_config || p.update_all) {
+  if ((p.update_config || p.update_all) && !p.plan_only) {
     p.report_settings(p.output_test_dir / "unit" / "config.yaml");
   }
+  if (!p.profile_json.string().empty()) {
+    prof->report_json(p.profile_json.string());
+  }
+  if (prof->get_tracer()) {
+    prof->get_tracer()->report_json(p.trace.string());
+  }
   std::cout << "all done woo!" << std::endl;
   return 0;
 }
@@ -0,0 +1,379 @@
+/*!
+  \file output_checker.cc
+  \brief implementation of native unit test output comparison
+  \copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#include "snakemake_unit_tests/output_checker.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace {
+/*!
+  @brief read-only memory map of an entire file, released on destruction
+ */
+struct mapped_file {
+  /*!
+    @brief map a file
+    @param filename name of file to map
+   */
+  explicit mapped_file(const boost::filesystem::path &filename) : data(0), size(0) {
+    int fd = open(filename.string().c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("cannot open \"" + filename.string() + "\" for reading");
+    struct stat info;
+    if (fstat(fd, &info)) {
+      close(fd);
+      throw std::runtime_error("cannot query size of \"" + filename.string() + "\"");
+    }
+    size = info.st_size;
+    if (size) {
+      void *mapped = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("cannot map \"" + filename.string() + "\" for reading");
+      }
+      madvise(mapped, size, MADV_SEQUENTIAL);
+      data = static_cast<const char *>(mapped);
+    }
+    close(fd);
+  }
+  /*!
+    @brief release the mapping
+   */
+  ~mapped_file() throw() {
+    if (data) munmap(const_cast<char *>(data), size);
+  }
+  /*!
+    @brief mapped contents; null for empty files
+   */
+  const char *data;
+  /*!
+    @brief size of mapped contents
+   */
+  std::string::size_type size;
+};
+/*!
+  @brief format a line for a difference report
+  @param line line as read, or empty at end of file
+  @return the line without its newline, shortened if long
+ */
+std::string describe_line(const std::string &line) {
+  if (line.empty()) return "<end of file>";
+  std::string result = line.substr(0, line.size() - (line.at(line.size() - 1) == '\n' ? 1 : 0));
+  if (result.size() > 200) result = result.substr(0, 200) + "...";
+  return result;
+}
+}  // namespace
+
+snakemake_unit_tests::output_checker::output_checker() : _jobs(1) {
+  // the same defaults inst/test.py applies
+  add_exclude_pattern("\\.snakemake/");
+  add_exclude_pattern("__pycache__");
+}
+
+void snakemake_unit_tests::output_checker::add_exclude_pattern(const std::string &pattern) {
+  _exclude_patterns.push_back(boost::regex(pattern));
+}
+
+void snakemake_unit_tests::output_checker::add_comparison_exclusion(const std::string &substring) {
+  _comparison_exclusions.push_back(substring);
+}
+
+void snakemake_unit_tests::output_checker::add_comparators(const YAML::Node &comparators) {
+  if (!comparators.IsDefined() || comparators.IsNull()) return;
+  if (!comparators.IsSequence()) throw std::runtime_error("comparators must be a sequence");
+  for (YAML::const_iterator iter = comparators.begin(); iter != comparators.end(); ++iter) {
+    comparator c;
+    if (!(*iter)["type"] || !(*iter)["patterns"]) {
+      throw std::runtime_error("comparators must each have a type and patterns");
+    }
+    c.type = (*iter)["type"].as<std::string>();
+    if (c.type.compare("byte") && c.type.compare("plaintext") && c.type.compare("frame")) {
+      throw std::runtime_error("comparator type " + c.type + " is not supported by the compare subcommand");
+    }
+    YAML::Node patterns = (*iter)["patterns"];
+    for (YAML::const_iterator pattern = patterns.begin(); pattern != patterns.end(); ++pattern) {
+      c.patterns.push_back(boost::regex(pattern->as<std::string>()));
+    }
+    if ((*iter)["args"]) {
+      YAML::Node args = (*iter)["args"];
+      for (YAML::const_iterator arg = args.begin(); arg != args.end(); ++arg) {
+        c.args[arg->first.as<std::string>()] = arg->second.IsNull() ? "" : arg->second.as<std::string>();
+      }
+    }
+    if (!c.type.compare("frame")) c.frame = boost::shared_ptr<frame_comparator>(new frame_comparator(c.args));
+    _comparators.push_back(c);
+  }
+}
+
+void snakemake_unit_tests::output_checker::load_expected_digests(const boost::filesystem::path &manifest) {
+  std::ifstream input(manifest.string().c_str());
+  if (!input.is_open()) throw std::runtime_error("cannot open digest manifest \"" + manifest.string() + "\"");
+  std::string line = "";
+  while (std::getline(input, line)) {
+    if (line.empty()) continue;
+    // paths may contain spaces, so only the first two separators split
+    std::string::size_type method_start = line.find("  "), path_start = std::string::npos;
+    if (method_start != std::string::npos) path_start = line.find("  ", method_start + 2);
+    expected_digest d;
+    d.digest = line.substr(0, method_start);
+    if (path_start != std::string::npos) d.method = line.substr(method_start + 2, path_start - method_start - 2);
+    if (path_start == std::string::npos || d.digest.size() != 64 ||
+        d.digest.find_first_not_of("0123456789abcdef") != std::string::npos ||
+        (d.method.compare("byte") && d.method.compare("plaintext")) || path_start + 2 == line.size()) {
+      throw std::runtime_error("invalid line in digest manifest \"" + manifest.string() + "\": \"" + line + "\"");
+    }
+    _expected_digests[line.substr(path_start + 2)] = d;
+  }
+  input.close();
+}
+
+void snakemake_unit_tests::output_checker::load_compressed_files(const boost::filesystem::path &manifest) {
+  std::ifstream input(manifest.string().c_str());
+  if (!input.is_open()) throw std::runtime_error("cannot open compressed file list \"" + manifest.string() + "\"");
+  const std::string prefix = "expected/";
+  std::string line = "";
+  while (std::getline(input, line)) {
+    // workspace files are decompressed before the test runs, so only expected files matter here
+    if (line.find(prefix) == 0) _compressed_expected[line.substr(prefix.size())] = true;
+  }
+  input.close();
+}
+
+void snakemake_unit_tests::output_checker::list_files(const boost::filesystem::path &dir,
+                                                      std::map<std::string, bool> *target) {
+  if (!target) throw std::runtime_error("null pointer provided to list_files");
+  target->clear();
+  if (!boost::filesystem::is_directory(dir)) return;
+  std::string::size_type prefix_length = dir.string().size() + 1;
+  boost::filesystem::recursive_directory_iterator iter(dir), end;
+  for (; iter != end; ++iter) {
+    if (boost::filesystem::is_regular_file(iter->path())) {
+      (*target)[iter->path().string().substr(prefix_length)] = true;
+    }
+  }
+}
+
+void snakemake_unit_tests::output_checker::check(const boost::filesystem::path &workspace_dir,
+                                                 const boost::filesystem::path &expected_dir,
+                                                 const boost::filesystem::path &run_dir,
+                                                 std::vector<std::string> *failures) const {
+  if (!failures) throw std::runtime_error("null pointer provided to check");
+  failures->clear();
+  if (!boost::filesystem::is_directory(run_dir)) {
+    throw std::runtime_error("run directory \"" + run_dir.string() + "\" is not a directory");
+  }
+  std::map<std::string, bool> input_files, expected_files, generated_files;
+  list_files(boost::filesystem::path(workspace_dir).remove_trailing_separator(), &input_files);
+  list_files(boost::filesystem::path(expected_dir).remove_trailing_separator(), &expected_files);
+  list_files(boost::filesystem::path(run_dir).remove_trailing_separator(), &generated_files);
+  std::vector<std::string> to_compare, unexpected;
+  for (std::map<std::string, bool>::const_iterator iter = generated_files.begin(); iter != generated_files.end();
+       ++iter) {
+    if (iter->first.find(".snakemake") == 0) continue;
+    bool excluded = false;
+    for (std::vector<boost::regex>::const_iterator pattern = _exclude_patterns.begin();
+         pattern != _exclude_patterns.end() && !excluded; ++pattern) {
+      excluded = boost::regex_search(iter->first, *pattern);
+    }
+    for (std::vector<std::string>::const_iterator substring = _comparison_exclusions.begin();
+         substring != _comparison_exclusions.end() && !excluded; ++substring) {
+      excluded = iter->first.find(*substring) != std::string::npos;
+    }
+    if (excluded) continue;
+    if (expected_files.find(iter->first) != expected_files.end() ||
+        _expected_digests.find(iter->first) != _expected_digests.end()) {
+      to_compare.push_back(iter->first);
+    } else if (input_files.find(iter->first) == input_files.end()) {
+      unexpected.push_back(iter->first);
+    }
+  }
+  std::vector<std::string> mismatches(to_compare.size());
+  // threads not needed for separate files can decompress blocks within them
+  unsigned jobs = _jobs ? _jobs : std::max(std::thread::hardware_concurrency(), 1u);
+  unsigned n_files = to_compare.size();
+  unsigned threads_per_file = n_files && n_files < jobs ? jobs / n_files : 1;
+  run_in_parallel(to_compare.size(), jobs, [&](unsigned i) {
+    std::map<std::string, expected_digest>::const_iterator finder = _expected_digests.find(to_compare.at(i));
+    // a file stored in full is compared in full
+    if (finder == _expected_digests.end() || expected_files.find(to_compare.at(i)) != expected_files.end()) {
+      mismatches.at(i) = compare_files(run_dir / to_compare.at(i), expected_dir / to_compare.at(i), threads_per_file,
+                                       _compressed_expected.find(to_compare.at(i)) != _compressed_expected.end());
+    } else if (digest(run_dir / to_compare.at(i), finder->second.method, threads_per_file) != finder->second.digest) {
+      mismatches.at(i) = "contents differ (" + finder->second.method + " digest)";
+    }
+  });
+  for (unsigned i = 0; i < to_compare.size(); ++i) {
+    if (!mismatches.at(i).empty()) failures->push_back(to_compare.at(i) + ": " + mismatches.at(i));
+  }
+  if (!unexpected.empty()) {
+    std::string message = "Unexpected files: ";
+    for (std::vector<std::string>::const_iterator iter = unexpected.begin(); iter != unexpected.end(); ++iter) {
+      message += (iter == unexpected.begin() ? "" : ";") + *iter;
+    }
+    failures->push_back(message);
+  }
+}
+
+std::string snakemake_unit_tests::output_checker::compare_files(const boost::filesystem::path &generated_file,
+                                                                const boost::filesystem::path &expected_file,
+                                                                unsigned threads, bool expected_compressed) const {
+  bool found_handler = false;
+  for (std::vector<comparator>::const_iterator iter = _comparators.begin(); iter != _comparators.end(); ++iter) {
+    bool matched = false;
+    for (std::vector<boost::regex>::const_iterator pattern = iter->patterns.begin();
+         pattern != iter->patterns.end() && !matched; ++pattern) {
+      matched = boost::regex_search(generated_file.string(), *pattern);
+    }
+    if (!matched) continue;
+    found_handler = true;
+    if (!iter->type.compare("byte")) {
+      if (!bytes_equal(generated_file, expected_file, expected_compressed)) return "contents differ (byte comparator)";
+    } else if (iter->frame) {
+      std::string difference = iter->frame->compare(generated_file, expected_file, threads, expected_compressed);
+      if (!difference.empty()) return "contents differ (frame comparator): " + difference;
+    } else {
+      std::string difference = plaintext_difference(generated_file, expected_file, threads, expected_compressed);
+      if (!difference.empty()) return "contents differ (plaintext comparator): " + difference;
+    }
+  }
+  if (found_handler) return "";
+  if (!is_plaintext(generated_file)) {
+    return bytes_equal(generated_file, expected_file, expected_compressed) ? "" : "contents differ (byte comparison)";
+  }
+  std::string difference = plaintext_difference(generated_file, expected_file, threads, expected_compressed);
+  return difference.empty() ? "" : "contents differ (plaintext comparison): " + difference;
+}
+
+bool snakemake_unit_tests::output_checker::bytes_equal(const boost::filesystem::path &file1,
+                                                       const boost::filesystem::path &file2, bool file2_compressed) {
+  if (file2_compressed) {
+    // decompress a window at a time, against the mapped first file
+    mapped_file map1(file1);
+    gzFile input = gzopen(file2.string().c_str(), "rb");
+    if (!input) throw std::runtime_error("cannot open \"" + file2.string() + "\" for reading");
+    gzbuffer(input, 1 << 17);
+    std::string buffer(1 << 17, '\0');
+    std::string::size_type offset = 0;
+    int n_read = 0;
+    bool equal = true;
+    while (equal && (n_read = gzread(input, &buffer[0], buffer.size())) > 0) {
+      equal = offset + n_read <= map1.size && !memcmp(map1.data + offset, buffer.data(), n_read);
+      offset += n_read;
+    }
+    gzclose(input);
+    if (n_read < 0) throw std::runtime_error("cannot decompress \"" + file2.string() + "\"");
+    return equal && offset == map1.size;
+  }
+  if (boost::filesystem::file_size(file1) != boost::filesystem::file_size(file2)) return false;
+  mapped_file map1(file1), map2(file2);
+  return map1.size == map2.size && (!map1.size || !memcmp(map1.data, map2.data, map1.size));
+}
+
+std::string snakemake_unit_tests::output_checker::comment_prefix(const boost::filesystem::path &filename) {
+  std::string name = filename.string();
+  for (std::string::iterator iter = name.begin(); iter != name.end(); ++iter) {
+    *iter = tolower(*iter);
+  }
+  const std::string vcf = ".vcf", vcf_gz = ".vcf.gz";
+  if ((name.size() >= vcf.size() && !name.compare(name.size() - vcf.size(), vcf.size(), vcf)) ||
+      (name.size() >= vcf_gz.size() && !name.compare(name.size() - vcf_gz.size(), vcf_gz.size(), vcf_gz))) {
+    return "##";
+  }
+  return "#";
+}
+
+bool snakemake_unit_tests::output_checker::plaintext_equal(const boost::filesystem::path &file1,
+                                                           const boost::filesystem::path &file2) {
+  return plaintext_difference(file1, file2).empty();
+}
+
+std::string snakemake_unit_tests::output_checker::plaintext_difference(const boost::filesystem::path &generated_file,
+                                                                       const boost::filesystem::path &expected_file,
+                                                                       unsigned threads, bool expected_compressed) {
+  line_reader generated(generated_file, threads), expected(expected_file, threads, expected_compressed);
+  std::string generated_prefix = comment_prefix(generated_file), expected_prefix = comment_prefix(expected_file);
+  std::string generated_line = "", expected_line = "";
+  while (true) {
+    bool generated_more = false, expected_more = false;
+    while ((generated_more = generated.getline(&generated_line)) && generated_line.find(generated_prefix) == 0) {
+    }
+    while ((expected_more = expected.getline(&expected_line)) && expected_line.find(expected_prefix) == 0) {
+    }
+    if (!generated_more && !expected_more) return "";
+    if (generated_more != expected_more || generated_line.compare(expected_line)) {
+      // a file that ended is past its last line
+      return "first difference at line " +
+             std::to_string(generated.get_line_number() + (generated_more ? 0 : 1)) + " of generated file, line " +
+             std::to_string(expected.get_line_number() + (expected_more ? 0 : 1)) + " of expected file\n  generated: " +
+             describe_line(generated_line) + "\n  expected:  " + describe_line(expected_line);
+    }
+  }
+}
+
+std::string snakemake_unit_tests::output_checker::digest_method(const boost::filesystem::path &filename) const {
+  bool found_handler = false;
+  std::string method = "plaintext";
+  for (std::vector<comparator>::const_iterator iter = _comparators.begin(); iter != _comparators.end(); ++iter) {
+    bool matched = false;
+    for (std::vector<boost::regex>::const_iterator pattern = iter->patterns.begin();
+         pattern != iter->patterns.end() && !matched; ++pattern) {
+      matched = boost::regex_search(filename.string(), *pattern);
+    }
+    if (!matched) continue;
+    found_handler = true;
+    if (iter->frame) return "";
+    // identical bytes satisfy a plaintext comparator as well
+    if (!iter->type.compare("byte")) method = "byte";
+  }
+  if (found_handler) return method;
+  return is_plaintext(filename) ? "plaintext" : "byte";
+}
+
+std::string snakemake_unit_tests::output_checker::digest(const boost::filesystem::path &filename,
+                                                         const std::string &method, unsigned threads) {
+  sha256 hasher;
+  if (!method.compare("byte")) {
+    mapped_file map(filename);
+    hasher.update(map.data, map.size);
+  } else if (!method.compare("plaintext")) {
+    line_reader reader(filename, threads);
+    std::string prefix = comment_prefix(filename), line = "";
+    while (reader.getline(&line)) {
+      if (line.find(prefix) != 0) hasher.update(line);
+    }
+  } else {
+    throw std::runtime_error("digest method \"" + method + "\" is not byte or plaintext");
+  }
+  return hasher.hex_digest();
+}
+
+bool snakemake_unit_tests::output_checker::is_plaintext(const boost::filesystem::path &filename) {
+  // gzopen reads files that are not gzipped as they are
+  gzFile input = gzopen(filename.string().c_str(), "rb");
+  if (!input) throw std::runtime_error("cannot open \"" + filename.string() + "\" for reading");
+  unsigned char buffer[8192];
+  int n_read = gzread(input, buffer, sizeof(buffer));
+  gzclose(input);
+  if (n_read <= 0) return false;
+  for (int i = 0; i < n_read; ++i) {
+    unsigned char c = buffer[i];
+    // allow ascii whitespace, printable ascii, and utf-8 and other high bytes
+    if (c < 0x20 && c != '\t' && c != '\n' && c != '\r' && c != '\f' && c != '\v' && c != '\b' && c != 0x1b) {
+      return false;
+    }
+    if (c == 0x7f) return false;
+  }
+  return true;
+}
@@ -0,0 +1,251 @@
+/*!
+  @file output_checker.h
+  @brief compare a unit test's outputs against its expected outputs
+  @copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_OUTPUT_CHECKER_H_
+#define SNAKEMAKE_UNIT_TESTS_OUTPUT_CHECKER_H_
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "boost/regex.hpp"
+#include "boost/shared_ptr.hpp"
+#include "snakemake_unit_tests/frame_comparator.h"
+#include "snakemake_unit_tests/line_reader.h"
+#include "snakemake_unit_tests/sha256.h"
+#include "snakemake_unit_tests/utilities.h"
+#include "yaml-cpp/yaml.h"
+
+namespace snakemake_unit_tests {
+/*!
+  @class output_checker
+  @brief native counterpart of OutputChecker in inst/common.py
+
+  every file a test run leaves behind must either be excluded, be
+  one of the test's inputs, or match an expected output. matching files
+  are compared with each user-configured comparator whose patterns
+  match them, which may be "byte", "plaintext" or "frame"; files no comparator claims are compared as plaintext
+  if they look like text, and byte for byte otherwise. plaintext
+  comparison ignores comment lines ("##" for vcf files, "#" otherwise)
+  and reads ".gz" files through gzip; both files are streamed in
+  lockstep, so memory use does not grow with file size, and the first
+  differing line is reported.
+
+  expected outputs may instead be recorded as SHA-256 digests in a
+  manifest, one "<digest>  <method>  <path>" line per file. the method
+  is "byte" for raw contents, or "plaintext" for the lines plaintext
+  comparison would compare; a generated file is digested the same way
+  in one streaming pass, and matches if the digests agree.
+
+  expected outputs may also be stored gzipped under their own names,
+  as listed in a test's compressed.txt; they are decompressed as they
+  are compared, and never written out in full.
+ */
+class output_checker {
+ public:
+  /*!
+    @brief default constructor: exclude snakemake metadata and python caches
+   */
+  output_checker();
+  /*!
+    @brief copy constructor
+    @param obj existing output_checker
+   */
+  output_checker(const output_checker &obj)
+      : _exclude_patterns(obj._exclude_patterns),
+        _comparison_exclusions(obj._comparison_exclusions),
+        _comparators(obj._comparators),
+        _expected_digests(obj._expected_digests),
+        _compressed_expected(obj._compressed_expected),
+        _jobs(obj._jobs) {}
+  /*!
+    @brief destructor
+   */
+  ~output_checker() throw() {}
+  /*!
+    @brief skip files whose paths, relative to the run directory, match a regular expression
+    @param pattern regular expression, searched anywhere in the path
+   */
+  void add_exclude_pattern(const std::string &pattern);
+  /*!
+    @brief skip files whose paths, relative to the run directory, contain a string
+    @param substring text to search for in the path
+   */
+  void add_comparison_exclusion(const std::string &substring);
+  /*!
+    @brief add comparators from the "comparators" entry of a user configuration
+    @param comparators sequence of maps with "type", "patterns" and optional "args"
+   */
+  void add_comparators(const YAML::Node &comparators);
+  /*!
+    @brief load digests of expected outputs that are not stored as files
+    @param manifest file of "<digest>  <method>  <path>" lines, paths relative to the expected directory
+   */
+  void load_expected_digests(const boost::filesystem::path &manifest);
+  /*!
+    @brief load the list of a test's files that are stored gzipped under their own names
+    @param manifest file of paths relative to the test directory; those under "expected/" are used
+   */
+  void load_compressed_files(const boost::filesystem::path &manifest);
+  /*!
+    @brief set the number of files to compare at once
+    @param jobs number of files; 0 for one per core
+   */
+  void set_jobs(unsigned jobs) { _jobs = jobs; }
+  /*!
+    @brief get the number of files to compare at once
+    @return number of files, or 0 for one per core
+   */
+  unsigned get_jobs() const { return _jobs; }
+  /*!
+    @brief compare the contents of a run directory against expected outputs
+    @param workspace_dir directory of the test's inputs
+    @param expected_dir directory of the test's expected outputs
+    @param run_dir directory in which the test ran
+    @param failures where to store one message per problem found; empty if the run matched
+   */
+  void check(const boost::filesystem::path &workspace_dir, const boost::filesystem::path &expected_dir,
+             const boost::filesystem::path &run_dir, std::vector<std::string> *failures) const;
+  /*!
+    @brief compare one generated file against its expected counterpart
+    @param generated_file file produced by the test
+    @param expected_file file the test should have produced
+    @param threads number of threads with which to decompress BGZF files
+    @param expected_compressed whether the expected file is stored gzipped, whatever its name
+    @return empty on a match, or a description of the mismatch
+   */
+  std::string compare_files(const boost::filesystem::path &generated_file,
+                            const boost::filesystem::path &expected_file, unsigned threads = 1,
+                            bool expected_compressed = false) const;
+  /*!
+    @brief determine whether two files have identical bytes
+    @param file1 first file
+    @param file2 second file
+    @param file2_compressed whether the second file is stored gzipped, and should be compared once decompressed
+    @return whether the files are identical
+   */
+  static bool bytes_equal(const boost::filesystem::path &file1, const boost::filesystem::path &file2,
+                          bool file2_compressed = false);
+  /*!
+    @brief determine whether two text files match once comment lines are removed
+    @param file1 first file
+    @param file2 second file
+    @return whether the files match
+   */
+  static bool plaintext_equal(const boost::filesystem::path &file1, const boost::filesystem::path &file2);
+  /*!
+    @brief find the first difference between two text files once comment lines are removed
+    @param generated_file file produced by the test
+    @param expected_file file the test should have produced
+    @param threads number of threads with which to decompress BGZF files
+    @param expected_compressed whether the expected file is stored gzipped, whatever its name
+    @return empty if the files match, or the line numbers and contents of the first differing lines
+   */
+  static std::string plaintext_difference(const boost::filesystem::path &generated_file,
+                                          const boost::filesystem::path &expected_file, unsigned threads = 1,
+                                          bool expected_compressed = false);
+  /*!
+    @brief guess whether a file, after any gzip decompression, is text
+    @param filename name of file to inspect
+    @return whether the start of the file contains only text characters
+   */
+  static bool is_plaintext(const boost::filesystem::path &filename);
+  /*!
+    @brief get the comment prefix stripped from a text file before comparison
+    @param filename name of file
+    @return "##" for vcf files, compressed or not, and "#" for everything else
+   */
+  static std::string comment_prefix(const boost::filesystem::path &filename);
+  /*!
+    @brief choose how a file's contents should be normalized before digesting
+    @param filename name of file, matched against comparator patterns
+    @return "byte" or "plaintext", as compare_files would compare the file; or empty
+    if a frame comparator claims it, as tolerance comparisons cannot be digested
+   */
+  std::string digest_method(const boost::filesystem::path &filename) const;
+  /*!
+    @brief compute the SHA-256 digest of a file's normalized contents
+    @param filename name of file to digest
+    @param method "byte" for raw contents, or "plaintext" for lines other than comments
+    @param threads number of threads with which to decompress BGZF files
+    @return digest as lowercase hex
+   */
+  static std::string digest(const boost::filesystem::path &filename, const std::string &method,
+                            unsigned threads = 1);
+
+ private:
+  friend class output_checkerTest;
+  /*!
+    @brief a user-configured comparison method and the files it applies to
+   */
+  struct comparator {
+    /*!
+      @brief comparison method: "byte", "plaintext" or "frame"
+     */
+    std::string type;
+    /*!
+      @brief expressions searched for in the generated file's path
+     */
+    std::vector<boost::regex> patterns;
+    /*!
+      @brief method-specific settings
+     */
+    std::map<std::string, std::string> args;
+    /*!
+      @brief table comparison configured from args; null unless type is "frame"
+     */
+    boost::shared_ptr<frame_comparator> frame;
+  };
+  /*!
+    @brief digest of an expected output that is not stored as a file
+   */
+  struct expected_digest {
+    /*!
+      @brief normalization applied before digesting: "byte" or "plaintext"
+     */
+    std::string method;
+    /*!
+      @brief SHA-256 digest as lowercase hex
+     */
+    std::string digest;
+  };
+  /*!
+    @brief list regular files under a directory
+    @param dir directory to search; a missing directory has no files
+    @param target where to store paths relative to dir, as keys
+   */
+  static void list_files(const boost::filesystem::path &dir, std::map<std::string, bool> *target);
+  /*!
+    @brief patterns of run directory paths to skip
+   */
+  std::vector<boost::regex> _exclude_patterns;
+  /*!
+    @brief substrings of run directory paths to skip
+   */
+  std::vector<std::string> _comparison_exclusions;
+  /*!
+    @brief user-configured comparators, in configuration order
+   */
+  std::vector<comparator> _comparators;
+  /*!
+    @brief digests of expected outputs, by path relative to the expected directory
+   */
+  std::map<std::string, expected_digest> _expected_digests;
+  /*!
+    @brief expected outputs stored gzipped, by path relative to the expected directory
+   */
+  std::map<std::string, bool> _compressed_expected;
+  /*!
+    @brief number of files to compare at once; 0 for one per core
+   */
+  unsigned _jobs;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_OUTPUT_CHECKER_H_
@@ -0,0 +1,298 @@
+/*!
+  \file output_checkerTest.cc
+  \brief implementation of output_checker unit tests for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#include "snakemake_unit_tests/output_checkerTest.h"
+
+void snakemake_unit_tests::output_checkerTest::setUp() {
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutOCTXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("output_checkerTest mkdtemp failed");
+  }
+}
+
+void snakemake_unit_tests::output_checkerTest::tearDown() {
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
+}
+
+boost::filesystem::path snakemake_unit_tests::output_checkerTest::install_file(const std::string &relative_path,
+                                                                               const std::string &content) const {
+  boost::filesystem::path filename = boost::filesystem::path(_tmp_dir) / relative_path;
+  boost::filesystem::create_directories(filename.parent_path());
+  if (line_reader::is_gzipped(filename)) {
+    gzFile output = gzopen(filename.string().c_str(), "wb");
+    if (!output) throw std::runtime_error("output_checkerTest gzopen failed");
+    gzwrite(output, content.c_str(), content.size());
+    gzclose(output);
+  } else {
+    std::ofstream output(filename.string().c_str(), std::ios_base::binary);
+    output << content;
+    output.close();
+  }
+  return filename;
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_default_constructor() {
+  output_checker oc;
+  CPPUNIT_ASSERT(oc._exclude_patterns.size() == 2);
+  CPPUNIT_ASSERT(oc._comparison_exclusions.empty());
+  CPPUNIT_ASSERT(oc._comparators.empty());
+  CPPUNIT_ASSERT(oc.get_jobs() == 1);
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_copy_constructor() {
+  output_checker oc1;
+  oc1.add_exclude_pattern("\\.log$");
+  oc1.add_comparison_exclusion("benchmarks");
+  oc1.add_comparators(YAML::Load("[{type: byte, patterns: ['\\.bam$']}]"));
+  oc1.set_jobs(4);
+  output_checker oc2(oc1);
+  CPPUNIT_ASSERT(oc2._exclude_patterns.size() == 3);
+  CPPUNIT_ASSERT(oc2._comparison_exclusions.size() == 1);
+  CPPUNIT_ASSERT(oc2._comparators.size() == 1);
+  CPPUNIT_ASSERT(oc2.get_jobs() == 4);
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_add_comparators() {
+  output_checker oc;
+  oc.add_comparators(YAML::Node());
+  CPPUNIT_ASSERT(oc._comparators.empty());
+  oc.add_comparators(
+      YAML::Load("[{type: byte, patterns: ['\\.bam$', '\\.bai$']}, "
+                 "{type: plaintext, patterns: ['\\.txt$'], args: {sep: ',', header: null}}]"));
+  CPPUNIT_ASSERT(oc._comparators.size() == 2);
+  CPPUNIT_ASSERT(!oc._comparators.at(0).type.compare("byte"));
+  CPPUNIT_ASSERT(oc._comparators.at(0).patterns.size() == 2);
+  CPPUNIT_ASSERT(!oc._comparators.at(1).type.compare("plaintext"));
+  CPPUNIT_ASSERT(!oc._comparators.at(1).args["sep"].compare(","));
+  CPPUNIT_ASSERT(oc._comparators.at(1).args["header"].empty());
+  CPPUNIT_ASSERT(!oc._comparators.at(1).frame);
+  oc.add_comparators(YAML::Load("[{type: frame, patterns: ['\\.tsv$'], args: {sep: ',', header: null}}]"));
+  CPPUNIT_ASSERT(oc._comparators.size() == 3);
+  CPPUNIT_ASSERT(oc._comparators.at(2).frame);
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_add_comparators_unknown_type() {
+  output_checker oc;
+  oc.add_comparators(YAML::Load("[{type: fuzzy, patterns: ['\\.txt$']}]"));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_add_comparators_missing_patterns() {
+  output_checker oc;
+  oc.add_comparators(YAML::Load("[{type: byte}]"));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_comment_prefix() {
+  CPPUNIT_ASSERT_EQUAL(std::string("##"), output_checker::comment_prefix("results/calls.vcf"));
+  CPPUNIT_ASSERT_EQUAL(std::string("##"), output_checker::comment_prefix("results/calls.VCF.gz"));
+  CPPUNIT_ASSERT_EQUAL(std::string("#"), output_checker::comment_prefix("results/calls.tsv.gz"));
+  CPPUNIT_ASSERT_EQUAL(std::string("#"), output_checker::comment_prefix("results/vcf"));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_is_plaintext() {
+  CPPUNIT_ASSERT(output_checker::is_plaintext(install_file("file.txt", "a\tb\nc\td\n")));
+  CPPUNIT_ASSERT(output_checker::is_plaintext(install_file("file.txt.gz", "a\tb\nc\td\n")));
+  CPPUNIT_ASSERT(!output_checker::is_plaintext(install_file("file.bin", std::string("a\0b\n", 4))));
+  CPPUNIT_ASSERT(!output_checker::is_plaintext(install_file("file.bin.gz", std::string("\x01\x02\x03", 3))));
+  CPPUNIT_ASSERT(!output_checker::is_plaintext(install_file("empty.txt", "")));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_bytes_equal() {
+  boost::filesystem::path file1 = install_file("file1", "abc\n");
+  CPPUNIT_ASSERT(output_checker::bytes_equal(file1, install_file("file2", "abc\n")));
+  CPPUNIT_ASSERT(!output_checker::bytes_equal(file1, install_file("file3", "abd\n")));
+  CPPUNIT_ASSERT(!output_checker::bytes_equal(file1, install_file("file4", "abc")));
+  CPPUNIT_ASSERT(output_checker::bytes_equal(install_file("empty1", ""), install_file("empty2", "")));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_bytes_equal_compressed() {
+  boost::filesystem::path file1 = install_file("file1", std::string("\0abc\n", 5));
+  boost::filesystem::path file2 = install_file("file2.gz", std::string("\0abc\n", 5));
+  CPPUNIT_ASSERT(output_checker::bytes_equal(file1, file2, true));
+  CPPUNIT_ASSERT(!output_checker::bytes_equal(file1, file2));
+  CPPUNIT_ASSERT(!output_checker::bytes_equal(file1, install_file("file3.gz", std::string("\0abc", 4)), true));
+  CPPUNIT_ASSERT(!output_checker::bytes_equal(install_file("file4", "\0ab"), file2, true));
+  CPPUNIT_ASSERT(output_checker::bytes_equal(install_file("empty1", ""), install_file("empty2.gz", ""), true));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_plaintext_equal() {
+  // comment lines, such as datestamps, are ignored
+  boost::filesystem::path file1 = install_file("dir1/file.tsv", "# made today\na\tb\n");
+  CPPUNIT_ASSERT(output_checker::plaintext_equal(file1, install_file("dir2/file.tsv", "a\tb\n# made yesterday\n")));
+  CPPUNIT_ASSERT(!output_checker::plaintext_equal(file1, install_file("dir3/file.tsv", "# made today\na\tc\n")));
+  CPPUNIT_ASSERT(!output_checker::plaintext_equal(file1, install_file("dir4/file.tsv", "a\tb\na\tb\n")));
+  // vcf column headers are not comments
+  boost::filesystem::path vcf1 = install_file("dir1/file.vcf", "##date=today\n#CHROM\tPOS\n");
+  CPPUNIT_ASSERT(output_checker::plaintext_equal(vcf1, install_file("dir2/file.vcf", "##date=then\n#CHROM\tPOS\n")));
+  CPPUNIT_ASSERT(!output_checker::plaintext_equal(vcf1, install_file("dir3/file.vcf", "##date=today\n#CHROM\n")));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_plaintext_equal_gzipped() {
+  boost::filesystem::path file1 = install_file("dir1/file.vcf.gz", "##date=today\n#CHROM\tPOS\nchr1\t1\n");
+  CPPUNIT_ASSERT(output_checker::plaintext_equal(
+      file1, install_file("dir2/file.vcf.gz", "##date=then\n#CHROM\tPOS\nchr1\t1\n")));
+  CPPUNIT_ASSERT(
+      !output_checker::plaintext_equal(file1, install_file("dir3/file.vcf.gz", "##date=today\n#CHROM\tPOS\n")));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_plaintext_difference() {
+  boost::filesystem::path expected = install_file("expected/file.tsv", "# made today\na\tb\nc\td\n");
+  CPPUNIT_ASSERT(
+      output_checker::plaintext_difference(install_file("output/same.tsv", "a\tb\nc\td\n"), expected).empty());
+  // line numbers count comment lines, so they can be found in either file
+  CPPUNIT_ASSERT_EQUAL(std::string("first difference at line 3 of generated file, line 3 of expected file\n"
+                                   "  generated: c\te\n  expected:  c\td"),
+                       output_checker::plaintext_difference(
+                           install_file("output/file.tsv", "# made yesterday\na\tb\nc\te\n"), expected));
+  CPPUNIT_ASSERT_EQUAL(std::string("first difference at line 2 of generated file, line 3 of expected file\n"
+                                   "  generated: <end of file>\n  expected:  c\td"),
+                       output_checker::plaintext_difference(install_file("output/short.tsv", "a\tb\n"), expected));
+  // long lines are shortened
+  std::string difference =
+      output_checker::plaintext_difference(install_file("output/long.tsv", std::string(1000, 'x')), expected);
+  CPPUNIT_ASSERT(difference.find(std::string(200, 'x') + "...\n") != std::string::npos);
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_digest() {
+  boost::filesystem::path plain = install_file("file.txt", "# made today\r\nabc\r\n");
+  boost::filesystem::path gzipped = install_file("file.txt.gz", "# made yesterday\nabc\n");
+  // the lines plaintext comparison compares are digested
+  CPPUNIT_ASSERT_EQUAL(std::string("edeaaff3f1774ad2888673770c6d64097e391bc362d7d6fb34982ddf0efd18cb"),
+                       output_checker::digest(plain, "plaintext"));
+  CPPUNIT_ASSERT_EQUAL(output_checker::digest(plain, "plaintext"), output_checker::digest(gzipped, "plaintext"));
+  CPPUNIT_ASSERT(output_checker::digest(plain, "byte") != output_checker::digest(plain, "plaintext"));
+  CPPUNIT_ASSERT_EQUAL(std::string("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"),
+                       output_checker::digest(install_file("empty.bin", ""), "byte"));
+  CPPUNIT_ASSERT_THROW(output_checker::digest(plain, "frame"), std::runtime_error);
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_digest_method() {
+  output_checker oc;
+  oc.add_comparators(
+      YAML::Load("[{type: plaintext, patterns: ['\\.txt$']}, {type: byte, patterns: ['keep\\.txt$']}, "
+                 "{type: frame, patterns: ['\\.tsv$']}]"));
+  CPPUNIT_ASSERT_EQUAL(std::string("plaintext"), oc.digest_method(install_file("a.txt", "a\n")));
+  CPPUNIT_ASSERT_EQUAL(std::string("byte"), oc.digest_method(install_file("keep.txt", "a\n")));
+  CPPUNIT_ASSERT(oc.digest_method(install_file("a.tsv", "a\n")).empty());
+  // unclaimed files are digested as they would be compared
+  CPPUNIT_ASSERT_EQUAL(std::string("plaintext"), oc.digest_method(install_file("a.csv", "a\n")));
+  CPPUNIT_ASSERT_EQUAL(std::string("byte"), oc.digest_method(install_file("a.bin", std::string("\0a", 2))));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_compare_files() {
+  output_checker oc;
+  boost::filesystem::path generated = install_file("output/file.txt", "# made today\nabc\n");
+  boost::filesystem::path expected = install_file("expected/file.txt", "# made yesterday\nabc\n");
+  // text files are compared without comments by default
+  CPPUNIT_ASSERT(oc.compare_files(generated, expected).empty());
+  // but not when a byte comparator claims them
+  oc.add_comparators(YAML::Load("[{type: byte, patterns: ['\\.txt$']}]"));
+  CPPUNIT_ASSERT_EQUAL(std::string("contents differ (byte comparator)"), oc.compare_files(generated, expected));
+  // binary files are compared byte for byte
+  output_checker oc2;
+  generated = install_file("output/file.bin", std::string("\0# 1\nabc\n", 9));
+  expected = install_file("expected/file.bin", std::string("\0# 2\nabc\n", 9));
+  CPPUNIT_ASSERT_EQUAL(std::string("contents differ (byte comparison)"), oc2.compare_files(generated, expected));
+  // tables claimed by a frame comparator are compared with tolerance
+  output_checker oc3;
+  oc3.add_comparators(YAML::Load("[{type: frame, patterns: ['\\.tsv$']}]"));
+  generated = install_file("output/file.tsv", "a\tb\n1.0\tx\n");
+  expected = install_file("expected/file.tsv", "a\tb\n1.0000001\tx\n");
+  CPPUNIT_ASSERT(oc3.compare_files(generated, expected).empty());
+  expected = install_file("expected/file.tsv", "a\tb\n1.1\tx\n");
+  CPPUNIT_ASSERT_EQUAL(std::string("contents differ (frame comparator): row 1 (line 2 of generated file, line 2 of "
+                                   "expected file), column \"a\": generated \"1.0\", expected \"1.1\""),
+                       oc3.compare_files(generated, expected));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_check() {
+  boost::filesystem::path prefix(_tmp_dir);
+  install_file("workspace/input.txt", "input\n");
+  install_file("output/input.txt", "input\n");
+  install_file("expected/result.txt", "result\n");
+  install_file("output/result.txt", "result\n");
+  install_file("expected/nested/other.txt", "other\n");
+  install_file("output/nested/other.txt", "different\n");
+  install_file("output/.snakemake/log/run.log", "log\n");
+  install_file("output/scripts/__pycache__/x.pyc", "cache\n");
+  install_file("output/logs/rule.log", "log\n");
+  install_file("output/benchmarks/rule.tsv", "s\n");
+  install_file("output/surprise.txt", "surprise\n");
+  output_checker oc;
+  oc.add_exclude_pattern("\\.log$");
+  oc.add_comparison_exclusion("benchmarks");
+  oc.set_jobs(2);
+  std::vector<std::string> failures;
+  oc.check(prefix / "workspace", prefix / "expected", prefix / "output", &failures);
+  CPPUNIT_ASSERT(failures.size() == 2);
+  CPPUNIT_ASSERT_EQUAL(std::string("nested/other.txt: contents differ (plaintext comparison): first difference at "
+                                   "line 1 of generated file, line 1 of expected file\n"
+                                   "  generated: different\n  expected:  other"),
+                       failures.at(0));
+  CPPUNIT_ASSERT_EQUAL(std::string("Unexpected files: surprise.txt"), failures.at(1));
+  // a matching run reports nothing
+  install_file("output/nested/other.txt", "other\n");
+  boost::filesystem::remove(prefix / "output" / "surprise.txt");
+  oc.check(prefix / "workspace", prefix / "expected", prefix / "output/", &failures);
+  CPPUNIT_ASSERT(failures.empty());
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_check_digests() {
+  boost::filesystem::path prefix(_tmp_dir);
+  install_file("output/result.txt", "# made today\nresult\n");
+  install_file("output/other.bin", std::string("\0other", 6));
+  install_file("output/stored.txt", "stored\n");
+  install_file("expected/stored.txt", "stored\n");
+  output_checker oc;
+  std::string manifest = std::string(output_checker::digest(prefix / "output/result.txt", "plaintext")) +
+                         "  plaintext  result.txt\n" + std::string(64, '0') + "  byte  other.bin\n" +
+                         std::string(64, '0') + "  byte  stored.txt\n";
+  oc.load_expected_digests(install_file("expected.sha256", manifest));
+  CPPUNIT_ASSERT(oc._expected_digests.size() == 3);
+  std::vector<std::string> failures;
+  oc.check(prefix / "workspace", prefix / "expected", prefix / "output", &failures);
+  // files stored in full are compared in full
+  CPPUNIT_ASSERT(failures.size() == 1);
+  CPPUNIT_ASSERT_EQUAL(std::string("other.bin: contents differ (byte digest)"), failures.at(0));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_check_compressed() {
+  boost::filesystem::path prefix(_tmp_dir);
+  install_file("output/result.txt", "# made today\nresult\n");
+  install_file("output/other.txt", "other\n");
+  // compressed expected files keep the names of the outputs they stand for
+  boost::filesystem::rename(install_file("expected/result.txt.gz", "# made yesterday\nresult\n"),
+                            prefix / "expected/result.txt");
+  boost::filesystem::rename(install_file("expected/other.txt.gz", "another\n"), prefix / "expected/other.txt");
+  output_checker oc;
+  oc.load_compressed_files(
+      install_file("compressed.txt", "expected/result.txt\nexpected/other.txt\nworkspace/input.txt\n"));
+  CPPUNIT_ASSERT(oc._compressed_expected.size() == 2);
+  std::vector<std::string> failures;
+  oc.check(prefix / "workspace", prefix / "expected", prefix / "output", &failures);
+  CPPUNIT_ASSERT(failures.size() == 1);
+  CPPUNIT_ASSERT(failures.at(0).find("other.txt: contents differ (plaintext comparison)") == 0);
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_load_expected_digests_invalid() {
+  output_checker oc;
+  oc.load_expected_digests(install_file("expected.sha256", std::string(64, 'a') + "  fuzzy  result.txt\n"));
+}
+
+void snakemake_unit_tests::output_checkerTest::test_output_checker_check_missing_run_dir() {
+  boost::filesystem::path prefix(_tmp_dir);
+  output_checker oc;
+  std::vector<std::string> failures;
+  oc.check(prefix / "workspace", prefix / "expected", prefix / "output", &failures);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::output_checkerTest);
@@ -0,0 +1,92 @@
+/*!
+  \file output_checkerTest.h
+  \brief output_checker test fixture for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_OUTPUT_CHECKERTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_OUTPUT_CHECKERTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <zlib.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/output_checker.h"
+#include "yaml-cpp/yaml.h"
+
+namespace snakemake_unit_tests {
+class output_checkerTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(output_checkerTest);
+  CPPUNIT_TEST(test_output_checker_default_constructor);
+  CPPUNIT_TEST(test_output_checker_copy_constructor);
+  CPPUNIT_TEST(test_output_checker_add_comparators);
+  CPPUNIT_TEST_EXCEPTION(test_output_checker_add_comparators_unknown_type, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_output_checker_add_comparators_missing_patterns, std::runtime_error);
+  CPPUNIT_TEST(test_output_checker_comment_prefix);
+  CPPUNIT_TEST(test_output_checker_is_plaintext);
+  CPPUNIT_TEST(test_output_checker_bytes_equal);
+  CPPUNIT_TEST(test_output_checker_bytes_equal_compressed);
+  CPPUNIT_TEST(test_output_checker_plaintext_equal);
+  CPPUNIT_TEST(test_output_checker_plaintext_equal_gzipped);
+  CPPUNIT_TEST(test_output_checker_plaintext_difference);
+  CPPUNIT_TEST(test_output_checker_digest);
+  CPPUNIT_TEST(test_output_checker_digest_method);
+  CPPUNIT_TEST(test_output_checker_compare_files);
+  CPPUNIT_TEST(test_output_checker_check);
+  CPPUNIT_TEST(test_output_checker_check_digests);
+  CPPUNIT_TEST(test_output_checker_check_compressed);
+  CPPUNIT_TEST_EXCEPTION(test_output_checker_load_expected_digests_invalid, std::runtime_error);
+  CPPUNIT_TEST_EXCEPTION(test_output_checker_check_missing_run_dir, std::runtime_error);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_output_checker_default_constructor();
+  void test_output_checker_copy_constructor();
+  void test_output_checker_add_comparators();
+  void test_output_checker_add_comparators_unknown_type();
+  void test_output_checker_add_comparators_missing_patterns();
+  void test_output_checker_comment_prefix();
+  void test_output_checker_is_plaintext();
+  void test_output_checker_bytes_equal();
+  void test_output_checker_bytes_equal_compressed();
+  void test_output_checker_plaintext_equal();
+  void test_output_checker_plaintext_equal_gzipped();
+  void test_output_checker_plaintext_difference();
+  void test_output_checker_digest();
+  void test_output_checker_digest_method();
+  void test_output_checker_compare_files();
+  void test_output_checker_check();
+  void test_output_checker_check_digests();
+  void test_output_checker_check_compressed();
+  void test_output_checker_load_expected_digests_invalid();
+  void test_output_checker_check_missing_run_dir();
+
+ private:
+  /*!
+    @brief write a file under the temporary directory
+    @param relative_path path of the file relative to the temporary directory
+    @param content content of the file; gzipped if the name ends in ".gz"
+    @return full path of the file
+   */
+  boost::filesystem::path install_file(const std::string &relative_path, const std::string &content) const;
+  char *_tmp_dir;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_OUTPUT_CHECKERTEST_H_
@@ -0,0 +1,182 @@
+/*!
+  \file profiler.cc
+  \brief implementation of per-phase and per-rule resource accounting
+  \copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#include "snakemake_unit_tests/profiler.h"
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "snakemake_unit_tests/utilities.h"
+
+namespace {
+/*!
+  \brief convert a rusage time to seconds
+  @param t time to convert
+  @return t in seconds
+ */
+double to_seconds(const struct timeval &t) { return static_cast<double>(t.tv_sec) + t.tv_usec / 1000000.0; }
+}  // namespace
+
+snakemake_unit_tests::resource_usage::resource_usage()
+    : wall_seconds(0.0),
+      user_seconds(0.0),
+      system_seconds(0.0),
+      child_user_seconds(0.0),
+      child_system_seconds(0.0),
+      max_rss_kb(0),
+      child_max_rss_kb(0),
+      bytes_read(0),
+      bytes_written(0),
+      subprocesses(0) {}
+
+snakemake_unit_tests::profiler::profiler()
+    : _start(timed_now()), _phase_open(false), _rule_open(false), _total_subprocesses(0) {}
+
+snakemake_unit_tests::resource_usage snakemake_unit_tests::profiler::snapshot() {
+  resource_usage result;
+  struct rusage self, children;
+  if (getrusage(RUSAGE_SELF, &self) || getrusage(RUSAGE_CHILDREN, &children)) {
+    throw std::runtime_error("profiler: cannot query resource usage");
+  }
+  result.user_seconds = to_seconds(self.ru_utime);
+  result.system_seconds = to_seconds(self.ru_stime);
+  result.child_user_seconds = to_seconds(children.ru_utime);
+  result.child_system_seconds = to_seconds(children.ru_stime);
+  // linux reports maximum resident set size in kilobytes
+  result.max_rss_kb = self.ru_maxrss;
+  result.child_max_rss_kb = children.ru_maxrss;
+  // rchar and wchar count all bytes passed through read- and write-like calls,
+  // including those satisfied from page cache
+  std::ifstream input("/proc/self/io");
+  std::string key;
+  unsigned long long value = 0;
+  while (input >> key >> value) {
+    if (!key.compare("rchar:")) {
+      result.bytes_read = value;
+    } else if (!key.compare("wchar:")) {
+      result.bytes_written = value;
+    }
+  }
+  return result;
+}
+
+snakemake_unit_tests::resource_usage snakemake_unit_tests::profiler::difference(const resource_usage &start,
+                                                                               const resource_usage &end) {
+  resource_usage result;
+  result.wall_seconds = end.wall_seconds - start.wall_seconds;
+  result.user_seconds = end.user_seconds - start.user_seconds;
+  result.system_seconds = end.system_seconds - start.system_seconds;
+  result.child_user_seconds = end.child_user_seconds - start.child_user_seconds;
+  result.child_system_seconds = end.child_system_seconds - start.child_system_seconds;
+  result.max_rss_kb = end.max_rss_kb;
+  result.child_max_rss_kb = end.child_max_rss_kb;
+  result.bytes_read = end.bytes_read >= start.bytes_read ? end.bytes_read - start.bytes_read : 0;
+  result.bytes_written = end.bytes_written >= start.bytes_written ? end.bytes_written - start.bytes_written : 0;
+  result.subprocesses = end.subprocesses - start.subprocesses;
+  return result;
+}
+
+snakemake_unit_tests::profiler::timed_snapshot snakemake_unit_tests::profiler::timed_now() {
+  return timed_snapshot(std::chrono::steady_clock::now(), snapshot());
+}
+
+snakemake_unit_tests::resource_usage snakemake_unit_tests::profiler::since(const timed_snapshot &start) {
+  timed_snapshot now = timed_now();
+  resource_usage result = difference(start.second, now.second);
+  result.wall_seconds = std::chrono::duration<double>(now.first - start.first).count();
+  return result;
+}
+
+void snakemake_unit_tests::profiler::begin_phase(const std::string &name) {
+  if (_phase_open) end_phase();
+  _phases.push_back(std::make_pair(name, resource_usage()));
+  _phase_open = true;
+  _phase_start = timed_now();
+}
+
+void snakemake_unit_tests::profiler::end_phase() {
+  if (!_phase_open) throw std::logic_error("profiler: end_phase called without an open phase");
+  unsigned subprocesses = _phases.back().second.subprocesses;
+  _phases.back().second = since(_phase_start);
+  _phases.back().second.subprocesses = subprocesses;
+  _phase_open = false;
+  if (_tracer) {
+    _tracer->add_span(_phases.back().first, "phase", _phase_start.first, std::chrono::steady_clock::now(),
+                      std::vector<std::pair<std::string, std::string>>());
+  }
+}
+
+void snakemake_unit_tests::profiler::begin_rule(const std::string &name) {
+  if (_rule_open) end_rule();
+  _rules.push_back(std::make_pair(name, resource_usage()));
+  _rule_open = true;
+  _rule_start = timed_now();
+}
+
+void snakemake_unit_tests::profiler::end_rule() {
+  if (!_rule_open) throw std::logic_error("profiler: end_rule called without an open rule");
+  unsigned subprocesses = _rules.back().second.subprocesses;
+  _rules.back().second = since(_rule_start);
+  _rules.back().second.subprocesses = subprocesses;
+  _rule_open = false;
+  if (_tracer) {
+    _tracer->add_span(_rules.back().first, "rule", _rule_start.first, std::chrono::steady_clock::now(),
+                      std::vector<std::pair<std::string, std::string>>());
+  }
+}
+
+void snakemake_unit_tests::profiler::count_subprocess() {
+  ++_total_subprocesses;
+  if (_phase_open) ++_phases.back().second.subprocesses;
+  if (_rule_open) ++_rules.back().second.subprocesses;
+}
+
+snakemake_unit_tests::resource_usage snakemake_unit_tests::profiler::get_total() const {
+  resource_usage result = since(_start);
+  result.subprocesses = _total_subprocesses;
+  return result;
+}
+
+void snakemake_unit_tests::profiler::report_usage_json(const resource_usage &usage, std::ostream &out) {
+  out << "\"wall_seconds\": " << usage.wall_seconds << ", \"user_seconds\": " << usage.user_seconds
+      << ", \"system_seconds\": " << usage.system_seconds << ", \"child_user_seconds\": " << usage.child_user_seconds
+      << ", \"child_system_seconds\": " << usage.child_system_seconds << ", \"max_rss_kb\": " << usage.max_rss_kb
+      << ", \"child_max_rss_kb\": " << usage.child_max_rss_kb << ", \"bytes_read\": " << usage.bytes_read
+      << ", \"bytes_written\": " << usage.bytes_written << ", \"subprocesses\": " << usage.subprocesses;
+}
+
+void snakemake_unit_tests::profiler::report_json(std::ostream &out) const {
+  out << "{\n  \"total\": {";
+  report_usage_json(get_total(), out);
+  out << "},\n  \"phases\": [";
+  for (std::vector<std::pair<std::string, resource_usage>>::const_iterator iter = _phases.begin();
+       iter != _phases.end(); ++iter) {
+    out << (iter == _phases.begin() ? "\n" : ",\n") << "    {\"name\": \"" << json_escape(iter->first) << "\", ";
+    report_usage_json(iter->second, out);
+    out << "}";
+  }
+  out << (_phases.empty() ? "" : "\n  ") << "],\n  \"rules\": [";
+  for (std::vector<std::pair<std::string, resource_usage>>::const_iterator iter = _rules.begin(); iter != _rules.end();
+       ++iter) {
+    out << (iter == _rules.begin() ? "\n" : ",\n") << "    {\"name\": \"" << json_escape(iter->first) << "\", ";
+    report_usage_json(iter->second, out);
+    out << "}";
+  }
+  out << (_rules.empty() ? "" : "\n  ") << "]\n}\n";
+}
+
+void snakemake_unit_tests::profiler::report_json(const std::string &filename) const {
+  std::ostringstream o;
+  report_json(o);
+  std::ofstream output(filename.c_str());
+  if (!output.is_open()) throw std::runtime_error("cannot write profile file \"" + filename + "\"");
+  if (!(output << o.str())) throw std::runtime_error("cannot write profile file \"" + filename + "\"");
+  output.close();
+}
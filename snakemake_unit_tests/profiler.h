@@ -0,0 +1,249 @@
+/*!
+  @file profiler.h
+  @brief per-phase and per-rule resource accounting for test generation
+  @copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_PROFILER_H_
+#define SNAKEMAKE_UNIT_TESTS_PROFILER_H_
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "boost/smart_ptr.hpp"
+#include "snakemake_unit_tests/tracer.h"
+
+namespace snakemake_unit_tests {
+/*!
+  @brief resources used over an interval of a run
+ */
+struct resource_usage {
+  /*!
+    @brief default constructor: nothing used
+   */
+  resource_usage();
+  /*!
+    @brief elapsed time
+   */
+  double wall_seconds;
+  /*!
+    @brief user CPU time of this process
+   */
+  double user_seconds;
+  /*!
+    @brief system CPU time of this process
+   */
+  double system_seconds;
+  /*!
+    @brief user CPU time of reaped subprocesses
+   */
+  double child_user_seconds;
+  /*!
+    @brief system CPU time of reaped subprocesses
+   */
+  double child_system_seconds;
+  /*!
+    @brief high-water resident set size of this process at the end of the interval, in KiB
+   */
+  long max_rss_kb;
+  /*!
+    @brief largest resident set size of any reaped subprocess by the end of the interval, in KiB
+   */
+  long child_max_rss_kb;
+  /*!
+    @brief bytes this process read through system calls
+   */
+  unsigned long long bytes_read;
+  /*!
+    @brief bytes this process wrote through system calls
+   */
+  unsigned long long bytes_written;
+  /*!
+    @brief subprocesses run
+   */
+  unsigned subprocesses;
+};
+
+/*!
+  @class profiler
+  @brief record resource use of each phase of a run, and of each emitted rule
+
+  phases are sequential and do not nest; a rule interval may be open inside
+  a phase. subprocesses are attributed to whichever phase and rule are open
+  when they are counted. if a tracer is attached, each phase and rule is
+  also recorded there as a span.
+ */
+class profiler {
+ public:
+  /*!
+    @brief default constructor; the run is measured from here
+   */
+  profiler();
+  /*!
+    @brief copy constructor
+    @param obj existing profiler
+   */
+  profiler(const profiler &obj)
+      : _start(obj._start),
+        _phases(obj._phases),
+        _rules(obj._rules),
+        _phase_open(obj._phase_open),
+        _rule_open(obj._rule_open),
+        _phase_start(obj._phase_start),
+        _rule_start(obj._rule_start),
+        _total_subprocesses(obj._total_subprocesses),
+        _tracer(obj._tracer) {}
+  /*!
+    @brief destructor
+   */
+  ~profiler() throw() {}
+  /*!
+    @brief start measuring a phase
+    @param name name of the phase, for reporting
+
+    any phase already open is ended first
+   */
+  void begin_phase(const std::string &name);
+  /*!
+    @brief stop measuring the open phase
+   */
+  void end_phase();
+  /*!
+    @brief start measuring work on a single rule
+    @param name name of the rule, for reporting
+   */
+  void begin_rule(const std::string &name);
+  /*!
+    @brief stop measuring the open rule
+   */
+  void end_rule();
+  /*!
+    @brief count a subprocess against the open phase and rule
+   */
+  void count_subprocess();
+  /*!
+    @brief attach a tracer to receive phase and rule spans, and spans from instrumented code
+    @param ptr tracer shared with the caller, or null to stop tracing
+   */
+  void set_tracer(boost::shared_ptr<tracer> ptr) { _tracer = ptr; }
+  /*!
+    @brief get the attached tracer
+    @return the attached tracer, or null if tracing is not enabled
+   */
+  boost::shared_ptr<tracer> get_tracer() const { return _tracer; }
+  /*!
+    @brief get the tracer attached to a possibly absent profiler
+    @param ptr profiler to query, or null
+    @return the attached tracer, or null if there is no profiler or it is not tracing
+   */
+  static boost::shared_ptr<tracer> tracer_of(const boost::shared_ptr<profiler> &ptr) {
+    return ptr ? ptr->get_tracer() : boost::shared_ptr<tracer>();
+  }
+  /*!
+    @brief get measured phases
+    @return phase names and their resource use, in order
+   */
+  const std::vector<std::pair<std::string, resource_usage>> &get_phases() const { return _phases; }
+  /*!
+    @brief get measured rules
+    @return rule names and their resource use, in order
+   */
+  const std::vector<std::pair<std::string, resource_usage>> &get_rules() const { return _rules; }
+  /*!
+    @brief get resource use since construction
+    @return resource use of the whole run so far
+   */
+  resource_usage get_total() const;
+  /*!
+    @brief write all measurements as a JSON object
+    @param out stream to which to write
+   */
+  void report_json(std::ostream &out) const;
+  /*!
+    @brief write all measurements as a JSON object to a file
+    @param filename name of file to create or truncate
+   */
+  void report_json(const std::string &filename) const;
+  /*!
+    @brief measure cumulative resource use of this process
+    @return cumulative totals; wall time is left at zero, and subprocesses are not counted
+
+    I/O totals come from /proc/self/io, and are zero where that is unavailable
+   */
+  static resource_usage snapshot();
+  /*!
+    @brief compute resource use between two snapshots
+    @param start earlier snapshot
+    @param end later snapshot
+    @return differences of cumulative fields; high-water marks are taken from end
+   */
+  static resource_usage difference(const resource_usage &start, const resource_usage &end);
+
+ private:
+  friend class profilerTest;
+  /*!
+    @brief write one resource record as the members of a JSON object
+    @param usage record to write
+    @param out stream to which to write
+   */
+  static void report_usage_json(const resource_usage &usage, std::ostream &out);
+  /*!
+    @brief a cumulative snapshot with the time it was taken
+   */
+  typedef std::pair<std::chrono::steady_clock::time_point, resource_usage> timed_snapshot;
+  /*!
+    @brief take a snapshot with the current time
+    @return the current time and cumulative resource use
+   */
+  static timed_snapshot timed_now();
+  /*!
+    @brief resource use between a timed snapshot and now
+    @param start earlier snapshot
+    @return resource use since start
+   */
+  static resource_usage since(const timed_snapshot &start);
+  /*!
+    @brief snapshot at construction
+   */
+  timed_snapshot _start;
+  /*!
+    @brief completed phases, in order
+   */
+  std::vector<std::pair<std::string, resource_usage>> _phases;
+  /*!
+    @brief completed rules, in order
+   */
+  std::vector<std::pair<std::string, resource_usage>> _rules;
+  /*!
+    @brief whether the last entry of _phases is still being measured
+   */
+  bool _phase_open;
+  /*!
+    @brief whether the last entry of _rules is still being measured
+   */
+  bool _rule_open;
+  /*!
+    @brief snapshot at the start of the open phase
+   */
+  timed_snapshot _phase_start;
+  /*!
+    @brief snapshot at the start of the open rule
+   */
+  timed_snapshot _rule_start;
+  /*!
+    @brief subprocesses counted since construction
+   */
+  unsigned _total_subprocesses;
+  /*!
+    @brief optional recipient of phase and rule spans
+   */
+  boost::shared_ptr<tracer> _tracer;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_PROFILER_H_
@@ -0,0 +1,266 @@
+/*!
+  \file profilerTest.cc
+  \brief implementation of profiler unit tests for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#include "snakemake_unit_tests/profilerTest.h"
+
+#include <chrono>
+#include <thread>
+
+void snakemake_unit_tests::profilerTest::setUp() {}
+
+void snakemake_unit_tests::profilerTest::tearDown() {}
+
+void snakemake_unit_tests::profilerTest::test_resource_usage_default_constructor() {
+  resource_usage r;
+  CPPUNIT_ASSERT(r.wall_seconds == 0.0);
+  CPPUNIT_ASSERT(r.user_seconds == 0.0);
+  CPPUNIT_ASSERT(r.system_seconds == 0.0);
+  CPPUNIT_ASSERT(r.child_user_seconds == 0.0);
+  CPPUNIT_ASSERT(r.child_system_seconds == 0.0);
+  CPPUNIT_ASSERT(!r.max_rss_kb);
+  CPPUNIT_ASSERT(!r.child_max_rss_kb);
+  CPPUNIT_ASSERT(!r.bytes_read);
+  CPPUNIT_ASSERT(!r.bytes_written);
+  CPPUNIT_ASSERT(!r.subprocesses);
+}
+
+void snakemake_unit_tests::profilerTest::test_profiler_default_constructor() {
+  profiler p;
+  CPPUNIT_ASSERT(p._phases.empty());
+  CPPUNIT_ASSERT(p._rules.empty());
+  CPPUNIT_ASSERT(!p._phase_open);
+  CPPUNIT_ASSERT(!p._rule_open);
+  CPPUNIT_ASSERT(!p._total_subprocesses);
+  CPPUNIT_ASSERT(p._start.second.max_rss_kb > 0);
+}
+
+void snakemake_unit_tests::profilerTest::test_profiler_copy_constructor() {
+  profiler p;
+  p.begin_phase("phase1");
+  p.begin_rule("rule1");
+  p.count_subprocess();
+  profiler q(p);
+  CPPUNIT_ASSERT(q._start.first == p._start.first);
+  CPPUNIT_ASSERT(q._start.second.max_rss_kb == p._start.second.max_rss_kb);
+  CPPUNIT_ASSERT(q._phases.size() == 1u);
+  CPPUNIT_ASSERT(!q._phases.at(0).first.compare("phase1"));
+  CPPUNIT_ASSERT(q._rules.size() == 1u);
+  CPPUNIT_ASSERT(!q._rules.at(0).first.compare("rule1"));
+  CPPUNIT_ASSERT(q._phase_open);
+  CPPUNIT_ASSERT(q._rule_open);
+  CPPUNIT_ASSERT(q._phase_start.first == p._phase_start.first);
+  CPPUNIT_ASSERT(q._rule_start.first == p._rule_start.first);
+  CPPUNIT_ASSERT_EQUAL(1u, q._total_subprocesses);
+}
+
+void snakemake_unit_tests::profilerTest::test_profiler_snapshot() {
+  resource_usage before = profiler::snapshot();
+  // do some measurable work: cpu, and i/o through this process
+  std::string filename = (boost::filesystem::temp_directory_path() /
+                          boost::filesystem::unique_path("sutPRFXXXX-%%%%-%%%%-%%%%"))
+                             .string();
+  std::string content(100000, 'x');
+  std::ofstream output(filename.c_str());
+  output << content;
+  output.close();
+  std::ifstream input(filename.c_str());
+  std::ostringstream observed;
+  observed << input.rdbuf();
+  input.close();
+  boost::filesystem::remove(filename);
+  resource_usage after = profiler::snapshot();
+  CPPUNIT_ASSERT(after.user_seconds >= before.user_seconds);
+  CPPUNIT_ASSERT(after.system_seconds >= before.system_seconds);
+  CPPUNIT_ASSERT(after.max_rss_kb >= before.max_rss_kb);
+  CPPUNIT_ASSERT(after.max_rss_kb > 0);
+  CPPUNIT_ASSERT(after.wall_seconds == 0.0);
+  CPPUNIT_ASSERT(!after.subprocesses);
+  // /proc/self/io is linux-specific
+  if (boost::filesystem::exists("/proc/self/io")) {
+    CPPUNIT_ASSERT(after.bytes_written >= before.bytes_written + content.size());
+    CPPUNIT_ASSERT(after.bytes_read >= before.bytes_read + content.size());
+  }
+}
+
+void snakemake_unit_tests::profilerTest::test_profiler_difference() {
+  resource_usage start, end;
+  start.wall_seconds = 1.0;
+  start.user_seconds = 2.0;
+  start.system_seconds = 3.0;
+  start.child_user_seconds = 4.0;
+  start.child_system_seconds = 5.0;
+  start.max_rss_kb = 100;
+  start.child_max_rss_kb = 200;
+  start.bytes_read = 1000;
+  start.bytes_written = 2000;
+  start.subprocesses = 1;
+  end = start;
+  end.wall_seconds = 1.5;
+  end.user_seconds = 2.25;
+  end.system_seconds = 3.5;
+  end.child_user_seconds = 6.0;
+  end.child_system_seconds = 5.5;
+  end.max_rss_kb = 150;
+  end.child_max_rss_kb = 300;
+  end.bytes_read = 1500;
+  end.bytes_written = 2100;
+  end.subprocesses = 4;
+  resource_usage diff = profiler::difference(start, end);
+  CPPUNIT_ASSERT(diff.wall_seconds == 0.5);
+  CPPUNIT_ASSERT(diff.user_seconds == 0.25);
+  CPPUNIT_ASSERT(diff.system_seconds == 0.5);
+  CPPUNIT_ASSERT(diff.child_user_seconds == 2.0);
+  CPPUNIT_ASSERT(diff.child_system_seconds == 0.5);
+  // high-water marks are not differenced
+  CPPUNIT_ASSERT_EQUAL(150l, diff.max_rss_kb);
+  CPPUNIT_ASSERT_EQUAL(300l, diff.child_max_rss_kb);
+  CPPUNIT_ASSERT_EQUAL(500ull, diff.bytes_read);
+  CPPUNIT_ASSERT_EQUAL(100ull, diff.bytes_written);
+  CPPUNIT_ASSERT_EQUAL(3u, diff.subprocesses);
+  // counters that went backwards are clamped
+  diff = profiler::difference(end, start);
+  CPPUNIT_ASSERT(!diff.bytes_read);
+  CPPUNIT_ASSERT(!diff.bytes_written);
+}
+
+void snakemake_unit_tests::profilerTest::test_profiler_phases() {
+  profiler p;
+  p.begin_phase("phase1");
+  CPPUNIT_ASSERT(p._phase_open);
+  p.end_phase();
+  CPPUNIT_ASSERT(!p._phase_open);
+  p.begin_phase("phase2");
+  // beginning a phase ends the open one
+  p.begin_phase("phase3");
+  p.end_phase();
+  CPPUNIT_ASSERT(p.get_phases().size() == 3u);
+  CPPUNIT_ASSERT(!p.get_phases().at(0).first.compare("phase1"));
+  CPPUNIT_ASSERT(!p.get_phases().at(1).first.compare("phase2"));
+  CPPUNIT_ASSERT(!p.get_phases().at(2).first.compare("phase3"));
+  for (unsigned i = 0; i < p.get_phases().size(); ++i) {
+    CPPUNIT_ASSERT(p.get_phases().at(i).second.wall_seconds >= 0.0);
+    CPPUNIT_ASSERT(p.get_phases().at(i).second.max_rss_kb > 0);
+  }
+  CPPUNIT_ASSERT(p.get_rules().empty());
+}
+
+void snakemake_unit_tests::profilerTest::test_profiler_end_phase_not_open() {
+  profiler p;
+  p.end_phase();
+}
+
+void snakemake_unit_tests::profilerTest::test_profiler_main_phase_sequence() {
+  // the phases of a generator run, begun and ended as main.cc does
+  const char *phases[] = {"load_everything",     "load_file",         "create_empty_workspace",
+                          "resolve_with_python", "postflight_checks", "emit_tests"};
+  profiler p;
+  for (unsigned i = 0; i < 6; ++i) {
+    p.begin_phase(phases[i]);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    p.end_phase();
+  }
+  CPPUNIT_ASSERT(!p._phase_open);
+  CPPUNIT_ASSERT(p.get_phases().size() == 6u);
+  for (unsigned i = 0; i < 6; ++i) {
+    CPPUNIT_ASSERT(!p.get_phases().at(i).first.compare(phases[i]));
+    // each phase was measured when it ended, not left at its defaults
+    CPPUNIT_ASSERT(p.get_phases().at(i).second.wall_seconds > 0.0);
+  }
+}
+
+void snakemake_unit_tests::profilerTest::test_profiler_rules() {
+  profiler p;
+  p.begin_phase("emit_tests");
+  p.begin_rule("rule1");
+  p.end_rule();
+  p.begin_rule("rule2");
+  p.begin_rule("rule3");
+  p.end_rule();
+  p.end_phase();
+  CPPUNIT_ASSERT(p.get_phases().size() == 1u);
+  CPPUNIT_ASSERT(p.get_rules().size() == 3u);
+  CPPUNIT_ASSERT(!p.get_rules().at(0).first.compare("rule1"));
+  CPPUNIT_ASSERT(!p.get_rules().at(1).first.compare("rule2"));
+  CPPUNIT_ASSERT(!p.get_rules().at(2).first.compare("rule3"));
+  CPPUNIT_ASSERT(!p._rule_open);
+}
+
+void snakemake_unit_tests::profilerTest::test_profiler_end_rule_not_open() {
+  profiler p;
+  p.end_rule();
+}
+
+void snakemake_unit_tests::profilerTest::test_profiler_count_subprocess() {
+  profiler p;
+  // outside of any phase, only the total is counted
+  p.count_subprocess();
+  p.begin_phase("phase1");
+  p.count_subprocess();
+  p.begin_rule("rule1");
+  p.count_subprocess();
+  p.count_subprocess();
+  p.end_rule();
+  p.end_phase();
+  CPPUNIT_ASSERT_EQUAL(3u, p.get_phases().at(0).second.subprocesses);
+  CPPUNIT_ASSERT_EQUAL(2u, p.get_rules().at(0).second.subprocesses);
+  CPPUNIT_ASSERT_EQUAL(4u, p.get_total().subprocesses);
+}
+
+void snakemake_unit_tests::profilerTest::test_profiler_report_json() {
+  profiler p;
+  std::ostringstream o1;
+  p.report_json(o1);
+  CPPUNIT_ASSERT(o1.str().find("{\n  \"total\": {\"wall_seconds\": ") == 0);
+  CPPUNIT_ASSERT(o1.str().find("\"phases\": [],\n  \"rules\": []\n}\n") != std::string::npos);
+  p.begin_phase("emit_tests");
+  p.begin_rule("rule \"quoted\"");
+  p.count_subprocess();
+  p.end_rule();
+  p.end_phase();
+  std::ostringstream o2;
+  p.report_json(o2);
+  CPPUNIT_ASSERT(o2.str().find("\"phases\": [\n    {\"name\": \"emit_tests\", \"wall_seconds\": ") !=
+                 std::string::npos);
+  CPPUNIT_ASSERT(o2.str().find("\"rules\": [\n    {\"name\": \"rule \\\"quoted\\\"\", \"wall_seconds\": ") !=
+                 std::string::npos);
+  CPPUNIT_ASSERT(o2.str().find("\"subprocesses\": 1}\n  ]\n}\n") != std::string::npos);
+  // file output has the same content
+  std::string filename = (boost::filesystem::temp_directory_path() /
+                          boost::filesystem::unique_path("sutPRFXXXX-%%%%-%%%%-%%%%"))
+                             .string();
+  p.report_json(filename);
+  std::ifstream input(filename.c_str());
+  CPPUNIT_ASSERT(input.is_open());
+  std::ostringstream observed;
+  observed << input.rdbuf();
+  input.close();
+  boost::filesystem::remove(filename);
+  CPPUNIT_ASSERT(observed.str().find("\"rules\": [\n    {\"name\": \"rule \\\"quoted\\\"\"") != std::string::npos);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::profilerTest);
+
+void snakemake_unit_tests::profilerTest::test_profiler_tracer() {
+  profiler p;
+  CPPUNIT_ASSERT(!p.get_tracer());
+  CPPUNIT_ASSERT(!profiler::tracer_of(boost::shared_ptr<profiler>()));
+  boost::shared_ptr<tracer> t(new tracer);
+  p.set_tracer(t);
+  CPPUNIT_ASSERT(p.get_tracer() == t);
+  // phases and rules are recorded as spans as they end
+  p.begin_phase("emit_tests");
+  p.begin_rule("rule1");
+  p.end_rule();
+  p.end_phase();
+  CPPUNIT_ASSERT_EQUAL(2u, t->get_span_count());
+  CPPUNIT_ASSERT(!t->_events.at(0).name.compare("rule1"));
+  CPPUNIT_ASSERT(!t->_events.at(0).category.compare("rule"));
+  CPPUNIT_ASSERT(!t->_events.at(1).name.compare("emit_tests"));
+  CPPUNIT_ASSERT(!t->_events.at(1).category.compare("phase"));
+  boost::shared_ptr<profiler> ptr(new profiler(p));
+  CPPUNIT_ASSERT(profiler::tracer_of(ptr) == t);
+}
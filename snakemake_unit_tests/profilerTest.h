@@ -0,0 +1,64 @@
+/*!
+  \file profilerTest.h
+  \brief profiler test fixture for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_PROFILERTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_PROFILERTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/profiler.h"
+
+namespace snakemake_unit_tests {
+class profilerTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(profilerTest);
+  CPPUNIT_TEST(test_resource_usage_default_constructor);
+  CPPUNIT_TEST(test_profiler_default_constructor);
+  CPPUNIT_TEST(test_profiler_copy_constructor);
+  CPPUNIT_TEST(test_profiler_snapshot);
+  CPPUNIT_TEST(test_profiler_difference);
+  CPPUNIT_TEST(test_profiler_phases);
+  CPPUNIT_TEST_EXCEPTION(test_profiler_end_phase_not_open, std::logic_error);
+  CPPUNIT_TEST(test_profiler_main_phase_sequence);
+  CPPUNIT_TEST(test_profiler_rules);
+  CPPUNIT_TEST_EXCEPTION(test_profiler_end_rule_not_open, std::logic_error);
+  CPPUNIT_TEST(test_profiler_count_subprocess);
+  CPPUNIT_TEST(test_profiler_report_json);
+  CPPUNIT_TEST(test_profiler_tracer);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_resource_usage_default_constructor();
+  void test_profiler_default_constructor();
+  void test_profiler_copy_constructor();
+  void test_profiler_snapshot();
+  void test_profiler_difference();
+  void test_profiler_phases();
+  void test_profiler_end_phase_not_open();
+  void test_profiler_main_phase_sequence();
+  void test_profiler_rules();
+  void test_profiler_end_rule_not_open();
+  void test_profiler_count_subprocess();
+  void test_profiler_report_json();
+  void test_profiler_tracer();
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_PROFILERTEST_H_
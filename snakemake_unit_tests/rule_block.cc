@@ -14,6 +14,8 @@ snakemake_unit_tests::rule_block::rule_block()
       _base_rule_name(""),
       _rule_is_checkpoint(false),
       _docstring(""),
+      _is_include_directive(false),
+      _include_expression(""),
       _local_indentation(0),
       _resolution(UNRESOLVED),
       _queried_by_python(false),
@@ -26,63 +28,89 @@ snakemake_unit_tests::rule_block::rule_block(const rule_block &obj)
       _docstring(obj._docstring),
       _named_blocks(obj._named_blocks),
       _code_chunk(obj._code_chunk),
+      _rule_references(obj._rule_references),
+      _is_include_directive(obj._is_include_directive),
+      _include_expression(obj._include_expression),
       _local_indentation(obj._local_indentation),
       _resolution(obj._resolution),
       _queried_by_python(obj._queried_by_python),
       _python_tag(obj._python_tag),
       _resolved_included_filename(obj._resolved_included_filename) {}
 
+snakemake_unit_tests::rule_block::rule_block(rule_block &&obj) noexcept
+    : _rule_name(std::move(obj._rule_name)),
+      _base_rule_name(std::move(obj._base_rule_name)),
+      _rule_is_checkpoint(obj._rule_is_checkpoint),
+      _docstring(std::move(obj._docstring)),
+      _named_blocks(std::move(obj._named_blocks)),
+      _code_chunk(std::move(obj._code_chunk)),
+      _rule_references(std::move(obj._rule_references)),
+      _is_include_directive(obj._is_include_directive),
+      _include_expression(std::move(obj._include_expression)),
+      _local_indentation(obj._local_indentation),
+      _resolution(obj._resolution),
+      _queried_by_python(obj._queried_by_python),
+      _python_tag(obj._python_tag),
+      _resolved_included_filename(std::move(obj._resolved_included_filename)) {}
+
 snakemake_unit_tests::rule_block::~rule_block() throw() {}
 
 bool snakemake_unit_tests::rule_block::load_content_block(const std::vector<std::string> &loaded_lines, bool verbose,
                                                           unsigned *current_line) {
+  std::vector<logical_line> lines;
+  as_logical_lines(loaded_lines, &lines);
+  return load_content_block(lines, verbose, current_line);
+}
+
+bool snakemake_unit_tests::rule_block::load_content_block(const std::vector<logical_line> &loaded_lines, bool verbose,
+                                                          unsigned *current_line) {
   if (!current_line) throw std::runtime_error("null pointer for counter passed to load_content_block");
   // clear out internals, just to be safe
   clear();
   // define variables for processing
-  std::string line = "";
-  // define regex patterns for testing
-  const boost::regex standard_rule_declaration("^( *)rule ([^ ]+):.*$");
-  const boost::regex checkpoint_rule_declaration("^( *)checkpoint ([^ ]+):.*$");
-  const boost::regex derived_rule_declaration("^( *)use rule ([^ ]+) as ([^ ]+) with:.*$");
+  std::string_view line, name, base_name;
+  std::string_view::size_type declaration_indentation = 0;
   if (*current_line >= loaded_lines.size()) return false;
   while (*current_line < loaded_lines.size()) {
-    line = loaded_lines.at(*current_line);
+    line = loaded_lines.at(*current_line).text;
     ++*current_line;
     if (verbose) {
       std::cout << "considering line \"" << line << "\"" << std::endl;
     }
     if (line.empty() || line.find_first_not_of(" ") == std::string::npos) continue;
     // if the line is a valid rule declaration
-    boost::smatch regex_result;
-    if (boost::regex_match(line, regex_result, standard_rule_declaration) ||
-        boost::regex_match(line, regex_result, checkpoint_rule_declaration)) {
+    if (match_rule_declaration(line, "rule", &declaration_indentation, &name) ||
+        match_rule_declaration(line, "checkpoint", &declaration_indentation, &name)) {
       if (verbose) {
-        std::cout << "consuming rule with name \"" << regex_result[2] << "\"" << std::endl;
+        std::cout << "consuming rule with name \"" << name << "\"" << std::endl;
       }
-      set_rule_name(regex_result[2]);
+      set_rule_name(std::string(name));
       if (line.find_first_not_of(" ") == line.find("checkpoint")) {
         set_checkpoint(true);
       }
-      _local_indentation = regex_result[1].str().size();
-      return consume_rule_contents(loaded_lines, verbose, current_line);
-    } else if (boost::regex_match(line, regex_result, derived_rule_declaration)) {
+      _local_indentation = declaration_indentation;
+      bool res = consume_rule_contents(loaded_lines, verbose, current_line);
+      update_rule_references();
+      return res;
+    } else if (match_derived_rule_declaration(line, &declaration_indentation, &base_name, &name)) {
       if (verbose) {
-        std::cout << "consuming derived rule with name \"" << regex_result[3] << "\"" << std::endl;
+        std::cout << "consuming derived rule with name \"" << name << "\"" << std::endl;
       }
-      set_rule_name(regex_result[3]);
-      _local_indentation += regex_result[1].str().size();
+      set_rule_name(std::string(name));
+      _local_indentation += declaration_indentation;
       // derived rules declare a base rule from which they inherit certain
       // fields. setting those certain fields must be deferred until all rules
       // are available.
-      set_base_rule_name(regex_result[2]);
-      return consume_rule_contents(loaded_lines, verbose, current_line);
+      set_base_rule_name(std::string(base_name));
+      bool res = consume_rule_contents(loaded_lines, verbose, current_line);
+      update_rule_references();
+      return res;
     } else {
       // new to refactor: this is arbitrary python and we're leaving it like that
       if (verbose) {
         std::cout << "adding code chunk \"" << line << "\"" << std::endl;
       }
-      _code_chunk.push_back(line);
+      add_code_chunk(std::string(line));
       return true;
     }
   }
@@ -92,17 +120,22 @@ bool snakemake_unit_tests::rule_block::load_content_block(const std::vector<std:
 
 bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<std::string> &loaded_lines, bool verbose,
                                                              unsigned *current_line) {
-  std::ostringstream regex_formatter;
-  regex_formatter << "^" << indentation(get_local_indentation() + 4) << "([a-zA-Z_\\-]+):(.*)$";
-  const boost::regex named_block_tag(regex_formatter.str());
+  std::vector<logical_line> lines;
+  as_logical_lines(loaded_lines, &lines);
+  return consume_rule_contents(lines, verbose, current_line);
+}
+
+bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<logical_line> &loaded_lines,
+                                                             bool verbose, unsigned *current_line) {
   if (!current_line) throw std::runtime_error("null pointer for counter passed to consume_rule_contents");
-  std::string line = "", block_name = "", block_contents = "";
+  std::string_view line, block_name_view, block_contents_view;
+  std::string block_name = "", block_contents = "";
   std::string::size_type line_indentation = 0;
   unsigned starting_line = 0;
   while (*current_line < loaded_lines.size()) {
     // deal with reverting multiline consumption of content
     starting_line = *current_line;
-    line = loaded_lines.at(*current_line);
+    line = loaded_lines.at(*current_line).text;
     ++*current_line;
     if (verbose) {
       std::cout << "considering (in block) line \"" << line << "\"" << std::endl;
@@ -123,16 +156,15 @@ bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<s
     // expose this to user space?
     if (line_indentation == get_local_indentation() + 4) {
       // enforce named tag here
-      boost::smatch named_block_tag_result;
-      if (boost::regex_match(line, named_block_tag_result, named_block_tag)) {
-        block_name = named_block_tag_result[1];
-        block_contents = named_block_tag_result[2];
+      if (match_named_block(line, get_local_indentation() + 4, &block_name_view, &block_contents_view)) {
+        block_name = block_name_view;
+        block_contents = block_contents_view;
         // remove_comments_and_docstrings is deprecated by lexical parser
         // while additional block contents are theoretically available
         while (*current_line < loaded_lines.size()) {
           // deal with reverting multiline consumption of content
           starting_line = *current_line;
-          line = loaded_lines.at(*current_line);
+          line = loaded_lines.at(*current_line).text;
           ++*current_line;
           // remove_comments_and_docstrings is deprecated by lexical parser
           if (line.empty() || line.find_first_not_of(" ") == std::string::npos) continue;
@@ -152,7 +184,8 @@ bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<s
           } else {
             // TODO(lightning-auriga): deal with entries extending across multiple
             // lines? aggregate the contents with some formatting
-            block_contents += "\n" + line;
+            block_contents += "\n";
+            block_contents += line;
           }
         }
         if (*current_line >= loaded_lines.size()) {
@@ -169,7 +202,7 @@ bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<s
       } else if (_named_blocks.empty() &&
                  (line.at(line.find_first_not_of(" \t")) == '\'' || line.at(line.find_first_not_of(" \t")) == '"')) {
         // multiline string literals are aggregated in the lexical parser
-        _docstring = line;
+        _docstring = std::string(line);
       } else {
         std::cerr << "warning: in a rule parse, the line \"" << line
                   << "\" is found floating and is removed. if this behavior "
@@ -181,31 +214,101 @@ bool snakemake_unit_tests::rule_block::consume_rule_contents(const std::vector<s
   return true;
 }
 
-bool snakemake_unit_tests::rule_block::contains_include_directive() const {
-  // what is an include directive?
-  const boost::regex include_directive("^( *)include: *(.*[^ ]) *$");
-  if (get_code_chunk().size() == 1) {
-    boost::smatch include_match;
-    return boost::regex_match(*get_code_chunk().begin(), include_match, include_directive);
-  }
-  return false;
-}
-
 std::string snakemake_unit_tests::rule_block::get_filename_expression() const {
-  // what is an include directive?
-  const boost::regex include_directive("^( *)include: *(.*[^ ]) *$");
-  if (get_code_chunk().size() == 1) {
-    boost::smatch include_match;
-    if (boost::regex_match(*get_code_chunk().begin(), include_match, include_directive)) {
-      return include_match[2].str();
-    }
+  if (_is_include_directive) {
+    return _include_expression;
   }
   throw std::runtime_error(
       "get_filename_expression() called in code block "
       "that does not match include directive pattern");
 }
 
+void snakemake_unit_tests::rule_block::add_code_chunk(const std::string &s) {
+  _code_chunk.push_back(s);
+  // include directives are only recognized as standalone statements
+  std::string_view expression;
+  _is_include_directive = _code_chunk.size() == 1 && match_include_directive(*_code_chunk.begin(), &expression);
+  _include_expression = _is_include_directive ? std::string(expression) : "";
+}
+
+bool snakemake_unit_tests::rule_block::match_rule_declaration(std::string_view line, std::string_view keyword,
+                                                              std::string_view::size_type *indentation,
+                                                              std::string_view *name) {
+  if (!indentation || !name) throw std::runtime_error("null pointer provided to match_rule_declaration");
+  std::string_view::size_type pos = line.find_first_not_of(' ');
+  if (pos == std::string_view::npos || line.compare(pos, keyword.size(), keyword)) return false;
+  std::string_view::size_type name_start = pos + keyword.size() + 1;
+  if (name_start > line.size() || line[name_start - 1] != ' ') return false;
+  // the name runs to the last colon before the next space
+  std::string_view run = line.substr(name_start, line.find(' ', name_start) - name_start);
+  std::string_view::size_type colon = run.rfind(':');
+  if (colon == std::string_view::npos || !colon) return false;
+  *indentation = pos;
+  *name = run.substr(0, colon);
+  return true;
+}
+
+bool snakemake_unit_tests::rule_block::match_derived_rule_declaration(std::string_view line,
+                                                                      std::string_view::size_type *indentation,
+                                                                      std::string_view *base_name,
+                                                                      std::string_view *name) {
+  if (!indentation || !base_name || !name) {
+    throw std::runtime_error("null pointer provided to match_derived_rule_declaration");
+  }
+  std::string_view::size_type pos = line.find_first_not_of(' ');
+  const std::string_view prefix = "use rule ", separator = " as ", suffix = " with:";
+  if (pos == std::string_view::npos || line.compare(pos, prefix.size(), prefix)) return false;
+  std::string_view::size_type base_start = pos + prefix.size();
+  std::string_view::size_type base_end = line.find(' ', base_start);
+  if (base_end == std::string_view::npos || base_end == base_start ||
+      line.compare(base_end, separator.size(), separator))
+    return false;
+  std::string_view::size_type name_start = base_end + separator.size();
+  std::string_view::size_type name_end = line.find(' ', name_start);
+  if (name_end == std::string_view::npos || name_end == name_start || line.compare(name_end, suffix.size(), suffix))
+    return false;
+  *indentation = pos;
+  *base_name = line.substr(base_start, base_end - base_start);
+  *name = line.substr(name_start, name_end - name_start);
+  return true;
+}
+
+bool snakemake_unit_tests::rule_block::match_include_directive(std::string_view line, std::string_view *expression) {
+  if (!expression) throw std::runtime_error("null pointer provided to match_include_directive");
+  std::string_view::size_type pos = line.find_first_not_of(' ');
+  const std::string_view keyword = "include:";
+  if (pos == std::string_view::npos || line.compare(pos, keyword.size(), keyword)) return false;
+  std::string_view::size_type start = line.find_first_not_of(' ', pos + keyword.size());
+  if (start == std::string_view::npos) return false;
+  *expression = line.substr(start, line.find_last_not_of(' ') + 1 - start);
+  return true;
+}
+
+bool snakemake_unit_tests::rule_block::match_named_block(std::string_view line, std::string_view::size_type indentation,
+                                                         std::string_view *name, std::string_view *contents) {
+  if (!name || !contents) throw std::runtime_error("null pointer provided to match_named_block");
+  if (line.size() <= indentation || line.find_first_not_of(' ') != indentation) return false;
+  std::string_view::size_type end = indentation;
+  // block names are [a-zA-Z_\-]+, independent of locale
+  while (end < line.size() && ((line[end] >= 'a' && line[end] <= 'z') || (line[end] >= 'A' && line[end] <= 'Z') ||
+                               line[end] == '_' || line[end] == '-')) {
+    ++end;
+  }
+  if (end == indentation || end == line.size() || line[end] != ':') return false;
+  *name = line.substr(indentation, end - indentation);
+  *contents = line.substr(end + 1);
+  return true;
+}
+
 bool snakemake_unit_tests::rule_block::report_python_logging_code(std::ostream &out) {
+  std::string buffer;
+  bool res = render_python_logging_code(&buffer);
+  if (!out.write(buffer.data(), buffer.size())) throw std::runtime_error("python logging code printing error");
+  return res;
+}
+
+bool snakemake_unit_tests::rule_block::render_python_logging_code(std::string *target) {
+  if (!target) throw std::runtime_error("null pointer provided to render_python_logging_code");
   _queried_by_python = true;
   // report contents. may eventually be used for printing to custom snakefile
   if (!get_code_chunk().empty()) {
@@ -213,13 +316,16 @@ bool snakemake_unit_tests::rule_block::report_python_logging_code(std::ostream &
     if (contains_include_directive()) {
       // it can be resolved, in which case, it can sometimes be included
       if (_resolution == RESOLVED_INCLUDED) {
-        if (!(out << *get_code_chunk().rbegin() << std::endl))
-          throw std::runtime_error("include statement printing error");
+        target->append(*get_code_chunk().rbegin());
+        target->push_back('\n');
       }
       // report tag along with required expression for evaluation
-      if (!(out << indentation(get_code_chunk().rbegin()->find_first_not_of(" ")) << "print(\"tag"
-                << get_interpreter_tag() << ": {}\".format(" << get_filename_expression() << "))" << std::endl))
-        throw std::runtime_error("complex include printing error");
+      target->append(get_code_chunk().rbegin()->find_first_not_of(" "), ' ');
+      target->append("print(\"tag");
+      target->append(std::to_string(get_interpreter_tag()));
+      target->append(": {}\".format(");
+      target->append(get_filename_expression());
+      target->append("))\n");
       // new: terminate immediately if this was an unresolved
       // include directive
       if (_resolution == UNRESOLVED) {
@@ -229,23 +335,27 @@ bool snakemake_unit_tests::rule_block::report_python_logging_code(std::ostream &
       // regardless of resolution, print other code as-is
       for (std::vector<std::string>::const_iterator iter = get_code_chunk().begin(); iter != get_code_chunk().end();
            ++iter) {
-        if (!(out << *iter << std::endl)) throw std::runtime_error("code chunk printing error");
+        target->append(*iter);
+        target->push_back('\n');
       }
     }
   } else if (!get_rule_name().empty()) {  // is a rule
     // new logic: must print tag each time, in case status changes later
-    if (!(out << indentation(get_local_indentation()) << "print(\"tag" << get_interpreter_tag() << "\")" << std::endl
-              << std::endl
-              << std::endl))
-      throw std::runtime_error("rule interpreter code printing failure");
+    target->append(get_local_indentation(), ' ');
+    target->append("print(\"tag");
+    target->append(std::to_string(get_interpreter_tag()));
+    target->append("\")\n\n\n");
   } else {  // is a snakemake metacontent block
     // rule name is empty but blocks are not.
     // switching to direct snakemake interpretation, in which case these
     // need to be included
     for (std::vector<std::pair<std::string, std::string> >::const_iterator iter = get_named_blocks().begin();
          iter != get_named_blocks().end(); ++iter) {
-      if (!(out << indentation(get_local_indentation()) << iter->first << ":" << iter->second << std::endl))
-        throw std::runtime_error("snakemake directive printing failure");
+      target->append(get_local_indentation(), ' ');
+      target->append(iter->first);
+      target->push_back(':');
+      target->append(iter->second);
+      target->push_back('\n');
     }
   }
   return false;
@@ -283,79 +393,158 @@ bool snakemake_unit_tests::rule_block::update_resolution(const std::map<std::str
 }
 
 void snakemake_unit_tests::rule_block::print_contents(std::ostream &out) const {
+  std::string buffer;
+  render_contents(&buffer);
+  if (!out.write(buffer.data(), buffer.size())) throw std::runtime_error("rule block printing error");
+}
+
+void snakemake_unit_tests::rule_block::render_contents(std::string *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to render_contents");
   // report contents. may eventually be used for printing to custom snakefile
   if (!get_code_chunk().empty()) {  // python code
     for (std::vector<std::string>::const_iterator iter = get_code_chunk().begin(); iter != get_code_chunk().end();
          ++iter) {
-      if (!(out << *iter << std::endl)) throw std::runtime_error("code chunk printing error");
+      target->append(*iter);
+      target->push_back('\n');
     }
   } else if (!get_rule_name().empty()) {  // rule
+    target->append(get_local_indentation(), ' ');
     if (!get_base_rule_name().empty()) {
-      if (!(out << indentation(get_local_indentation()) << "use rule " << get_base_rule_name() << " as "
-                << get_rule_name() << " with:" << std::endl))
-        throw std::runtime_error("base rule name printing failure");
-    } else if (!(out << indentation(get_local_indentation()) << (is_checkpoint() ? "checkpoint " : "rule ")
-                     << get_rule_name() << ":" << std::endl)) {
-      throw std::runtime_error("rule name printing failure");
+      target->append("use rule ");
+      target->append(get_base_rule_name());
+      target->append(" as ");
+      target->append(get_rule_name());
+      target->append(" with:\n");
+    } else {
+      target->append(is_checkpoint() ? "checkpoint " : "rule ");
+      target->append(get_rule_name());
+      target->append(":\n");
     }
     // if docstring is present, report it
     if (!_docstring.empty()) {
-      if (!(out << _docstring << std::endl)) {
-        throw std::runtime_error("docstring printing failure");
-      }
+      target->append(_docstring);
+      target->push_back('\n');
     }
     // report all blocks in the order they were encountered
-    std::map<std::string, bool> forbidden_blocks;
-    /*
-      new: in snakemake 6.15.0, support for a 'default_target' rule block entry
-      was added, to override the behavior of snakemake running the first rule it encounters
-      when no additional information is provided in the snakemake invocation. this functionality
-      seems to largely have no impact on the unit tester, but it's also antithetical to how
-      this testing regime is structured. as such, it is the inaugural member of a named block exclusion
-      list, against which the output is filtered.
-     */
-    forbidden_blocks["default_target"] = true;
     for (std::vector<std::pair<std::string, std::string> >::const_iterator iter = get_named_blocks().begin();
          iter != get_named_blocks().end(); ++iter) {
-      if (forbidden_blocks.find(iter->first) == forbidden_blocks.end()) {
-        if (!(out << indentation(get_local_indentation() + 4) << iter->first << ":" << iter->second << std::endl))
-          throw std::runtime_error("named block printing failure");
+      if (!is_forbidden_block(iter->first)) {
+        target->append(get_local_indentation() + 4, ' ');
+        target->append(iter->first);
+        target->push_back(':');
+        target->append(iter->second);
+        target->push_back('\n');
       }
     }
     // for snakefmt compatibility: emit two empty lines at the end of a rule
-    if (!(out << std::endl << std::endl)) throw std::runtime_error("rule padding printing error");
+    target->append("\n\n");
   } else {
     // snakemake metacontent block
     for (std::vector<std::pair<std::string, std::string> >::const_iterator iter = get_named_blocks().begin();
          iter != get_named_blocks().end(); ++iter) {
-      if (!(out << indentation(get_local_indentation()) << iter->first << ":" << iter->second << std::endl))
-        throw std::runtime_error("named block printing failure");
+      target->append(get_local_indentation(), ' ');
+      target->append(iter->first);
+      target->push_back(':');
+      target->append(iter->second);
+      target->push_back('\n');
     }
   }
 }
 
+bool snakemake_unit_tests::rule_block::is_forbidden_block(const std::string &name) {
+  /*
+    new: in snakemake 6.15.0, support for a 'default_target' rule block entry
+    was added, to override the behavior of snakemake running the first rule it encounters
+    when no additional information is provided in the snakemake invocation. this functionality
+    seems to largely have no impact on the unit tester, but it's also antithetical to how
+    this testing regime is structured. as such, it is the inaugural member of a named block exclusion
+    list, against which the output is filtered.
+   */
+  return !name.compare("default_target");
+}
+
 void snakemake_unit_tests::rule_block::clear() {
   _rule_name = _base_rule_name = "";
   _named_blocks.clear();
   _code_chunk.clear();
+  _rule_references.clear();
+  _is_include_directive = false;
+  _include_expression = "";
+}
+
+void snakemake_unit_tests::rule_block::update_rule_references() {
+  _rule_references.clear();
+  for (std::vector<std::pair<std::string, std::string> >::const_iterator iter = _named_blocks.begin();
+       iter != _named_blocks.end(); ++iter) {
+    find_rule_references(iter->second, &_rule_references);
+  }
 }
 
-std::string snakemake_unit_tests::rule_block::indentation(unsigned count) const {
-  std::ostringstream o;
-  for (unsigned i = 0; i < count; ++i) {
-    o << ' ';
+void snakemake_unit_tests::rule_block::find_rule_references(std::string_view text,
+                                                           std::map<std::string, bool> *target) {
+  if (!target) throw std::runtime_error("null pointer provided to find_rule_references");
+  // python identifiers, restricted to ascii
+  auto identifier_start = [](char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; };
+  auto identifier_char = [&identifier_start](char c) { return identifier_start(c) || (c >= '0' && c <= '9'); };
+  std::string_view::size_type i = 0;
+  while (i < text.size()) {
+    char c = text[i];
+    if (c == '#') {
+      // comment: skip to end of line
+      i = text.find('\n', i);
+      if (i == std::string_view::npos) break;
+    } else if (c == '\'' || c == '"') {
+      // string literal, possibly triple quoted: skip to matching close
+      bool triple = i + 2 < text.size() && text[i + 1] == c && text[i + 2] == c;
+      i += triple ? 3 : 1;
+      while (i < text.size()) {
+        if (text[i] == '\\') {
+          i += 2;
+        } else if (text[i] == c && (!triple || (i + 2 < text.size() && text[i + 1] == c && text[i + 2] == c))) {
+          i += triple ? 3 : 1;
+          break;
+        } else {
+          ++i;
+        }
+      }
+      continue;
+    } else if (identifier_start(c)) {
+      // identifier; only a standalone `rules` or `checkpoints` is of interest
+      std::string_view::size_type end = i;
+      while (end < text.size() && identifier_char(text[end])) ++end;
+      std::string_view word = text.substr(i, end - i);
+      bool attribute = i && text[i - 1] == '.';
+      if (!attribute && (!word.compare("rules") || !word.compare("checkpoints")) && end + 1 < text.size() &&
+          text[end] == '.' && identifier_start(text[end + 1])) {
+        std::string_view::size_type name_end = end + 1;
+        while (name_end < text.size() && identifier_char(text[name_end])) ++name_end;
+        (*target)[std::string(text.substr(end + 1, name_end - end - 1))] = true;
+        end = name_end;
+      }
+      i = end;
+      continue;
+    } else if (c >= '0' && c <= '9') {
+      // numeric literal; skip so that e.g. exponents are not read as identifiers
+      while (i < text.size() && (identifier_char(text[i]) || text[i] == '.')) ++i;
+      continue;
+    }
+    ++i;
   }
-  return o.str();
 }
 
+std::string snakemake_unit_tests::rule_block::indentation(unsigned count) const { return std::string(count, ' '); }
+
 std::string snakemake_unit_tests::rule_block::apply_indentation(const std::string &s, unsigned count) const {
   // this is a multi-line string with embedded newlines. the newlines need
   // to be replaced by "\n[some number of spaces]"
-  std::string res = s, indent = indentation(count);
+  std::string res;
+  res.reserve(s.size() + count * std::count(s.begin(), s.end(), '\n'));
   std::string::size_type loc = 0, cur = 0;
-  while ((loc = res.find('\n', cur)) != std::string::npos) {
-    res = res.substr(0, loc + 1) + indent + res.substr(loc + 1);
-    cur = loc + 1 + indent.size();
+  while ((loc = s.find('\n', cur)) != std::string::npos) {
+    res.append(s, cur, loc + 1 - cur);
+    res.append(count, ' ');
+    cur = loc + 1;
   }
+  res.append(s, cur, std::string::npos);
   return res;
 }
@@ -9,12 +9,14 @@
 #ifndef SNAKEMAKE_UNIT_TESTS_RULE_BLOCK_H_
 #define SNAKEMAKE_UNIT_TESTS_RULE_BLOCK_H_
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -42,6 +44,13 @@ class rule_block {
     @param obj existing rule block
    */
   rule_block(const rule_block &obj);
+  /*!
+    @brief move constructor
+    @param obj existing rule block, left empty
+
+    allows blocks to be stored by value in growing contiguous storage
+   */
+  rule_block(rule_block &&obj) noexcept;
   /*!
     @brief destructor
    */
@@ -58,6 +67,16 @@ class rule_block {
     it is designed to be called until it returns false.
    */
   bool load_content_block(const std::vector<std::string> &loaded_lines, bool verbose, unsigned *current_line);
+  /*!
+    @brief load a rule block or python chunk from lexed logical lines
+    @param loaded_lines logical lines of snakemake file to process
+    @param verbose whether to report verbose logging output
+    @param current_line currently probed line tracker
+    @return whether a rule was successfully loaded
+
+    lines are only copied when stored in the block
+   */
+  bool load_content_block(const std::vector<logical_line> &loaded_lines, bool verbose, unsigned *current_line);
 
   /*!
     @brief having found a rule declaration, load its blocks
@@ -67,6 +86,14 @@ class rule_block {
     @return whether a rule was successfully loaded
    */
   bool consume_rule_contents(const std::vector<std::string> &loaded_lines, bool verbose, unsigned *current_line);
+  /*!
+    @brief having found a rule declaration, load its blocks from lexed logical lines
+    @param loaded_lines logical lines of snakemake file to process
+    @param verbose whether to report verbose logging output
+    @param current_line currently probed line tracker
+    @return whether a rule was successfully loaded
+   */
+  bool consume_rule_contents(const std::vector<logical_line> &loaded_lines, bool verbose, unsigned *current_line);
 
   /*!
     @brief set the name of the rule
@@ -99,7 +126,7 @@ class rule_block {
     an include directive but that doesn't conform to basic include syntax
     @return whether a non-standard include directive is in effect
    */
-  bool contains_include_directive() const;
+  bool contains_include_directive() const { return _is_include_directive; }
 
   /*!
     @brief extract the filename expression from an include statement
@@ -116,6 +143,16 @@ class rule_block {
    */
   void print_contents(std::ostream &out) const;
 
+  /*!
+    @brief append mildly formatted contents to a text buffer
+    @param target buffer to which to append formatted contents
+
+    produces exactly the content of print_contents. the buffer is
+    only ever appended to, so callers can reuse a single buffer
+    across many blocks
+   */
+  void render_contents(std::string *target) const;
+
   /*!
     @brief get internal storage of code chunk as const reference
     @return code chunk as const reference
@@ -128,6 +165,12 @@ class rule_block {
    */
   const std::vector<std::pair<std::string, std::string> > &get_named_blocks() const { return _named_blocks; }
 
+  /*!
+    @brief get names of rules referenced through `rules.` or `checkpoints.` in the rule body
+    @return referenced rule names, recorded when the rule is loaded
+   */
+  const std::map<std::string, bool> &get_rule_references() const { return _rule_references; }
+
   /*!
     @brief get local indentation of rule block
     @return local indentation of rule block
@@ -140,7 +183,65 @@ class rule_block {
 
     required for the redesign of the parser
    */
-  void add_code_chunk(const std::string &s) { _code_chunk.push_back(s); }
+  void add_code_chunk(const std::string &s);
+
+  /*!
+    @brief recognize a rule or checkpoint declaration
+    @param line logical line to test
+    @param keyword declaration keyword: "rule" or "checkpoint"
+    @param indentation where to store the number of leading spaces
+    @param name where to store the declared rule name
+    @return whether the line is a declaration of the requested type
+
+    equivalent to matching "^( *)keyword ([^ ]+):.*$"
+   */
+  static bool match_rule_declaration(std::string_view line, std::string_view keyword,
+                                     std::string_view::size_type *indentation, std::string_view *name);
+
+  /*!
+    @brief recognize a derived rule declaration
+    @param line logical line to test
+    @param indentation where to store the number of leading spaces
+    @param base_name where to store the name of the base rule
+    @param name where to store the name of the derived rule
+    @return whether the line is a derived rule declaration
+
+    equivalent to matching "^( *)use rule ([^ ]+) as ([^ ]+) with:.*$"
+   */
+  static bool match_derived_rule_declaration(std::string_view line, std::string_view::size_type *indentation,
+                                             std::string_view *base_name, std::string_view *name);
+
+  /*!
+    @brief recognize an include directive
+    @param line logical line to test
+    @param expression where to store the included filename expression
+    @return whether the line is an include directive
+
+    equivalent to matching "^( *)include: *(.*[^ ]) *$"
+   */
+  static bool match_include_directive(std::string_view line, std::string_view *expression);
+
+  /*!
+    @brief recognize a named block within a rule
+    @param line logical line to test
+    @param indentation required number of leading spaces
+    @param name where to store the block name
+    @param contents where to store any content following the block name
+    @return whether the line opens a named block
+
+    equivalent to matching "^ {indentation}([a-zA-Z_\-]+):(.*)$"
+   */
+  static bool match_named_block(std::string_view line, std::string_view::size_type indentation,
+                                std::string_view *name, std::string_view *contents);
+
+  /*!
+    @brief find `rules.<name>` and `checkpoints.<name>` references in python code
+    @param text code to scan
+    @param target where to add referenced rule names
+
+    references inside string literals and comments are ignored
+   */
+  static void find_rule_references(std::string_view text, std::map<std::string, bool> *target);
 
   /*!
     @brief test equality
@@ -207,6 +308,15 @@ class rule_block {
     of an unresolved include directive
    */
   bool report_python_logging_code(std::ostream &out);
+  /*!
+    @brief append a python syntax reporting block to a text buffer
+    @param target buffer to which to append reporting code
+    @return whether the reporting terminated upon first instance
+    of an unresolved include directive
+
+    produces exactly the content of report_python_logging_code
+   */
+  bool render_python_logging_code(std::string *target);
   /*!
     @brief using python tag output, update resolution status
     @param tag_values loaded key(:value) pairs from python output
@@ -244,6 +354,13 @@ class rule_block {
    */
   std::string indentation(unsigned count) const;
 
+  /*!
+    @brief whether a named block is excluded from rendered rules
+    @param name name of block to test
+    @return whether the block is excluded
+   */
+  static bool is_forbidden_block(const std::string &name);
+
   /*!
     @brief replace embedded newlines in a string with newlines plus indentation
     @param s input string, possibly with embedded newlines
@@ -259,6 +376,10 @@ class rule_block {
     @brief clear out internal storage
    */
   void clear();
+  /*!
+    @brief record rule references from the named blocks of this rule
+   */
+  void update_rule_references();
   /*!
     @brief declared rule name
 
@@ -302,6 +423,20 @@ class rule_block {
     own copy of this class
    */
   std::vector<std::string> _code_chunk;
+  /*!
+    @brief rules referenced from named blocks, through `rules.` or `checkpoints.`
+   */
+  std::map<std::string, bool> _rule_references;
+  /*!
+    @brief whether the code chunk is a single include directive
+
+    classification is updated whenever the code chunk changes
+   */
+  bool _is_include_directive;
+  /*!
+    @brief filename expression of include directive, if present
+   */
+  std::string _include_expression;
   /*!
     @brief allow for local indentation of conditionally included rules
 
@@ -86,6 +86,26 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_copy_constructor() {
   CPPUNIT_ASSERT_EQUAL(333u, b2._python_tag);
   CPPUNIT_ASSERT(!b2._resolved_included_filename.compare("thing1/thing2/thing3"));
 }
+void snakemake_unit_tests::rule_blockTest::test_rule_block_move_constructor() {
+  rule_block b1;
+  b1._rule_name = "rulename";
+  b1._named_blocks.push_back(std::make_pair("thing1", "thing2"));
+  b1.add_code_chunk("include: \"thing.smk\"");
+  b1._local_indentation = 42;
+  b1._resolution = RESOLVED_INCLUDED;
+  b1._python_tag = 333;
+  b1._resolved_included_filename = "thing1/thing2/thing3";
+  rule_block b2(std::move(b1));
+  CPPUNIT_ASSERT(!b2._rule_name.compare("rulename"));
+  CPPUNIT_ASSERT(b2._named_blocks.size() == 1u);
+  CPPUNIT_ASSERT(b2._code_chunk.size() == 1u);
+  CPPUNIT_ASSERT(b2._is_include_directive);
+  CPPUNIT_ASSERT(!b2._include_expression.compare("\"thing.smk\""));
+  CPPUNIT_ASSERT_EQUAL(42u, b2._local_indentation);
+  CPPUNIT_ASSERT_EQUAL(RESOLVED_INCLUDED, b2._resolution);
+  CPPUNIT_ASSERT_EQUAL(333u, b2._python_tag);
+  CPPUNIT_ASSERT(!b2._resolved_included_filename.string().compare("thing1/thing2/thing3"));
+}
 void snakemake_unit_tests::rule_blockTest::test_rule_block_load_content_block() {
   rule_block standard_rule, derived_rule, localrules, python_if, checkpoint, configfile;
   unsigned current_line = 0u;
@@ -217,38 +237,47 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_get_base_rule_name()
 }
 void snakemake_unit_tests::rule_blockTest::test_rule_block_contains_include_directive() {
   rule_block b;
-  b._code_chunk.push_back("include: stuff");
+  b.add_code_chunk("include: stuff");
   CPPUNIT_ASSERT(b.contains_include_directive());
-  b._code_chunk.at(0) = "include: \"stuff\"";
+  b.clear();
+  b.add_code_chunk("include: \"stuff\"");
   CPPUNIT_ASSERT(b.contains_include_directive());
-  b._code_chunk.at(0) = "   include: thing";
+  b.clear();
+  b.add_code_chunk("   include: thing");
   CPPUNIT_ASSERT(b.contains_include_directive());
-  b._code_chunk.at(0) = "include: \"thing\"   ";
+  b.clear();
+  b.add_code_chunk("include: \"thing\"   ");
   CPPUNIT_ASSERT(b.contains_include_directive());
-  b._code_chunk.at(0) = "include thing";
+  b.clear();
+  b.add_code_chunk("include thing");
   CPPUNIT_ASSERT(!b.contains_include_directive());
-  b._code_chunk.at(0) = "sinclude: thing";
+  b.clear();
+  b.add_code_chunk("sinclude: thing");
   CPPUNIT_ASSERT(!b.contains_include_directive());
   // note that this code chunk is technically impossible,
   // as individual python statements should be stored individually
-  b._code_chunk.at(0) = "include: thing";
-  b._code_chunk.push_back("include: otherthing");
+  b.clear();
+  b.add_code_chunk("include: thing");
+  b.add_code_chunk("include: otherthing");
   CPPUNIT_ASSERT(!b.contains_include_directive());
 }
 void snakemake_unit_tests::rule_blockTest::test_rule_block_get_filename_expression() {
   rule_block b;
-  b._code_chunk.push_back("include: stuff");
+  b.add_code_chunk("include: stuff");
   CPPUNIT_ASSERT(!b.get_filename_expression().compare("stuff"));
-  b._code_chunk.at(0) = "include: \"stuff\"";
+  b.clear();
+  b.add_code_chunk("include: \"stuff\"");
   CPPUNIT_ASSERT(!b.get_filename_expression().compare("\"stuff\""));
-  b._code_chunk.at(0) = "   include: thing";
+  b.clear();
+  b.add_code_chunk("   include: thing");
   CPPUNIT_ASSERT(!b.get_filename_expression().compare("thing"));
-  b._code_chunk.at(0) = "include: \"thing\"   ";
+  b.clear();
+  b.add_code_chunk("include: \"thing\"   ");
   CPPUNIT_ASSERT(!b.get_filename_expression().compare("\"thing\""));
 }
 void snakemake_unit_tests::rule_blockTest::test_rule_block_get_filename_expression_invalid_statement() {
   rule_block b;
-  b._code_chunk.push_back("here's some weird statement that isn't an include");
+  b.add_code_chunk("here's some weird statement that isn't an include");
   b.get_filename_expression();
 }
 void snakemake_unit_tests::rule_blockTest::test_rule_block_print_contents() {
@@ -323,6 +352,32 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_print_contents() {
   CPPUNIT_ASSERT(!o4.str().compare(expected));
 }
 
+void snakemake_unit_tests::rule_blockTest::test_rule_block_render_contents() {
+  // rendering appends to an existing buffer, matching print_contents
+  rule_block b;
+  b._rule_name = "myrulename";
+  b._docstring = "    '''here's some commentary'''";
+  b._named_blocks.push_back(std::make_pair("input", " 'filename1'"));
+  b._named_blocks.push_back(std::make_pair("default_target", " True"));
+  b._named_blocks.push_back(std::make_pair("shell", " 'cat {input}'"));
+  b._local_indentation = 4u;
+  std::string buffer = "previous content\n";
+  b.render_contents(&buffer);
+  std::string expected =
+      "    rule myrulename:\n"
+      "    '''here's some commentary'''\n"
+      "        input: 'filename1'\n"
+      "        shell: 'cat {input}'\n\n\n";
+  CPPUNIT_ASSERT(!buffer.compare("previous content\n" + expected));
+  std::ostringstream o1;
+  b.print_contents(o1);
+  CPPUNIT_ASSERT(!o1.str().compare(expected));
+  // code chunks
+  b.add_code_chunk("x = 1");
+  buffer.clear();
+  b.render_contents(&buffer);
+  CPPUNIT_ASSERT(!buffer.compare("x = 1\n"));
+}
 void snakemake_unit_tests::rule_blockTest::test_rule_block_get_code_chunk() {
   rule_block b;
   std::vector<std::string> data, result;
@@ -518,7 +573,7 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_report_python_logging
   expected = "code chunk line 1\n   code chunk line 2\n";
   CPPUNIT_ASSERT(!o1.str().compare(expected));
   b._code_chunk.clear();
-  b._code_chunk.push_back("    include: \"myname.smk\"");
+  b.add_code_chunk("    include: \"myname.smk\"");
   CPPUNIT_ASSERT(b.report_python_logging_code(o2));
   expected = "    print(\"tag22: {}\".format(\"myname.smk\"))\n";
   CPPUNIT_ASSERT(!o2.str().compare(expected));
@@ -527,6 +582,7 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_report_python_logging
   expected = "    include: \"myname.smk\"\n    print(\"tag22: {}\".format(\"myname.smk\"))\n";
   CPPUNIT_ASSERT(!o3.str().compare(expected));
   b._code_chunk.clear();
+  b._is_include_directive = false;
   CPPUNIT_ASSERT(!b.report_python_logging_code(o4));
   expected = "  print(\"tag22\")\n\n\n";
   CPPUNIT_ASSERT(!o4.str().compare(expected));
@@ -538,6 +594,23 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_report_python_logging
       "  shell:\n          'cat {input} > {output}'\n";
   CPPUNIT_ASSERT(!o5.str().compare(expected));
 }
+void snakemake_unit_tests::rule_blockTest::test_rule_block_render_python_logging_code() {
+  // rendering appends to an existing buffer, matching report_python_logging_code
+  rule_block b;
+  b.add_code_chunk("  include: \"myname.smk\"");
+  b._python_tag = 7u;
+  std::string buffer = "x = 1\n";
+  CPPUNIT_ASSERT(b.render_python_logging_code(&buffer));
+  CPPUNIT_ASSERT(b._queried_by_python);
+  CPPUNIT_ASSERT(!buffer.compare("x = 1\n  print(\"tag7: {}\".format(\"myname.smk\"))\n"));
+  b._resolution = RESOLVED_INCLUDED;
+  buffer.clear();
+  CPPUNIT_ASSERT(!b.render_python_logging_code(&buffer));
+  std::ostringstream o1;
+  CPPUNIT_ASSERT(!b.report_python_logging_code(o1));
+  CPPUNIT_ASSERT(!buffer.compare(o1.str()));
+  CPPUNIT_ASSERT(!buffer.compare("  include: \"myname.smk\"\n  print(\"tag7: {}\".format(\"myname.smk\"))\n"));
+}
 void snakemake_unit_tests::rule_blockTest::test_rule_block_update_resolution() {
   /*
     rule_block objects scan the results of a python logging pass and
@@ -602,6 +675,51 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_apply_indentation() {
   std::string result = b.apply_indentation(test_str, 5);
   std::string expected = "here is some content:\n       there's some stuff here\n         ok?";
   CPPUNIT_ASSERT(!result.compare(expected));
+  // leading and trailing newlines
+  CPPUNIT_ASSERT(!b.apply_indentation("\na\n", 2).compare("\n  a\n  "));
+  CPPUNIT_ASSERT(!b.apply_indentation("", 2).compare(""));
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_is_forbidden_block() {
+  CPPUNIT_ASSERT(rule_block::is_forbidden_block("default_target"));
+  CPPUNIT_ASSERT(!rule_block::is_forbidden_block("default"));
+  CPPUNIT_ASSERT(!rule_block::is_forbidden_block("input"));
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_find_rule_references() {
+  std::map<std::string, bool> refs;
+  rule_block::find_rule_references(" rules.alpha.output, checkpoints.beta_2.get(sample='a').output[0]", &refs);
+  CPPUNIT_ASSERT(refs.size() == 2u);
+  CPPUNIT_ASSERT(refs.find("alpha") != refs.end());
+  CPPUNIT_ASSERT(refs.find("beta_2") != refs.end());
+  // string literals, comments, and attributes of other objects are ignored
+  refs.clear();
+  rule_block::find_rule_references(
+      " 'rules.gamma', \"\"\"checkpoints.delta\n rules.epsilon\"\"\", myrules.zeta, x.rules.eta  # rules.theta", &refs);
+  CPPUNIT_ASSERT(refs.empty());
+  // escaped quotes do not end a literal, and scanning resumes after it
+  refs.clear();
+  rule_block::find_rule_references(" \"a\\\" rules.iota\" + rules.kappa.input\n", &refs);
+  CPPUNIT_ASSERT(refs.size() == 1u);
+  CPPUNIT_ASSERT(refs.find("kappa") != refs.end());
+  // incomplete references
+  refs.clear();
+  rule_block::find_rule_references(" rules. rules.1 rules", &refs);
+  CPPUNIT_ASSERT(refs.empty());
+}
+void snakemake_unit_tests::rule_blockTest::test_rule_block_load_content_block_rule_references() {
+  std::vector<std::string> loaded_lines;
+  loaded_lines.push_back("rule rule1:");
+  loaded_lines.push_back("    input: rules.rule0.output,");
+  loaded_lines.push_back("    params: p=lambda wildcards: checkpoints.rule2.get(**wildcards).output,");
+  loaded_lines.push_back("x = rules.rule3.output");
+  rule_block b;
+  unsigned current_line = 0;
+  CPPUNIT_ASSERT(b.load_content_block(loaded_lines, false, &current_line));
+  CPPUNIT_ASSERT(b.get_rule_references().size() == 2u);
+  CPPUNIT_ASSERT(b.get_rule_references().find("rule0") != b.get_rule_references().end());
+  CPPUNIT_ASSERT(b.get_rule_references().find("rule2") != b.get_rule_references().end());
+  // code chunks are not scanned
+  CPPUNIT_ASSERT(b.load_content_block(loaded_lines, false, &current_line));
+  CPPUNIT_ASSERT(b.get_rule_references().empty());
 }
 void snakemake_unit_tests::rule_blockTest::test_rule_block_clear() {
   rule_block b1;
@@ -623,4 +741,83 @@ void snakemake_unit_tests::rule_blockTest::test_rule_block_clear() {
   CPPUNIT_ASSERT(b1 == b2);
 }
 
+void snakemake_unit_tests::rule_blockTest::test_rule_block_recognizers() {
+  std::string_view::size_type indentation = 0;
+  std::string_view name, base_name, contents;
+  CPPUNIT_ASSERT(rule_block::match_rule_declaration("  rule myrule:", "rule", &indentation, &name));
+  CPPUNIT_ASSERT(indentation == 2 && name == "myrule");
+  CPPUNIT_ASSERT(rule_block::match_rule_declaration("checkpoint a:b: # x", "checkpoint", &indentation, &name));
+  CPPUNIT_ASSERT(indentation == 0 && name == "a:b");
+  CPPUNIT_ASSERT(!rule_block::match_rule_declaration("rule  myrule:", "rule", &indentation, &name));
+  CPPUNIT_ASSERT(!rule_block::match_rule_declaration("rule :", "rule", &indentation, &name));
+  CPPUNIT_ASSERT(!rule_block::match_rule_declaration("\trule a:", "rule", &indentation, &name));
+  CPPUNIT_ASSERT(rule_block::match_derived_rule_declaration("    use rule base as derived with:", &indentation,
+                                                            &base_name, &name));
+  CPPUNIT_ASSERT(indentation == 4 && base_name == "base" && name == "derived");
+  CPPUNIT_ASSERT(!rule_block::match_derived_rule_declaration("use rule * from module as mod_* with:", &indentation,
+                                                             &base_name, &name));
+  CPPUNIT_ASSERT(rule_block::match_include_directive("  include:   \"file.smk\"  ", &contents));
+  CPPUNIT_ASSERT(contents == "\"file.smk\"");
+  CPPUNIT_ASSERT(!rule_block::match_include_directive("include:   ", &contents));
+  CPPUNIT_ASSERT(rule_block::match_named_block("    input: 'a',", 4, &name, &contents));
+  CPPUNIT_ASSERT(name == "input" && contents == " 'a',");
+  CPPUNIT_ASSERT(!rule_block::match_named_block("     input: 'a',", 4, &name, &contents));
+  CPPUNIT_ASSERT(!rule_block::match_named_block("    input2: 'a',", 4, &name, &contents));
+  // the include classification follows the code chunk
+  rule_block b;
+  b.add_code_chunk("include: \"file.smk\"");
+  rule_block c(b);
+  CPPUNIT_ASSERT(c.contains_include_directive());
+  CPPUNIT_ASSERT(!c.get_filename_expression().compare("\"file.smk\""));
+  b.clear();
+  CPPUNIT_ASSERT(!b.contains_include_directive());
+}
+
+void snakemake_unit_tests::rule_blockTest::test_rule_block_recognizers_match_regex() {
+  // the recognizers replace these patterns, and must agree with them exactly
+  const boost::regex standard_rule_declaration("^( *)rule ([^ ]+):.*$");
+  const boost::regex derived_rule_declaration("^( *)use rule ([^ ]+) as ([^ ]+) with:.*$");
+  const boost::regex include_directive("^( *)include: *(.*[^ ]) *$");
+  const boost::regex named_block_tag("^  ([a-zA-Z_\\-]+):(.*)$");
+  const std::vector<std::string> fragments = {"rule ", "use ", "as ", " with:", "include:", ":", " ", "a", "Z",
+                                              "_",     "-",    "\n",  "\t",     "'",        "9", "b:c"};
+  std::mt19937 generator(29);
+  std::uniform_int_distribution<unsigned> count_dist(0, 8), fragment_dist(0, fragments.size() - 1);
+  for (unsigned trial = 0; trial < 20000; ++trial) {
+    std::string line = std::string(trial % 3, ' ');
+    unsigned n = count_dist(generator);
+    if (trial % 4 == 0) line += "rule ";
+    if (trial % 4 == 1) line += "use rule ";
+    if (trial % 4 == 2) line += "include:";
+    for (unsigned i = 0; i < n; ++i) line += fragments.at(fragment_dist(generator));
+    boost::smatch regex_result;
+    std::string_view::size_type indentation = 0;
+    std::string_view name, base_name, contents;
+    bool expected = boost::regex_match(line, regex_result, standard_rule_declaration);
+    CPPUNIT_ASSERT(expected == rule_block::match_rule_declaration(line, "rule", &indentation, &name));
+    if (expected) {
+      CPPUNIT_ASSERT(regex_result[1].str().size() == indentation);
+      CPPUNIT_ASSERT(regex_result[2].str() == name);
+    }
+    expected = boost::regex_match(line, regex_result, derived_rule_declaration);
+    CPPUNIT_ASSERT(expected == rule_block::match_derived_rule_declaration(line, &indentation, &base_name, &name));
+    if (expected) {
+      CPPUNIT_ASSERT(regex_result[1].str().size() == indentation);
+      CPPUNIT_ASSERT(regex_result[2].str() == base_name);
+      CPPUNIT_ASSERT(regex_result[3].str() == name);
+    }
+    expected = boost::regex_match(line, regex_result, include_directive);
+    CPPUNIT_ASSERT(expected == rule_block::match_include_directive(line, &contents));
+    if (expected) {
+      CPPUNIT_ASSERT(regex_result[2].str() == contents);
+    }
+    expected = boost::regex_match(line, regex_result, named_block_tag);
+    CPPUNIT_ASSERT(expected == rule_block::match_named_block(line, 2, &name, &contents));
+    if (expected) {
+      CPPUNIT_ASSERT(regex_result[1].str() == name);
+      CPPUNIT_ASSERT(regex_result[2].str() == contents);
+    }
+  }
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::rule_blockTest);
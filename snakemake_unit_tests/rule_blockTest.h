@@ -15,6 +15,7 @@
 #include <cstdlib>
 #include <filesystem>
 #include <map>
+#include <random>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -29,6 +30,7 @@ class rule_blockTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(rule_blockTest);
   CPPUNIT_TEST(test_rule_block_default_constructor);
   CPPUNIT_TEST(test_rule_block_copy_constructor);
+  CPPUNIT_TEST(test_rule_block_move_constructor);
   CPPUNIT_TEST(test_rule_block_load_content_block);
   CPPUNIT_TEST_EXCEPTION(test_rule_block_load_content_block_null_pointer, std::runtime_error);
   CPPUNIT_TEST_EXCEPTION(test_rule_block_consume_rule_contents_null_pointer, std::runtime_error);
@@ -40,6 +42,7 @@ class rule_blockTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_EXCEPTION(test_rule_block_get_filename_expression_invalid_statement, std::runtime_error);
   CPPUNIT_TEST(test_rule_block_get_filename_expression);
   CPPUNIT_TEST(test_rule_block_print_contents);
+  CPPUNIT_TEST(test_rule_block_render_contents);
   CPPUNIT_TEST(test_rule_block_get_code_chunk);
   CPPUNIT_TEST(test_rule_block_get_named_blocks);
   CPPUNIT_TEST(test_rule_block_get_local_indentation);
@@ -53,13 +56,19 @@ class rule_blockTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_rule_block_set_interpreter_tag);
   CPPUNIT_TEST(test_rule_block_get_interpreter_tag);
   CPPUNIT_TEST(test_rule_block_report_python_logging_code);
+  CPPUNIT_TEST(test_rule_block_render_python_logging_code);
   CPPUNIT_TEST(test_rule_block_update_resolution);
   CPPUNIT_TEST(test_rule_block_get_resolved_included_filename);
   CPPUNIT_TEST(test_rule_block_is_checkpoint);
   CPPUNIT_TEST(test_rule_block_set_checkpoint);
   CPPUNIT_TEST(test_rule_block_indentation);
   CPPUNIT_TEST(test_rule_block_apply_indentation);
+  CPPUNIT_TEST(test_rule_block_is_forbidden_block);
+  CPPUNIT_TEST(test_rule_block_find_rule_references);
+  CPPUNIT_TEST(test_rule_block_load_content_block_rule_references);
   CPPUNIT_TEST(test_rule_block_clear);
+  CPPUNIT_TEST(test_rule_block_recognizers);
+  CPPUNIT_TEST(test_rule_block_recognizers_match_regex);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -69,6 +78,7 @@ class rule_blockTest : public CppUnit::TestFixture {
   // test case methods
   void test_rule_block_default_constructor();
   void test_rule_block_copy_constructor();
+  void test_rule_block_move_constructor();
   void test_rule_block_load_content_block();
   void test_rule_block_load_content_block_null_pointer();
   void test_rule_block_consume_rule_contents_null_pointer();
@@ -80,10 +90,13 @@ class rule_blockTest : public CppUnit::TestFixture {
   void test_rule_block_get_filename_expression();
   void test_rule_block_get_filename_expression_invalid_statement();
   void test_rule_block_print_contents();
+  void test_rule_block_render_contents();
   void test_rule_block_get_code_chunk();
   void test_rule_block_get_named_blocks();
   void test_rule_block_get_local_indentation();
   void test_rule_block_add_code_chunk();
+  void test_rule_block_recognizers();
+  void test_rule_block_recognizers_match_regex();
   void test_rule_block_equality_operator();
   void test_rule_block_inequality_operator();
   void test_rule_block_resolved();
@@ -93,12 +106,16 @@ class rule_blockTest : public CppUnit::TestFixture {
   void test_rule_block_set_interpreter_tag();
   void test_rule_block_get_interpreter_tag();
   void test_rule_block_report_python_logging_code();
+  void test_rule_block_render_python_logging_code();
   void test_rule_block_update_resolution();
   void test_rule_block_get_resolved_included_filename();
   void test_rule_block_is_checkpoint();
   void test_rule_block_set_checkpoint();
   void test_rule_block_indentation();
   void test_rule_block_apply_indentation();
+  void test_rule_block_is_forbidden_block();
+  void test_rule_block_find_rule_references();
+  void test_rule_block_load_content_block_rule_references();
   void test_rule_block_clear();
 
  private:
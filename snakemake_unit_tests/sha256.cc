@@ -0,0 +1,121 @@
+/*!
+  \file sha256.cc
+  \brief implementation of incremental SHA-256 digests
+  \copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#include "snakemake_unit_tests/sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+/*!
+  @brief round constants: fractional parts of the cube roots of the first 64 primes
+ */
+const uint32_t round_constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+/*!
+  @brief rotate a word right
+  @param x word to rotate
+  @param n number of bits
+  @return rotated word
+ */
+inline uint32_t rotr(uint32_t x, unsigned n) { return (x >> n) | (x << (32 - n)); }
+}  // namespace
+
+snakemake_unit_tests::sha256::sha256() : _block_size(0), _total_size(0), _finished(false) {
+  // fractional parts of the square roots of the first 8 primes
+  const uint32_t initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                               0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  memcpy(_state, initial, sizeof(_state));
+  memset(_block, 0, sizeof(_block));
+}
+
+snakemake_unit_tests::sha256::sha256(const sha256 &obj)
+    : _block_size(obj._block_size), _total_size(obj._total_size), _finished(obj._finished) {
+  memcpy(_state, obj._state, sizeof(_state));
+  memcpy(_block, obj._block, sizeof(_block));
+}
+
+void snakemake_unit_tests::sha256::process_block(const unsigned char *block) {
+  uint32_t w[64];
+  for (unsigned i = 0; i < 16; ++i) {
+    w[i] = (static_cast<uint32_t>(block[4 * i]) << 24) | (static_cast<uint32_t>(block[4 * i + 1]) << 16) |
+           (static_cast<uint32_t>(block[4 * i + 2]) << 8) | static_cast<uint32_t>(block[4 * i + 3]);
+  }
+  for (unsigned i = 16; i < 64; ++i) {
+    uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+  uint32_t a = _state[0], b = _state[1], c = _state[2], d = _state[3];
+  uint32_t e = _state[4], f = _state[5], g = _state[6], h = _state[7];
+  for (unsigned i = 0; i < 64; ++i) {
+    uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + round_constants[i] + w[i];
+    uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  _state[0] += a;
+  _state[1] += b;
+  _state[2] += c;
+  _state[3] += d;
+  _state[4] += e;
+  _state[5] += f;
+  _state[6] += g;
+  _state[7] += h;
+}
+
+void snakemake_unit_tests::sha256::update(const char *data, std::string::size_type size) {
+  if (_finished) throw std::logic_error("sha256: cannot add data to a finished digest");
+  if (!data && size) throw std::runtime_error("null pointer provided to sha256::update");
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+  _total_size += size;
+  // complete any partial block first
+  if (_block_size) {
+    std::string::size_type n = std::min<std::string::size_type>(size, 64 - _block_size);
+    memcpy(_block + _block_size, bytes, n);
+    _block_size += n;
+    bytes += n;
+    size -= n;
+    if (_block_size < 64) return;
+    process_block(_block);
+    _block_size = 0;
+  }
+  // then hash full blocks in place
+  for (; size >= 64; bytes += 64, size -= 64) process_block(bytes);
+  memcpy(_block, bytes, size);
+  _block_size = size;
+}
+
+std::string snakemake_unit_tests::sha256::hex_digest() {
+  if (_finished) throw std::logic_error("sha256: digest already finished");
+  uint64_t total_bits = _total_size * 8;
+  // pad with a one bit, zeros, and the message length in bits
+  unsigned char padding[72] = {0x80};
+  unsigned padding_size = (_block_size < 56 ? 56 : 120) - _block_size;
+  for (unsigned i = 0; i < 8; ++i) padding[padding_size + i] = static_cast<unsigned char>(total_bits >> (56 - 8 * i));
+  update(reinterpret_cast<const char *>(padding), padding_size + 8);
+  _finished = true;
+  const char *hex = "0123456789abcdef";
+  std::string result = "";
+  for (unsigned i = 0; i < 8; ++i) {
+    for (int shift = 28; shift >= 0; shift -= 4) result += hex[(_state[i] >> shift) & 15];
+  }
+  return result;
+}
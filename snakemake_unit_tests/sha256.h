@@ -0,0 +1,87 @@
+/*!
+  @file sha256.h
+  @brief incremental SHA-256 digests
+  @copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_SHA256_H_
+#define SNAKEMAKE_UNIT_TESTS_SHA256_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace snakemake_unit_tests {
+/*!
+  @class sha256
+  @brief compute a SHA-256 digest (FIPS 180-4) of data supplied in pieces
+
+  data is hashed as it arrives, so a file of any size can be digested
+  in one streaming pass. the digest is reported as lowercase hex, as
+  sha256sum and python's hashlib report it.
+ */
+class sha256 {
+ public:
+  /*!
+    @brief constructor: begin an empty digest
+   */
+  sha256();
+  /*!
+    @brief copy constructor
+    @param obj existing sha256
+   */
+  sha256(const sha256 &obj);
+  /*!
+    @brief destructor
+   */
+  ~sha256() throw() {}
+  /*!
+    @brief add data to the digest
+    @param data start of data
+    @param size number of bytes of data
+   */
+  void update(const char *data, std::string::size_type size);
+  /*!
+    @brief add data to the digest
+    @param data bytes to add
+   */
+  void update(const std::string &data) { update(data.data(), data.size()); }
+  /*!
+    @brief finish the digest
+    @return digest of all data added, as 64 lowercase hex characters
+
+    no more data may be added once the digest is finished.
+   */
+  std::string hex_digest();
+
+ private:
+  /*!
+    @brief hash one full 64 byte block into the state
+    @param block start of block
+   */
+  void process_block(const unsigned char *block);
+  /*!
+    @brief intermediate hash value
+   */
+  uint32_t _state[8];
+  /*!
+    @brief bytes of a partial block not yet hashed
+   */
+  unsigned char _block[64];
+  /*!
+    @brief number of bytes in _block
+   */
+  unsigned _block_size;
+  /*!
+    @brief total number of bytes added
+   */
+  uint64_t _total_size;
+  /*!
+    @brief whether hex_digest has been called
+   */
+  bool _finished;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_SHA256_H_
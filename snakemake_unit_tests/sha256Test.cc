@@ -0,0 +1,70 @@
+/*!
+  \file sha256Test.cc
+  \brief implementation of sha256 unit tests for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#include "snakemake_unit_tests/sha256Test.h"
+
+void snakemake_unit_tests::sha256Test::setUp() {}
+
+void snakemake_unit_tests::sha256Test::tearDown() {}
+
+void snakemake_unit_tests::sha256Test::test_sha256_empty() {
+  sha256 hasher;
+  CPPUNIT_ASSERT_EQUAL(std::string("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"),
+                       hasher.hex_digest());
+}
+
+void snakemake_unit_tests::sha256Test::test_sha256_known_values() {
+  // test vectors from FIPS 180-4 examples
+  sha256 hasher1;
+  hasher1.update("abc");
+  CPPUNIT_ASSERT_EQUAL(std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"),
+                       hasher1.hex_digest());
+  // the padding of this message spills into a second block
+  sha256 hasher2;
+  hasher2.update("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq");
+  CPPUNIT_ASSERT_EQUAL(std::string("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"),
+                       hasher2.hex_digest());
+  sha256 hasher3;
+  hasher3.update(std::string(1000000, 'a'));
+  CPPUNIT_ASSERT_EQUAL(std::string("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"),
+                       hasher3.hex_digest());
+}
+
+void snakemake_unit_tests::sha256Test::test_sha256_incremental() {
+  std::string data = "";
+  for (unsigned i = 0; i < 1000; ++i) data += static_cast<char>(i % 251);
+  sha256 whole;
+  whole.update(data);
+  // pieces of every size straddle block boundaries differently
+  for (unsigned piece = 1; piece < 130; piece += 7) {
+    sha256 pieces;
+    for (std::string::size_type start = 0; start < data.size(); start += piece) {
+      pieces.update(data.substr(start, piece));
+    }
+    CPPUNIT_ASSERT_EQUAL(sha256(whole).hex_digest(), pieces.hex_digest());
+  }
+}
+
+void snakemake_unit_tests::sha256Test::test_sha256_copy_constructor() {
+  sha256 hasher1;
+  hasher1.update("ab");
+  sha256 hasher2(hasher1);
+  hasher2.update("c");
+  CPPUNIT_ASSERT_EQUAL(std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"),
+                       hasher2.hex_digest());
+  hasher1.update("c");
+  CPPUNIT_ASSERT_EQUAL(std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"),
+                       hasher1.hex_digest());
+}
+
+void snakemake_unit_tests::sha256Test::test_sha256_update_finished() {
+  sha256 hasher;
+  hasher.hex_digest();
+  hasher.update("abc");
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::sha256Test);
@@ -0,0 +1,44 @@
+/*!
+  \file sha256Test.h
+  \brief sha256 test fixture for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_SHA256TEST_H_
+#define SNAKEMAKE_UNIT_TESTS_SHA256TEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <stdexcept>
+#include <string>
+
+#include "snakemake_unit_tests/sha256.h"
+
+namespace snakemake_unit_tests {
+class sha256Test : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(sha256Test);
+  CPPUNIT_TEST(test_sha256_empty);
+  CPPUNIT_TEST(test_sha256_known_values);
+  CPPUNIT_TEST(test_sha256_incremental);
+  CPPUNIT_TEST(test_sha256_copy_constructor);
+  CPPUNIT_TEST_EXCEPTION(test_sha256_update_finished, std::logic_error);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_sha256_empty();
+  void test_sha256_known_values();
+  void test_sha256_incremental();
+  void test_sha256_copy_constructor();
+  void test_sha256_update_finished();
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_SHA256TEST_H_
@@ -57,12 +57,10 @@
 void snakemake_unit_tests::snakemake_file::load_everything(const boost::filesystem::path &filename,
                                                            const boost::filesystem::path &base_dir, bool verbose) {
   _snakefile_relative_path = filename;
-  std::vector<std::string> loaded_lines;
   boost::filesystem::path recursive_path = base_dir / filename;
-  load_lines(recursive_path, &loaded_lines);
-  // new: preprocess all lines with the improved lexical parser
-  loaded_lines = lexical_parse(loaded_lines);
-  parse_file(loaded_lines, filename, verbose);
+  // new: preprocess all lines with the improved lexical parser, directly on the mapped file
+  lexed_file loaded_lines(recursive_path, false);
+  parse_file(loaded_lines.get_lines(), filename, verbose);
 }
 
 void snakemake_unit_tests::snakemake_file::postflight_checks(const std::map<std::string, bool> &include_rules,
@@ -70,13 +68,52 @@ void snakemake_unit_tests::snakemake_file::postflight_checks(const std::map<std:
   // placeholder: add screening step to detect known issues/unsupported features
   detect_known_issues(include_rules, exclude_rules);
   // resolved rules are being dealt with differently, and in solved_rules
+  // resolution is complete: rule queries from here can use an index,
+  // and the emitted text of each block is fixed
+  build_rule_index();
+  render_segments();
+}
+
+void snakemake_unit_tests::snakemake_file::build_rule_index() {
+  _rule_index.clear();
+  index_rules(&_rule_index);
+  _rule_index_built = true;
+}
+
+void snakemake_unit_tests::snakemake_file::index_rules(
+    std::map<std::string, std::vector<std::pair<boost::shared_ptr<rule_block>, const snakemake_file *> > > *target)
+    const {
+  if (!target) throw std::runtime_error("null pointer provided to index_rules");
+  for (std::vector<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
+       ++iter) {
+    if (!(*iter)->included() || (*iter)->get_rule_name().empty()) continue;
+    (*target)[(*iter)->get_rule_name()].push_back(std::make_pair(*iter, this));
+  }
+  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::const_iterator iter =
+           _included_files.begin();
+       iter != _included_files.end(); ++iter) {
+    iter->second->index_rules(target);
+  }
 }
 
 void snakemake_unit_tests::snakemake_file::report_rules(
     std::map<std::string, std::vector<boost::shared_ptr<rule_block> > > *aggregated_rules) const {
   if (!aggregated_rules) throw std::runtime_error("null pointer provided to report_rules");
+  if (_rule_index_built) {
+    for (std::map<std::string, std::vector<std::pair<boost::shared_ptr<rule_block>, const snakemake_file *> > >::
+             const_iterator iter = _rule_index.begin();
+         iter != _rule_index.end(); ++iter) {
+      std::vector<boost::shared_ptr<rule_block> > &target = (*aggregated_rules)[iter->first];
+      for (std::vector<std::pair<boost::shared_ptr<rule_block>, const snakemake_file *> >::const_iterator riter =
+               iter->second.begin();
+           riter != iter->second.end(); ++riter) {
+        target.push_back(riter->first);
+      }
+    }
+    return;
+  }
   std::map<std::string, std::vector<boost::shared_ptr<rule_block> > >::iterator finder;
-  for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
+  for (std::vector<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
        ++iter) {
     // new: respect blocks' reports of inclusion status
     if (!(*iter)->included()) continue;
@@ -101,6 +138,52 @@ void snakemake_unit_tests::snakemake_file::report_rules(
   }
 }
 
+void snakemake_unit_tests::snakemake_file::report_rule_references(
+    std::map<std::string, std::map<std::string, bool> > *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to report_rule_references");
+  std::map<std::string, std::vector<boost::shared_ptr<rule_block> > > aggregated_rules;
+  report_rules(&aggregated_rules);
+  for (std::map<std::string, std::vector<boost::shared_ptr<rule_block> > >::const_iterator iter =
+           aggregated_rules.begin();
+       iter != aggregated_rules.end(); ++iter) {
+    std::map<std::string, bool> &references = (*target)[iter->first];
+    for (std::vector<boost::shared_ptr<rule_block> >::const_iterator block = iter->second.begin();
+         block != iter->second.end(); ++block) {
+      references.insert((*block)->get_rule_references().begin(), (*block)->get_rule_references().end());
+    }
+  }
+}
+
+void snakemake_unit_tests::snakemake_file::report_conda_envs(const std::map<std::string, bool> &rule_names,
+                                                             std::map<boost::filesystem::path, bool> *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to report_conda_envs");
+  for (std::vector<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
+       ++iter) {
+    if (!(*iter)->included() || rule_names.find((*iter)->get_rule_name()) == rule_names.end()) continue;
+    for (std::vector<std::pair<std::string, std::string> >::const_iterator block = (*iter)->get_named_blocks().begin();
+         block != (*iter)->get_named_blocks().end(); ++block) {
+      if (block->first.compare("conda")) continue;
+      std::string::size_type start = block->second.find_first_not_of(" \t\n");
+      std::string::size_type end = block->second.find_last_not_of(" \t\n,");
+      if (start == std::string::npos || end == std::string::npos || end <= start) continue;
+      std::string value = block->second.substr(start, end - start + 1);
+      // a single string literal, without escapes
+      if ((value.at(0) != '"' && value.at(0) != '\'') || value.find(value.at(0), 1) != value.size() - 1 ||
+          value.find('\\') != std::string::npos)
+        continue;
+      boost::filesystem::path env_file = value.substr(1, value.size() - 2);
+      if (env_file.extension() != ".yaml" && env_file.extension() != ".yml") continue;
+      if (env_file.is_relative()) env_file = (_snakefile_relative_path.parent_path() / env_file).lexically_normal();
+      (*target)[env_file] = true;
+    }
+  }
+  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::const_iterator iter =
+           _included_files.begin();
+       iter != _included_files.end(); ++iter) {
+    iter->second->report_conda_envs(rule_names, target);
+  }
+}
+
 void snakemake_unit_tests::snakemake_file::detect_known_issues(const std::map<std::string, bool> &include_rules,
                                                                const std::map<std::string, bool> &exclude_rules) {
   /*
@@ -158,33 +241,51 @@ void snakemake_unit_tests::snakemake_file::load_lines(const boost::filesystem::p
 
 void snakemake_unit_tests::snakemake_file::parse_file(const std::vector<std::string> &loaded_lines,
                                                       const boost::filesystem::path &filename, bool verbose) {
+  std::vector<logical_line> lines;
+  as_logical_lines(loaded_lines, &lines);
+  parse_file(lines, filename, verbose);
+}
+
+void snakemake_unit_tests::snakemake_file::parse_file(const std::vector<logical_line> &loaded_lines,
+                                                      const boost::filesystem::path &filename, bool verbose) {
   _snakefile_relative_path = filename;
   // track current line
   unsigned current_line = 0;
+  // blocks are parsed in place into a single contiguous arena
+  boost::shared_ptr<std::vector<rule_block> > arena(new std::vector<rule_block>);
   while (current_line < loaded_lines.size()) {
-    boost::shared_ptr<rule_block> rb(new rule_block);
-    if (rb->load_content_block(loaded_lines, verbose, &current_line)) {
+    arena->emplace_back();
+    rule_block &rb = *arena->rbegin();
+    if (rb.load_content_block(loaded_lines, verbose, &current_line)) {
       // set python interpreter resolution status
       // rules should all be set to unresolved before first pass
       // and ambiguous include directives need a complicated resolution pass
-      if (!rb->get_rule_name().empty() || rb->contains_include_directive()) {
-        rb->set_resolution(UNRESOLVED);
-        rb->set_interpreter_tag(*_tag_counter);
+      if (!rb.get_rule_name().empty() || rb.contains_include_directive()) {
+        rb.set_resolution(UNRESOLVED);
+        rb.set_interpreter_tag(*_tag_counter);
         ++*_tag_counter;
       } else {
         // all other contents are good to go, to be handled by interpreter later
-        rb->set_resolution(RESOLVED_INCLUDED);
+        rb.set_resolution(RESOLVED_INCLUDED);
       }
-      _blocks.push_back(rb);
+    } else {
+      arena->pop_back();
     }
   }
+  arena->shrink_to_fit();
+  // handles alias into the arena, which lives as long as any of them
+  _blocks.reserve(_blocks.size() + arena->size());
+  for (std::vector<rule_block>::size_type i = 0; i < arena->size(); ++i) {
+    _blocks.push_back(boost::shared_ptr<rule_block>(arena, &(*arena)[i]));
+  }
 }
 
 unsigned snakemake_unit_tests::snakemake_file::report_single_rule(const std::map<std::string, bool> &rule_names,
                                                                   std::ostream &out) const {
   // find the requested rule
   unsigned found_rule_count = 0;
-  for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = get_blocks().begin();
+  std::string buffer;
+  for (std::vector<boost::shared_ptr<rule_block> >::const_iterator iter = get_blocks().begin();
        iter != get_blocks().end(); ++iter) {
     // if this is the rule, that's great
     bool is_target = false;
@@ -197,18 +298,70 @@ unsigned snakemake_unit_tests::snakemake_file::report_single_rule(const std::map
     // report it to the synthetic snakefile
     // new: respect rule's inclusion status
     if ((is_target && (*iter)->included()) || (*iter)->get_rule_name().empty()) {
-      (*iter)->print_contents(out);
+      (*iter)->render_contents(&buffer);
     } else {
-      for (unsigned i = 0; i < (*iter)->get_local_indentation(); ++i) out << ' ';
-      out << "pass" << std::endl << std::endl << std::endl;
+      buffer.append((*iter)->get_local_indentation(), ' ');
+      buffer.append("pass\n\n\n");
     }
   }
+  if (!out.write(buffer.data(), buffer.size())) throw std::runtime_error("synthetic snakefile printing error");
   // return number of the target rules found
   return found_rule_count;
 }
 
+unsigned snakemake_unit_tests::snakemake_file::select_rendered_segments(const std::map<std::string, bool> &rule_names,
+                                                                        std::vector<std::string_view> *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to select_rendered_segments");
+  if (!_segments_rendered) throw std::logic_error("select_rendered_segments called before render_segments");
+  unsigned found_rule_count = 0;
+  for (std::vector<rendered_segment>::const_iterator iter = _segments.begin(); iter != _segments.end(); ++iter) {
+    if (iter->rule_name.empty()) {
+      target->push_back(iter->text);
+    } else if (rule_names.find(iter->rule_name) != rule_names.end()) {
+      target->push_back(iter->text);
+      ++found_rule_count;
+    } else {
+      target->push_back(iter->stub);
+    }
+  }
+  return found_rule_count;
+}
+
+void snakemake_unit_tests::snakemake_file::render_segments() {
+  _segments.clear();
+  for (std::vector<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
+       ++iter) {
+    // only included rules can ever be requested; everything else is fixed text
+    if (!(*iter)->get_rule_name().empty() && (*iter)->included()) {
+      _segments.push_back(rendered_segment());
+      rendered_segment &segment = *_segments.rbegin();
+      segment.rule_name = (*iter)->get_rule_name();
+      (*iter)->render_contents(&segment.text);
+      segment.stub.assign((*iter)->get_local_indentation(), ' ');
+      segment.stub.append("pass\n\n\n");
+      continue;
+    }
+    // merge runs of fixed text into a single segment
+    if (_segments.empty() || !_segments.rbegin()->rule_name.empty()) {
+      _segments.push_back(rendered_segment());
+    }
+    std::string &text = _segments.rbegin()->text;
+    if ((*iter)->get_rule_name().empty()) {
+      (*iter)->render_contents(&text);
+    } else {
+      text.append((*iter)->get_local_indentation(), ' ');
+      text.append("pass\n\n\n");
+    }
+  }
+  _segments_rendered = true;
+  for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::iterator iter = _included_files.begin();
+       iter != _included_files.end(); ++iter) {
+    iter->second->render_segments();
+  }
+}
+
 bool snakemake_unit_tests::snakemake_file::fully_resolved() const {
-  for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
+  for (std::vector<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
        ++iter) {
     if (!(*iter)->resolved()) return false;
   }
@@ -217,7 +370,7 @@ bool snakemake_unit_tests::snakemake_file::fully_resolved() const {
 
 bool snakemake_unit_tests::snakemake_file::contains_blockers() const {
   bool res = _updated_last_round;
-  for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
+  for (std::vector<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
        ++iter) {
     res |= !(*iter)->resolved();
   }
@@ -238,8 +391,8 @@ bool snakemake_unit_tests::snakemake_file::resolve_with_python(const boost::file
     // set this file and all its dependencies to no update
     set_update_status(false);
   }
-  // within a workspace, open a snakefile
-  std::ofstream output;
+  // within a workspace, render a snakefile
+  std::string output;
   boost::filesystem::path output_name = workspace / get_snakefile_relative_path();
   if (verbose) {
     std::cout << "\toutput workspace: \"" << workspace.string() << "\"" << std::endl
@@ -251,12 +404,9 @@ bool snakemake_unit_tests::snakemake_file::resolve_with_python(const boost::file
   if (verbose) {
     std::cout << "\twriting interpreter snakefile " << output_name.string() << std::endl;
   }
-  output.open(output_name.string().c_str());
-  if (!output.is_open())
-    throw std::runtime_error("cannot write interpreter snakefile to file \"" + output_name.string() + "\"");
   // write python reporting code
   bool reporting_terminated = false;
-  for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = get_blocks().begin();
+  for (std::vector<boost::shared_ptr<rule_block> >::const_iterator iter = get_blocks().begin();
        iter != get_blocks().end() && !reporting_terminated; ++iter) {
     // ask the rule to report the python equivalent of its contents
     /* new: disable logging reporting after the first include statement
@@ -269,10 +419,15 @@ bool snakemake_unit_tests::snakemake_file::resolve_with_python(const boost::file
        is reported.
     */
     // true return value means the reporter hit an unresolved include
-    if ((*iter)->report_python_logging_code(output)) {
+    if ((*iter)->render_python_logging_code(&output)) {
       reporting_terminated = true;
     }
   }
+  // only from the top-level call, so not during recursion
+  if (!disable_resolution) {
+    output.append("rule tmp:\n    output: \"tmp.txt\",\n");
+  }
+  write_segments(output_name.string(), std::vector<std::string_view>(1, output));
   // handle recursive reporters
   for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::iterator iter = _included_files.begin();
        iter != _included_files.end() && !reporting_terminated; ++iter) {
@@ -285,8 +440,6 @@ bool snakemake_unit_tests::snakemake_file::resolve_with_python(const boost::file
   }
   // only from the top-level call, so not during recursion
   if (!disable_resolution) {
-    if (!(output << "rule tmp:" << std::endl << "    output: \"tmp.txt\"," << std::endl))
-      throw std::runtime_error("cannot write tmp output rule to python reporter");
     // adjust snakefile such that it is relative to the run directory
     boost::filesystem::path complete_run_directory = boost::filesystem::canonical(pipeline_top_dir / pipeline_run_dir);
     boost::filesystem::path complete_snakefile_loc =
@@ -296,14 +449,35 @@ bool snakemake_unit_tests::snakemake_file::resolve_with_python(const boost::file
     if (verbose) {
       std::cout << "\texecuting snakemake" << std::endl;
     }
-    std::vector<std::string> results =
-        exec("cd " + (workspace / pipeline_run_dir).string() + " && snakemake -nFs " + adjusted_snakefile, true);
-    // capture the resulting tags for updating completion status
+    // capture the resulting tags for updating completion status as output arrives
     std::map<std::string, std::string> tag_values;
-    capture_python_tag_values(results, &tag_values);
+    std::vector<std::string> args;
+    args.push_back("snakemake");
+    args.push_back("-nFs");
+    args.push_back(adjusted_snakefile);
+    subprocess_options options;
+    options.working_directory = (workspace / pipeline_run_dir).string();
+    options.timeout_seconds = _subprocess_timeout;
+    // an error early in a long dry run must still be reported
+    options.error_log_lines = 0;
+    options.stdout_callback = [&](std::string_view line) { capture_python_tag_value(line, &tag_values); };
+    // snakemake's own complaints are only shown on failure, unless requested
+    options.stderr_callback = [&](std::string_view line) {
+      if (verbose) std::cerr << line;
+    };
+    subprocess_record record;
+    record.label = "python resolution pass " + std::to_string(_subprocess_records.size() + 1);
+    record.working_directory = options.working_directory;
+    {
+      tracer::span subprocess_span(profiler::tracer_of(_profiler), "snakemake", "subprocess");
+      subprocess_span.add_arg("label", record.label);
+      subprocess_span.add_arg("working_directory", record.working_directory);
+      record.result = run_subprocess(args, options);
+    }
+    _subprocess_records.push_back(record);
+    if (_profiler) _profiler->count_subprocess();
     process_python_results(workspace, pipeline_top_dir, verbose, tag_values, output_name);
   }
-  output.close();
   if (verbose) {
     std::cout << "\tpython pass complete" << std::endl;
   }
@@ -315,9 +489,18 @@ bool snakemake_unit_tests::snakemake_file::process_python_results(const boost::f
                                                                   bool verbose,
                                                                   const std::map<std::string, std::string> &tag_values,
                                                                   const boost::filesystem::path &output_name) {
-  std::vector<std::string> loaded_lines;
+  // resolution status may change, so any existing rule index is stale
+  _rule_index.clear();
+  _rule_index_built = false;
+  _segments.clear();
+  _segments_rendered = false;
+  // include directives resolved by this pass, in file order: (full path to file, output path)
+  std::vector<std::pair<boost::filesystem::path, boost::filesystem::path> > includes;
+  // newly discovered files are parsed together before any of them is added
+  std::vector<std::pair<boost::filesystem::path, boost::filesystem::path> > pending_loads;
+  std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> > parsed;
   // update rule block status based on python report
-  for (std::list<boost::shared_ptr<rule_block> >::iterator iter = _blocks.begin(); iter != _blocks.end(); ++iter) {
+  for (std::vector<boost::shared_ptr<rule_block> >::iterator iter = _blocks.begin(); iter != _blocks.end(); ++iter) {
     // if the block reports that it was an include directive
     (*iter)->update_resolution(tag_values);
     if ((*iter)->contains_include_directive() && !(*iter)->get_resolved_included_filename().empty()) {
@@ -326,86 +509,137 @@ bool snakemake_unit_tests::snakemake_file::process_python_results(const boost::f
       }
       // include statements are relative to the directory of the snakefile in which they're included
       boost::filesystem::path recursive_path = output_name.parent_path() / (*iter)->get_resolved_included_filename();
-      std::string recursive_str = recursive_path.string();
-      // since the workflow may be installed in nonstandard places, find where it is relative to the test workspace
-      recursive_str = recursive_str.substr(recursive_str.find(workspace.string()) + workspace.string().size() + 1);
-      // determine if this was included already
-      std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::iterator file_finder;
       std::string input_name = output_name.string();
+      // since the workflow may be installed in nonstandard places, find where it is relative to the test workspace
       boost::filesystem::path computed_relative_suffix =
           boost::filesystem::path(input_name.substr(input_name.find(workspace.string()) + workspace.size() + 1))
               .parent_path() /
           (*iter)->get_resolved_included_filename();
       input_name = (pipeline_top_dir / computed_relative_suffix).string();
-
-      if ((file_finder = _included_files.find(boost::filesystem::path(input_name))) != _included_files.end()) {
-        // it was already loaded. recurse into that loaded file
-        if (verbose)
-          std::cout << "\t\tthe file \"" << file_finder->first.string()
-                    << "\" was already loaded, passing python "
-                       "results along to it"
-                    << std::endl;
-        file_finder->second->process_python_results(workspace, pipeline_top_dir, verbose, tag_values, recursive_path);
-      } else {
-        if (verbose) {
-          std::cout << "cannot find tag " << boost::filesystem::path(input_name) << " in already included files"
-                    << std::endl;
-          for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::const_iterator mapper =
-                   _included_files.begin();
-               mapper != _included_files.end(); ++mapper) {
-            std::cout << "\tcandidate: " << mapper->first << std::endl;
-          }
+      includes.push_back(std::make_pair(boost::filesystem::path(input_name), recursive_path));
+      // the same file may be included more than once in a single pass; it is parsed once
+      if (_included_files.find(boost::filesystem::path(input_name)) == _included_files.end() &&
+          parsed.find(boost::filesystem::path(input_name)) == parsed.end()) {
+        parsed[boost::filesystem::path(input_name)] = boost::shared_ptr<snakemake_file>();
+        pending_loads.push_back(std::make_pair(boost::filesystem::path(input_name), computed_relative_suffix));
+      }
+    }
+  }
+  if (!pending_loads.empty()) {
+    load_included_files(pending_loads, verbose, &parsed);
+    // always flag as updated when new file is loaded
+    _updated_last_round = true;
+  }
+  // visit the directives in file order, as a serial load would have: a new file takes its
+  // tags when first included, and a file already loaded, even earlier in this pass,
+  // has the python results passed along to it, so tags are assigned depth first
+  for (std::vector<std::pair<boost::filesystem::path, boost::filesystem::path> >::const_iterator iter =
+           includes.begin();
+       iter != includes.end(); ++iter) {
+    std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::iterator file_finder;
+    if ((file_finder = _included_files.find(iter->first)) != _included_files.end()) {
+      // it was already loaded. recurse into that loaded file
+      if (verbose)
+        std::cout << "\t\tthe file \"" << file_finder->first.string()
+                  << "\" was already loaded, passing python "
+                     "results along to it"
+                  << std::endl;
+      file_finder->second->process_python_results(workspace, pipeline_top_dir, verbose, tag_values, iter->second);
+    } else {
+      boost::shared_ptr<snakemake_file> ptr = parsed[iter->first];
+      if (verbose) {
+        std::cout << "cannot find tag " << iter->first << " in already included files" << std::endl;
+        for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::const_iterator mapper =
+                 _included_files.begin();
+             mapper != _included_files.end(); ++mapper) {
+          std::cout << "\tcandidate: " << mapper->first << std::endl;
         }
         // it updated itself to an unambiguous include directive. include it.
-        // need the location in input
-        if (verbose) {
-          std::cout << "\t\toutput name \"" << output_name << "\"" << std::endl
-                    << "\t\tinput name: \"" << input_name << "\"" << std::endl
-                    << "\t\tworkspace: \"" << workspace << "\"" << std::endl
-                    << "\t\tsuffix relative to pipeline dir: \"" << computed_relative_suffix.string() << "\""
-                    << std::endl
-                    << "\t\tresolved inclusion: \"" << (*iter)->get_resolved_included_filename() << "\"" << std::endl;
-        }
-        load_lines(input_name, &loaded_lines);
-        if (verbose)
-          std::cout << "\t\tthe file has not been loaded before, loading it now: " << input_name << std::endl;
-        loaded_lines = lexical_parse(loaded_lines, verbose);
-        if (verbose) std::cout << "\t\t\tlexical parse successful" << std::endl;
-        boost::shared_ptr<snakemake_file> ptr(new snakemake_file(_tag_counter));
-        ptr->parse_file(loaded_lines, computed_relative_suffix, verbose);
-        _included_files[boost::filesystem::path(input_name)] = ptr;
-        // always flag as updated when new file is loaded
-        _updated_last_round = true;
+        std::cout << "\t\toutput name \"" << output_name << "\"" << std::endl
+                  << "\t\tinput name: \"" << iter->first.string() << "\"" << std::endl
+                  << "\t\tworkspace: \"" << workspace << "\"" << std::endl
+                  << "\t\tsuffix relative to pipeline dir: \"" << ptr->get_snakefile_relative_path().string() << "\""
+                  << std::endl;
       }
+      ptr->rebase_interpreter_tags(_tag_counter);
+      _included_files[iter->first] = ptr;
     }
   }
   return true;
 }
 
+void snakemake_unit_tests::snakemake_file::load_included_files(
+    const std::vector<std::pair<boost::filesystem::path, boost::filesystem::path> > &requests, bool verbose,
+    std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> > *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to load_included_files");
+  // each file is parsed with a private tag counter, so workers share no state
+  std::vector<boost::shared_ptr<snakemake_file> > parsed(requests.size());
+  boost::shared_ptr<tracer> trace_target = profiler::tracer_of(_profiler);
+  run_in_parallel(requests.size(), verbose ? 1 : 0, [&](unsigned i) {
+    tracer::span parse_span(trace_target, "load included file", "parse");
+    parse_span.add_arg("file", requests.at(i).second.string());
+    if (verbose)
+      std::cout << "\t\tthe file has not been loaded before, loading it now: " << requests.at(i).first.string()
+                << std::endl;
+    lexed_file loaded_lines(requests.at(i).first, verbose);
+    if (verbose) std::cout << "\t\t\tlexical parse successful" << std::endl;
+    boost::shared_ptr<snakemake_file> ptr(new snakemake_file);
+    ptr->parse_file(loaded_lines.get_lines(), requests.at(i).second, verbose);
+    parsed.at(i) = ptr;
+  });
+  for (unsigned i = 0; i < requests.size(); ++i) {
+    (*target)[requests.at(i).first] = parsed.at(i);
+  }
+}
+
+void snakemake_unit_tests::snakemake_file::rebase_interpreter_tags(boost::shared_ptr<unsigned> ptr) {
+  if (!ptr) throw std::runtime_error("null pointer provided to rebase_interpreter_tags");
+  for (std::vector<boost::shared_ptr<rule_block> >::iterator iter = _blocks.begin(); iter != _blocks.end(); ++iter) {
+    // tag==0 entries are python code that doesn't require inclusion tracking
+    if ((*iter)->get_interpreter_tag()) {
+      (*iter)->set_interpreter_tag((*iter)->get_interpreter_tag() - 1 + *ptr);
+    }
+  }
+  *ptr += *_tag_counter - 1;
+  _tag_counter = ptr;
+}
+
 void snakemake_unit_tests::snakemake_file::capture_python_tag_values(const std::vector<std::string> &vec,
                                                                      std::map<std::string, std::string> *target) const {
-  const boost::regex tag_value_pair("^(tag[0-9]+): *(.*) *[\r\n]+$");
-  const boost::regex tag_alone("^(tag[0-9]+) *[\r\n]+$");
-  boost::smatch tag_match;
   if (!target) throw std::runtime_error("null pointer provided to capture_python_tag_values");
   // for each line of output
   for (std::vector<std::string>::const_iterator iter = vec.begin(); iter != vec.end(); ++iter) {
+    capture_python_tag_value(*iter, target);
+  }
+}
+
+void snakemake_unit_tests::snakemake_file::capture_python_tag_value(std::string_view line,
+                                                                    std::map<std::string, std::string> *target) const {
+  static const boost::regex tag_value_pair("^(tag[0-9]+): *(.*) *[\r\n]+$");
+  static const boost::regex tag_alone("^(tag[0-9]+) *[\r\n]+$");
+  boost::cmatch tag_match;
+  if (!target) throw std::runtime_error("null pointer provided to capture_python_tag_value");
+  // in snakemake interpreter mode, lines without tags are ignored
+  if (line.compare(0, 3, "tag")) return;
+  if (boost::regex_match(line.data(), line.data() + line.size(), tag_match, tag_value_pair)) {
     // match format "tag#: value"
-    if (boost::regex_match(*iter, tag_match, tag_value_pair)) {
-      (*target)[tag_match[1].str()] = tag_match[2].str();
-    } else if (boost::regex_match(*iter, tag_match, tag_alone)) {
-      // match format "tag#"
-      (*target)[tag_match[1].str()] = "";
-    } else {
-      // in snakemake interpreter mode, just ignore this
-      continue;
-    }
+    (*target)[tag_match[1].str()] = tag_match[2].str();
+  } else if (boost::regex_match(line.data(), line.data() + line.size(), tag_match, tag_alone)) {
+    // match format "tag#"
+    (*target)[tag_match[1].str()] = "";
   }
 }
 
 bool snakemake_unit_tests::snakemake_file::get_base_rule_name(const std::string &name, std::string *target) const {
   if (!target) throw std::runtime_error("null pointer to get_base_rule_name");
-  for (std::list<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
+  if (_rule_index_built) {
+    std::map<std::string, std::vector<std::pair<boost::shared_ptr<rule_block>, const snakemake_file *> > >::
+        const_iterator finder = _rule_index.find(name);
+    if (finder == _rule_index.end()) return false;
+    *target = finder->second.begin()->first->get_base_rule_name();
+    return true;
+  }
+  for (std::vector<boost::shared_ptr<rule_block> >::const_iterator iter = _blocks.begin(); iter != _blocks.end();
        ++iter) {
     if (!(*iter)->included()) {
       continue;
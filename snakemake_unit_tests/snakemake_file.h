@@ -12,19 +12,43 @@
 
 #include <array>
 #include <deque>
-#include <list>
 #include <map>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "boost/filesystem.hpp"
 #include "boost/smart_ptr.hpp"
+#include "snakemake_unit_tests/lexed_file.h"
+#include "snakemake_unit_tests/profiler.h"
 #include "snakemake_unit_tests/rule_block.h"
+#include "snakemake_unit_tests/utilities.h"
 
 namespace snakemake_unit_tests {
 /*!
+@brief pre-rendered text of a run of blocks from a snakefile
+
+shared segments are emitted unchanged in every synthetic snakefile.
+rule segments are emitted as full text when the rule is requested,
+and as a placeholder otherwise.
+*/
+struct rendered_segment {
+  /*!
+  @brief name of rule, or empty for shared content
+ */
+  std::string rule_name;
+  /*!
+  @brief rendered text: full rule for rule segments
+ */
+  std::string text;
+  /*!
+  @brief placeholder text for rule segments, when the rule is not requested
+ */
+  std::string stub;
+};
+/*!
 @class snakemake_file
 @brief abstract representation of snakefile
 as a series of rules and python code chunks
@@ -34,7 +58,8 @@ class snakemake_file {
   /*!
   @brief default constructor
  */
-  snakemake_file() : _tag_counter(0), _updated_last_round(true) {
+  snakemake_file() : _tag_counter(0), _updated_last_round(true), _rule_index_built(false), _segments_rendered(false),
+        _subprocess_timeout(0.0) {
     _tag_counter.reset(new unsigned);
     *_tag_counter = 1;
   }
@@ -43,7 +68,12 @@ class snakemake_file {
   an initialized counter
   @param ptr pre-initialized counter, from root file
  */
-  explicit snakemake_file(boost::shared_ptr<unsigned> ptr) : _tag_counter(ptr), _updated_last_round(true) {}
+  explicit snakemake_file(boost::shared_ptr<unsigned> ptr)
+      : _tag_counter(ptr),
+        _updated_last_round(true),
+        _rule_index_built(false),
+        _segments_rendered(false),
+        _subprocess_timeout(0.0) {}
   /*!
   @brief copy constructor
   @param obj existing snakemake_file object
@@ -53,7 +83,14 @@ class snakemake_file {
         _snakefile_relative_path(obj._snakefile_relative_path),
         _included_files(obj._included_files),
         _tag_counter(obj._tag_counter),
-        _updated_last_round(obj._updated_last_round) {}
+        _updated_last_round(obj._updated_last_round),
+        _rule_index(obj._rule_index),
+        _rule_index_built(obj._rule_index_built),
+        _segments(obj._segments),
+        _segments_rendered(obj._segments_rendered),
+        _subprocess_timeout(obj._subprocess_timeout),
+        _subprocess_records(obj._subprocess_records),
+        _profiler(obj._profiler) {}
   /*!
   @brief destructor
  */
@@ -75,6 +112,15 @@ class snakemake_file {
  logging output
 */
   void parse_file(const std::vector<std::string> &loaded_lines, const boost::filesystem::path &filename, bool verbose);
+  /*!
+ @brief parse a lexed snakemake file
+ @param loaded_lines logical lines of file to parse
+ @param filename name of file for informative errors
+ @param verbose whether to emit verbose
+ logging output
+*/
+  void parse_file(const std::vector<logical_line> &loaded_lines, const boost::filesystem::path &filename,
+                  bool verbose);
 
   /*!
   @brief load all lines from a file into memory
@@ -96,15 +142,15 @@ class snakemake_file {
 
   /*!
   @brief get const access to internal block representation
-  @return const reference to internal block list
+  @return const reference to internal block handles, in file order
  */
-  const std::list<boost::shared_ptr<rule_block>> &get_blocks() const { return _blocks; }
+  const std::vector<boost::shared_ptr<rule_block>> &get_blocks() const { return _blocks; }
 
   /*!
   @brief get mutable access to internal block representation
-  @return non-const reference to internal block list
+  @return non-const reference to internal block handles, in file order
  */
-  std::list<boost::shared_ptr<rule_block>> &get_blocks() { return _blocks; }
+  std::vector<boost::shared_ptr<rule_block>> &get_blocks() { return _blocks; }
 
   /*!
   @brief report all code blocks but a single requested rule to file
@@ -114,6 +160,33 @@ class snakemake_file {
  */
   unsigned report_single_rule(const std::map<std::string, bool> &rule_names, std::ostream &out) const;
 
+  /*!
+  @brief select the pre-rendered text for a set of requested rules
+  @param rule_names string names of requested rules
+  @param target where to append views of the selected text, in file order
+  @return how many target rules are present in this file
+
+  produces exactly the content of report_single_rule, but requires
+  render_segments to have been called. views remain valid until
+  segments are rendered again.
+ */
+  unsigned select_rendered_segments(const std::map<std::string, bool> &rule_names,
+                                    std::vector<std::string_view> *target) const;
+
+  /*!
+  @brief render all blocks in this file and all dependencies into segments
+
+  called by postflight_checks once python resolution is complete; processing
+  further python results discards the segments.
+ */
+  void render_segments();
+
+  /*!
+  @brief whether pre-rendered segments are available for this file
+  @return whether pre-rendered segments are available for this file
+ */
+  bool segments_rendered() const { return _segments_rendered; }
+
   /*!
   @brief whether the object's rules are unambiguously resolved
   @return whether the object's rules are unambiguously resolved
@@ -174,6 +247,14 @@ class snakemake_file {
  */
   void capture_python_tag_values(const std::vector<std::string> &vec, std::map<std::string, std::string> *target) const;
   /*!
+  @brief parse a single line of python reporting output to a tag or tag and value
+  @param line captured line from python output, including its newline
+  @param target results collector
+
+  lines without tags are ignored, so this can be applied to output as it arrives
+ */
+  void capture_python_tag_value(std::string_view line, std::map<std::string, std::string> *target) const;
+  /*!
   @brief resolve derived rules and check for sanity
   @param include_rules flagged rules to be included
   @param exclude_rules flagged rules to be excluded
@@ -213,6 +294,24 @@ class snakemake_file {
  */
   void report_rules(std::map<std::string, std::vector<boost::shared_ptr<rule_block>>> *aggregated_rules) const;
 
+  /*!
+  @brief report rule reference graph across this file and all dependencies
+  @param target for each included rule, the rules it names through `rules.` or `checkpoints.`
+ */
+  void report_rule_references(std::map<std::string, std::map<std::string, bool>> *target) const;
+
+  /*!
+  @brief report conda environment files of requested rules in this file and all dependencies
+  @param rule_names string names of requested rules
+  @param target for each environment file, its path relative to pipeline top level
+
+  as snakemake does, paths are taken relative to the snakefile declaring the rule.
+  only literal paths to yaml files are found; environments named by expressions,
+  or by name, are left for snakemake to resolve.
+ */
+  void report_conda_envs(const std::map<std::string, bool> &rule_names,
+                         std::map<boost::filesystem::path, bool> *target) const;
+
   /*!
     @brief for a single rule, get base rule name
     @param name name of rule to query
@@ -221,13 +320,82 @@ class snakemake_file {
   */
   bool get_base_rule_name(const std::string &name, std::string *target) const;
 
+  /*!
+    @brief index all included rules in this file and all dependencies by name
+
+    the index is built by postflight_checks, once python resolution is complete,
+    and is discarded if further python results are processed. until it is built,
+    rule queries fall back to scanning the include tree.
+   */
+  void build_rule_index();
+
+  /*!
+    @brief whether the rule index is available
+    @return whether the rule index is available
+   */
+  bool rule_index_built() const { return _rule_index_built; }
+
+  /*!
+    @brief set the wall-clock limit for each snakemake run during python resolution
+    @param seconds limit in seconds, or 0 for no limit
+   */
+  void set_subprocess_timeout(double seconds) { _subprocess_timeout = seconds; }
+  /*!
+    @brief get the wall-clock limit for each snakemake run during python resolution
+    @return limit in seconds, or 0 for no limit
+   */
+  double get_subprocess_timeout() const { return _subprocess_timeout; }
+  /*!
+    @brief get resource use of the snakemake runs made during python resolution
+    @return records of each run, in order
+   */
+  const std::vector<subprocess_record> &get_subprocess_records() const { return _subprocess_records; }
+  /*!
+    @brief attach a profiler, to which snakemake runs during python resolution are reported
+    @param ptr profiler shared with the caller, or null to stop reporting
+   */
+  void set_profiler(boost::shared_ptr<profiler> ptr) { _profiler = ptr; }
+
  private:
   friend class snakemake_fileTest;
   friend class solved_rulesTest;
   /*!
+  @brief load, lex, and parse a set of newly discovered included files
+  @param requests pairs of (full path to file, path relative to pipeline top level)
+  @param verbose whether to emit verbose logging output
+  @param target map of full path to parsed file, in which to store the results
+
+  files are processed concurrently, each with its own tag counter starting from 1;
+  the caller moves them into the shared tag sequence with rebase_interpreter_tags,
+  in the order a serial load would have reached them. verbose logging forces
+  serial loading, to keep the logging output readable.
+ */
+  void load_included_files(const std::vector<std::pair<boost::filesystem::path, boost::filesystem::path>> &requests,
+                           bool verbose,
+                           std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file>> *target) const;
+  /*!
+  @brief move this file's python tags into a shared tag sequence
+  @param ptr shared counter of assigned tags, from root file
+
+  the file is expected to have been parsed with its own private counter
+  starting from 1; its tags are shifted to begin at the current value of the
+  shared counter, which is then advanced past them
+ */
+  void rebase_interpreter_tags(boost::shared_ptr<unsigned> ptr);
+  /*!
+  @brief add included rules in this file and all dependencies to a rule index
+  @param target index in which to store rules, in file traversal order
+ */
+  void index_rules(
+      std::map<std::string, std::vector<std::pair<boost::shared_ptr<rule_block>, const snakemake_file *>>> *target)
+      const;
+  /*!
   @brief minimal contents of snakemake file as blocks of code
+
+  blocks loaded by parse_file are stored contiguously in a per-file
+  arena; these handles share ownership of that arena
  */
-  std::list<boost::shared_ptr<rule_block>> _blocks;
+  std::vector<boost::shared_ptr<rule_block>> _blocks;
   /*!
   @brief relative path to source snakefile from top level pipeline dir
  */
@@ -244,6 +412,36 @@ class snakemake_file {
   @brief whether any contained block updated its inclusion status last update
  */
   bool _updated_last_round;
+  /*!
+  @brief included rules by name, with the file in which each was declared
+
+  rules with the same name are stored in the order report_rules would find them
+ */
+  std::map<std::string, std::vector<std::pair<boost::shared_ptr<rule_block>, const snakemake_file *>>> _rule_index;
+  /*!
+  @brief whether _rule_index reflects the current resolution state
+ */
+  bool _rule_index_built;
+  /*!
+  @brief pre-rendered contents of this file, in order
+ */
+  std::vector<rendered_segment> _segments;
+  /*!
+  @brief whether _segments reflects the current resolution state
+ */
+  bool _segments_rendered;
+  /*!
+  @brief wall-clock limit for each snakemake run, or 0 for no limit
+ */
+  double _subprocess_timeout;
+  /*!
+  @brief resource use of snakemake runs made from this file
+ */
+  std::vector<subprocess_record> _subprocess_records;
+  /*!
+  @brief optional profiler counting snakemake runs
+ */
+  boost::shared_ptr<profiler> _profiler;
 };
 }  // namespace snakemake_unit_tests
 
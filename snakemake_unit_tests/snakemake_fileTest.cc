@@ -32,6 +32,9 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_default_const
   CPPUNIT_ASSERT(sf._tag_counter.get());
   CPPUNIT_ASSERT_EQUAL(1u, *sf._tag_counter);
   CPPUNIT_ASSERT(sf._updated_last_round);
+  CPPUNIT_ASSERT(sf.get_subprocess_timeout() == 0.0);
+  CPPUNIT_ASSERT(sf.get_subprocess_records().empty());
+  CPPUNIT_ASSERT(!sf._profiler);
 }
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_pointer_constructor() {
   boost::shared_ptr<unsigned> ptr(new unsigned);
@@ -53,6 +56,10 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_copy_construc
   sf1._included_files["/other/path"] = ptr_sf;
   *sf1._tag_counter = 55u;
   sf1._updated_last_round = false;
+  sf1.set_subprocess_timeout(45.0);
+  sf1._subprocess_records.push_back(subprocess_record());
+  boost::shared_ptr<profiler> prof(new profiler);
+  sf1.set_profiler(prof);
   snakemake_file sf2(sf1);
   CPPUNIT_ASSERT(sf2._blocks.size() == 1u);
   CPPUNIT_ASSERT(*(sf2._blocks.begin()) == ptr_rb);
@@ -62,6 +69,9 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_copy_construc
   CPPUNIT_ASSERT(sf2._included_files["/other/path"] == ptr_sf);
   CPPUNIT_ASSERT_EQUAL(55u, *sf2._tag_counter);
   CPPUNIT_ASSERT(!sf2._updated_last_round);
+  CPPUNIT_ASSERT(sf2.get_subprocess_timeout() == 45.0);
+  CPPUNIT_ASSERT(sf2.get_subprocess_records().size() == 1u);
+  CPPUNIT_ASSERT(sf2._profiler == prof);
 }
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_load_everything() {}
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_parse_file() {
@@ -74,7 +84,7 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_parse_file()
   sf.parse_file(loaded_lines, "fakefile", false);
   CPPUNIT_ASSERT(!sf._snakefile_relative_path.compare("fakefile"));
   CPPUNIT_ASSERT(sf._blocks.size() == 3);
-  std::list<boost::shared_ptr<rule_block> >::iterator iter = sf._blocks.begin();
+  std::vector<boost::shared_ptr<rule_block> >::iterator iter = sf._blocks.begin();
   CPPUNIT_ASSERT(!(*iter)->_rule_name.compare("rule1"));
   CPPUNIT_ASSERT((*iter)->_named_blocks.size() == 1);
   CPPUNIT_ASSERT(!(*iter)->_named_blocks.at(0).first.compare("input"));
@@ -93,6 +103,52 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_parse_file()
   CPPUNIT_ASSERT((*iter)->_resolution == RESOLVED_INCLUDED);
   CPPUNIT_ASSERT(*sf._tag_counter == 3);
 }
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_parse_file_contiguous() {
+  std::vector<std::string> loaded_lines;
+  loaded_lines.push_back("rule rule1:");
+  loaded_lines.push_back("    input: 'filename',");
+  loaded_lines.push_back("x = 1");
+  loaded_lines.push_back("rule rule2:");
+  loaded_lines.push_back("    output: 'filename',");
+  boost::shared_ptr<rule_block> last;
+  {
+    snakemake_file sf;
+    sf.parse_file(loaded_lines, "fakefile", false);
+    CPPUNIT_ASSERT(sf._blocks.size() == 3);
+    // parsed blocks are stored by value, one after another
+    CPPUNIT_ASSERT(sf._blocks.at(1).get() == sf._blocks.at(0).get() + 1);
+    CPPUNIT_ASSERT(sf._blocks.at(2).get() == sf._blocks.at(0).get() + 2);
+    last = sf._blocks.at(2);
+  }
+  // handles keep the storage alive after the file is gone
+  CPPUNIT_ASSERT(!last->get_rule_name().compare("rule2"));
+  CPPUNIT_ASSERT(last->get_named_blocks().size() == 1u);
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_report_rule_references() {
+  std::vector<std::string> loaded_lines;
+  loaded_lines.push_back("rule rule1:");
+  loaded_lines.push_back("    input: rules.rule0.output,");
+  loaded_lines.push_back("rule rule2:");
+  loaded_lines.push_back("    input: rules.rule1.output, checkpoints.rule0.get().output,");
+  loaded_lines.push_back("rule rule3:");
+  loaded_lines.push_back("    input: rules.rule4.output,");
+  snakemake_file sf;
+  sf.parse_file(loaded_lines, "fakefile", false);
+  for (std::vector<boost::shared_ptr<rule_block> >::iterator iter = sf._blocks.begin(); iter != sf._blocks.end();
+       ++iter) {
+    (*iter)->set_resolution(RESOLVED_INCLUDED);
+  }
+  // excluded rules do not contribute
+  sf._blocks.at(2)->set_resolution(RESOLVED_EXCLUDED);
+  std::map<std::string, std::map<std::string, bool> > references;
+  sf.report_rule_references(&references);
+  CPPUNIT_ASSERT(references.size() == 2u);
+  CPPUNIT_ASSERT(references["rule1"].size() == 1u);
+  CPPUNIT_ASSERT(references["rule1"].find("rule0") != references["rule1"].end());
+  CPPUNIT_ASSERT(references["rule2"].size() == 2u);
+  CPPUNIT_ASSERT(references["rule2"].find("rule0") != references["rule2"].end());
+  CPPUNIT_ASSERT(references["rule2"].find("rule1") != references["rule2"].end());
+}
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_load_lines() {
   // create a dummy snakefile and ensure it's loaded as anticipated
   std::ofstream output;
@@ -169,13 +225,13 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_detect_known_
   CPPUNIT_ASSERT(!observed.str().compare(expected));
 }
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_get_blocks() {
-  std::list<boost::shared_ptr<rule_block> > result;
+  std::vector<boost::shared_ptr<rule_block> > result;
   boost::shared_ptr<rule_block> b1(new rule_block), b2(new rule_block);
   b1->_rule_name = "myrule";
   b1->_named_blocks.push_back(std::make_pair("input", " 'myinfile.txt',"));
   b1->_named_blocks.push_back(std::make_pair("output", " 'myoutfile.txt',"));
   b1->_named_blocks.push_back(std::make_pair("shell", " 'echo thing > {output}'"));
-  b2->_code_chunk.push_back("localrules: myrule");
+  b2->add_code_chunk("localrules: myrule");
   snakemake_file sf;
   sf._blocks.push_back(b1);
   sf._blocks.push_back(b2);
@@ -194,7 +250,7 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_report_single
   snakemake_file sf;
   boost::shared_ptr<rule_block> b1(new rule_block), b2(new rule_block), b3(new rule_block), b4(new rule_block),
       b5(new rule_block);
-  b1->_code_chunk.push_back("if True:");
+  b1->add_code_chunk("if True:");
   b1->_resolution = RESOLVED_INCLUDED;
   b1->_queried_by_python = true;
   b2->_rule_name = "myrule";
@@ -202,7 +258,7 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_report_single
   b2->_named_blocks.push_back(std::make_pair("input", "\n            file1,"));
   b2->_resolution = RESOLVED_INCLUDED;
   b2->_queried_by_python = true;
-  b3->_code_chunk.push_back("else:");
+  b3->add_code_chunk("else:");
   b3->_resolution = RESOLVED_INCLUDED;
   b3->_queried_by_python = true;
   b4->_rule_name = "myrule";
@@ -232,6 +288,54 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_report_single
       "else:\n    pass\n\n\nrule otherrule:\n    input:\n        file2,\n\n\n";
   CPPUNIT_ASSERT(!out.str().compare(expected));
 }
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_render_segments() {
+  // pre-rendered segments must reproduce report_single_rule for any rule set
+  snakemake_file sf;
+  boost::shared_ptr<rule_block> b1(new rule_block), b2(new rule_block), b3(new rule_block), b4(new rule_block),
+      b5(new rule_block);
+  b1->add_code_chunk("if True:");
+  b1->_resolution = RESOLVED_INCLUDED;
+  b2->_rule_name = "myrule";
+  b2->_local_indentation = 4;
+  b2->_named_blocks.push_back(std::make_pair("input", "\n            file1,"));
+  b2->_resolution = RESOLVED_INCLUDED;
+  b3->add_code_chunk("else:");
+  b3->_resolution = RESOLVED_INCLUDED;
+  b4->_rule_name = "myrule";
+  b4->_local_indentation = 4;
+  b4->_resolution = RESOLVED_EXCLUDED;
+  b5->_rule_name = "otherrule";
+  b5->_named_blocks.push_back(std::make_pair("input", "\n        file2,"));
+  b5->_resolution = RESOLVED_INCLUDED;
+  sf._blocks.push_back(b1);
+  sf._blocks.push_back(b2);
+  sf._blocks.push_back(b3);
+  sf._blocks.push_back(b4);
+  sf._blocks.push_back(b5);
+  CPPUNIT_ASSERT(!sf.segments_rendered());
+  sf.render_segments();
+  CPPUNIT_ASSERT(sf.segments_rendered());
+  // fixed text between rules is merged
+  CPPUNIT_ASSERT(sf._segments.size() == 4);
+  CPPUNIT_ASSERT(!sf._segments.at(2).text.compare("else:\n    pass\n\n\n"));
+  std::vector<std::map<std::string, bool> > rulesets(4);
+  rulesets.at(1)["myrule"] = true;
+  rulesets.at(2)["otherrule"] = true;
+  rulesets.at(3)["myrule"] = true;
+  rulesets.at(3)["otherrule"] = true;
+  rulesets.at(3)["missingrule"] = true;
+  for (unsigned i = 0; i < rulesets.size(); ++i) {
+    std::ostringstream expected;
+    unsigned expected_count = sf.report_single_rule(rulesets.at(i), expected);
+    std::vector<std::string_view> segments;
+    CPPUNIT_ASSERT(sf.select_rendered_segments(rulesets.at(i), &segments) == expected_count);
+    std::string observed = "";
+    for (std::vector<std::string_view>::const_iterator iter = segments.begin(); iter != segments.end(); ++iter) {
+      observed += *iter;
+    }
+    CPPUNIT_ASSERT(!observed.compare(expected.str()));
+  }
+}
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_fully_resolved() {
   snakemake_file sf;
   boost::shared_ptr<rule_block> rb1(new rule_block), rb2(new rule_block), rb3(new rule_block);
@@ -335,7 +439,7 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_resolve_with_
   rb1->_resolution = RESOLVED_INCLUDED;
   rb1->_queried_by_python = true;
   rb1->_python_tag = 1;
-  rb2->_code_chunk.push_back("include: \"rules/include.smk\"");
+  rb2->add_code_chunk("include: \"rules/include.smk\"");
   rb2->_local_indentation = 0;
   rb2->_resolution = RESOLVED_INCLUDED;
   rb2->_queried_by_python = true;
@@ -345,7 +449,7 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_resolve_with_
   rb3->_resolution = UNRESOLVED;
   rb3->_queried_by_python = false;
   rb3->_python_tag = 3;
-  rb4->_code_chunk.push_back("include: \"future.smk\"");
+  rb4->add_code_chunk("include: \"future.smk\"");
   rb4->_local_indentation = 0;
   rb4->_resolution = UNRESOLVED;
   rb4->_queried_by_python = false;
@@ -401,7 +505,7 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_resolve_with_
   CPPUNIT_ASSERT(sf2->_updated_last_round);
   CPPUNIT_ASSERT(sf1->_blocks.size() == 2);
   CPPUNIT_ASSERT(sf2->_blocks.size() == 3);
-  std::list<boost::shared_ptr<rule_block> >::iterator iter = sf2->_blocks.begin();
+  std::vector<boost::shared_ptr<rule_block> >::iterator iter = sf2->_blocks.begin();
   CPPUNIT_ASSERT((*iter)->_queried_by_python);
   CPPUNIT_ASSERT((*iter)->_resolution == RESOLVED_INCLUDED);
   ++iter;
@@ -449,13 +553,13 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_process_pytho
   rb1->_queried_by_python = true;
   rb1->_python_tag = 1;
   rb2->_rule_name = "";
-  rb2->_code_chunk.push_back("include: \"rules/include.smk\"");
+  rb2->add_code_chunk("include: \"rules/include.smk\"");
   rb2->_resolution = RESOLVED_INCLUDED;
   rb2->_queried_by_python = true;
   rb2->_python_tag = 2;
   rb2->_resolved_included_filename = "rules/include.smk";
   rb3->_rule_name = "";
-  rb3->_code_chunk.push_back("include: \"rules/fake.smk\"");
+  rb3->add_code_chunk("include: \"rules/fake.smk\"");
   rb3->_resolution = RESOLVED_INCLUDED;
   rb3->_queried_by_python = true;
   rb3->_python_tag = 3;
@@ -465,7 +569,7 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_process_pytho
   rb4->_queried_by_python = false;
   rb4->_python_tag = 4;
   rb5->_rule_name = "";
-  rb5->_code_chunk.push_back("pass");
+  rb5->add_code_chunk("pass");
   rb5->_resolution = UNRESOLVED;
   rb5->_queried_by_python = false;
   rb5->_python_tag = 5;
@@ -526,9 +630,121 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_process_pytho
   CPPUNIT_ASSERT(sf1->_included_files.size() == 2);
   CPPUNIT_ASSERT(sf1->_included_files.begin()->second == sf2);
   CPPUNIT_ASSERT(sf1->_included_files.rbegin()->second->_blocks.size() == 1);
-  std::list<boost::shared_ptr<rule_block> >::iterator iter = sf1->_included_files.rbegin()->second->_blocks.begin();
+  std::vector<boost::shared_ptr<rule_block> >::iterator iter = sf1->_included_files.rbegin()->second->_blocks.begin();
   CPPUNIT_ASSERT(!(*iter)->_rule_name.compare("rule5"));
 }
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_load_included_files() {
+  /*
+    newly discovered files are parsed concurrently, each with its own tags;
+    rebasing them in request order continues from the parent file's counter
+   */
+  boost::filesystem::path workspace = boost::filesystem::path(std::string(_tmp_dir)) / "lif_workspace";
+  boost::filesystem::create_directories(workspace / "rules");
+  std::vector<std::pair<boost::filesystem::path, boost::filesystem::path> > requests;
+  for (unsigned i = 0; i < 6; ++i) {
+    std::string name = "file" + std::to_string(i) + ".smk";
+    std::ofstream output;
+    output.open((workspace / "rules" / name).string().c_str());
+    if (!output.is_open()) {
+      throw std::runtime_error("cannot write " + name + " for included file loading test");
+    }
+    if (!(output << "rule rule" << i << ":\n    input: \"input" << i << ".txt\",\n\n"
+                 << "include: \"other" << i << ".smk\"\n"
+                 << "rule rule" << i << "b:\n    output: \"output" << i << ".txt\",\n")) {
+      throw std::runtime_error("cannot write to " + name + " for included file loading test");
+    }
+    output.close();
+    requests.push_back(std::make_pair(workspace / "rules" / name, boost::filesystem::path("rules") / name));
+  }
+  snakemake_file sf;
+  *sf._tag_counter = 10;
+  std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> > parsed;
+  CPPUNIT_ASSERT_THROW(sf.load_included_files(requests, false, NULL), std::runtime_error);
+  sf.load_included_files(requests, false, &parsed);
+  CPPUNIT_ASSERT(parsed.size() == requests.size());
+  CPPUNIT_ASSERT(sf._included_files.empty());
+  for (unsigned i = 0; i < requests.size(); ++i) {
+    boost::shared_ptr<snakemake_file> file = parsed[requests.at(i).first];
+    CPPUNIT_ASSERT(file);
+    CPPUNIT_ASSERT(file->_blocks.at(0)->get_interpreter_tag() == 1);
+    file->rebase_interpreter_tags(sf._tag_counter);
+  }
+  CPPUNIT_ASSERT(*sf._tag_counter == 10 + 3 * requests.size());
+  unsigned expected_tag = 10;
+  for (unsigned i = 0; i < requests.size(); ++i) {
+    std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file> >::const_iterator finder =
+        parsed.find(requests.at(i).first);
+    CPPUNIT_ASSERT(finder->second->_tag_counter == sf._tag_counter);
+    CPPUNIT_ASSERT(finder->second->get_snakefile_relative_path() == requests.at(i).second);
+    CPPUNIT_ASSERT(finder->second->_blocks.size() == 3);
+    for (std::vector<boost::shared_ptr<rule_block> >::const_iterator iter = finder->second->_blocks.begin();
+         iter != finder->second->_blocks.end(); ++iter, ++expected_tag) {
+      CPPUNIT_ASSERT((*iter)->get_interpreter_tag() == expected_tag);
+    }
+  }
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_process_python_results_include_order() {
+  /*
+    Snakefile includes rules/a.smk (new), rules/b.smk (loaded already; it includes
+    the new rules/c.smk), and rules/a.smk again. tags are assigned as a serial load
+    would: a.smk first, then c.smk while passing results along to b.smk. a.smk is
+    loaded once, and its second include passes results along to it.
+   */
+  boost::filesystem::path workspace = boost::filesystem::path(std::string(_tmp_dir)) / "ppr_order_workspace";
+  boost::filesystem::create_directories(workspace / "rules");
+  std::map<std::string, std::string> files;
+  files["rules/a.smk"] = "rule rule_a1:\n    input: \"a1.txt\",\n\nrule rule_a2:\n    input: \"a2.txt\",\n";
+  files["rules/c.smk"] = "rule rule_c:\n    input: \"c.txt\",\n";
+  for (std::map<std::string, std::string>::const_iterator iter = files.begin(); iter != files.end(); ++iter) {
+    std::ofstream output;
+    output.open((workspace / iter->first).string().c_str());
+    if (!output.is_open()) {
+      throw std::runtime_error("cannot write " + iter->first + " for include order test");
+    }
+    if (!(output << iter->second)) {
+      throw std::runtime_error("cannot write to " + iter->first + " for include order test");
+    }
+    output.close();
+  }
+  boost::shared_ptr<snakemake_file> sf1(new snakemake_file);
+  *sf1->_tag_counter = 5;
+  boost::shared_ptr<snakemake_file> sf2(new snakemake_file(sf1->_tag_counter));
+  std::map<std::string, std::string> tag_values;
+  const char *included[] = {"rules/a.smk", "rules/b.smk", "rules/a.smk"};
+  for (unsigned i = 0; i < 3; ++i) {
+    boost::shared_ptr<rule_block> rb(new rule_block);
+    rb->add_code_chunk("include: \"" + std::string(included[i]) + "\"");
+    rb->_python_tag = i + 1;
+    rb->_resolved_included_filename = included[i];
+    sf1->_blocks.push_back(rb);
+    tag_values["tag" + std::to_string(i + 1)] = included[i];
+  }
+  boost::shared_ptr<rule_block> rb4(new rule_block);
+  rb4->add_code_chunk("include: \"c.smk\"");
+  rb4->_python_tag = 4;
+  rb4->_resolved_included_filename = "c.smk";
+  sf2->_blocks.push_back(rb4);
+  tag_values["tag4"] = "c.smk";
+  sf1->_included_files[workspace / "rules/b.smk"] = sf2;
+
+  sf1->process_python_results(workspace, workspace, false, tag_values, workspace / "Snakefile");
+
+  CPPUNIT_ASSERT(sf1->_included_files.size() == 2);
+  boost::shared_ptr<snakemake_file> sfa = sf1->_included_files[workspace / "rules/a.smk"];
+  CPPUNIT_ASSERT(sfa);
+  CPPUNIT_ASSERT(sf2->_included_files.size() == 1);
+  boost::shared_ptr<snakemake_file> sfc = sf2->_included_files[workspace / "rules/c.smk"];
+  CPPUNIT_ASSERT(sfc);
+  CPPUNIT_ASSERT(sfa->_blocks.size() == 2);
+  CPPUNIT_ASSERT(sfa->_blocks.at(0)->get_interpreter_tag() == 5);
+  CPPUNIT_ASSERT(sfa->_blocks.at(1)->get_interpreter_tag() == 6);
+  CPPUNIT_ASSERT(sfc->_blocks.size() == 1);
+  CPPUNIT_ASSERT(sfc->_blocks.at(0)->get_interpreter_tag() == 7);
+  CPPUNIT_ASSERT(*sf1->_tag_counter == 8);
+  // the second include of a.smk passed this round's results along; its new tags were not reported
+  CPPUNIT_ASSERT(sfa->_blocks.at(0)->get_resolution_status() == RESOLVED_EXCLUDED);
+  CPPUNIT_ASSERT(sfc->_blocks.at(0)->get_resolution_status() == UNRESOLVED);
+}
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_capture_python_tag_values() {
   std::vector<std::string> input;
   std::map<std::string, std::string> output;
@@ -543,6 +759,19 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_capture_pytho
   CPPUNIT_ASSERT(output.find("tag222333") != output.end());
   CPPUNIT_ASSERT(!output["tag222333"].compare("valuevaluevalue"));
 }
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_capture_python_tag_value() {
+  std::map<std::string, std::string> output;
+  snakemake_file sf;
+  sf.capture_python_tag_value("some sort of infrastructure\n", &output);
+  sf.capture_python_tag_value("tagline without a number\n", &output);
+  CPPUNIT_ASSERT(output.empty());
+  sf.capture_python_tag_value("tag12\n", &output);
+  sf.capture_python_tag_value("tag34: path/to/file.smk\n", &output);
+  CPPUNIT_ASSERT(output.size() == 2);
+  CPPUNIT_ASSERT(output.find("tag12") != output.end());
+  CPPUNIT_ASSERT(output["tag12"].empty());
+  CPPUNIT_ASSERT(!output["tag34"].compare("path/to/file.smk"));
+}
 void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_postflight_checks() {
   // for the moment, this is just a dispatch to detect_known_issues
   std::map<std::string, bool> include_rules, exclude_rules;
@@ -615,7 +844,7 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_get_base_rule
   b1->_named_blocks.push_back(std::make_pair("output", " 'myoutfile.txt',"));
   b1->_named_blocks.push_back(std::make_pair("shell", " 'echo thing > {output}'"));
   b1->_resolution = RESOLVED_INCLUDED;
-  b2->_code_chunk.push_back("localrules: myrule");
+  b2->add_code_chunk("localrules: myrule");
   b2->_resolution = RESOLVED_INCLUDED;
   b3->_rule_name = "hidden_rule";
   b3->_base_rule_name = "magical_treasure";
@@ -638,5 +867,97 @@ void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_get_base_rule
   snakemake_file sf;
   sf.get_base_rule_name("fake_rule", NULL);
 }
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_build_rule_index() {
+  // the index must answer rule queries exactly as the include tree scan does
+  snakemake_file sf1;
+  boost::shared_ptr<snakemake_file> sf2(new snakemake_file);
+  boost::shared_ptr<rule_block> b0(new rule_block), b1(new rule_block), b2(new rule_block), b3(new rule_block);
+  b0->_rule_name = "myrule";
+  b0->_base_rule_name = "excluded_parent";
+  b0->_resolution = RESOLVED_EXCLUDED;
+  b1->_rule_name = "myrule";
+  b1->_base_rule_name = "top_level_rule";
+  b1->_resolution = RESOLVED_INCLUDED;
+  b2->add_code_chunk("localrules: myrule");
+  b2->_resolution = RESOLVED_INCLUDED;
+  b3->_rule_name = "myrule";
+  b3->_base_rule_name = "shadowed_parent";
+  b3->_resolution = RESOLVED_INCLUDED;
+  sf1._blocks.push_back(b0);
+  sf1._blocks.push_back(b1);
+  sf1._blocks.push_back(b2);
+  sf2->_blocks.push_back(b3);
+  sf1._included_files["/path/to/file"] = sf2;
+  std::map<std::string, std::vector<boost::shared_ptr<rule_block> > > scanned, indexed;
+  sf1.report_rules(&scanned);
+  CPPUNIT_ASSERT(!sf1.rule_index_built());
+  sf1.build_rule_index();
+  CPPUNIT_ASSERT(sf1.rule_index_built());
+  sf1.report_rules(&indexed);
+  CPPUNIT_ASSERT(scanned == indexed);
+  CPPUNIT_ASSERT(sf1._rule_index.size() == 1);
+  CPPUNIT_ASSERT(sf1._rule_index["myrule"].size() == 2);
+  CPPUNIT_ASSERT(sf1._rule_index["myrule"].at(0).first == b1);
+  CPPUNIT_ASSERT(sf1._rule_index["myrule"].at(0).second == &sf1);
+  CPPUNIT_ASSERT(sf1._rule_index["myrule"].at(1).first == b3);
+  CPPUNIT_ASSERT(sf1._rule_index["myrule"].at(1).second == sf2.get());
+  std::string result = "";
+  CPPUNIT_ASSERT(sf1.get_base_rule_name("myrule", &result));
+  CPPUNIT_ASSERT(!result.compare("top_level_rule"));
+  CPPUNIT_ASSERT(!sf1.get_base_rule_name("fake_rule", &result));
+  // processing further python results invalidates the index
+  boost::filesystem::path workspace = boost::filesystem::path(std::string(_tmp_dir));
+  std::map<std::string, std::string> tag_values;
+  sf1.process_python_results(workspace, workspace, false, tag_values, workspace / "Snakefile");
+  CPPUNIT_ASSERT(!sf1.rule_index_built());
+  CPPUNIT_ASSERT(sf1._rule_index.empty());
+}
 
 CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::snakemake_fileTest);
+
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_report_conda_envs() {
+  // literal environment files are reported relative to the workflow, for the requested rules only
+  snakemake_file sf1;
+  boost::shared_ptr<snakemake_file> sf2(new snakemake_file);
+  boost::shared_ptr<rule_block> b0(new rule_block), b1(new rule_block), b2(new rule_block), b3(new rule_block),
+      b4(new rule_block);
+  b0->_rule_name = "rule0";
+  b0->_named_blocks.push_back(std::make_pair("conda", " '../envs/first.yaml',"));
+  b0->_resolution = RESOLVED_INCLUDED;
+  b1->_rule_name = "rule1";
+  b1->_named_blocks.push_back(std::make_pair("conda", " \"envs/second.yml\""));
+  b1->_resolution = RESOLVED_INCLUDED;
+  b2->_rule_name = "rule2";
+  b2->_named_blocks.push_back(std::make_pair("conda", " config['env']"));
+  b2->_resolution = RESOLVED_INCLUDED;
+  b3->_rule_name = "rule3";
+  b3->_named_blocks.push_back(std::make_pair("conda", " 'named_environment'"));
+  b3->_resolution = RESOLVED_INCLUDED;
+  b4->_rule_name = "rule4";
+  b4->_named_blocks.push_back(std::make_pair("conda", " '/opt/envs/third.yaml'"));
+  b4->_resolution = RESOLVED_INCLUDED;
+  sf1._snakefile_relative_path = "workflow/Snakefile";
+  sf1._blocks.push_back(b0);
+  sf1._blocks.push_back(b2);
+  sf1._blocks.push_back(b3);
+  sf2->_snakefile_relative_path = "workflow/rules/included.smk";
+  sf2->_blocks.push_back(b1);
+  sf2->_blocks.push_back(b4);
+  sf1._included_files["workflow/rules/included.smk"] = sf2;
+  std::map<std::string, bool> rule_names;
+  rule_names["rule0"] = rule_names["rule1"] = rule_names["rule2"] = rule_names["rule3"] = true;
+  std::map<boost::filesystem::path, bool> envs;
+  sf1.report_conda_envs(rule_names, &envs);
+  CPPUNIT_ASSERT(envs.size() == 2);
+  CPPUNIT_ASSERT(envs.find("envs/first.yaml") != envs.end());
+  CPPUNIT_ASSERT(envs.find("workflow/rules/envs/second.yml") != envs.end());
+  rule_names["rule4"] = true;
+  sf1.report_conda_envs(rule_names, &envs);
+  CPPUNIT_ASSERT(envs.size() == 3);
+  CPPUNIT_ASSERT(envs.find("/opt/envs/third.yaml") != envs.end());
+}
+void snakemake_unit_tests::snakemake_fileTest::test_snakemake_file_report_conda_envs_null_pointer() {
+  snakemake_file sf;
+  std::map<std::string, bool> rule_names;
+  sf.report_conda_envs(rule_names, NULL);
+}
@@ -32,15 +32,21 @@ class snakemake_fileTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_snakemake_file_copy_constructor);
   CPPUNIT_TEST(test_snakemake_file_load_everything);
   CPPUNIT_TEST(test_snakemake_file_parse_file);
+  CPPUNIT_TEST(test_snakemake_file_parse_file_contiguous);
+  CPPUNIT_TEST(test_snakemake_file_report_rule_references);
   CPPUNIT_TEST(test_snakemake_file_load_lines);
   CPPUNIT_TEST(test_snakemake_file_detect_known_issues);
   CPPUNIT_TEST(test_snakemake_file_get_blocks);
   CPPUNIT_TEST(test_snakemake_file_report_single_rule);
+  CPPUNIT_TEST(test_snakemake_file_render_segments);
   CPPUNIT_TEST(test_snakemake_file_fully_resolved);
   CPPUNIT_TEST(test_snakemake_file_contains_blockers);
   CPPUNIT_TEST(test_snakemake_file_resolve_with_python);
   CPPUNIT_TEST(test_snakemake_file_process_python_results);
+  CPPUNIT_TEST(test_snakemake_file_load_included_files);
+  CPPUNIT_TEST(test_snakemake_file_process_python_results_include_order);
   CPPUNIT_TEST(test_snakemake_file_capture_python_tag_values);
+  CPPUNIT_TEST(test_snakemake_file_capture_python_tag_value);
   CPPUNIT_TEST(test_snakemake_file_postflight_checks);
   CPPUNIT_TEST(test_snakemake_file_get_snakefile_relative_path);
   CPPUNIT_TEST(test_snakemake_file_loaded_files);
@@ -48,6 +54,9 @@ class snakemake_fileTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_snakemake_file_report_rules);
   CPPUNIT_TEST(test_snakemake_file_get_base_rule_name);
   CPPUNIT_TEST_EXCEPTION(test_snakemake_file_get_base_rule_name_null_pointer, std::runtime_error);
+  CPPUNIT_TEST(test_snakemake_file_build_rule_index);
+  CPPUNIT_TEST(test_snakemake_file_report_conda_envs);
+  CPPUNIT_TEST_EXCEPTION(test_snakemake_file_report_conda_envs_null_pointer, std::runtime_error);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -60,15 +69,21 @@ class snakemake_fileTest : public CppUnit::TestFixture {
   void test_snakemake_file_copy_constructor();
   void test_snakemake_file_load_everything();
   void test_snakemake_file_parse_file();
+  void test_snakemake_file_parse_file_contiguous();
+  void test_snakemake_file_report_rule_references();
   void test_snakemake_file_load_lines();
   void test_snakemake_file_detect_known_issues();
   void test_snakemake_file_get_blocks();
   void test_snakemake_file_report_single_rule();
+  void test_snakemake_file_render_segments();
   void test_snakemake_file_fully_resolved();
   void test_snakemake_file_contains_blockers();
   void test_snakemake_file_resolve_with_python();
   void test_snakemake_file_process_python_results();
+  void test_snakemake_file_load_included_files();
+  void test_snakemake_file_process_python_results_include_order();
   void test_snakemake_file_capture_python_tag_values();
+  void test_snakemake_file_capture_python_tag_value();
   void test_snakemake_file_postflight_checks();
   void test_snakemake_file_get_snakefile_relative_path();
   void test_snakemake_file_loaded_files();
@@ -76,6 +91,9 @@ class snakemake_fileTest : public CppUnit::TestFixture {
   void test_snakemake_file_report_rules();
   void test_snakemake_file_get_base_rule_name();
   void test_snakemake_file_get_base_rule_name_null_pointer();
+  void test_snakemake_file_build_rule_index();
+  void test_snakemake_file_report_conda_envs();
+  void test_snakemake_file_report_conda_envs_null_pointer();
 
  private:
   char *_tmp_dir;
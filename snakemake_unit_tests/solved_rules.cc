@@ -8,9 +8,16 @@
 
 #include "snakemake_unit_tests/solved_rules.h"
 
-snakemake_unit_tests::recipe::recipe() : _rule_name(""), _log("") {}
+#include <zlib.h>
+
+snakemake_unit_tests::recipe::recipe() : _rule_name(""), _log(""), _threads(1) {}
 snakemake_unit_tests::recipe::recipe(const recipe &obj)
-    : _rule_name(obj._rule_name), _inputs(obj._inputs), _outputs(obj._outputs), _log(obj._log) {}
+    : _rule_name(obj._rule_name),
+      _inputs(obj._inputs),
+      _outputs(obj._outputs),
+      _log(obj._log),
+      _threads(obj._threads),
+      _resources(obj._resources) {}
 snakemake_unit_tests::recipe::~recipe() throw() {}
 const std::string &snakemake_unit_tests::recipe::get_rule_name() const { return _rule_name; }
 void snakemake_unit_tests::recipe::set_rule_name(const std::string &s) { _rule_name = s; }
@@ -20,18 +27,26 @@ const std::vector<boost::filesystem::path> &snakemake_unit_tests::recipe::get_ou
 void snakemake_unit_tests::recipe::add_output(const std::string &s) { _outputs.push_back(s); }
 const std::string &snakemake_unit_tests::recipe::get_log() const { return _log; }
 void snakemake_unit_tests::recipe::set_log(const std::string &s) { _log = s; }
+unsigned snakemake_unit_tests::recipe::get_threads() const { return _threads; }
+void snakemake_unit_tests::recipe::set_threads(unsigned threads) { _threads = threads; }
+const std::map<std::string, std::string> &snakemake_unit_tests::recipe::get_resources() const { return _resources; }
+void snakemake_unit_tests::recipe::set_resource(const std::string &name, const std::string &value) {
+  _resources[name] = value;
+}
 void snakemake_unit_tests::recipe::clear() {
   _rule_name = _log = "";
   _inputs.clear();
   _outputs.clear();
+  _threads = 1;
+  _resources.clear();
 }
 
 void snakemake_unit_tests::solved_rules::load_file(const std::string &filename) {
   std::ifstream input;
   std::string line = "";
   std::vector<std::string> input_filenames, output_filenames;
-  const boost::regex standard_rule_declaration("^rule ([^ ]+):.*$");
-  const boost::regex checkpoint_declaration("^checkpoint ([^ ]+):.*$");
+  static const boost::regex standard_rule_declaration("^rule ([^ ]+):.*$");
+  static const boost::regex checkpoint_declaration("^checkpoint ([^ ]+):.*$");
   boost::smatch regex_result;
   std::map<std::string, std::vector<std::string>> toxic_output_files;
   try {
@@ -80,9 +95,25 @@ void snakemake_unit_tests::solved_rules::load_file(const std::string &filename)
             // log files get created. may need to add this to
             // an exclusion list.
             rep->set_log(line.substr(9));
+          } else if (line.find("    threads:") == 0) {
+            // kept so tests can be given, and scheduled with, the threads of the logged run
+            std::string count = line.substr(13);
+            if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos || !std::stoul(count)) {
+              throw std::runtime_error("in log entry \"" + regex_result[1] + "\": invalid thread count \"" + count +
+                                       "\"");
+            }
+            rep->set_threads(std::stoul(count));
+          } else if (line.find("    resources:") == 0) {
+            std::vector<std::string> resources;
+            split_comma_list(line.substr(15), &resources);
+            for (std::vector<std::string>::const_iterator iter = resources.begin(); iter != resources.end(); ++iter) {
+              std::string::size_type split = iter->find('=');
+              // unnamed entries are not resources anything could request
+              if (split == std::string::npos || !split) continue;
+              rep->set_resource(iter->substr(0, split), iter->substr(split + 1));
+            }
           } else if (line.find("    jobid:") == 0 || line.find("    wildcards:") == 0 ||
-                     line.find("    benchmark:") == 0 || line.find("    resources:") == 0 ||
-                     line.find("    threads:") == 0 || line.find("    priority:") == 0 ||
+                     line.find("    benchmark:") == 0 || line.find("    priority:") == 0 ||
                      line.find("    reason:") == 0) {
             // other recognized solution annotations;
             // for the moment, do nothing with them
@@ -169,31 +200,84 @@ void snakemake_unit_tests::solved_rules::emit_tests(
         inst_dir.string() + "\"");
   }
 
+  // rules./checkpoints. references, to predict extra required rules up front
+  std::map<std::string, std::map<std::string, bool>> rule_references;
+  sf.report_rule_references(&rule_references);
+
   // iterate across loaded recipes, creating tests as you go
   std::map<std::string, bool> test_history;
   for (std::vector<boost::shared_ptr<recipe>>::const_iterator iter = _recipes.begin(); iter != _recipes.end(); ++iter) {
     if (test_history.find((*iter)->get_rule_name()) == test_history.end()) {
+      if (_profiler) _profiler->begin_rule((*iter)->get_rule_name());
       bool deployment_successful = false;
       std::map<std::string, bool> missing_rules;
       std::map<boost::shared_ptr<recipe>, bool> missing_recipes;
+      add_referenced_recipes((*iter)->get_rule_name(), rule_references, sf, &missing_recipes);
+      unsigned attempt = 0;
       do {
+        // each attempt is traced separately, as retries are where unexpected time goes
+        tracer::span attempt_span(profiler::tracer_of(_profiler), "dry run attempt " + std::to_string(++attempt),
+                                  "dry run");
+        attempt_span.add_arg("rule", (*iter)->get_rule_name());
         create_workspace(*iter, sf, output_test_dir, test_parent_path, pipeline_top_dir, pipeline_run_dir, inst_test_py,
                          missing_recipes, include_rules, exclude_rules, added_files, added_directories,
                          update_snakefiles, update_added_content, update_inputs, update_outputs, update_pytest,
                          include_entire_dag, files_outside_workspace);
         // new: deal with the fact that certain kinds of rule relationships (e.g. rulesdot) cannot be
-        // reliably detected with this program's approach to querying snakefiles
+        // reliably detected with this program's approach to querying snakefiles.
+        // references visible in rule bodies are added before the first attempt; this
+        // dry run catches any that are constructed less directly
         if (exclude_rules.find((*iter)->get_rule_name()) == exclude_rules.end() &&
             (include_rules.empty() || include_rules.find((*iter)->get_rule_name()) != include_rules.end()) &&
             (update_snakefiles || update_added_content || update_inputs || update_outputs)) {
-          std::vector<std::string> snakemake_exec;
-          snakemake_exec =
-              exec("cd " + (test_parent_path / (*iter)->get_rule_name() / "workspace").string() + " && snakemake -nFs" +
-                       sf.get_snakefile_relative_path().string() + " --directory " + pipeline_run_dir.string(),
-                   false);
-          // try to find snakemake errors that report rules missing from dag
+          // try to find snakemake errors that report rules missing from dag, as output arrives
           unsigned initial_missing_count = missing_rules.size();
-          find_missing_rules(snakemake_exec, &missing_rules);
+          bool found_error = false, found_permitted_error = false;
+          // dry run output is small, and is kept whole so that an error report shows the first error
+          std::vector<std::string> dryrun_output;
+          std::vector<std::string> args;
+          args.push_back("snakemake");
+          args.push_back("-nFs");
+          args.push_back(sf.get_snakefile_relative_path().string());
+          args.push_back("--directory");
+          args.push_back(pipeline_run_dir.string());
+          std::function<void(std::string_view)> scan_line = [&](std::string_view line) {
+            if (find_missing_rule(line, &missing_rules, &found_error)) {
+              found_permitted_error = true;
+            }
+            dryrun_output.push_back(std::string(line));
+          };
+          subprocess_options options;
+          options.working_directory = (test_parent_path / (*iter)->get_rule_name() / "workspace").string();
+          options.fail_on_error = false;
+          options.timeout_seconds = _subprocess_timeout;
+          // errors are recognized on stdout, as they always were; stderr only adds context to error reports
+          options.stdout_callback = scan_line;
+          options.stderr_callback = [&dryrun_output](std::string_view line) {
+            dryrun_output.push_back(std::string(line));
+          };
+          subprocess_record record;
+          record.label = "dry run for rule " + (*iter)->get_rule_name();
+          record.working_directory = options.working_directory;
+          {
+            tracer::span subprocess_span(profiler::tracer_of(_profiler), "snakemake", "subprocess");
+            subprocess_span.add_arg("label", record.label);
+            subprocess_span.add_arg("working_directory", record.working_directory);
+            record.result = run_subprocess(args, options);
+          }
+          _subprocess_records.push_back(record);
+          if (_profiler) _profiler->count_subprocess();
+          if (record.result.timed_out) {
+            for (std::vector<std::string>::const_iterator line_iter = dryrun_output.begin();
+                 line_iter != dryrun_output.end(); ++line_iter) {
+              std::cerr << *line_iter;
+            }
+            throw std::runtime_error("snakemake dry run for rule \"" + (*iter)->get_rule_name() +
+                                     "\" did not finish within " + std::to_string(_subprocess_timeout) + " seconds");
+          }
+          if (found_error && !found_permitted_error) {
+            report_unhandled_dryrun_error(dryrun_output);
+          }
           if (missing_rules.size() == initial_missing_count) {
             deployment_successful = true;
           } else {
@@ -215,52 +299,297 @@ void snakemake_unit_tests::solved_rules::emit_tests(
       test_history[(*iter)->get_rule_name()] = true;
       // remove evidence of having run snakemake in-place
       boost::filesystem::remove_all(test_parent_path / (*iter)->get_rule_name() / "workspace/.snakemake");
+      // the runner skips tests whose fingerprint has passed before; taken once the workspace is final
+      if (exclude_rules.find((*iter)->get_rule_name()) == exclude_rules.end() &&
+          (include_rules.empty() || include_rules.find((*iter)->get_rule_name()) != include_rules.end()) &&
+          (update_snakefiles || update_added_content || update_inputs || update_outputs)) {
+        boost::filesystem::path rule_parent_path = test_parent_path / (*iter)->get_rule_name();
+        std::string fingerprint = fingerprint_test(rule_parent_path, _fingerprint_threads) + "\n";
+        write_if_changed((rule_parent_path / "fingerprint.txt").string(),
+                         std::vector<std::string_view>(1, fingerprint));
+      }
+      if (_profiler) _profiler->end_rule();
     }
   }
   // emit common.py in the test_parent_path; no modifications needed
   if (update_pytest) {
-    boost::filesystem::copy(
-        inst_common_py, test_parent_path,
-        boost::filesystem::copy_options::overwrite_existing | boost::filesystem::copy_options::recursive);
+    std::ifstream input;
+    std::ostringstream common_py;
+    input.open(inst_common_py.string().c_str());
+    if (!input.is_open()) throw std::runtime_error("cannot read installed file \"" + inst_common_py.string() + "\"");
+    if (!(common_py << input.rdbuf()))
+      throw std::runtime_error("cannot read installed file \"" + inst_common_py.string() + "\"");
+    input.close();
+    std::string common_py_text = common_py.str();
+    write_if_changed((test_parent_path / "common.py").string(), std::vector<std::string_view>(1, common_py_text));
     report_modified_launcher_script(test_parent_path, output_test_dir, inst_launcher_bash);
   }
 }
 
+void snakemake_unit_tests::solved_rules::plan_tests(
+    const snakemake_file &sf, const boost::filesystem::path &output_test_dir,
+    const boost::filesystem::path &pipeline_top_dir, const boost::filesystem::path &pipeline_run_dir,
+    const std::map<std::string, bool> &include_rules, const std::map<std::string, bool> &exclude_rules,
+    const std::vector<boost::filesystem::path> &added_files,
+    const std::vector<boost::filesystem::path> &added_directories, bool include_entire_dag,
+    std::vector<rule_plan> *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to plan_tests");
+  target->clear();
+  boost::filesystem::path test_parent_path = output_test_dir / "unit";
+  std::map<std::string, std::map<std::string, bool>> rule_references;
+  sf.report_rule_references(&rule_references);
+  // the first recipe for each rule is the one emit_tests uses
+  std::map<std::string, bool> test_history;
+  unsigned recipe_index = 0;
+  for (std::vector<boost::shared_ptr<recipe>>::const_iterator iter = _recipes.begin(); iter != _recipes.end(); ++iter) {
+    ++recipe_index;
+    const std::string &rule_name = (*iter)->get_rule_name();
+    if (test_history.find(rule_name) != test_history.end()) continue;
+    test_history[rule_name] = true;
+    if (exclude_rules.find(rule_name) != exclude_rules.end() ||
+        (!include_rules.empty() && include_rules.find(rule_name) == include_rules.end())) {
+      continue;
+    }
+    rule_plan plan;
+    plan.rule_name = rule_name;
+    plan.recipe_index = recipe_index;
+    // the same closure as create_workspace, seeded as emit_tests seeds it
+    std::map<boost::shared_ptr<recipe>, bool> dependent_recipes;
+    add_referenced_recipes(rule_name, rule_references, sf, &dependent_recipes);
+    dependent_recipes[*iter] = true;
+    if (include_entire_dag) {
+      add_dag_from_leaf(*iter, include_entire_dag, &dependent_recipes);
+    }
+    std::map<std::string, bool> dependent_rulenames;
+    for (std::map<boost::shared_ptr<recipe>, bool>::const_iterator dep_iter = dependent_recipes.begin();
+         dep_iter != dependent_recipes.end(); ++dep_iter) {
+      if (dep_iter->first->get_rule_name().compare(rule_name)) {
+        dependent_rulenames[dep_iter->first->get_rule_name()] = true;
+      }
+    }
+    for (std::map<std::string, bool>::const_iterator name_iter = dependent_rulenames.begin();
+         name_iter != dependent_rulenames.end(); ++name_iter) {
+      plan.dependent_rules.push_back(name_iter->first);
+    }
+    // the same copies as create_workspace, in the same order
+    boost::filesystem::path rule_parent_path = test_parent_path / rule_name;
+    boost::filesystem::path workspace_path = rule_parent_path / "workspace";
+    plan_contents((*iter)->get_outputs(), pipeline_top_dir / pipeline_run_dir,
+                  rule_parent_path / "expected" / pipeline_run_dir, "output", &plan.copies);
+    for (std::map<boost::shared_ptr<recipe>, bool>::const_iterator dep_iter = dependent_recipes.begin();
+         dep_iter != dependent_recipes.end(); ++dep_iter) {
+      if (!dep_iter->first->get_rule_name().compare(rule_name)) {
+        plan_contents(dep_iter->first->get_inputs(), pipeline_top_dir / pipeline_run_dir,
+                      workspace_path / pipeline_run_dir, "input", &plan.copies);
+      } else {
+        plan_contents(dep_iter->first->get_outputs(), pipeline_top_dir / pipeline_run_dir,
+                      workspace_path / pipeline_run_dir, "upstream output", &plan.copies);
+      }
+    }
+    plan_contents(added_files, pipeline_top_dir, workspace_path, "added file", &plan.copies);
+    plan_contents(added_directories, pipeline_top_dir, workspace_path, "added directory", &plan.copies);
+    target->push_back(plan);
+  }
+}
+
+void snakemake_unit_tests::solved_rules::plan_contents(const std::vector<boost::filesystem::path> &contents,
+                                                       const boost::filesystem::path &source_prefix,
+                                                       const boost::filesystem::path &target_prefix,
+                                                       const std::string &purpose,
+                                                       std::vector<planned_copy> *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to plan_contents");
+  std::map<boost::filesystem::path, bool> planned_sources;
+  for (std::vector<boost::filesystem::path>::const_iterator iter = contents.begin(); iter != contents.end(); ++iter) {
+    planned_copy copy;
+    copy.purpose = purpose;
+    bool outside_workspace = false;
+    try {
+      outside_workspace = resolve_copy_paths(*iter, source_prefix, target_prefix, &copy.source, &copy.target);
+    } catch (const boost::filesystem::filesystem_error &e) {
+      // absolute paths are resolved through the filesystem, and so must exist
+      copy.source = *iter;
+      copy.target = target_prefix / *iter;
+      copy.status = "missing";
+      target->push_back(copy);
+      continue;
+    }
+    if (outside_workspace) {
+      copy.status = "outside workspace";
+    } else if (!boost::filesystem::is_regular_file(copy.source) && !boost::filesystem::is_directory(copy.source)) {
+      copy.status = "missing";
+    } else if (planned_sources.find(copy.source) != planned_sources.end()) {
+      // copy_contents copies each source only once per call
+      continue;
+    } else {
+      planned_sources[copy.source] = true;
+      copy.status = "copy";
+      copy.size_bytes = content_size(copy.source);
+    }
+    target->push_back(copy);
+  }
+}
+
+unsigned long long snakemake_unit_tests::solved_rules::content_size(const boost::filesystem::path &p) {
+  if (boost::filesystem::is_regular_file(p)) return boost::filesystem::file_size(p);
+  unsigned long long total = 0;
+  if (boost::filesystem::is_directory(p)) {
+    boost::filesystem::recursive_directory_iterator rec_iter(p), rec_end;
+    for (; rec_iter != rec_end; ++rec_iter) {
+      if (boost::filesystem::is_regular_file(rec_iter->path())) total += boost::filesystem::file_size(rec_iter->path());
+    }
+  }
+  return total;
+}
+
+void snakemake_unit_tests::solved_rules::report_plans(const std::vector<rule_plan> &plans, std::ostream &out) {
+  unsigned long long grand_total = 0;
+  for (std::vector<rule_plan>::const_iterator iter = plans.begin(); iter != plans.end(); ++iter) {
+    unsigned long long rule_total = 0;
+    out << "rule \"" << iter->rule_name << "\" (recipe " << iter->recipe_index << " in log)" << std::endl;
+    out << "  dependent rules:";
+    if (iter->dependent_rules.empty()) out << " none";
+    for (std::vector<std::string>::const_iterator dep_iter = iter->dependent_rules.begin();
+         dep_iter != iter->dependent_rules.end(); ++dep_iter) {
+      out << (dep_iter == iter->dependent_rules.begin() ? " " : ", ") << *dep_iter;
+    }
+    out << std::endl;
+    for (std::vector<planned_copy>::const_iterator copy_iter = iter->copies.begin(); copy_iter != iter->copies.end();
+         ++copy_iter) {
+      out << "  " << copy_iter->purpose << ": " << copy_iter->source.string();
+      if (!copy_iter->status.compare("copy")) {
+        out << " (" << copy_iter->size_bytes << " bytes)";
+        rule_total += copy_iter->size_bytes;
+      } else {
+        out << " (" << copy_iter->status << ")";
+      }
+      out << std::endl;
+    }
+    out << "  total: " << rule_total << " bytes" << std::endl;
+    grand_total += rule_total;
+  }
+  out << "planned " << plans.size() << " test" << (plans.size() == 1 ? "" : "s") << ", copying " << grand_total
+      << " bytes" << std::endl;
+}
+
+void snakemake_unit_tests::solved_rules::report_plans_json(const std::vector<rule_plan> &plans, std::ostream &out) {
+  out << "[";
+  for (std::vector<rule_plan>::const_iterator iter = plans.begin(); iter != plans.end(); ++iter) {
+    out << (iter == plans.begin() ? "\n" : ",\n") << "  {\"rule\": \"" << json_escape(iter->rule_name)
+        << "\", \"recipe_index\": " << iter->recipe_index << ", \"dependent_rules\": [";
+    for (std::vector<std::string>::const_iterator dep_iter = iter->dependent_rules.begin();
+         dep_iter != iter->dependent_rules.end(); ++dep_iter) {
+      out << (dep_iter == iter->dependent_rules.begin() ? "\"" : ", \"") << json_escape(*dep_iter) << "\"";
+    }
+    out << "], \"copies\": [";
+    for (std::vector<planned_copy>::const_iterator copy_iter = iter->copies.begin(); copy_iter != iter->copies.end();
+         ++copy_iter) {
+      out << (copy_iter == iter->copies.begin() ? "\n" : ",\n") << "    {\"purpose\": \""
+          << json_escape(copy_iter->purpose) << "\", \"source\": \"" << json_escape(copy_iter->source.string())
+          << "\", \"target\": \"" << json_escape(copy_iter->target.string()) << "\", \"status\": \""
+          << json_escape(copy_iter->status) << "\", \"size_bytes\": " << copy_iter->size_bytes << "}";
+    }
+    out << (iter->copies.empty() ? "" : "\n  ") << "]}";
+  }
+  out << (plans.empty() ? "" : "\n") << "]\n";
+}
+
+void snakemake_unit_tests::solved_rules::write_if_changed(const std::string &filename,
+                                                          const std::vector<std::string_view> &segments) const {
+  if (write_segments_if_changed(filename, segments)) {
+    ++_files_written;
+  } else {
+    ++_files_unchanged;
+  }
+}
+
+void snakemake_unit_tests::solved_rules::add_referenced_recipes(
+    const std::string &rule_name, const std::map<std::string, std::map<std::string, bool>> &references,
+    const snakemake_file &sf, std::map<boost::shared_ptr<recipe>, bool> *target) const {
+  if (!target) throw std::runtime_error("null pointer to solved_rules::add_referenced_recipes");
+  std::map<std::string, bool> visited, referenced;
+  std::deque<std::string> pending;
+  pending.push_back(rule_name);
+  visited[rule_name] = true;
+  std::string parent = "";
+  while (!pending.empty()) {
+    std::string current = pending.front();
+    pending.pop_front();
+    std::map<std::string, std::map<std::string, bool>>::const_iterator finder = references.find(current);
+    if (finder != references.end()) {
+      for (std::map<std::string, bool>::const_iterator ref = finder->second.begin(); ref != finder->second.end();
+           ++ref) {
+        referenced[ref->first] = true;
+        if (visited.find(ref->first) == visited.end()) {
+          visited[ref->first] = true;
+          pending.push_back(ref->first);
+        }
+      }
+    }
+    // derived rules inherit the references of their base rules
+    if (sf.get_base_rule_name(current, &parent) && !parent.empty() && visited.find(parent) == visited.end()) {
+      visited[parent] = true;
+      pending.push_back(parent);
+    }
+  }
+  referenced.erase(rule_name);
+  for (std::vector<boost::shared_ptr<recipe>>::const_iterator iter = _recipes.begin(); iter != _recipes.end(); ++iter) {
+    if (referenced.find((*iter)->get_rule_name()) != referenced.end()) {
+      (*target)[*iter] = true;
+    }
+  }
+}
+
 void snakemake_unit_tests::solved_rules::find_missing_rules(const std::vector<std::string> &snakemake_exec,
                                                             std::map<std::string, bool> *target) const {
   if (!target) throw std::runtime_error("null pointer to solved_rules::find_missing_rules");
-  // target error pattern is: "'(Rules|Checkpoints)' object has no attribute 'RULENAME'"
-  const boost::regex rule_missing("^.*'Rules' object has no attribute '([^']+)'.*\n$");
-  // new in late snakemake 7: yet another message syntax for missing rulesdot
-  const boost::regex rule_missing_snakemake7("^.*Rule ([^ ]+) is not defined in this workflow.*\n$");
-  const boost::regex checkpoint_missing("^.*'Checkpoints' object has no attribute '([^']+)'.*\n$");
-  const boost::regex any_error("^.*[eE][xX][cC][eE][pP][tT][iI][oO][nN].*\n?$");
   bool found_error = false, found_permitted_error = false;
   for (std::vector<std::string>::const_iterator iter = snakemake_exec.begin(); iter != snakemake_exec.end(); ++iter) {
-    boost::smatch regex_result;
-    if (boost::regex_match(*iter, regex_result, rule_missing) ||
-        boost::regex_match(*iter, regex_result, rule_missing_snakemake7) ||
-        boost::regex_match(*iter, regex_result, checkpoint_missing)) {
-      target->insert(std::make_pair(regex_result[1].str(), true));
+    if (find_missing_rule(*iter, target, &found_error)) {
       found_permitted_error = true;
     }
-    if (boost::regex_match(*iter, regex_result, any_error)) {
-      found_error = true;
-    }
   }
   if (found_error && !found_permitted_error) {
-    for (std::vector<std::string>::const_iterator iter = snakemake_exec.begin(); iter != snakemake_exec.end(); ++iter) {
-      std::cerr << *iter;
-    }
-    throw std::runtime_error(
-        "snakemake dryrun found unhandled error, indicating something wrong with either "
-        "the configuration of this run or the internal logic of snakemake_unit_tests; "
-        "please inspect the logging information above to determine which. in particular, "
-        "any message about missing infrastructure files from this workflow (e.g. config.yaml) "
-        "may indicate that you need to add more things to added-files or added-directories, "
-        "for files that are necessary for pipeline functionality but that exist outside "
-        "of the DAG.");
+    report_unhandled_dryrun_error(snakemake_exec);
+  }
+}
+
+bool snakemake_unit_tests::solved_rules::find_missing_rule(std::string_view line, std::map<std::string, bool> *target,
+                                                           bool *found_error) const {
+  if (!target || !found_error) throw std::runtime_error("null pointer to solved_rules::find_missing_rule");
+  // target error pattern is: "'(Rules|Checkpoints)' object has no attribute 'RULENAME'"
+  static const boost::regex rule_missing("^.*'Rules' object has no attribute '([^']+)'.*\n$");
+  // new in late snakemake 7: yet another message syntax for missing rulesdot
+  static const boost::regex rule_missing_snakemake7("^.*Rule ([^ ]+) is not defined in this workflow.*\n$");
+  static const boost::regex checkpoint_missing("^.*'Checkpoints' object has no attribute '([^']+)'.*\n$");
+  static const boost::regex any_error("^.*[eE][xX][cC][eE][pP][tT][iI][oO][nN].*\n?$");
+  const char *begin = line.data(), *end = line.data() + line.size();
+  boost::cmatch regex_result;
+  bool found_missing_rule = false;
+  if (boost::regex_match(begin, end, regex_result, rule_missing) ||
+      boost::regex_match(begin, end, regex_result, rule_missing_snakemake7) ||
+      boost::regex_match(begin, end, regex_result, checkpoint_missing)) {
+    target->insert(std::make_pair(regex_result[1].str(), true));
+    found_missing_rule = true;
   }
+  if (boost::regex_match(begin, end, regex_result, any_error)) {
+    *found_error = true;
+  }
+  return found_missing_rule;
+}
+
+void snakemake_unit_tests::solved_rules::report_unhandled_dryrun_error(
+    const std::vector<std::string> &snakemake_exec) const {
+  for (std::vector<std::string>::const_iterator iter = snakemake_exec.begin(); iter != snakemake_exec.end(); ++iter) {
+    std::cerr << *iter;
+  }
+  throw std::runtime_error(
+      "snakemake dryrun found unhandled error, indicating something wrong with either "
+      "the configuration of this run or the internal logic of snakemake_unit_tests; "
+      "please inspect the logging information above to determine which. in particular, "
+      "any message about missing infrastructure files from this workflow (e.g. config.yaml) "
+      "may indicate that you need to add more things to added-files or added-directories, "
+      "for files that are necessary for pipeline functionality but that exist outside "
+      "of the DAG.");
 }
 
 void snakemake_unit_tests::solved_rules::add_dag_from_leaf(const boost::shared_ptr<recipe> &rec,
@@ -290,6 +619,8 @@ void snakemake_unit_tests::solved_rules::create_workspace(
     const std::vector<boost::filesystem::path> &added_directories, bool update_snakefiles, bool update_added_content,
     bool update_inputs, bool update_outputs, bool update_pytest, bool include_entire_dag,
     std::map<std::string, std::vector<std::string>> *files_outside_workspace) const {
+  tracer::span workspace_span(profiler::tracer_of(_profiler), "create_workspace", "workspace");
+  workspace_span.add_arg("rule", rec->get_rule_name());
   // new: deal with rule structures that drag a certain number of upstream
   // recipes with them:
   //  - scattergather
@@ -322,10 +653,42 @@ void snakemake_unit_tests::solved_rules::create_workspace(
       boost::filesystem::create_directories(rule_expected_path);
       boost::filesystem::create_directories(workspace_path);
     }
+    // copies gzipped under their own names, relative to the test directory
+    boost::filesystem::path compressed_path = rule_parent_path / "compressed.txt";
+    std::map<std::string, bool> compressed_entries;
+    std::vector<boost::filesystem::path> compressed_outputs, compressed_inputs;
+    if ((update_inputs || update_outputs) && boost::filesystem::is_regular_file(compressed_path)) {
+      std::ifstream input(compressed_path.string().c_str());
+      std::string line = "";
+      while (std::getline(input, line)) {
+        // entries for the content being replaced are listed again only if they are compressed again
+        if (line.empty() || (update_outputs && line.find("expected/") == 0) ||
+            (update_inputs && line.find("workspace/") == 0))
+          continue;
+        compressed_entries[line] = true;
+      }
+      input.close();
+    }
     if (update_outputs) {
-      // copy *output* to expected path
-      copy_contents(rec->get_outputs(), pipeline_top_dir / pipeline_run_dir, rule_expected_path / pipeline_run_dir,
-                    rec->get_rule_name(), files_outside_workspace);
+      boost::filesystem::path manifest_path = rule_parent_path / "expected.sha256";
+      if (_output_digests) {
+        // record digests of *output*, in place of copies at the expected path
+        std::map<std::string, std::string> manifest;
+        digest_contents(rec->get_outputs(), pipeline_top_dir / pipeline_run_dir, rule_expected_path / pipeline_run_dir,
+                        rule_expected_path, rec->get_rule_name(), &manifest, files_outside_workspace);
+        std::string manifest_text = "";
+        for (std::map<std::string, std::string>::const_iterator iter = manifest.begin(); iter != manifest.end();
+             ++iter) {
+          manifest_text += iter->second + "  " + iter->first + "\n";
+        }
+        write_if_changed(manifest_path.string(), std::vector<std::string_view>(1, manifest_text));
+      } else {
+        // copy *output* to expected path
+        copy_contents(rec->get_outputs(), pipeline_top_dir / pipeline_run_dir, rule_expected_path / pipeline_run_dir,
+                      rec->get_rule_name(), files_outside_workspace, &compressed_outputs);
+        // copies replace any digests recorded by an earlier run
+        boost::filesystem::remove(manifest_path);
+      }
     }
     if (update_inputs) {
       // copy *input* to workspace
@@ -334,14 +697,34 @@ void snakemake_unit_tests::solved_rules::create_workspace(
            iter != dependent_recipes.end(); ++iter) {
         if (!iter->first->get_rule_name().compare(rec->get_rule_name())) {
           copy_contents(iter->first->get_inputs(), pipeline_top_dir / pipeline_run_dir,
-                        workspace_path / pipeline_run_dir, rec->get_rule_name(), files_outside_workspace);
+                        workspace_path / pipeline_run_dir, rec->get_rule_name(), files_outside_workspace,
+                        &compressed_inputs);
         } else {
           // upstream rules should have their *outputs* emitted as *input* to the unit test
           copy_contents(iter->first->get_outputs(), pipeline_top_dir / pipeline_run_dir,
-                        workspace_path / pipeline_run_dir, rec->get_rule_name(), files_outside_workspace);
+                        workspace_path / pipeline_run_dir, rec->get_rule_name(), files_outside_workspace,
+                        &compressed_inputs);
         }
       }
     }
+    if (update_inputs || update_outputs) {
+      compressed_outputs.insert(compressed_outputs.end(), compressed_inputs.begin(), compressed_inputs.end());
+      for (std::vector<boost::filesystem::path>::const_iterator iter = compressed_outputs.begin();
+           iter != compressed_outputs.end(); ++iter) {
+        compressed_entries[iter->lexically_normal().lexically_relative(rule_parent_path.lexically_normal()).string()] =
+            true;
+      }
+      if (compressed_entries.empty()) {
+        boost::filesystem::remove(compressed_path);
+      } else {
+        std::string compressed_text = "";
+        for (std::map<std::string, bool>::const_iterator iter = compressed_entries.begin();
+             iter != compressed_entries.end(); ++iter) {
+          compressed_text += iter->first + "\n";
+        }
+        write_if_changed(compressed_path.string(), std::vector<std::string_view>(1, compressed_text));
+      }
+    }
     if (update_added_content) {
       // copy extra files and directories, if provided, to workspace
       copy_contents(added_files, pipeline_top_dir, workspace_path, "added files", files_outside_workspace);
@@ -366,6 +749,8 @@ void snakemake_unit_tests::solved_rules::create_workspace(
           throw std::runtime_error("unable to locate required rule \"" + possible_children.front() + "\"");
         }
       }
+    }
+    if (update_snakefiles) {
       // enforce success across possibly many files by checking the sum
       // of found rules. logic only works because the postflight checker
       // enforces lack of redundant rulenames.
@@ -375,9 +760,12 @@ void snakemake_unit_tests::solved_rules::create_workspace(
     }
     // modify repo inst/test.py into a test runner for this rule
     if (update_pytest) {
+      // environments are listed for the runner to build once, in a shared prefix
+      std::map<boost::filesystem::path, bool> conda_envs;
+      if (!_conda_prefix.empty()) sf.report_conda_envs(dependent_rulenames, &conda_envs);
       report_modified_test_script(test_parent_path, output_test_dir, rec->get_rule_name(),
-                                  sf.get_snakefile_relative_path(), pipeline_run_dir, extra_comparison_exclusions,
-                                  inst_test_py);
+                                  sf.get_snakefile_relative_path(), pipeline_run_dir, rec->get_threads(),
+                                  rec->get_resources(), conda_envs, extra_comparison_exclusions, inst_test_py);
     }
   }
 }
@@ -391,16 +779,34 @@ unsigned snakemake_unit_tests::solved_rules::emit_snakefile(const snakemake_file
   boost::filesystem::create_directories((workspace_path / sf.get_snakefile_relative_path()).parent_path());
   // create the synthetic snakefile in workspace
   std::string output_filename = (workspace_path / sf.get_snakefile_relative_path()).string();
-  std::ofstream output;
-  output.open(output_filename.c_str());
-  if (!output.is_open()) throw std::runtime_error("cannot create synthetic snakemake file \"" + output_filename + "\"");
+  unsigned res = 0;
+  if (sf.segments_rendered()) {
+    // pre-rendered text: assemble the file from shared and per-rule segments
+    std::vector<std::string_view> segments;
+    std::ostringstream phony_all;
+    if (requires_phony_all) {
+      report_phony_all_target(phony_all, rec->get_outputs());
+    }
+    std::string phony_all_text = phony_all.str();
+    segments.push_back(phony_all_text);
+    res = sf.select_rendered_segments(dependent_rulenames, &segments);
+    write_if_changed(output_filename, segments);
+    for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file>>::const_iterator mapper =
+             sf.loaded_files().begin();
+         mapper != sf.loaded_files().end(); ++mapper) {
+      res += emit_snakefile(*mapper->second, workspace_path, rec, dependent_rulenames, false);
+    }
+    return res;
+  }
+  std::ostringstream output;
   // before adding anything else: add a single 'all' rule that points at
   // solved rule output files
   // note: only do this at top level
   if (requires_phony_all) report_phony_all_target(output, rec->get_outputs());
   // find the rule from the parsed snakefile(s) and report it to file
-  unsigned res = sf.report_single_rule(dependent_rulenames, output);
-  output.close();
+  res = sf.report_single_rule(dependent_rulenames, output);
+  std::string output_text = output.str();
+  write_if_changed(output_filename, std::vector<std::string_view>(1, output_text));
   for (std::map<boost::filesystem::path, boost::shared_ptr<snakemake_file>>::const_iterator mapper =
            sf.loaded_files().begin();
        mapper != sf.loaded_files().end(); ++mapper) {
@@ -427,34 +833,54 @@ void snakemake_unit_tests::solved_rules::remove_empty_workspace(const boost::fil
   boost::filesystem::remove_all(output_test_dir / ".snakemake_unit_tests");
 }
 
+bool snakemake_unit_tests::solved_rules::resolve_copy_paths(const boost::filesystem::path &entry,
+                                                            const boost::filesystem::path &source_prefix,
+                                                            const boost::filesystem::path &target_prefix,
+                                                            boost::filesystem::path *source_file,
+                                                            boost::filesystem::path *target_file) const {
+  if (!source_file || !target_file) throw std::runtime_error("null pointer provided to resolve_copy_paths");
+  *source_file = source_prefix / entry;
+  *target_file = target_prefix / entry;
+  // deal with the fact that source prefix might be an absolute path :(
+  if (boost::filesystem::absolute(entry) == entry) {
+    // corner case: for some reason, snakemake is tracking absolute path of
+    // something that is still actually in the pipeline directory
+    if (boost::filesystem::canonical(boost::filesystem::absolute(entry))
+            .string()
+            .find(boost::filesystem::canonical(boost::filesystem::absolute(source_prefix)).string()) == 0) {
+      *source_file = entry;
+      *target_file = target_prefix / boost::filesystem::relative(
+                                         boost::filesystem::canonical(boost::filesystem::absolute(entry)),
+                                         boost::filesystem::canonical(boost::filesystem::absolute(source_prefix)));
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
 void snakemake_unit_tests::solved_rules::copy_contents(
     const std::vector<boost::filesystem::path> &contents, const boost::filesystem::path &source_prefix,
     const boost::filesystem::path &target_prefix, const std::string &rule_name,
-    std::map<std::string, std::vector<std::string>> *files_outside_workspace) const {
+    std::map<std::string, std::vector<std::string>> *files_outside_workspace,
+    std::vector<boost::filesystem::path> *compressed) const {
+  tracer::span copy_span(profiler::tracer_of(_profiler), "copy_contents", "copy");
+  copy_span.add_arg("rule", rule_name);
+  copy_span.add_arg("entries", std::to_string(contents.size()));
   std::map<boost::filesystem::path, bool> copied_sources;
+  // source and target of each regular file to compress, including those within directories
+  std::vector<std::pair<boost::filesystem::path, boost::filesystem::path>> to_compress;
+  bool compress = _compress_test_data && compressed;
   for (std::vector<boost::filesystem::path>::const_iterator iter = contents.begin(); iter != contents.end(); ++iter) {
-    boost::filesystem::path source_file = source_prefix / *iter;
-    boost::filesystem::path target_file = target_prefix / *iter;
-    // deal with the fact that source prefix might be an absolute path :(
-    if (boost::filesystem::absolute(*iter) == *iter) {
-      // corner case: for some reason, snakemake is tracking absolute path of
-      // something that is still actually in the pipeline directory
-      if (boost::filesystem::canonical(boost::filesystem::absolute(*iter))
-              .string()
-              .find(boost::filesystem::canonical(boost::filesystem::absolute(source_prefix)).string()) == 0) {
-        source_file = *iter;
-        target_file = target_prefix / boost::filesystem::relative(
-                                          boost::filesystem::canonical(boost::filesystem::absolute(*iter)),
-                                          boost::filesystem::canonical(boost::filesystem::absolute(source_prefix)));
-      } else if (files_outside_workspace) {
-        std::map<std::string, std::vector<std::string>>::iterator file_finder;
-        if ((file_finder = files_outside_workspace->find(iter->string())) == files_outside_workspace->end()) {
-          file_finder =
-              files_outside_workspace->insert(std::make_pair(iter->string(), std::vector<std::string>())).first;
-        }
-        file_finder->second.push_back(rule_name);
-        continue;
+    boost::filesystem::path source_file, target_file;
+    if (resolve_copy_paths(*iter, source_prefix, target_prefix, &source_file, &target_file) &&
+        files_outside_workspace) {
+      std::map<std::string, std::vector<std::string>>::iterator file_finder;
+      if ((file_finder = files_outside_workspace->find(iter->string())) == files_outside_workspace->end()) {
+        file_finder = files_outside_workspace->insert(std::make_pair(iter->string(), std::vector<std::string>())).first;
       }
+      file_finder->second.push_back(rule_name);
+      continue;
     }
     // check source exists
     if (!boost::filesystem::is_regular_file(source_file) && !boost::filesystem::is_directory(source_file)) {
@@ -480,10 +906,173 @@ void snakemake_unit_tests::solved_rules::copy_contents(
         }
         boost::filesystem::remove_all(target_file);
       }
-      // then copy
-      boost::filesystem::copy(
-          source_file, target_file,
-          boost::filesystem::copy_options::overwrite_existing | boost::filesystem::copy_options::recursive);
+      if (!compress) {
+        // then copy
+        boost::filesystem::copy(
+            source_file, target_file,
+            boost::filesystem::copy_options::overwrite_existing | boost::filesystem::copy_options::recursive);
+      } else if (boost::filesystem::is_directory(source_file)) {
+        // recreate the directory tree, and compress its files once it exists
+        boost::filesystem::create_directories(target_file);
+        boost::filesystem::recursive_directory_iterator rec_iter(source_file), rec_end;
+        for (; rec_iter != rec_end; ++rec_iter) {
+          boost::filesystem::path nested_target = target_file / rec_iter->path().lexically_relative(source_file);
+          if (boost::filesystem::is_directory(rec_iter->path())) {
+            boost::filesystem::create_directories(nested_target);
+          } else if (boost::filesystem::is_regular_file(rec_iter->path())) {
+            to_compress.push_back(std::make_pair(rec_iter->path(), nested_target));
+          } else {
+            boost::filesystem::copy(rec_iter->path(), nested_target);
+          }
+        }
+      } else {
+        to_compress.push_back(std::make_pair(source_file, target_file));
+      }
+    }
+  }
+  // compression is the bottleneck of a compressed copy, so files are compressed in parallel
+  std::vector<char> was_compressed(to_compress.size(), 0);
+  run_in_parallel(to_compress.size(), _compression_threads, [&](unsigned i) {
+    was_compressed.at(i) = compress_file(to_compress.at(i).first, to_compress.at(i).second);
+  });
+  for (unsigned i = 0; i < to_compress.size(); ++i) {
+    if (was_compressed.at(i)) compressed->push_back(to_compress.at(i).second);
+  }
+}
+
+bool snakemake_unit_tests::solved_rules::compress_file(const boost::filesystem::path &source_file,
+                                                       const boost::filesystem::path &target_file) {
+  std::ifstream input(source_file.string().c_str(), std::ios_base::binary);
+  if (!input.is_open()) throw std::runtime_error("cannot open \"" + source_file.string() + "\" for compression");
+  char magic[2] = {0, 0};
+  input.read(magic, 2);
+  if (input.gcount() == 2 && magic[0] == '\x1f' && magic[1] == '\x8b') {
+    // compressing again would only cost time
+    input.close();
+    boost::filesystem::copy_file(source_file, target_file, boost::filesystem::copy_options::overwrite_existing);
+    return false;
+  }
+  input.clear();
+  input.seekg(0);
+  gzFile output = gzopen(target_file.string().c_str(), "wb6");
+  if (!output) throw std::runtime_error("cannot open \"" + target_file.string() + "\" for writing");
+  std::string buffer(1 << 17, '\0');
+  while (input.read(&buffer[0], buffer.size()) || input.gcount() > 0) {
+    if (gzwrite(output, buffer.data(), input.gcount()) != input.gcount()) {
+      gzclose(output);
+      throw std::runtime_error("cannot write compressed copy \"" + target_file.string() + "\"");
+    }
+  }
+  if (gzclose(output) != Z_OK)
+    throw std::runtime_error("cannot finish compressed copy \"" + target_file.string() + "\"");
+  input.close();
+  return true;
+}
+
+std::string snakemake_unit_tests::solved_rules::fingerprint_test(const boost::filesystem::path &rule_parent_path,
+                                                                unsigned threads) {
+  // entries by relative path, so that the manifest does not depend on directory order
+  std::map<std::string, boost::filesystem::path> entries;
+  const char *manifests[] = {"expected.sha256", "compressed.txt"};
+  for (unsigned i = 0; i < 2; ++i) {
+    if (boost::filesystem::is_regular_file(rule_parent_path / manifests[i]))
+      entries[manifests[i]] = rule_parent_path / manifests[i];
+  }
+  const char *trees[] = {"workspace", "expected"};
+  for (unsigned i = 0; i < 2; ++i) {
+    if (!boost::filesystem::is_directory(rule_parent_path / trees[i])) continue;
+    boost::filesystem::recursive_directory_iterator iter(rule_parent_path / trees[i]), end;
+    for (; iter != end; ++iter) {
+      // snakemake's own state from dry runs is not test data
+      if (!i && iter.depth() == 0 && iter->path().filename() == ".snakemake") {
+        iter.disable_recursion_pending();
+        continue;
+      }
+      entries[iter->path().lexically_relative(rule_parent_path).string()] = iter->path();
+    }
+  }
+  std::vector<std::map<std::string, boost::filesystem::path>::const_iterator> ordered;
+  for (std::map<std::string, boost::filesystem::path>::const_iterator iter = entries.begin(); iter != entries.end();
+       ++iter) {
+    ordered.push_back(iter);
+  }
+  // links are recorded by target and directories by name, so that neither is followed
+  std::vector<std::string> digests(ordered.size());
+  run_in_parallel(ordered.size(), threads, [&](unsigned i) {
+    const boost::filesystem::path &entry = ordered.at(i)->second;
+    if (boost::filesystem::is_symlink(entry)) {
+      digests.at(i) = "link:" + boost::filesystem::read_symlink(entry).string();
+    } else if (boost::filesystem::is_directory(entry)) {
+      digests.at(i) = "directory";
+    } else {
+      digests.at(i) = output_checker::digest(entry, "byte", 1);
+    }
+  });
+  sha256 hasher;
+  for (unsigned i = 0; i < ordered.size(); ++i) {
+    hasher.update(digests.at(i) + "  " + ordered.at(i)->first + "\n");
+  }
+  return hasher.hex_digest();
+}
+
+void snakemake_unit_tests::solved_rules::digest_contents(
+    const std::vector<boost::filesystem::path> &contents, const boost::filesystem::path &source_prefix,
+    const boost::filesystem::path &target_prefix, const boost::filesystem::path &expected_path,
+    const std::string &rule_name, std::map<std::string, std::string> *manifest,
+    std::map<std::string, std::vector<std::string>> *files_outside_workspace) const {
+  if (!manifest) throw std::runtime_error("null pointer provided to digest_contents");
+  if (!_output_digests) throw std::logic_error("digest_contents called without a checker to digest with");
+  tracer::span digest_span(profiler::tracer_of(_profiler), "digest_contents", "copy");
+  digest_span.add_arg("rule", rule_name);
+  digest_span.add_arg("entries", std::to_string(contents.size()));
+  // source and target of each regular file, including those within directories
+  std::vector<std::pair<boost::filesystem::path, boost::filesystem::path>> files;
+  std::map<boost::filesystem::path, bool> digested_sources;
+  for (std::vector<boost::filesystem::path>::const_iterator iter = contents.begin(); iter != contents.end(); ++iter) {
+    boost::filesystem::path source_file, target_file;
+    if (resolve_copy_paths(*iter, source_prefix, target_prefix, &source_file, &target_file) &&
+        files_outside_workspace) {
+      (*files_outside_workspace)[iter->string()].push_back(rule_name);
+      continue;
+    }
+    if (!boost::filesystem::is_regular_file(source_file) && !boost::filesystem::is_directory(source_file)) {
+      throw std::runtime_error("cannot find file/directory \"" + source_file.string() + "\" for " + rule_name);
+    }
+    if (digested_sources.find(source_file) != digested_sources.end()) continue;
+    digested_sources[source_file] = true;
+    if (boost::filesystem::is_directory(source_file)) {
+      boost::filesystem::recursive_directory_iterator rec_iter(source_file), rec_end;
+      for (; rec_iter != rec_end; ++rec_iter) {
+        if (boost::filesystem::is_regular_file(rec_iter->path())) {
+          files.push_back(
+              std::make_pair(rec_iter->path(), target_file / rec_iter->path().lexically_relative(source_file)));
+        }
+      }
+    } else {
+      files.push_back(std::make_pair(source_file, target_file));
+    }
+  }
+  // outputs are the bulk of the data, so they are hashed in parallel
+  std::vector<std::string> methods(files.size()), digests(files.size());
+  run_in_parallel(files.size(), _output_digests->get_jobs(), [&](unsigned i) {
+    methods.at(i) = _output_digests->digest_method(files.at(i).first);
+    if (!methods.at(i).empty()) digests.at(i) = output_checker::digest(files.at(i).first, methods.at(i));
+  });
+  for (unsigned i = 0; i < files.size(); ++i) {
+    const boost::filesystem::path &target_file = files.at(i).second;
+    // copies from an earlier run would be compared in place of the digests
+    if (boost::filesystem::is_regular_file(target_file)) {
+      boost::filesystem::permissions(target_file, boost::filesystem::owner_write | boost::filesystem::add_perms);
+      boost::filesystem::remove(target_file);
+    }
+    if (methods.at(i).empty()) {
+      // tolerance comparisons need the whole file
+      boost::filesystem::create_directories(target_file.parent_path());
+      boost::filesystem::copy_file(files.at(i).first, target_file);
+    } else {
+      std::string relative_path =
+          target_file.lexically_normal().lexically_relative(expected_path.lexically_normal()).string();
+      (*manifest)[relative_path] = digests.at(i) + "  " + methods.at(i);
     }
   }
 }
@@ -507,19 +1096,37 @@ void snakemake_unit_tests::solved_rules::report_phony_all_target(
 void snakemake_unit_tests::solved_rules::report_modified_test_script(
     const boost::filesystem::path &parent_dir, const boost::filesystem::path &test_dir, const std::string &rule_name,
     const boost::filesystem::path &snakefile_relative_path, const boost::filesystem::path &pipeline_run_dir,
+    unsigned threads, const std::map<std::string, std::string> &resources,
+    const std::map<boost::filesystem::path, bool> &conda_envs,
     const std::vector<boost::filesystem::path> &extra_comparison_exclusions,
     const boost::filesystem::path &inst_test_py) const {
   std::ifstream input;
-  std::ofstream output;
+  std::ostringstream output;
   std::string test_python_file = (parent_dir / ("test_" + rule_name + ".py")).string();
-  output.open(test_python_file.c_str());
-  if (!output.is_open()) throw std::runtime_error("cannot write test python file \"" + test_python_file + "\"");
   if (!(output << "#!/usr/bin/env python3\ntestdir='" << test_dir.string() << "'" << std::endl
                << "rulename='" << rule_name << '\'' << std::endl
                << "snakefile_relative_path='" << snakefile_relative_path.string() << "'" << std::endl
                << "snakemake_exec_path='" << pipeline_run_dir.string() << "'" << std::endl
-               << "extra_comparison_exclusions=["))
+               << "threads=" << threads << std::endl
+               << "resources={"))
     throw std::runtime_error("cannot write rulename variable to test python file \"" + test_python_file + "\"");
+  // resources are recorded as logged, for the runner to schedule with
+  for (std::map<std::string, std::string>::const_iterator iter = resources.begin(); iter != resources.end(); ++iter) {
+    if (!(output << "'" << python_escape(iter->first) << "': '" << python_escape(iter->second) << "', "))
+      throw std::runtime_error("cannot write resources to test python file \"" + test_python_file + "\"");
+  }
+  if (!(output << "}" << std::endl
+               << "conda_prefix='" << python_escape(_conda_prefix.string()) << "'" << std::endl
+               << "conda_envs=["))
+    throw std::runtime_error("cannot write conda settings to test python file \"" + test_python_file + "\"");
+  for (std::map<boost::filesystem::path, bool>::const_iterator iter = conda_envs.begin(); iter != conda_envs.end();
+       ++iter) {
+    if (!(output << "'" << python_escape(iter->first.string()) << "', "))
+      throw std::runtime_error("cannot write conda environments to test python file \"" + test_python_file + "\"");
+  }
+  if (!(output << "]" << std::endl << "extra_comparison_exclusions=["))
+    throw std::runtime_error("cannot write extra comparison exclusions to test python file \"" + test_python_file +
+                             "\"");
   for (std::vector<boost::filesystem::path>::const_iterator iter = extra_comparison_exclusions.begin();
        iter != extra_comparison_exclusions.end(); ++iter) {
     if (!(output << "'" << iter->string() << "', "))
@@ -534,17 +1141,16 @@ void snakemake_unit_tests::solved_rules::report_modified_test_script(
   if (!(output << input.rdbuf()))
     throw std::runtime_error("cannot dump \"" + inst_test_py.string() + "\" to output \"" + test_python_file + "\"");
   input.close();
-  output.close();
+  std::string output_text = output.str();
+  write_if_changed(test_python_file, std::vector<std::string_view>(1, output_text));
 }
 
 void snakemake_unit_tests::solved_rules::report_modified_launcher_script(
     const boost::filesystem::path &parent_dir, const boost::filesystem::path &test_dir,
     const boost::filesystem::path &inst_launcher_script) const {
   std::ifstream input;
-  std::ofstream output;
+  std::ostringstream output;
   std::string launcher_file = (parent_dir / "pytest_runner.bash").string();
-  output.open(launcher_file.c_str());
-  if (!output.is_open()) throw std::runtime_error("cannot write launcher file \"" + launcher_file + "\"");
   if (!(output << "#!/usr/bin/env bash\nSNAKEMAKE_UNIT_TESTS_DIR=" << test_dir.string() << std::endl)) {
     throw std::runtime_error("cannot write bash header to \"" + launcher_file + "\"");
   }
@@ -555,5 +1161,6 @@ void snakemake_unit_tests::solved_rules::report_modified_launcher_script(
     throw std::runtime_error("cannot dump \"" + inst_launcher_script.string() + "\" to output \"" + launcher_file +
                              "\"");
   input.close();
-  output.close();
+  std::string output_text = output.str();
+  write_if_changed(launcher_file, std::vector<std::string_view>(1, output_text));
 }
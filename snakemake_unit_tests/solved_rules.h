@@ -16,11 +16,14 @@
 #include <map>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "boost/regex.hpp"
 #include "boost/smart_ptr.hpp"
+#include "snakemake_unit_tests/output_checker.h"
+#include "snakemake_unit_tests/profiler.h"
 #include "snakemake_unit_tests/snakemake_file.h"
 #include "snakemake_unit_tests/utilities.h"
 
@@ -86,6 +89,27 @@ class recipe {
     @param s new log filename
    */
   void set_log(const std::string &s);
+  /*!
+    @brief access declared thread count
+    @return threads the job was given in the logged run; 1 if not logged
+   */
+  unsigned get_threads() const;
+  /*!
+    @brief set declared thread count
+    @param threads new thread count
+   */
+  void set_threads(unsigned threads);
+  /*!
+    @brief access declared resources
+    @return resource names and their values as logged, e.g. mem_mb -> 1000
+   */
+  const std::map<std::string, std::string> &get_resources() const;
+  /*!
+    @brief set a declared resource
+    @param name resource name
+    @param value resource value, as logged
+   */
+  void set_resource(const std::string &name, const std::string &value);
   /*!
     @brief clear all stored contents
    */
@@ -116,6 +140,72 @@ class recipe {
     currently done with this information even if present
    */
   std::string _log;
+  /*!
+    @brief threads the job was given in the logged run
+   */
+  unsigned _threads;
+  /*!
+    @brief resources the job declared in the logged run
+
+    parsed from ", " delimited name=value list from log output
+   */
+  std::map<std::string, std::string> _resources;
+};
+/*!
+  @brief a file or directory that a test would copy, as reported by plan_tests
+ */
+struct planned_copy {
+  /*!
+    @brief default constructor
+   */
+  planned_copy() : size_bytes(0) {}
+  /*!
+    @brief what the copy is for: "output", "input", "upstream output",
+    "added file", or "added directory"
+   */
+  std::string purpose;
+  /*!
+    @brief path that would be copied
+   */
+  boost::filesystem::path source;
+  /*!
+    @brief path to which it would be copied
+   */
+  boost::filesystem::path target;
+  /*!
+    @brief "copy"; "missing" if the source does not exist; or "outside workspace"
+    if the source is outside the pipeline and would not be copied
+   */
+  std::string status;
+  /*!
+    @brief size of the source; for directories, the total size of contained files
+   */
+  unsigned long long size_bytes;
+};
+/*!
+  @brief what emit_tests would do for a single rule, without doing it
+ */
+struct rule_plan {
+  /*!
+    @brief default constructor
+   */
+  rule_plan() : recipe_index(0) {}
+  /*!
+    @brief name of the tested rule
+   */
+  std::string rule_name;
+  /*!
+    @brief position of the selected recipe in the snakemake log, counting from 1
+   */
+  unsigned recipe_index;
+  /*!
+    @brief other rules whose recipes would be included in the test snakefile
+   */
+  std::vector<std::string> dependent_rules;
+  /*!
+    @brief files and directories the test would copy, in copy order
+   */
+  std::vector<planned_copy> copies;
 };
 /*!
   @class solved_rules
@@ -128,12 +218,30 @@ class solved_rules {
   /*!
     @brief constructor
    */
-  solved_rules() {}
+  solved_rules()
+      : _files_written(0),
+        _files_unchanged(0),
+        _subprocess_timeout(0.0),
+        _compress_test_data(false),
+        _compression_threads(1),
+        _fingerprint_threads(0) {}
   /*!
     @brief copy constructor
     @param obj existing solved_rules object
    */
-  solved_rules(const solved_rules &obj) : _recipes(obj._recipes), _output_lookup(obj._output_lookup) {}
+  solved_rules(const solved_rules &obj)
+      : _recipes(obj._recipes),
+        _output_lookup(obj._output_lookup),
+        _files_written(obj._files_written),
+        _files_unchanged(obj._files_unchanged),
+        _subprocess_timeout(obj._subprocess_timeout),
+        _subprocess_records(obj._subprocess_records),
+        _profiler(obj._profiler),
+        _output_digests(obj._output_digests),
+        _compress_test_data(obj._compress_test_data),
+        _compression_threads(obj._compression_threads),
+        _fingerprint_threads(obj._fingerprint_threads),
+        _conda_prefix(obj._conda_prefix) {}
   /*!
     @brief destructor
    */
@@ -184,6 +292,42 @@ class solved_rules {
                   bool update_added_content, bool update_inputs, bool update_outputs, bool update_pytest,
                   bool include_entire_dag,
                   std::map<std::string, std::vector<std::string> > *files_outside_workspace) const;
+  /*!
+    @brief describe the tests emit_tests would create, without creating them
+    @param sf snakemake_file object with rule definitions corresponding
+    to loaded log data
+    @param output_test_dir top-level output directory for all tests
+    @param pipeline_top_dir top-level directory of pipeline
+    @param pipeline_run_dir directory from which pipeline was run, relative to pipeline_top_dir
+    @param include_rules set of rules to exclusively include in output
+    @param exclude_rules set of rules to skip in output
+    @param added_files set of files to add to each unit test workspace
+    @param added_directories set of directories to add to each unit test workspace
+    @param include_entire_dag whether to include every upstream rule in each test
+    @param target storage for one plan per emitted rule, in emission order
+
+    rules are selected, and their dependencies closed over, as in emit_tests;
+    but no snakemake dry runs are made, so dependencies that only a dry run
+    would reveal are not listed. nothing is written to the filesystem.
+   */
+  void plan_tests(const snakemake_file &sf, const boost::filesystem::path &output_test_dir,
+                  const boost::filesystem::path &pipeline_top_dir, const boost::filesystem::path &pipeline_run_dir,
+                  const std::map<std::string, bool> &include_rules, const std::map<std::string, bool> &exclude_rules,
+                  const std::vector<boost::filesystem::path> &added_files,
+                  const std::vector<boost::filesystem::path> &added_directories, bool include_entire_dag,
+                  std::vector<rule_plan> *target) const;
+  /*!
+    @brief write test plans in human-readable form
+    @param plans plans from plan_tests
+    @param out stream to which to write
+   */
+  static void report_plans(const std::vector<rule_plan> &plans, std::ostream &out);
+  /*!
+    @brief write test plans as a JSON array
+    @param plans plans from plan_tests
+    @param out stream to which to write
+   */
+  static void report_plans_json(const std::vector<rule_plan> &plans, std::ostream &out);
   /*!
     @brief emit snakefile from parsed snakemake information
     @param sf snakemake_file object with rule definitions corresponding
@@ -274,6 +418,35 @@ class solved_rules {
    */
   void remove_empty_workspace(const boost::filesystem::path &output_test_dir) const;
 
+  /*!
+    @brief compute the source and destination of a tracked file or folder
+    @param entry tracked path, from the log or user configuration
+    @param source_prefix parent directory of source files/folders
+    @param target_prefix directory destination of files/folders
+    @param source_file where to store the path to copy from
+    @param target_file where to store the path to copy to
+    @return whether entry is an absolute path outside of source_prefix
+   */
+  bool resolve_copy_paths(const boost::filesystem::path &entry, const boost::filesystem::path &source_prefix,
+                          const boost::filesystem::path &target_prefix, boost::filesystem::path *source_file,
+                          boost::filesystem::path *target_file) const;
+  /*!
+    @brief describe the copies copy_contents would make, without making them
+    @param contents files or folders that would be copied
+    @param source_prefix parent directory of source files/folders
+    @param target_prefix directory destination of files/folders
+    @param purpose what the copies are for, for reporting
+    @param target storage for planned copies
+   */
+  void plan_contents(const std::vector<boost::filesystem::path> &contents, const boost::filesystem::path &source_prefix,
+                     const boost::filesystem::path &target_prefix, const std::string &purpose,
+                     std::vector<planned_copy> *target) const;
+  /*!
+    @brief compute the size of a file, or the total size of files in a directory
+    @param p file or directory to measure
+    @return size in bytes
+   */
+  static unsigned long long content_size(const boost::filesystem::path &p);
   /*!
     @brief copy files/folders enumerated in vector to a location
     @param contents files or folders to be copied
@@ -283,10 +456,53 @@ class solved_rules {
     @param files_outside_workspace for logging, a collector for
     files that exist outside of the self-contained workspace, which
     will not be copied into the self-contained unit tests
+    @param compressed if not null, and test data are to be compressed, a collector
+    for copies that were gzipped under their own names
    */
   void copy_contents(const std::vector<boost::filesystem::path> &contents, const boost::filesystem::path &source_prefix,
                      const boost::filesystem::path &target_prefix, const std::string &rule_name,
-                     std::map<std::string, std::vector<std::string> > *files_outside_workspace) const;
+                     std::map<std::string, std::vector<std::string> > *files_outside_workspace,
+                     std::vector<boost::filesystem::path> *compressed = 0) const;
+  /*!
+    @brief write a gzipped copy of a file, under whatever name is given
+    @param source_file file to copy
+    @param target_file name of copy
+    @return whether the copy was compressed; files already gzipped are copied as they are
+   */
+  static bool compress_file(const boost::filesystem::path &source_file, const boost::filesystem::path &target_file);
+  /*!
+    @brief compute the fingerprint of an emitted test's data
+    @param rule_parent_path directory of the test, {output-test-dir}/unit/{rule}
+    @param threads number of files to hash at once; 0 for hardware concurrency
+    @return 64 hex character fingerprint
+
+    the fingerprint is the SHA-256 of a manifest of every entry under
+    workspace/ and expected/, with expected.sha256 and compressed.txt:
+    the snakefiles, scripts, environments and inputs the test runs with,
+    and the outputs it expects. a test's run directory, and any .snakemake
+    directory left in its workspace by a dry run, are not included.
+   */
+  static std::string fingerprint_test(const boost::filesystem::path &rule_parent_path, unsigned threads);
+  /*!
+    @brief digest files/folders enumerated in vector, instead of copying them
+    @param contents files or folders to be digested
+    @param source_prefix parent directory of source files/folders
+    @param target_prefix directory where copies would have been placed
+    @param expected_path directory to which manifest paths are relative
+    @param rule_name label for error reporting
+    @param manifest storage for "<digest>  <method>" entries, by relative path
+    @param files_outside_workspace for logging, a collector for
+    files that exist outside of the self-contained workspace, which
+    will not be digested
+
+    files that cannot be digested, as a frame comparator claims them,
+    are copied as copy_contents would copy them.
+   */
+  void digest_contents(const std::vector<boost::filesystem::path> &contents,
+                       const boost::filesystem::path &source_prefix, const boost::filesystem::path &target_prefix,
+                       const boost::filesystem::path &expected_path, const std::string &rule_name,
+                       std::map<std::string, std::string> *manifest,
+                       std::map<std::string, std::vector<std::string> > *files_outside_workspace) const;
 
   /*!
     @brief report phony all target controlling test snakemake run
@@ -301,13 +517,18 @@ class solved_rules {
     @param rule_name name of rule whose test is being emitted
     @param snakefile_relative_path relative path of snakefile in pipeline dir
     @param pipeline_run_dir relative path of snakemake execution within pipeline
+    @param threads threads the rule was given in the logged run
+    @param resources resources the rule declared in the logged run
+    @param conda_envs conda environment files of the test's rules, relative to its workspace
     @param extra_comparison_exclusions vector of files to exclude from pytest
     comparisons
     @param inst_test_py snakemake_unit_tests test.py script location
    */
   void report_modified_test_script(const boost::filesystem::path &parent_dir, const boost::filesystem::path &test_dir,
                                    const std::string &rule_name, const boost::filesystem::path &snakefile_relative_path,
-                                   const boost::filesystem::path &pipeline_run_dir,
+                                   const boost::filesystem::path &pipeline_run_dir, unsigned threads,
+                                   const std::map<std::string, std::string> &resources,
+                                   const std::map<boost::filesystem::path, bool> &conda_envs,
                                    const std::vector<boost::filesystem::path> &extra_comparison_exclusions,
                                    const boost::filesystem::path &inst_test_py) const;
   /*!
@@ -327,6 +548,16 @@ class solved_rules {
     this fallback method is designed specifically to handle toxic uses of snakemake `rules.` notation
    */
   void find_missing_rules(const std::vector<std::string> &snakemake_exec, std::map<std::string, bool> *target) const;
+  /*!
+    @brief parse a single line of test snakemake output for rules missing from dag
+    @param line captured line of snakemake output, including its newline
+    @param target any rule names found in informative snakemake errors
+    @param found_error set if the line reports an error of any kind
+    @return whether the line reported a missing rule
+
+    this allows find_missing_rules logic to be applied to output as it arrives
+   */
+  bool find_missing_rule(std::string_view line, std::map<std::string, bool> *target, bool *found_error) const;
   /*!
     @brief add rules and all dependencies starting from a particular leaf
     @param rec leaf to start adding things from
@@ -336,6 +567,77 @@ class solved_rules {
    */
   void add_dag_from_leaf(const boost::shared_ptr<recipe> &rec, bool include_entire_dag,
                          std::map<boost::shared_ptr<recipe>, bool> *target) const;
+  /*!
+    @brief add recipes for rules reachable through `rules.` and `checkpoints.` references
+    @param rule_name name of rule whose test is being emitted
+    @param references rule reference graph, from snakemake_file::report_rule_references
+    @param sf loaded snakefile representation, for base rule lookup
+    @param target storage for required recipes
+
+    references are followed transitively, including through the base rules
+    of derived rules. this predicts most of what find_missing_rules would
+    otherwise discover one failed dry run at a time.
+   */
+  void add_referenced_recipes(const std::string &rule_name,
+                              const std::map<std::string, std::map<std::string, bool> > &references,
+                              const snakemake_file &sf, std::map<boost::shared_ptr<recipe>, bool> *target) const;
+  /*!
+    @brief report how many emitted files were created or replaced
+    @return how many emitted files were created or replaced
+   */
+  unsigned get_files_written() const { return _files_written; }
+  /*!
+    @brief report how many emitted files were left in place, as their content was unchanged
+    @return how many emitted files were left in place
+   */
+  unsigned get_files_unchanged() const { return _files_unchanged; }
+  /*!
+    @brief set the wall-clock limit for each snakemake dry run while emitting tests
+    @param seconds limit in seconds, or 0 for no limit
+   */
+  void set_subprocess_timeout(double seconds) { _subprocess_timeout = seconds; }
+  /*!
+    @brief get the wall-clock limit for each snakemake dry run while emitting tests
+    @return limit in seconds, or 0 for no limit
+   */
+  double get_subprocess_timeout() const { return _subprocess_timeout; }
+  /*!
+    @brief get resource use of the snakemake dry runs made while emitting tests
+    @return records of each run, in order
+   */
+  const std::vector<subprocess_record> &get_subprocess_records() const { return _subprocess_records; }
+  /*!
+    @brief attach a profiler, to which each emitted rule and snakemake dry run is reported
+    @param ptr profiler shared with the caller, or null to stop reporting
+   */
+  void set_profiler(boost::shared_ptr<profiler> ptr) { _profiler = ptr; }
+  /*!
+    @brief store digests of rule outputs in each test's expected.sha256, instead of copies
+    @param checker checker whose comparators choose how each output is normalized before
+    digesting, or null to copy outputs
+   */
+  void set_output_digests(boost::shared_ptr<output_checker> checker) { _output_digests = checker; }
+  /*!
+    @brief gzip copied rule inputs and outputs under their own names, listing them in each test's compressed.txt
+    @param compress whether to compress copies
+    @param threads number of files to compress at once; 0 for hardware concurrency
+   */
+  void set_compress_test_data(bool compress, unsigned threads) {
+    _compress_test_data = compress;
+    _compression_threads = threads;
+  }
+  /*!
+    @brief set how many files are hashed at once for each emitted test's fingerprint
+    @param threads number of files to hash at once; 0 for hardware concurrency
+
+    fingerprinting reads every file under the test's workspace/ and expected/
+   */
+  void set_fingerprint_threads(unsigned threads) { _fingerprint_threads = threads; }
+  /*!
+    @brief have emitted tests create conda environments in a shared prefix
+    @param prefix absolute path of the prefix, or empty for each test to use its own
+   */
+  void set_conda_prefix(const boost::filesystem::path &prefix) { _conda_prefix = prefix; }
 
  private:
   friend class solved_rulesTest;
@@ -347,6 +649,57 @@ class solved_rules {
     @brief allow lookup of output->recipe for dependency resolution
    */
   std::map<boost::filesystem::path, boost::shared_ptr<recipe> > _output_lookup;
+  /*!
+    @brief write emitted file content, unless the file already has that content
+    @param filename name of file to create or replace
+    @param segments buffers to write, in order
+   */
+  void write_if_changed(const std::string &filename, const std::vector<std::string_view> &segments) const;
+  /*!
+    @brief report output from a snakemake dry run with an unhandled error, and throw
+    @param snakemake_exec output of the dry run
+   */
+  void report_unhandled_dryrun_error(const std::vector<std::string> &snakemake_exec) const;
+  /*!
+    @brief count of emitted files created or replaced
+   */
+  mutable unsigned _files_written;
+  /*!
+    @brief count of emitted files left in place
+   */
+  mutable unsigned _files_unchanged;
+  /*!
+    @brief wall-clock limit for each snakemake dry run, or 0 for no limit
+   */
+  double _subprocess_timeout;
+  /*!
+    @brief resource use of snakemake dry runs, labelled by rule
+   */
+  mutable std::vector<subprocess_record> _subprocess_records;
+  /*!
+    @brief optional profiler measuring each emitted rule
+   */
+  boost::shared_ptr<profiler> _profiler;
+  /*!
+    @brief optional checker with which to digest rule outputs, instead of copying them
+   */
+  boost::shared_ptr<output_checker> _output_digests;
+  /*!
+    @brief whether to gzip copied rule inputs and outputs
+   */
+  bool _compress_test_data;
+  /*!
+    @brief number of files to compress at once
+   */
+  unsigned _compression_threads;
+  /*!
+    @brief number of files to hash at once for a test's fingerprint
+   */
+  unsigned _fingerprint_threads;
+  /*!
+    @brief shared prefix in which emitted tests create conda environments; empty for none
+   */
+  boost::filesystem::path _conda_prefix;
 };
 }  // namespace snakemake_unit_tests
 
@@ -24,12 +24,62 @@ void snakemake_unit_tests::solved_rulesTest::tearDown() {
   }
 }
 
+void snakemake_unit_tests::solved_rulesTest::emit_tests_with_dry_run(const std::string &dry_run_script,
+                                                                    std::string *err) const {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path bin_dir = tmp_parent / "bin", inst_dir = tmp_parent / "inst";
+  boost::filesystem::create_directories(bin_dir);
+  boost::filesystem::create_directories(inst_dir);
+  boost::filesystem::create_directories(tmp_parent / "pipeline" / "workflow");
+  const char *inst_files[] = {"test.py", "common.py", "pytest_runner.bash"};
+  for (unsigned i = 0; i < 3; ++i) {
+    std::ofstream output((inst_dir / inst_files[i]).string().c_str());
+    output << "pass" << std::endl;
+    output.close();
+  }
+  std::ofstream output((bin_dir / "snakemake").string().c_str());
+  output << "#!/bin/bash\n" << dry_run_script << std::endl;
+  output.close();
+  boost::filesystem::permissions(bin_dir / "snakemake", boost::filesystem::owner_all);
+  boost::shared_ptr<recipe> rec(new recipe);
+  rec->_rule_name = "myrule";
+  solved_rules sr;
+  sr._recipes.push_back(rec);
+  snakemake_file sf;
+  std::map<std::string, bool> include_rules, exclude_rules;
+  std::vector<boost::filesystem::path> added_files, added_directories;
+  std::map<std::string, std::vector<std::string> > files_outside_workspace;
+  // the stand-in is found first on PATH; stdout and stderr are restored however emission ends
+  std::string path = getenv("PATH") ? getenv("PATH") : "";
+  setenv("PATH", (bin_dir.string() + ":" + path).c_str(), 1);
+  std::ostringstream observed, observed_err;
+  std::streambuf *previous_buffer(std::cout.rdbuf(observed.rdbuf()));
+  std::streambuf *previous_err_buffer(std::cerr.rdbuf(observed_err.rdbuf()));
+  try {
+    sr.emit_tests(sf, tmp_parent / ".tests", tmp_parent / "pipeline", "workflow", inst_dir, include_rules,
+                  exclude_rules, added_files, added_directories, false, false, true, false, false, false,
+                  &files_outside_workspace);
+  } catch (...) {
+    std::cout.rdbuf(previous_buffer);
+    std::cerr.rdbuf(previous_err_buffer);
+    setenv("PATH", path.c_str(), 1);
+    *err = observed_err.str();
+    throw;
+  }
+  std::cout.rdbuf(previous_buffer);
+  std::cerr.rdbuf(previous_err_buffer);
+  setenv("PATH", path.c_str(), 1);
+  *err = observed_err.str();
+}
+
 void snakemake_unit_tests::solved_rulesTest::test_recipe_default_constructor() {
   recipe r;
   CPPUNIT_ASSERT(r._rule_name.empty());
   CPPUNIT_ASSERT(r._inputs.empty());
   CPPUNIT_ASSERT(r._outputs.empty());
   CPPUNIT_ASSERT(r._log.empty());
+  CPPUNIT_ASSERT(r._threads == 1);
+  CPPUNIT_ASSERT(r._resources.empty());
 }
 void snakemake_unit_tests::solved_rulesTest::test_recipe_copy_constructor() {
   recipe r;
@@ -39,7 +89,11 @@ void snakemake_unit_tests::solved_rulesTest::test_recipe_copy_constructor() {
   r._outputs.push_back("output1");
   r._outputs.push_back("output2");
   r._log = "logname";
+  r._threads = 3;
+  r._resources["mem_mb"] = "100";
   recipe s(r);
+  CPPUNIT_ASSERT(s._threads == 3);
+  CPPUNIT_ASSERT(s._resources == r._resources);
   CPPUNIT_ASSERT(!s._rule_name.compare("rulename"));
   CPPUNIT_ASSERT(s._inputs.size() == 2);
   CPPUNIT_ASSERT(!s._inputs.at(0).string().compare("input1"));
@@ -127,7 +181,11 @@ void snakemake_unit_tests::solved_rulesTest::test_recipe_clear() {
   r._outputs.push_back("output1");
   r._outputs.push_back("output2");
   r._log = "logname";
+  r._threads = 3;
+  r._resources["mem_mb"] = "100";
   r.clear();
+  CPPUNIT_ASSERT(r._threads == 1);
+  CPPUNIT_ASSERT(r._resources.empty());
   CPPUNIT_ASSERT(r._rule_name.empty());
   CPPUNIT_ASSERT(r._inputs.empty());
   CPPUNIT_ASSERT(r._outputs.empty());
@@ -137,18 +195,39 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_default_construct
   solved_rules sr;
   CPPUNIT_ASSERT(sr._recipes.empty());
   CPPUNIT_ASSERT(sr._output_lookup.empty());
+  CPPUNIT_ASSERT(!sr._files_written);
+  CPPUNIT_ASSERT(!sr._files_unchanged);
+  CPPUNIT_ASSERT(sr._subprocess_timeout == 0.0);
+  CPPUNIT_ASSERT(sr._subprocess_records.empty());
+  CPPUNIT_ASSERT(!sr._profiler);
 }
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_copy_constructor() {
   solved_rules sr;
   boost::shared_ptr<recipe> rec(new recipe);
   sr._recipes.push_back(rec);
   sr._output_lookup["my/path"] = rec;
+  sr._files_written = 3;
+  sr._files_unchanged = 4;
+  sr.set_subprocess_timeout(60.0);
+  sr._subprocess_records.push_back(subprocess_record());
+  sr._subprocess_records.back().label = "dry run for rule rule1";
+  boost::shared_ptr<profiler> prof(new profiler);
+  sr.set_profiler(prof);
+  CPPUNIT_ASSERT(sr._fingerprint_threads == 0);
+  sr.set_fingerprint_threads(5);
   solved_rules ss(sr);
   CPPUNIT_ASSERT(ss._recipes.size() == 1);
   CPPUNIT_ASSERT(ss._recipes.at(0) == rec);
   CPPUNIT_ASSERT(ss._output_lookup.size() == 1);
   CPPUNIT_ASSERT(!ss._output_lookup.begin()->first.string().compare("my/path"));
   CPPUNIT_ASSERT(ss._output_lookup.begin()->second == rec);
+  CPPUNIT_ASSERT(ss._files_written == 3);
+  CPPUNIT_ASSERT(ss._files_unchanged == 4);
+  CPPUNIT_ASSERT(ss.get_subprocess_timeout() == 60.0);
+  CPPUNIT_ASSERT(ss.get_subprocess_records().size() == 1u);
+  CPPUNIT_ASSERT(!ss.get_subprocess_records().at(0).label.compare("dry run for rule rule1"));
+  CPPUNIT_ASSERT(ss._profiler == prof);
+  CPPUNIT_ASSERT(ss._fingerprint_threads == 5);
 }
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_load_file() {
   boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
@@ -165,8 +244,8 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_load_file() {
       "    jobid: whatever\n"
       "    wildcards: whatever\n"
       "    benchmark: whatever\n"
-      "    resources: whatever\n"
-      "    threads: whatever\n"
+      "    resources: tmpdir=/tmp, mem_mb=1000, <TBD>\n"
+      "    threads: 4\n"
       "    priority: whatever\n"
       "    reason: whatever\n"
       "This was a dry-run (flag -n)";
@@ -198,6 +277,12 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_load_file() {
   CPPUNIT_ASSERT(sr._recipes.at(1)->_outputs.size() == 1);
   CPPUNIT_ASSERT(!sr._recipes.at(1)->_outputs.at(0).string().compare("output2.tsv"));
   CPPUNIT_ASSERT(sr._recipes.at(1)->_log.empty());
+  CPPUNIT_ASSERT(sr._recipes.at(0)->_threads == 1);
+  CPPUNIT_ASSERT(sr._recipes.at(0)->_resources.empty());
+  CPPUNIT_ASSERT(sr._recipes.at(1)->_threads == 4);
+  CPPUNIT_ASSERT(sr._recipes.at(1)->_resources.size() == 2);
+  CPPUNIT_ASSERT(!sr._recipes.at(1)->_resources["tmpdir"].compare("/tmp"));
+  CPPUNIT_ASSERT(!sr._recipes.at(1)->_resources["mem_mb"].compare("1000"));
   CPPUNIT_ASSERT(sr._output_lookup.size() == 2);
   CPPUNIT_ASSERT(sr._output_lookup.find("output.tsv") != sr._output_lookup.end());
   CPPUNIT_ASSERT(sr._output_lookup["output.tsv"] == sr._recipes.at(0));
@@ -219,8 +304,8 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_load_file_unresol
       "    jobid: whatever\n"
       "    wildcards: whatever\n"
       "    benchmark: whatever\n"
-      "    resources: whatever\n"
-      "    threads: whatever\n"
+      "    resources: tmpdir=/tmp, mem_mb=1000, <TBD>\n"
+      "    threads: 4\n"
       "    priority: whatever\n"
       "    reason: whatever\n"
       "This was a dry-run (flag -n)";
@@ -253,8 +338,8 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_load_file_toxic_o
       "    jobid: whatever\n"
       "    wildcards: whatever\n"
       "    benchmark: whatever\n"
-      "    resources: whatever\n"
-      "    threads: whatever\n"
+      "    resources: tmpdir=/tmp, mem_mb=1000, <TBD>\n"
+      "    threads: 4\n"
       "    priority: whatever\n"
       "    reason: whatever\n"
       "This was a dry-run (flag -n)";
@@ -320,6 +405,18 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_load_file_unrecog
   solved_rules sr;
   sr.load_file(output_filename.string());
 }
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_load_file_invalid_threads() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path output_filename = tmp_parent / "logfile.txt";
+  std::ofstream output;
+  output.open(output_filename.string().c_str());
+  output << "rule rulename1:\n"
+         << "    output: output.tsv\n"
+         << "    threads: many\n";
+  output.close();
+  solved_rules sr;
+  sr.load_file(output_filename.string());
+}
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_tests() {
   /*
     so this is almost exactly the same thing as create_workspace, except it dispatches
@@ -452,6 +549,46 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_tests() {
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "test_myrule2.py"));
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "common.py"));
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "pytest_runner.bash"));
+  // fingerprints are taken once dry runs have finished, and match the final workspace
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / "myrule1" / "workspace" / ".snakemake"));
+  std::ifstream input((unitdir / "myrule1" / "fingerprint.txt").string().c_str());
+  std::string fingerprint = "";
+  CPPUNIT_ASSERT(getline(input, fingerprint));
+  input.close();
+  CPPUNIT_ASSERT(!fingerprint.compare(solved_rules::fingerprint_test(unitdir / "myrule1", 1)));
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "myrule2" / "fingerprint.txt"));
+}
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_tests_long_dry_run_error() {
+  // an error early in a long dry run is still reported in full
+  std::string err = "";
+  bool threw = false;
+  try {
+    emit_tests_with_dry_run("echo 'Exception: the first error'; for i in $(seq 1 2000); do echo \"job $i\"; done",
+                            &err);
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  CPPUNIT_ASSERT(threw);
+  CPPUNIT_ASSERT(err.find("Exception: the first error\n") == 0);
+  CPPUNIT_ASSERT(err.find("job 2000\n") != std::string::npos);
+}
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_tests_dry_run_stderr() {
+  // warnings on stderr do not stop emission, even if they mention exceptions
+  std::string err = "";
+  emit_tests_with_dry_run("echo 'Building DAG of jobs...'; echo 'Warning: exception ignored in thread' >&2", &err);
+  CPPUNIT_ASSERT(err.empty());
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(boost::filesystem::path(std::string(_tmp_dir)) / ".tests" / "unit" /
+                                                 "myrule" / "workspace"));
+  // but they are reported alongside an error on stdout
+  bool threw = false;
+  try {
+    emit_tests_with_dry_run("echo 'traceback detail' >&2; sleep 0.1; echo 'Exception: unhandled'", &err);
+  } catch (const std::runtime_error &) {
+    threw = true;
+  }
+  CPPUNIT_ASSERT(threw);
+  CPPUNIT_ASSERT(err.find("traceback detail\n") != std::string::npos);
+  CPPUNIT_ASSERT(err.find("Exception: unhandled\n") != std::string::npos);
 }
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_snakefile() {
   boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
@@ -469,7 +606,7 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_snakefile()
   rb1->_named_blocks.push_back(std::make_pair("output", " \"output1.tsv\","));
   rb1->_queried_by_python = true;
   rb1->_resolution = RESOLVED_INCLUDED;
-  rb2->_code_chunk.push_back("include: \"rules/file2.smk\"");
+  rb2->add_code_chunk("include: \"rules/file2.smk\"");
   rb2->_queried_by_python = true;
   rb2->_resolution = RESOLVED_INCLUDED;
   rb3->_rule_name = "myrule2";
@@ -555,6 +692,51 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_snakefile()
   CPPUNIT_ASSERT(line.empty());
   CPPUNIT_ASSERT(input.peek() == EOF);
 }
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_emit_snakefile_rendered() {
+  // emission from pre-rendered segments must match direct emission exactly
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::shared_ptr<snakemake_file> sf1(new snakemake_file), sf2(new snakemake_file);
+  boost::shared_ptr<recipe> rec(new recipe);
+  rec->_rule_name = "myrule1";
+  rec->_outputs.push_back("output1.tsv");
+  boost::shared_ptr<rule_block> rb1(new rule_block), rb2(new rule_block), rb3(new rule_block), rb4(new rule_block);
+  rb1->_rule_name = "myrule1";
+  rb1->_named_blocks.push_back(std::make_pair("output", " \"output1.tsv\","));
+  rb1->_resolution = RESOLVED_INCLUDED;
+  rb2->add_code_chunk("include: \"rules/file2.smk\"");
+  rb2->_resolution = RESOLVED_INCLUDED;
+  rb3->_rule_name = "myrule2";
+  rb3->_named_blocks.push_back(std::make_pair("output", " \"output2.tsv\","));
+  rb3->_resolution = RESOLVED_INCLUDED;
+  rb4->_rule_name = "myrule3";
+  rb4->_resolution = RESOLVED_EXCLUDED;
+  sf1->_blocks.push_back(rb1);
+  sf1->_blocks.push_back(rb2);
+  sf2->_blocks.push_back(rb3);
+  sf2->_blocks.push_back(rb4);
+  sf1->_snakefile_relative_path = "workflow/file1.smk";
+  sf2->_snakefile_relative_path = "workflow/rules/file2.smk";
+  sf1->_included_files["workflow/rules/file2.smk"] = sf2;
+  std::map<std::string, bool> dependent_rulenames;
+  dependent_rulenames["myrule1"] = true;
+  solved_rules sr;
+  unsigned direct = sr.emit_snakefile(*sf1, tmp_parent / "direct", rec, dependent_rulenames, true);
+  sf1->render_segments();
+  CPPUNIT_ASSERT(sf2->segments_rendered());
+  unsigned rendered = sr.emit_snakefile(*sf1, tmp_parent / "rendered", rec, dependent_rulenames, true);
+  CPPUNIT_ASSERT(direct == 1 && rendered == 1);
+  const char *files[] = {"workflow/file1.smk", "workflow/rules/file2.smk"};
+  for (unsigned i = 0; i < 2; ++i) {
+    std::ifstream input1((tmp_parent / "direct" / files[i]).string().c_str()),
+        input2((tmp_parent / "rendered" / files[i]).string().c_str());
+    CPPUNIT_ASSERT(input1.is_open() && input2.is_open());
+    std::ostringstream contents1, contents2;
+    contents1 << input1.rdbuf();
+    contents2 << input2.rdbuf();
+    CPPUNIT_ASSERT(!contents1.str().empty());
+    CPPUNIT_ASSERT(!contents1.str().compare(contents2.str()));
+  }
+}
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_create_workspace() {
   /*
     need:
@@ -668,6 +850,57 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_create_workspace(
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "myrule1" / "workspace" / "extra_stuff" / "file1.tsv"));
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "test_myrule1.py"));
 }
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_create_workspace_pytest_derived_rule() {
+  // updating only the pytest infrastructure does not need the rule's base rules,
+  // so it succeeds even when they cannot be located
+  boost::shared_ptr<recipe> rec1(new recipe);
+  rec1->_rule_name = "myrule1";
+  rec1->_outputs.push_back("results/output1.tsv");
+  boost::shared_ptr<snakemake_file> sf1(new snakemake_file);
+  boost::shared_ptr<rule_block> rb1(new rule_block);
+  rb1->_rule_name = "myrule1";
+  rb1->_base_rule_name = "missing_parent";
+  rb1->_named_blocks.push_back(std::make_pair("output", " \"results/output1.tsv\","));
+  rb1->_queried_by_python = true;
+  rb1->_resolution = RESOLVED_INCLUDED;
+  sf1->_blocks.push_back(rb1);
+  sf1->_snakefile_relative_path = "workflow/Snakefile";
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path testdir = tmp_parent / ".tests";
+  boost::filesystem::path unitdir = testdir / "unit";
+  boost::filesystem::path pipeline_top_dir = tmp_parent / "pipeline";
+  boost::filesystem::path inst_test_py = tmp_parent / "inst" / "test.py";
+  std::map<boost::shared_ptr<recipe>, bool> extra_required_recipes;
+  std::map<std::string, bool> include_rules, exclude_rules;
+  std::vector<boost::filesystem::path> added_files, added_directories;
+  std::map<std::string, std::vector<std::string> > files_outside_workspace;
+  boost::filesystem::create_directories(pipeline_top_dir / "workflow");
+  boost::filesystem::create_directories(tmp_parent / "inst");
+  std::ofstream output;
+  output.open(inst_test_py.string().c_str());
+  output << "inst test py content goes here" << std::endl;
+  output.close();
+
+  solved_rules sr;
+  sr._recipes.push_back(rec1);
+  std::string result = "";
+  CPPUNIT_ASSERT(sf1->get_base_rule_name("myrule1", &result));
+  CPPUNIT_ASSERT(!sf1->get_base_rule_name("missing_parent", &result));
+
+  std::ostringstream observed;
+  std::streambuf *previous_buffer(std::cout.rdbuf(observed.rdbuf()));
+  try {
+    sr.create_workspace(rec1, *sf1, testdir, unitdir, pipeline_top_dir, "workflow", inst_test_py,
+                        extra_required_recipes, include_rules, exclude_rules, added_files, added_directories, false,
+                        false, false, false, true, false, &files_outside_workspace);
+  } catch (...) {
+    std::cout.rdbuf(previous_buffer);
+    throw;
+  }
+  std::cout.rdbuf(previous_buffer);
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(unitdir / "test_myrule1.py"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unitdir / "myrule1" / "workspace" / "workflow" / "Snakefile"));
+}
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_create_empty_workspace() {
   boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
   boost::filesystem::path target = tmp_parent / "target";
@@ -781,6 +1014,293 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_copy_contents() {
   CPPUNIT_ASSERT(files_outside_workspace[file3.string()].size() == 1);
   CPPUNIT_ASSERT(!files_outside_workspace[file3.string()].at(0).compare("myrule"));
 }
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_copy_contents_compressed() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path workspace = tmp_parent / "workspace";
+  boost::filesystem::path target = tmp_parent / "destination";
+  boost::filesystem::create_directories(workspace / "results" / "nested");
+  std::ofstream output;
+  output.open((workspace / "results" / "a.txt").string().c_str());
+  output << "abc\n";
+  output.close();
+  output.clear();
+  output.open((workspace / "results" / "nested" / "b.txt").string().c_str());
+  output << "def\n";
+  output.close();
+  output.clear();
+  // files that are already gzipped are copied as they are
+  output.open((workspace / "results" / "c.gz").string().c_str(), std::ios_base::binary);
+  output << "\x1f\x8b";
+  output.close();
+  output.clear();
+  std::vector<boost::filesystem::path> contents, compressed;
+  contents.push_back("results/a.txt");
+  contents.push_back("results/nested");
+  contents.push_back("results/c.gz");
+  solved_rules sr;
+  sr.set_compress_test_data(true, 2);
+  sr.copy_contents(contents, workspace, target, "myrule", 0, &compressed);
+  CPPUNIT_ASSERT(compressed.size() == 2);
+  std::sort(compressed.begin(), compressed.end());
+  CPPUNIT_ASSERT(compressed.at(0) == target / "results" / "a.txt");
+  CPPUNIT_ASSERT(compressed.at(1) == target / "results" / "nested" / "b.txt");
+  line_reader reader(target / "results" / "nested" / "b.txt", 1, true);
+  std::string line = "";
+  CPPUNIT_ASSERT(reader.getline(&line));
+  CPPUNIT_ASSERT_EQUAL(std::string("def\n"), line);
+  CPPUNIT_ASSERT(boost::filesystem::file_size(target / "results" / "c.gz") == 2);
+  // without a collector, copies are made as they are
+  sr.copy_contents(contents, workspace, target, "myrule", 0);
+  CPPUNIT_ASSERT(boost::filesystem::file_size(target / "results" / "a.txt") == 4);
+}
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_digest_contents() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path workspace = tmp_parent / "workspace";
+  boost::filesystem::path target = tmp_parent / "expected";
+  boost::filesystem::create_directories(workspace / "results" / "nested");
+  boost::filesystem::create_directories(target / "results");
+  std::ofstream output;
+  output.open((workspace / "results" / "a.txt").string().c_str());
+  output << "# made today\nabc\n";
+  output.close();
+  output.clear();
+  output.open((workspace / "results" / "nested" / "b.tsv").string().c_str());
+  output << "x\ty\n1\t2\n";
+  output.close();
+  output.clear();
+  // a copy from an earlier run is replaced by its digest
+  output.open((target / "results" / "a.txt").string().c_str());
+  output << "abc\n";
+  output.close();
+  output.clear();
+  std::vector<boost::filesystem::path> contents;
+  contents.push_back("results/a.txt");
+  contents.push_back("results/nested");
+  std::map<std::string, std::string> manifest;
+  solved_rules sr;
+  boost::shared_ptr<output_checker> checker(new output_checker);
+  checker->add_comparators(YAML::Load("[{type: frame, patterns: ['\\.tsv$']}]"));
+  sr.set_output_digests(checker);
+  sr.digest_contents(contents, workspace, target / ".", target, "myrule", &manifest, 0);
+  CPPUNIT_ASSERT(manifest.size() == 1);
+  // comment lines are not digested
+  CPPUNIT_ASSERT_EQUAL(std::string("edeaaff3f1774ad2888673770c6d64097e391bc362d7d6fb34982ddf0efd18cb  plaintext"),
+                       manifest["results/a.txt"]);
+  CPPUNIT_ASSERT(!boost::filesystem::exists(target / "results" / "a.txt"));
+  // tables compared with tolerance are copied whole
+  CPPUNIT_ASSERT(boost::filesystem::is_regular_file(target / "results" / "nested" / "b.tsv"));
+}
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_fingerprint_test() {
+  boost::filesystem::path rule_dir = boost::filesystem::path(std::string(_tmp_dir)) / "unit" / "myrule";
+  boost::filesystem::create_directories(rule_dir / "workspace" / "workflow" / "envs");
+  boost::filesystem::create_directories(rule_dir / "expected" / "results");
+  std::ofstream output((rule_dir / "workspace" / "workflow" / "Snakefile").string().c_str());
+  output << "rule myrule:\n    output: 'results/out.txt'\n";
+  output.close();
+  output.open((rule_dir / "workspace" / "workflow" / "envs" / "env.yaml").string().c_str());
+  output << "dependencies:\n  - python\n";
+  output.close();
+  output.open((rule_dir / "expected" / "results" / "out.txt").string().c_str());
+  output << "expected\n";
+  output.close();
+  std::string first = solved_rules::fingerprint_test(rule_dir, 2);
+  CPPUNIT_ASSERT(first.size() == 64);
+  CPPUNIT_ASSERT(!first.compare(solved_rules::fingerprint_test(rule_dir, 1)));
+  // the run directory and the fingerprint itself are not part of the test's data
+  boost::filesystem::create_directories(rule_dir / "output" / "results");
+  output.open((rule_dir / "fingerprint.txt").string().c_str());
+  output << first << std::endl;
+  output.close();
+  CPPUNIT_ASSERT(!first.compare(solved_rules::fingerprint_test(rule_dir, 2)));
+  // nor is snakemake's state from a dry run in the workspace
+  boost::filesystem::create_directories(rule_dir / "workspace" / ".snakemake" / "metadata");
+  output.open((rule_dir / "workspace" / ".snakemake" / "metadata" / "entry").string().c_str());
+  output << "dry run state" << std::endl;
+  output.close();
+  CPPUNIT_ASSERT(!first.compare(solved_rules::fingerprint_test(rule_dir, 2)));
+  // changed content, names, and manifests all change it
+  output.open((rule_dir / "workspace" / "workflow" / "envs" / "env.yaml").string().c_str());
+  output << "dependencies:\n  - python=3.11\n";
+  output.close();
+  std::string second = solved_rules::fingerprint_test(rule_dir, 2);
+  CPPUNIT_ASSERT(second.compare(first));
+  boost::filesystem::rename(rule_dir / "expected" / "results" / "out.txt", rule_dir / "expected" / "results" / "o.txt");
+  std::string third = solved_rules::fingerprint_test(rule_dir, 2);
+  CPPUNIT_ASSERT(third.compare(second));
+  output.open((rule_dir / "compressed.txt").string().c_str());
+  output << "expected/results/o.txt\n";
+  output.close();
+  CPPUNIT_ASSERT(solved_rules::fingerprint_test(rule_dir, 2).compare(third));
+}
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_plan_tests() {
+  boost::shared_ptr<recipe> rec1(new recipe), rec2(new recipe), rec3(new recipe);
+  rec1->_rule_name = "myrule1";
+  rec1->_inputs.push_back("results/input1.tsv");
+  rec1->_outputs.push_back("results/output1.tsv");
+  rec2->_rule_name = "myrule2";
+  rec2->_inputs.push_back("results/output1.tsv");
+  rec2->_outputs.push_back("results/output2.tsv");
+  rec3->_rule_name = "myrule1";
+  rec3->_inputs.push_back("results/input3.tsv");
+  rec3->_outputs.push_back("results/output3.tsv");
+  snakemake_file sf;
+  boost::shared_ptr<rule_block> rb1(new rule_block), rb2(new rule_block);
+  rb1->_rule_name = "myrule1";
+  rb1->_named_blocks.push_back(std::make_pair("input", " \"results/input1.tsv\","));
+  rb1->_named_blocks.push_back(std::make_pair("output", " \"results/output1.tsv\","));
+  rb1->_queried_by_python = true;
+  rb1->_resolution = RESOLVED_INCLUDED;
+  rb2->_rule_name = "myrule2";
+  rb2->_named_blocks.push_back(std::make_pair("input", " \"results/output1.tsv\","));
+  rb2->_named_blocks.push_back(std::make_pair("output", " \"results/output2.tsv\","));
+  rb2->_queried_by_python = true;
+  rb2->_resolution = RESOLVED_INCLUDED;
+  sf._blocks.push_back(rb1);
+  sf._blocks.push_back(rb2);
+  sf._snakefile_relative_path = "workflow/Snakefile";
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path testdir = tmp_parent / ".tests";
+  boost::filesystem::path pipeline_top_dir = tmp_parent / "pipeline";
+  boost::filesystem::path pipeline_run_dir = "workflow";
+  std::map<std::string, bool> include_rules, exclude_rules;
+  std::vector<boost::filesystem::path> added_files, added_directories;
+  added_files.push_back("file2.tsv");
+  added_directories.push_back("extra_stuff");
+  boost::filesystem::create_directories(pipeline_top_dir / pipeline_run_dir / "results");
+  boost::filesystem::create_directories(pipeline_top_dir / "extra_stuff");
+  std::ofstream output;
+  output.open((pipeline_top_dir / pipeline_run_dir / "results" / "input1.tsv").string().c_str());
+  output << "abc" << std::endl;
+  output.close();
+  output.clear();
+  output.open((pipeline_top_dir / pipeline_run_dir / "results" / "output1.tsv").string().c_str());
+  output << "abcdef" << std::endl;
+  output.close();
+  output.clear();
+  output.open((pipeline_top_dir / "extra_stuff" / "file1.tsv").string().c_str());
+  output << "a" << std::endl;
+  output.close();
+  output.clear();
+
+  solved_rules sr;
+  sr._recipes.push_back(rec1);
+  sr._recipes.push_back(rec2);
+  sr._recipes.push_back(rec3);
+  sr._output_lookup["output1.tsv"] = rec1;
+  sr._output_lookup["output2.tsv"] = rec2;
+  sr._output_lookup["output3.tsv"] = rec3;
+
+  std::vector<rule_plan> plans;
+  sr.plan_tests(sf, testdir, pipeline_top_dir, pipeline_run_dir, include_rules, exclude_rules, added_files,
+                added_directories, false, &plans);
+  // one plan per rule, from its first recipe
+  CPPUNIT_ASSERT(plans.size() == 2);
+  CPPUNIT_ASSERT(!plans.at(0).rule_name.compare("myrule1"));
+  CPPUNIT_ASSERT(plans.at(0).recipe_index == 1);
+  CPPUNIT_ASSERT(plans.at(0).dependent_rules.empty());
+  CPPUNIT_ASSERT(plans.at(0).copies.size() == 4);
+  CPPUNIT_ASSERT(!plans.at(0).copies.at(0).purpose.compare("output"));
+  CPPUNIT_ASSERT(plans.at(0).copies.at(0).source == pipeline_top_dir / pipeline_run_dir / "results" / "output1.tsv");
+  CPPUNIT_ASSERT(plans.at(0).copies.at(0).target ==
+                 testdir / "unit" / "myrule1" / "expected" / pipeline_run_dir / "results" / "output1.tsv");
+  CPPUNIT_ASSERT(!plans.at(0).copies.at(0).status.compare("copy"));
+  CPPUNIT_ASSERT(plans.at(0).copies.at(0).size_bytes == 7);
+  CPPUNIT_ASSERT(!plans.at(0).copies.at(1).purpose.compare("input"));
+  CPPUNIT_ASSERT(plans.at(0).copies.at(1).size_bytes == 4);
+  CPPUNIT_ASSERT(!plans.at(0).copies.at(2).purpose.compare("added file"));
+  CPPUNIT_ASSERT(!plans.at(0).copies.at(2).status.compare("missing"));
+  CPPUNIT_ASSERT(plans.at(0).copies.at(2).size_bytes == 0);
+  CPPUNIT_ASSERT(!plans.at(0).copies.at(3).purpose.compare("added directory"));
+  CPPUNIT_ASSERT(plans.at(0).copies.at(3).size_bytes == 2);
+  CPPUNIT_ASSERT(!plans.at(1).rule_name.compare("myrule2"));
+  CPPUNIT_ASSERT(plans.at(1).recipe_index == 2);
+  CPPUNIT_ASSERT(!plans.at(1).copies.at(0).status.compare("missing"));
+  // nothing is written
+  CPPUNIT_ASSERT(!boost::filesystem::exists(testdir));
+
+  exclude_rules["myrule1"] = true;
+  sr.plan_tests(sf, testdir, pipeline_top_dir, pipeline_run_dir, include_rules, exclude_rules, added_files,
+                added_directories, false, &plans);
+  CPPUNIT_ASSERT(plans.size() == 1);
+  CPPUNIT_ASSERT(!plans.at(0).rule_name.compare("myrule2"));
+}
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_plans() {
+  std::vector<rule_plan> plans;
+  rule_plan plan;
+  plan.rule_name = "myrule1";
+  plan.recipe_index = 3;
+  plan.dependent_rules.push_back("myrule2");
+  plan.dependent_rules.push_back("myrule3");
+  planned_copy copy;
+  copy.purpose = "input";
+  copy.source = "a/b.tsv";
+  copy.target = "c/b.tsv";
+  copy.status = "copy";
+  copy.size_bytes = 10;
+  plan.copies.push_back(copy);
+  copy.purpose = "added file";
+  copy.source = "d.tsv";
+  copy.status = "missing";
+  copy.size_bytes = 0;
+  plan.copies.push_back(copy);
+  plans.push_back(plan);
+  std::ostringstream observed;
+  solved_rules::report_plans(plans, observed);
+  CPPUNIT_ASSERT_EQUAL(std::string("rule \"myrule1\" (recipe 3 in log)\n"
+                                   "  dependent rules: myrule2, myrule3\n"
+                                   "  input: a/b.tsv (10 bytes)\n"
+                                   "  added file: d.tsv (missing)\n"
+                                   "  total: 10 bytes\n"
+                                   "planned 1 test, copying 10 bytes\n"),
+                       observed.str());
+}
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_plans_json() {
+  std::vector<rule_plan> plans;
+  std::ostringstream observed;
+  solved_rules::report_plans_json(plans, observed);
+  CPPUNIT_ASSERT_EQUAL(std::string("[]\n"), observed.str());
+  rule_plan plan;
+  plan.rule_name = "my\"rule";
+  plan.recipe_index = 1;
+  plan.dependent_rules.push_back("other");
+  planned_copy copy;
+  copy.purpose = "output";
+  copy.source = "a.tsv";
+  copy.target = "b.tsv";
+  copy.status = "copy";
+  copy.size_bytes = 5;
+  plan.copies.push_back(copy);
+  plans.push_back(plan);
+  observed.str("");
+  solved_rules::report_plans_json(plans, observed);
+  CPPUNIT_ASSERT_EQUAL(std::string("[\n  {\"rule\": \"my\\\"rule\", \"recipe_index\": 1, \"dependent_rules\": "
+                                   "[\"other\"], \"copies\": [\n    {\"purpose\": \"output\", \"source\": \"a.tsv\", "
+                                   "\"target\": \"b.tsv\", \"status\": \"copy\", \"size_bytes\": 5}\n  ]}\n]\n"),
+                       observed.str());
+}
+
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_content_size() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::create_directories(tmp_parent / "dir" / "subdir");
+  std::ofstream output;
+  output.open((tmp_parent / "dir" / "file1.tsv").string().c_str());
+  output << "abc" << std::endl;
+  output.close();
+  output.clear();
+  output.open((tmp_parent / "dir" / "subdir" / "file2.tsv").string().c_str());
+  output << "abcdefg" << std::endl;
+  output.close();
+  output.clear();
+  CPPUNIT_ASSERT(solved_rules::content_size(tmp_parent / "dir" / "file1.tsv") == 4);
+  CPPUNIT_ASSERT(solved_rules::content_size(tmp_parent / "dir") == 12);
+  CPPUNIT_ASSERT(solved_rules::content_size(tmp_parent / "absent") == 0);
+}
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_phony_all_target() {
   std::ofstream output;
   std::vector<boost::filesystem::path> targets;
@@ -862,15 +1382,23 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_modified_t
   output.close();
 
   solved_rules sr;
-  sr.report_modified_test_script(unitdir, testdir, rulename, snakefile_relative_path, rundir, extra_exclusions,
-                                 inst_test_py);
+  std::map<std::string, std::string> resources;
+  resources["mem_mb"] = "1000";
+  resources["tmpdir"] = "it's";
+  std::map<boost::filesystem::path, bool> conda_envs;
+  conda_envs["workflow/envs/b.yaml"] = true;
+  conda_envs["workflow/envs/a.yaml"] = true;
+  sr.set_conda_prefix("/shared/conda");
+  sr.report_modified_test_script(unitdir, testdir, rulename, snakefile_relative_path, rundir, 4, resources,
+                                 conda_envs, extra_exclusions, inst_test_py);
 
   boost::filesystem::path expected = unitdir / ("test_" + rulename + ".py");
   CPPUNIT_ASSERT(boost::filesystem::is_regular_file(expected));
   std::ifstream input;
   input.open(expected.string().c_str());
   bool found_shebang = false, found_testdir = false, found_rulename = false, found_relative_path = false,
-       found_exec_path = false, found_extra_exclusions = false, found_inst_contents = false, firstline = true;
+       found_exec_path = false, found_threads = false, found_resources = false, found_extra_exclusions = false,
+       found_conda_prefix = false, found_conda_envs = false, found_inst_contents = false, firstline = true;
   std::string line = "";
   while (input.peek() != EOF) {
     getline(input, line);
@@ -890,6 +1418,18 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_modified_t
     } else if (!line.compare("snakemake_exec_path='" + rundir.string() + "'")) {
       CPPUNIT_ASSERT(!found_exec_path);
       found_exec_path = true;
+    } else if (!line.compare("threads=4")) {
+      CPPUNIT_ASSERT(!found_threads);
+      found_threads = true;
+    } else if (!line.compare("resources={'mem_mb': '1000', 'tmpdir': 'it\\'s', }")) {
+      CPPUNIT_ASSERT(!found_resources);
+      found_resources = true;
+    } else if (!line.compare("conda_prefix='/shared/conda'")) {
+      CPPUNIT_ASSERT(!found_conda_prefix);
+      found_conda_prefix = true;
+    } else if (!line.compare("conda_envs=['workflow/envs/a.yaml', 'workflow/envs/b.yaml', ]")) {
+      CPPUNIT_ASSERT(!found_conda_envs);
+      found_conda_envs = true;
     } else if (!line.compare("extra_comparison_exclusions=['.docx', '.eps', ]")) {
       CPPUNIT_ASSERT(!found_extra_exclusions);
       found_extra_exclusions = true;
@@ -905,6 +1445,10 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_modified_t
   CPPUNIT_ASSERT(found_rulename);
   CPPUNIT_ASSERT(found_relative_path);
   CPPUNIT_ASSERT(found_exec_path);
+  CPPUNIT_ASSERT(found_threads);
+  CPPUNIT_ASSERT(found_resources);
+  CPPUNIT_ASSERT(found_conda_prefix);
+  CPPUNIT_ASSERT(found_conda_envs);
   CPPUNIT_ASSERT(found_extra_exclusions);
   CPPUNIT_ASSERT(found_inst_contents);
 }
@@ -950,6 +1494,43 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_modified_l
   }
   CPPUNIT_ASSERT(input.peek() == EOF);
 }
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_modified_launcher_script_unchanged() {
+  boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
+  boost::filesystem::path inst_dir = tmp_parent / "inst";
+  boost::filesystem::path target_dir = tmp_parent / "target";
+  boost::filesystem::create_directories(inst_dir);
+  boost::filesystem::create_directories(target_dir);
+  boost::filesystem::path input_script = inst_dir / "scriptname.bash";
+  boost::filesystem::path test_dir = target_dir / "all_the_tests";
+  boost::filesystem::path target_script = target_dir / "pytest_runner.bash";
+  std::ofstream output;
+  output.open(input_script.string().c_str());
+  if (!output.is_open()) {
+    throw std::runtime_error("cannot write modified launcher script file");
+  }
+  if (!(output << "script\ncontents" << std::endl)) {
+    throw std::runtime_error("cannot write modified launcher script contents");
+  }
+  output.close();
+
+  solved_rules sr;
+  CPPUNIT_ASSERT(sr.get_files_written() == 0u);
+  CPPUNIT_ASSERT(sr.get_files_unchanged() == 0u);
+  sr.report_modified_launcher_script(target_dir, test_dir, input_script);
+  CPPUNIT_ASSERT(sr.get_files_written() == 1u);
+  CPPUNIT_ASSERT(sr.get_files_unchanged() == 0u);
+  // a second pass with the same inputs leaves the file alone
+  boost::filesystem::last_write_time(target_script, 1000);
+  sr.report_modified_launcher_script(target_dir, test_dir, input_script);
+  CPPUNIT_ASSERT(sr.get_files_written() == 1u);
+  CPPUNIT_ASSERT(sr.get_files_unchanged() == 1u);
+  CPPUNIT_ASSERT(boost::filesystem::last_write_time(target_script) == 1000);
+  // a changed test directory rewrites it
+  sr.report_modified_launcher_script(target_dir, target_dir / "other_tests", input_script);
+  CPPUNIT_ASSERT(sr.get_files_written() == 2u);
+  CPPUNIT_ASSERT(sr.get_files_unchanged() == 1u);
+  CPPUNIT_ASSERT(boost::filesystem::last_write_time(target_script) != 1000);
+}
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_report_modified_launcher_script_bad_target_directory() {
   boost::filesystem::path tmp_parent = boost::filesystem::path(std::string(_tmp_dir));
   boost::filesystem::path inst_dir = tmp_parent / "inst";
@@ -1002,6 +1583,26 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_find_missing_rule
   CPPUNIT_ASSERT(missing_rules.find("check1") != missing_rules.end());
   CPPUNIT_ASSERT(missing_rules.find("check2") != missing_rules.end());
 }
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_find_missing_rule() {
+  solved_rules sr;
+  std::map<std::string, bool> target;
+  bool found_error = false;
+  CPPUNIT_ASSERT(!sr.find_missing_rule("Building DAG of jobs...\n", &target, &found_error));
+  CPPUNIT_ASSERT(!found_error);
+  CPPUNIT_ASSERT(sr.find_missing_rule("AttributeError: 'Rules' object has no attribute 'rule1'\n", &target,
+                                      &found_error));
+  CPPUNIT_ASSERT(!found_error);
+  CPPUNIT_ASSERT(sr.find_missing_rule("WorkflowException: 'Checkpoints' object has no attribute 'rule2'\n", &target,
+                                      &found_error));
+  CPPUNIT_ASSERT(found_error);
+  CPPUNIT_ASSERT(target.size() == 2u);
+  CPPUNIT_ASSERT(target.find("rule1") != target.end());
+  CPPUNIT_ASSERT(target.find("rule2") != target.end());
+  found_error = false;
+  CPPUNIT_ASSERT(!sr.find_missing_rule("WorkflowException: something else\n", &target, &found_error));
+  CPPUNIT_ASSERT(found_error);
+  CPPUNIT_ASSERT(target.size() == 2u);
+}
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_find_missing_rules_null_pointer() {
   std::vector<std::string> exec_log;
   solved_rules sr;
@@ -1052,6 +1653,58 @@ void snakemake_unit_tests::solved_rulesTest::test_solved_rules_add_dag_from_leaf
   CPPUNIT_ASSERT(included_rules.size() == 1);
   CPPUNIT_ASSERT(included_rules.find(rec2) != included_rules.end());
 }
+void snakemake_unit_tests::solved_rulesTest::test_solved_rules_add_referenced_recipes() {
+  std::vector<std::string> loaded_lines;
+  loaded_lines.push_back("rule rule1:");
+  loaded_lines.push_back("    input: rules.rule0.output,");
+  loaded_lines.push_back("rule rule2:");
+  loaded_lines.push_back("    input: rules.rule1.output,");
+  loaded_lines.push_back("rule rule3:");
+  loaded_lines.push_back("    input: checkpoints.rule4.get().output,");
+  loaded_lines.push_back("use rule rule3 as rule5 with:");
+  loaded_lines.push_back("    output: 'other.txt',");
+  loaded_lines.push_back("rule rule0:");
+  loaded_lines.push_back("    output: 'zero.txt',");
+  loaded_lines.push_back("rule rule4:");
+  loaded_lines.push_back("    output: 'four.txt',");
+  snakemake_file sf;
+  sf.parse_file(loaded_lines, "fakefile", false);
+  for (std::vector<boost::shared_ptr<rule_block> >::iterator iter = sf._blocks.begin(); iter != sf._blocks.end();
+       ++iter) {
+    (*iter)->set_resolution(RESOLVED_INCLUDED);
+  }
+  std::map<std::string, std::map<std::string, bool> > references;
+  sf.report_rule_references(&references);
+  solved_rules sr;
+  boost::shared_ptr<recipe> rec0a(new recipe), rec0b(new recipe), rec1(new recipe), rec2(new recipe),
+      rec4(new recipe);
+  rec0a->set_rule_name("rule0");
+  rec0b->set_rule_name("rule0");
+  rec1->set_rule_name("rule1");
+  rec2->set_rule_name("rule2");
+  rec4->set_rule_name("rule4");
+  sr._recipes.push_back(rec0a);
+  sr._recipes.push_back(rec0b);
+  sr._recipes.push_back(rec1);
+  sr._recipes.push_back(rec2);
+  sr._recipes.push_back(rec4);
+  // references are followed transitively, and every recipe of a referenced rule is added
+  std::map<boost::shared_ptr<recipe>, bool> target;
+  sr.add_referenced_recipes("rule2", references, sf, &target);
+  CPPUNIT_ASSERT(target.size() == 3u);
+  CPPUNIT_ASSERT(target.find(rec1) != target.end());
+  CPPUNIT_ASSERT(target.find(rec0a) != target.end());
+  CPPUNIT_ASSERT(target.find(rec0b) != target.end());
+  // derived rules inherit references from their base rule
+  target.clear();
+  sr.add_referenced_recipes("rule5", references, sf, &target);
+  CPPUNIT_ASSERT(target.size() == 1u);
+  CPPUNIT_ASSERT(target.find(rec4) != target.end());
+  // rules without references need nothing extra
+  target.clear();
+  sr.add_referenced_recipes("rule0", references, sf, &target);
+  CPPUNIT_ASSERT(target.empty());
+}
 void snakemake_unit_tests::solved_rulesTest::test_solved_rules_add_dag_from_leaf_entire() {
   std::map<boost::shared_ptr<recipe>, bool> included_rules;
   boost::shared_ptr<recipe> rec1(new recipe), rec2(new recipe), rec3(new recipe);
@@ -43,21 +43,36 @@ class solved_rulesTest : public CppUnit::TestFixture {
   CPPUNIT_TEST_EXCEPTION(test_solved_rules_load_file_unresolved_checkpoint, std::logic_error);
   CPPUNIT_TEST(test_solved_rules_load_file_toxic_output_files);
   CPPUNIT_TEST_EXCEPTION(test_solved_rules_load_file_unrecognized_block, std::logic_error);
+  CPPUNIT_TEST_EXCEPTION(test_solved_rules_load_file_invalid_threads, std::runtime_error);
   CPPUNIT_TEST(test_solved_rules_emit_tests);
+  CPPUNIT_TEST(test_solved_rules_emit_tests_long_dry_run_error);
+  CPPUNIT_TEST(test_solved_rules_emit_tests_dry_run_stderr);
   CPPUNIT_TEST(test_solved_rules_emit_snakefile);
+  CPPUNIT_TEST(test_solved_rules_emit_snakefile_rendered);
   CPPUNIT_TEST(test_solved_rules_create_workspace);
+  CPPUNIT_TEST(test_solved_rules_create_workspace_pytest_derived_rule);
   CPPUNIT_TEST(test_solved_rules_create_empty_workspace);
   CPPUNIT_TEST(test_solved_rules_remove_empty_workspace);
   CPPUNIT_TEST(test_solved_rules_copy_contents);
+  CPPUNIT_TEST(test_solved_rules_copy_contents_compressed);
+  CPPUNIT_TEST(test_solved_rules_digest_contents);
+  CPPUNIT_TEST(test_solved_rules_fingerprint_test);
+  CPPUNIT_TEST(test_solved_rules_plan_tests);
+  CPPUNIT_TEST(test_solved_rules_report_plans);
+  CPPUNIT_TEST(test_solved_rules_report_plans_json);
+  CPPUNIT_TEST(test_solved_rules_content_size);
   CPPUNIT_TEST(test_solved_rules_report_phony_all_target);
   CPPUNIT_TEST(test_solved_rules_report_modified_test_script);
   CPPUNIT_TEST(test_solved_rules_report_modified_launcher_script);
+  CPPUNIT_TEST(test_solved_rules_report_modified_launcher_script_unchanged);
   CPPUNIT_TEST_EXCEPTION(test_solved_rules_report_modified_launcher_script_bad_target_directory, std::runtime_error);
   CPPUNIT_TEST_EXCEPTION(test_solved_rules_report_modified_launcher_script_missing_script, std::runtime_error);
   CPPUNIT_TEST(test_solved_rules_find_missing_rules);
+  CPPUNIT_TEST(test_solved_rules_find_missing_rule);
   CPPUNIT_TEST_EXCEPTION(test_solved_rules_find_missing_rules_null_pointer, std::runtime_error);
   CPPUNIT_TEST_EXCEPTION(test_solved_rules_find_missing_rules_unexpected_error, std::runtime_error);
   CPPUNIT_TEST(test_solved_rules_add_dag_from_leaf);
+  CPPUNIT_TEST(test_solved_rules_add_referenced_recipes);
   CPPUNIT_TEST(test_solved_rules_add_dag_from_leaf_entire);
   CPPUNIT_TEST_EXCEPTION(test_solved_rules_add_dag_from_leaf_null_pointer, std::runtime_error);
   CPPUNIT_TEST_SUITE_END();
@@ -84,25 +99,46 @@ class solved_rulesTest : public CppUnit::TestFixture {
   void test_solved_rules_load_file_unresolved_checkpoint();
   void test_solved_rules_load_file_toxic_output_files();
   void test_solved_rules_load_file_unrecognized_block();
+  void test_solved_rules_load_file_invalid_threads();
   void test_solved_rules_emit_tests();
+  void test_solved_rules_emit_tests_long_dry_run_error();
+  void test_solved_rules_emit_tests_dry_run_stderr();
   void test_solved_rules_emit_snakefile();
+  void test_solved_rules_emit_snakefile_rendered();
   void test_solved_rules_create_workspace();
+  void test_solved_rules_create_workspace_pytest_derived_rule();
   void test_solved_rules_create_empty_workspace();
   void test_solved_rules_remove_empty_workspace();
   void test_solved_rules_copy_contents();
+  void test_solved_rules_copy_contents_compressed();
+  void test_solved_rules_digest_contents();
+  void test_solved_rules_fingerprint_test();
+  void test_solved_rules_plan_tests();
+  void test_solved_rules_report_plans();
+  void test_solved_rules_report_plans_json();
+  void test_solved_rules_content_size();
   void test_solved_rules_report_phony_all_target();
   void test_solved_rules_report_modified_test_script();
   void test_solved_rules_report_modified_launcher_script();
+  void test_solved_rules_report_modified_launcher_script_unchanged();
   void test_solved_rules_report_modified_launcher_script_bad_target_directory();
   void test_solved_rules_report_modified_launcher_script_missing_script();
   void test_solved_rules_find_missing_rules();
+  void test_solved_rules_find_missing_rule();
   void test_solved_rules_find_missing_rules_null_pointer();
   void test_solved_rules_find_missing_rules_unexpected_error();
   void test_solved_rules_add_dag_from_leaf();
+  void test_solved_rules_add_referenced_recipes();
   void test_solved_rules_add_dag_from_leaf_entire();
   void test_solved_rules_add_dag_from_leaf_null_pointer();
 
  private:
+  /*!
+    @brief emit a test for one rule, with a stand-in for snakemake dry runs
+    @param dry_run_script bash commands run in place of snakemake
+    @param err storage for what emission reports to std::cerr
+   */
+  void emit_tests_with_dry_run(const std::string &dry_run_script, std::string *err) const;
   char *_tmp_dir;
 };
 }  // namespace snakemake_unit_tests
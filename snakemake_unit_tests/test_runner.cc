@@ -0,0 +1,456 @@
+/*!
+  \file test_runner.cc
+  \brief implementation of the concurrent unit test runner
+  \copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#include "snakemake_unit_tests/test_runner.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "snakemake_unit_tests/sha256.h"
+
+namespace {
+/*!
+  @brief parse a number of MB from a resource value
+  @param value resource value, as recorded
+  @param scale factor converting the value's unit to MB
+  @param memory_mb where to store the result
+  @return whether value was a plain number
+ */
+bool parse_memory(const std::string &value, double scale, unsigned long long *memory_mb) {
+  if (value.empty() || value.find_first_not_of("0123456789.") != std::string::npos) return false;
+  *memory_mb = static_cast<unsigned long long>(std::stod(value) * scale + 0.5);
+  return true;
+}
+
+/*!
+  @brief collect the single-quoted python string literals on a line
+  @param line line of an emitted test header
+  @param start position after the variable name
+  @param target storage for unescaped literals, in order
+ */
+void parse_python_strings(const std::string &line, std::string::size_type start, std::vector<std::string> *target) {
+  bool open = false;
+  std::string current = "";
+  for (std::string::size_type i = start; i < line.size(); ++i) {
+    if (!open) {
+      if (line.at(i) == '\'') open = true;
+    } else if (line.at(i) == '\\' && i + 1 < line.size()) {
+      current += line.at(++i);
+    } else if (line.at(i) == '\'') {
+      target->push_back(current);
+      current = "";
+      open = false;
+    } else {
+      current += line.at(i);
+    }
+  }
+}
+}  // namespace
+
+snakemake_unit_tests::test_runner::test_runner() : _jobs(0), _memory_mb(0), _timeout(0.0), _use_cache(true) {
+  _command.push_back("pytest");
+  // concurrent runs would otherwise race on a shared .pytest_cache
+  _command.push_back("-p");
+  _command.push_back("no:cacheprovider");
+  // as each test's own snakemake is run
+  _env_command.push_back("python");
+  _env_command.push_back("-m");
+  _env_command.push_back("snakemake");
+}
+
+void snakemake_unit_tests::test_runner::set_command(const std::vector<std::string> &command) {
+  if (command.empty()) throw std::runtime_error("test runner command cannot be empty");
+  _command = command;
+}
+
+void snakemake_unit_tests::test_runner::set_env_command(const std::vector<std::string> &command) {
+  if (command.empty()) throw std::runtime_error("conda environment command cannot be empty");
+  _env_command = command;
+}
+
+void snakemake_unit_tests::test_runner::discover_tests(const boost::filesystem::path &output_test_dir,
+                                                       const std::map<std::string, bool> &include_rules,
+                                                       const std::map<std::string, bool> &exclude_rules,
+                                                       std::vector<std::string> *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to discover_tests");
+  target->clear();
+  boost::filesystem::path unit_dir = output_test_dir / "unit";
+  if (!boost::filesystem::is_directory(unit_dir)) {
+    throw std::runtime_error("no unit tests found: \"" + unit_dir.string() + "\" is not a directory");
+  }
+  const std::string prefix = "test_", suffix = ".py";
+  boost::filesystem::directory_iterator dir_iter(unit_dir), dir_end;
+  for (; dir_iter != dir_end; ++dir_iter) {
+    std::string filename = dir_iter->path().filename().string();
+    if (filename.size() <= prefix.size() + suffix.size() || filename.compare(0, prefix.size(), prefix) ||
+        filename.compare(filename.size() - suffix.size(), suffix.size(), suffix)) {
+      continue;
+    }
+    std::string rule_name = filename.substr(prefix.size(), filename.size() - prefix.size() - suffix.size());
+    // test_common.py and the like are infrastructure, not tests
+    if (!boost::filesystem::is_directory(unit_dir / rule_name)) continue;
+    if (exclude_rules.find(rule_name) != exclude_rules.end() ||
+        (!include_rules.empty() && include_rules.find(rule_name) == include_rules.end())) {
+      continue;
+    }
+    target->push_back(rule_name);
+  }
+  std::sort(target->begin(), target->end());
+}
+
+void snakemake_unit_tests::test_runner::read_requirements(const boost::filesystem::path &test_file, unsigned *threads,
+                                                          unsigned long long *memory_mb) {
+  if (!threads || !memory_mb) throw std::runtime_error("null pointer provided to read_requirements");
+  *threads = 1;
+  *memory_mb = 0;
+  std::ifstream input(test_file.string().c_str());
+  if (!input.is_open()) throw std::runtime_error("cannot read test file \"" + test_file.string() + "\"");
+  std::map<std::string, std::string> resources;
+  std::string line = "";
+  // requirements are in the generated header, before the copy of inst/test.py
+  while (getline(input, line) && line.find("extra_comparison_exclusions=") != 0) {
+    if (line.find("threads=") == 0) {
+      std::string count = line.substr(8);
+      if (!count.empty() && count.find_first_not_of("0123456789") == std::string::npos && std::stoul(count)) {
+        *threads = std::stoul(count);
+      }
+    } else if (line.find("resources={") == 0) {
+      // alternating keys and values, as single-quoted python literals
+      std::vector<std::string> literals;
+      parse_python_strings(line, 11, &literals);
+      for (std::vector<std::string>::size_type i = 0; i + 1 < literals.size(); i += 2) {
+        resources[literals.at(i)] = literals.at(i + 1);
+      }
+    }
+  }
+  input.close();
+  std::map<std::string, std::string>::const_iterator finder;
+  if ((finder = resources.find("mem_mb")) != resources.end() && parse_memory(finder->second, 1.0, memory_mb)) return;
+  if ((finder = resources.find("mem_mib")) != resources.end() && parse_memory(finder->second, 1.048576, memory_mb))
+    return;
+  if ((finder = resources.find("mem_gb")) != resources.end()) parse_memory(finder->second, 1000.0, memory_mb);
+}
+
+void snakemake_unit_tests::test_runner::read_conda_envs(const boost::filesystem::path &test_file,
+                                                        std::string *conda_prefix,
+                                                        std::vector<std::string> *conda_envs) {
+  if (!conda_prefix || !conda_envs) throw std::runtime_error("null pointer provided to read_conda_envs");
+  conda_prefix->clear();
+  conda_envs->clear();
+  std::ifstream input(test_file.string().c_str());
+  if (!input.is_open()) throw std::runtime_error("cannot read test file \"" + test_file.string() + "\"");
+  std::string line = "";
+  while (getline(input, line) && line.find("extra_comparison_exclusions=") != 0) {
+    if (line.find("conda_prefix=") == 0) {
+      std::vector<std::string> literals;
+      parse_python_strings(line, 13, &literals);
+      if (!literals.empty()) *conda_prefix = literals.at(0);
+    } else if (line.find("conda_envs=[") == 0) {
+      parse_python_strings(line, 12, conda_envs);
+    }
+  }
+  input.close();
+}
+
+unsigned snakemake_unit_tests::test_runner::build_conda_envs(const boost::filesystem::path &output_test_dir,
+                                                             const std::vector<std::string> &rules,
+                                                             std::ostream &out) const {
+  boost::filesystem::path unit_dir = boost::filesystem::absolute(output_test_dir / "unit");
+  // snakemake names an environment for its prefix and contents, so the first file with each is built
+  std::map<std::pair<std::string, std::string>, boost::filesystem::path> unique_envs;
+  std::string prefix = "", contents = "";
+  std::vector<std::string> envs;
+  for (std::vector<std::string>::const_iterator iter = rules.begin(); iter != rules.end(); ++iter) {
+    read_conda_envs(unit_dir / ("test_" + *iter + ".py"), &prefix, &envs);
+    if (prefix.empty()) continue;
+    for (std::vector<std::string>::const_iterator env = envs.begin(); env != envs.end(); ++env) {
+      boost::filesystem::path env_file(*env);
+      if (env_file.is_relative()) env_file = unit_dir / *iter / "workspace" / env_file;
+      std::ifstream input(env_file.string().c_str(), std::ios_base::binary);
+      if (!input.is_open()) {
+        out << "cannot find conda environment \"" << *env << "\" for rule \"" << *iter
+            << "\"; its test will create it" << std::endl;
+        continue;
+      }
+      contents.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+      input.close();
+      unique_envs.insert(std::make_pair(std::make_pair(prefix, contents), env_file));
+    }
+  }
+  std::vector<std::pair<std::string, boost::filesystem::path>> to_build;
+  for (std::map<std::pair<std::string, std::string>, boost::filesystem::path>::const_iterator iter =
+           unique_envs.begin();
+       iter != unique_envs.end(); ++iter) {
+    to_build.push_back(std::make_pair(iter->first.first, iter->second));
+  }
+  // each environment gets its own snakefile, as snakemake creates one snakefile's environments one at a time
+  boost::filesystem::path scratch =
+      boost::filesystem::unique_path(boost::filesystem::temp_directory_path() / "sut_conda_envs_%%%%-%%%%-%%%%");
+  std::mutex lock;
+  unsigned failures = 0, finished = 0;
+  run_in_parallel(to_build.size(), _jobs, [&](unsigned i) {
+    boost::filesystem::path build_dir = scratch / std::to_string(i);
+    boost::filesystem::create_directories(build_dir);
+    std::ofstream output((build_dir / "Snakefile").string().c_str());
+    output << "rule build_env:\n    output:\n        'built',\n    conda:\n        '"
+           << python_escape(to_build.at(i).second.string()) << "'\n    shell:\n        'touch {output}'\n";
+    output.close();
+    std::vector<std::string> args(_env_command);
+    args.push_back("--snakefile");
+    args.push_back((build_dir / "Snakefile").string());
+    args.push_back("--directory");
+    args.push_back(build_dir.string());
+    args.push_back("--cores");
+    args.push_back("1");
+    args.push_back("--use-conda");
+    args.push_back("--conda-frontend");
+    args.push_back("mamba");
+    args.push_back("--conda-prefix");
+    args.push_back(to_build.at(i).first);
+    args.push_back("--conda-create-envs-only");
+    subprocess_options options;
+    options.fail_on_error = false;
+    options.emit_error_logging = false;
+    options.timeout_seconds = _timeout;
+    std::string log = "";
+    options.stdout_callback = [&log](std::string_view line) { log.append(line.data(), line.size()); };
+    options.stderr_callback = options.stdout_callback;
+    subprocess_result result = run_subprocess(args, options);
+    std::lock_guard<std::mutex> guard(lock);
+    bool built = !result.timed_out && !result.exit_status;
+    out << "[" << ++finished << "/" << to_build.size() << "] " << (built ? "BUILT " : "FAILED ")
+        << to_build.at(i).second.string() << " (" << result.wall_seconds << "s)" << std::endl;
+    if (!built) {
+      ++failures;
+      out << log;
+    }
+  });
+  boost::filesystem::remove_all(scratch);
+  return failures;
+}
+
+std::string snakemake_unit_tests::test_runner::cache_key(const boost::filesystem::path &unit_dir,
+                                                        const std::string &rule_name) {
+  boost::filesystem::path fingerprint = unit_dir / rule_name / "fingerprint.txt";
+  if (!boost::filesystem::is_regular_file(fingerprint)) return "";
+  // the data's fingerprint, and the small files that decide how the test treats that data
+  std::vector<boost::filesystem::path> files;
+  files.push_back(fingerprint);
+  files.push_back(unit_dir / ("test_" + rule_name + ".py"));
+  files.push_back(unit_dir / "common.py");
+  files.push_back(unit_dir / "config.yaml");
+  sha256 hasher;
+  for (std::vector<boost::filesystem::path>::const_iterator iter = files.begin(); iter != files.end(); ++iter) {
+    std::ifstream input(iter->string().c_str(), std::ios_base::binary);
+    std::string contents = "";
+    if (input.is_open()) {
+      contents.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+      input.close();
+      hasher.update(iter->filename().string() + " " + std::to_string(contents.size()) + "\n");
+      hasher.update(contents);
+    } else {
+      hasher.update(iter->filename().string() + " missing\n");
+    }
+  }
+  return hasher.hex_digest();
+}
+
+void snakemake_unit_tests::test_runner::read_pass_cache(const boost::filesystem::path &cache_file,
+                                                        std::map<std::string, std::string> *target) {
+  if (!target) throw std::runtime_error("null pointer provided to read_pass_cache");
+  target->clear();
+  std::ifstream input(cache_file.string().c_str());
+  if (!input.is_open()) return;
+  std::string line = "";
+  while (getline(input, line)) {
+    std::string::size_type tab = line.find('\t');
+    // anything else is not from this program, and is dropped when the record is replaced
+    if (tab == std::string::npos || !tab || line.size() - tab - 1 != 64) continue;
+    (*target)[line.substr(0, tab)] = line.substr(tab + 1);
+  }
+  input.close();
+}
+
+void snakemake_unit_tests::test_runner::write_pass_cache(const boost::filesystem::path &cache_file,
+                                                         const std::map<std::string, std::string> &cache) {
+  // written aside and renamed, so that an interrupted run leaves the old record intact
+  boost::filesystem::path tmp_file = cache_file.string() + ".tmp";
+  std::ofstream output(tmp_file.string().c_str());
+  if (!output.is_open()) throw std::runtime_error("cannot write test cache \"" + tmp_file.string() + "\"");
+  for (std::map<std::string, std::string>::const_iterator iter = cache.begin(); iter != cache.end(); ++iter) {
+    if (!(output << iter->first << '\t' << iter->second << '\n'))
+      throw std::runtime_error("cannot write test cache \"" + tmp_file.string() + "\"");
+  }
+  output.close();
+  boost::filesystem::rename(tmp_file, cache_file);
+}
+
+snakemake_unit_tests::test_result snakemake_unit_tests::test_runner::run_test(
+    const boost::filesystem::path &output_test_dir, const std::string &rule_name) const {
+  test_result res;
+  res.rule_name = rule_name;
+  // the test runs from the unit directory, so it must not be given relative paths
+  boost::filesystem::path unit_dir = boost::filesystem::absolute(output_test_dir / "unit");
+  boost::filesystem::path output_dir = unit_dir / rule_name / "output";
+  tracer::span test_span(_tracer, rule_name, "test");
+  // remove any output left by a failed prior run
+  boost::filesystem::remove_all(output_dir);
+  std::vector<std::string> args(_command);
+  args.push_back((unit_dir / ("test_" + rule_name + ".py")).string());
+  subprocess_options options;
+  options.working_directory = unit_dir.string();
+  options.fail_on_error = false;
+  options.emit_error_logging = false;
+  options.timeout_seconds = _timeout;
+  std::string *output = &res.output;
+  options.stdout_callback = [output](std::string_view line) { output->append(line.data(), line.size()); };
+  options.stderr_callback = options.stdout_callback;
+  res.result = run_subprocess(args, options);
+  if (res.result.exit_status == 127 && res.output.empty()) {
+    res.output = "cannot run \"" + args.at(0) + "\"\n";
+  }
+  test_span.add_arg("exit_status", std::to_string(res.result.exit_status));
+  if (res.passed()) {
+    // only failed runs keep their output, for inspection
+    boost::filesystem::remove_all(output_dir);
+  }
+  return res;
+}
+
+void snakemake_unit_tests::test_runner::run_tests(const boost::filesystem::path &output_test_dir,
+                                                  const std::vector<std::string> &rules, bool verbose,
+                                                  std::ostream &out, std::vector<test_result> *target) const {
+  if (!target) throw std::runtime_error("null pointer provided to run_tests");
+  target->clear();
+  target->resize(rules.size());
+  unsigned cores = _jobs ? _jobs : std::max(std::thread::hardware_concurrency(), 1u);
+  unsigned long long memory_mb = _memory_mb;
+  if (!memory_mb) {
+    memory_mb = static_cast<unsigned long long>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE) / 1000000;
+  }
+  // tests whose fingerprint passed before are not run again
+  boost::filesystem::path cache_file = output_test_dir / "unit" / "pass_cache.tsv";
+  std::map<std::string, std::string> cache;
+  read_pass_cache(cache_file, &cache);
+  std::vector<std::string> keys;
+  unsigned finished = 0;
+  for (unsigned i = 0; i < rules.size(); ++i) {
+    keys.push_back(cache_key(output_test_dir / "unit", rules.at(i)));
+    std::map<std::string, std::string>::const_iterator finder = cache.find(rules.at(i));
+    if (_use_cache && !keys.at(i).empty() && finder != cache.end() && !finder->second.compare(keys.at(i))) {
+      target->at(i).rule_name = rules.at(i);
+      target->at(i).cached = true;
+      out << "[" << ++finished << "/" << rules.size() << "] CACHED " << rules.at(i) << std::endl;
+    }
+  }
+  // reserve what each test declared, capped so that no test waits forever
+  std::vector<std::pair<unsigned, unsigned long long>> reserved;
+  for (std::vector<std::string>::const_iterator iter = rules.begin(); iter != rules.end(); ++iter) {
+    unsigned threads = 1;
+    unsigned long long declared_mb = 0;
+    read_requirements(output_test_dir / "unit" / ("test_" + *iter + ".py"), &threads, &declared_mb);
+    reserved.push_back(std::make_pair(std::min(threads, cores), std::min(declared_mb, memory_mb)));
+  }
+  // largest first, so that smaller tests fill the gaps around them
+  std::vector<unsigned> pending;
+  for (unsigned i = 0; i < rules.size(); ++i) {
+    if (!target->at(i).cached) pending.push_back(i);
+  }
+  std::stable_sort(pending.begin(), pending.end(),
+                   [&reserved](unsigned a, unsigned b) { return reserved.at(a) > reserved.at(b); });
+
+  std::mutex lock;
+  std::condition_variable released;
+  unsigned free_cores = cores;
+  unsigned long long free_mb = memory_mb;
+  std::exception_ptr first_error;
+  std::vector<std::thread> workers;
+  std::unique_lock<std::mutex> guard(lock);
+  while (!pending.empty() && !first_error) {
+    std::vector<unsigned>::iterator next = pending.begin();
+    while (next != pending.end() && (reserved.at(*next).first > free_cores || reserved.at(*next).second > free_mb)) {
+      ++next;
+    }
+    if (next == pending.end()) {
+      released.wait(guard);
+      continue;
+    }
+    unsigned i = *next;
+    pending.erase(next);
+    free_cores -= reserved.at(i).first;
+    free_mb -= reserved.at(i).second;
+    workers.push_back(std::thread([&, i]() {
+      test_result res;
+      std::exception_ptr error;
+      try {
+        res = run_test(output_test_dir, rules.at(i));
+      } catch (...) {
+        error = std::current_exception();
+      }
+      res.threads = reserved.at(i).first;
+      res.memory_mb = reserved.at(i).second;
+      // report whole tests at a time, so concurrent output does not interleave
+      std::lock_guard<std::mutex> worker_guard(lock);
+      free_cores += reserved.at(i).first;
+      free_mb += reserved.at(i).second;
+      if (error) {
+        if (!first_error) first_error = error;
+      } else {
+        out << "[" << ++finished << "/" << rules.size() << "] " << (res.passed() ? "PASS " : "FAIL ")
+            << res.rule_name << " (" << res.result.wall_seconds << "s"
+            << (res.result.timed_out ? ", timed out" : "") << ")" << std::endl;
+        if (verbose || !res.passed()) out << res.output;
+        target->at(i) = res;
+      }
+      released.notify_all();
+    }));
+  }
+  guard.unlock();
+  for (std::vector<std::thread>::iterator iter = workers.begin(); iter != workers.end(); ++iter) {
+    iter->join();
+  }
+  if (first_error) std::rethrow_exception(first_error);
+  for (unsigned i = 0; i < rules.size(); ++i) {
+    if (target->at(i).cached) continue;
+    if (target->at(i).passed() && !keys.at(i).empty()) {
+      cache[rules.at(i)] = keys.at(i);
+    } else {
+      cache.erase(rules.at(i));
+    }
+  }
+  write_pass_cache(cache_file, cache);
+}
+
+void snakemake_unit_tests::test_runner::report_results(const std::vector<test_result> &results, std::ostream &out) {
+  unsigned n_passed = 0, n_cached = 0;
+  for (std::vector<test_result>::const_iterator iter = results.begin(); iter != results.end(); ++iter) {
+    if (iter->passed()) ++n_passed;
+    if (iter->cached) ++n_cached;
+  }
+  out << results.size() << " test" << (results.size() == 1 ? "" : "s") << ": " << n_passed << " passed";
+  if (n_cached) out << " (" << n_cached << " cached)";
+  out << ", " << results.size() - n_passed << " failed" << std::endl;
+  if (n_passed == results.size()) return;
+  out << "failed tests:" << std::endl;
+  for (std::vector<test_result>::const_iterator iter = results.begin(); iter != results.end(); ++iter) {
+    if (iter->passed()) continue;
+    out << "  - " << iter->rule_name;
+    if (iter->result.timed_out) {
+      out << " (timed out)";
+    } else {
+      out << " (exit status " << iter->result.exit_status << ")";
+    }
+    out << std::endl;
+  }
+}
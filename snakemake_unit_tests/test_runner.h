@@ -0,0 +1,291 @@
+/*!
+  @file test_runner.h
+  @brief run emitted unit tests concurrently and track their results
+  @copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_TEST_RUNNER_H_
+#define SNAKEMAKE_UNIT_TESTS_TEST_RUNNER_H_
+
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "boost/smart_ptr.hpp"
+#include "snakemake_unit_tests/tracer.h"
+#include "snakemake_unit_tests/utilities.h"
+
+namespace snakemake_unit_tests {
+/*!
+  @brief outcome of a single emitted unit test
+ */
+struct test_result {
+  /*!
+    @brief default constructor: a passing single-threaded test
+   */
+  test_result() : threads(1), memory_mb(0), cached(false) {}
+  /*!
+    @brief whether the test ran to completion and succeeded
+    @return whether the test passed
+   */
+  bool passed() const { return !result.timed_out && !result.exit_status; }
+  /*!
+    @brief name of the tested rule
+   */
+  std::string rule_name;
+  /*!
+    @brief exit status, timeout state and resource use of the test command
+   */
+  subprocess_result result;
+  /*!
+    @brief combined standard output and standard error of the test command
+   */
+  std::string output;
+  /*!
+    @brief cores reserved for the test while it ran
+   */
+  unsigned threads;
+  /*!
+    @brief memory reserved for the test while it ran, in MB
+   */
+  unsigned long long memory_mb;
+  /*!
+    @brief whether the test was skipped, as its fingerprint passed before
+   */
+  bool cached;
+};
+
+/*!
+  @class test_runner
+  @brief discover tests under {output-test-dir}/unit and run them on a pool of workers
+
+  a test for rule R is the pytest file unit/test_R.py alongside the directory unit/R.
+  each test runs in its own process; results are collected from exit status, not
+  from terminal output. a test's output/ directory is removed before it runs, and
+  again after it passes, so that only failed runs leave output for inspection.
+
+  tests are packed onto a budget of cores and memory, using the threads and
+  memory their rule declared in the logged run, as recorded in the test file.
+  larger tests are started first, and smaller tests fill in around them; a test
+  declaring more than the whole budget runs alone.
+
+  each test's pass is recorded in unit/pass_cache.tsv against the fingerprint
+  of its emitted data, combined with its test file and the shared test
+  infrastructure. a test whose fingerprint has already passed is reported
+  as cached instead of run; a failure removes its record.
+
+  before any test runs, the conda environments that tests would create in a
+  shared conda prefix can be built, each once, by build_conda_envs.
+ */
+class test_runner {
+ public:
+  /*!
+    @brief default constructor: run with pytest, one test per core, no timeout
+   */
+  test_runner();
+  /*!
+    @brief copy constructor
+    @param obj existing test_runner
+   */
+  test_runner(const test_runner &obj)
+      : _jobs(obj._jobs),
+        _memory_mb(obj._memory_mb),
+        _timeout(obj._timeout),
+        _command(obj._command),
+        _env_command(obj._env_command),
+        _use_cache(obj._use_cache),
+        _tracer(obj._tracer) {}
+  /*!
+    @brief destructor
+   */
+  ~test_runner() throw() {}
+  /*!
+    @brief set how many cores tests may use at once
+    @param jobs number of cores; 0 for every core
+   */
+  void set_jobs(unsigned jobs) { _jobs = jobs; }
+  /*!
+    @brief get how many cores tests may use at once
+    @return number of cores; 0 for every core
+   */
+  unsigned get_jobs() const { return _jobs; }
+  /*!
+    @brief set how much memory tests may declare at once
+    @param memory_mb memory in MB; 0 for all physical memory
+   */
+  void set_memory_mb(unsigned long long memory_mb) { _memory_mb = memory_mb; }
+  /*!
+    @brief get how much memory tests may declare at once
+    @return memory in MB; 0 for all physical memory
+   */
+  unsigned long long get_memory_mb() const { return _memory_mb; }
+  /*!
+    @brief set the wall-clock limit for each test
+    @param seconds limit in seconds, or 0 for no limit
+   */
+  void set_timeout(double seconds) { _timeout = seconds; }
+  /*!
+    @brief get the wall-clock limit for each test
+    @return limit in seconds, or 0 for no limit
+   */
+  double get_timeout() const { return _timeout; }
+  /*!
+    @brief set the command that runs a single test
+    @param command program and leading arguments; the test file is appended
+   */
+  void set_command(const std::vector<std::string> &command);
+  /*!
+    @brief get the command that runs a single test
+    @return program and leading arguments
+   */
+  const std::vector<std::string> &get_command() const { return _command; }
+  /*!
+    @brief set the command that creates the conda environments of a snakefile
+    @param command program and leading arguments; snakemake arguments are appended
+   */
+  void set_env_command(const std::vector<std::string> &command);
+  /*!
+    @brief get the command that creates the conda environments of a snakefile
+    @return program and leading arguments
+   */
+  const std::vector<std::string> &get_env_command() const { return _env_command; }
+  /*!
+    @brief set whether tests whose fingerprint passed before are skipped
+    @param use_cache whether to skip them; passes are recorded either way
+   */
+  void set_use_cache(bool use_cache) { _use_cache = use_cache; }
+  /*!
+    @brief get whether tests whose fingerprint passed before are skipped
+    @return whether they are skipped
+   */
+  bool get_use_cache() const { return _use_cache; }
+  /*!
+    @brief attach a tracer to receive a span for each test
+    @param ptr tracer shared with the caller, or null to stop tracing
+   */
+  void set_tracer(boost::shared_ptr<tracer> ptr) { _tracer = ptr; }
+  /*!
+    @brief find the tests installed under an output directory
+    @param output_test_dir top-level output directory for all tests
+    @param include_rules if not empty, only these rules are tested
+    @param exclude_rules rules not to test
+    @param target storage for names of tested rules, in sorted order
+   */
+  void discover_tests(const boost::filesystem::path &output_test_dir, const std::map<std::string, bool> &include_rules,
+                      const std::map<std::string, bool> &exclude_rules, std::vector<std::string> *target) const;
+  /*!
+    @brief run tests concurrently
+    @param output_test_dir top-level output directory for all tests
+    @param rules names of rules to test
+    @param verbose whether to report the output of passing tests as well as failing ones
+    @param out stream to which progress is reported as each test finishes
+    @param target storage for results, in the order of rules
+
+    unit/pass_cache.tsv is updated with the results once every test has finished.
+   */
+  void run_tests(const boost::filesystem::path &output_test_dir, const std::vector<std::string> &rules, bool verbose,
+                 std::ostream &out, std::vector<test_result> *target) const;
+  /*!
+    @brief create the conda environments of tests that share a conda prefix, each once, concurrently
+    @param output_test_dir top-level output directory for all tests
+    @param rules names of rules whose tests' environments are created
+    @param out stream to which each environment is reported as it is finished
+    @return number of environments that could not be created
+
+    environments are identified as snakemake identifies them, by prefix and
+    file contents, so tests that share an environment file, or copies of it,
+    share one build. tests that name no prefix are left to create their own.
+   */
+  unsigned build_conda_envs(const boost::filesystem::path &output_test_dir, const std::vector<std::string> &rules,
+                            std::ostream &out) const;
+  /*!
+    @brief summarize results, listing failed tests
+    @param results results from run_tests
+    @param out stream to which to write
+   */
+  static void report_results(const std::vector<test_result> &results, std::ostream &out);
+
+ private:
+  friend class test_runnerTest;
+  /*!
+    @brief read the threads and memory a test declares
+    @param test_file emitted test_<rule>.py
+    @param threads where to store declared threads; 1 if none are declared
+    @param memory_mb where to store declared memory in MB; 0 if none is declared
+
+    memory is taken from the mem_mb, mem_mib or mem_gb resource, in that order
+   */
+  static void read_requirements(const boost::filesystem::path &test_file, unsigned *threads,
+                                unsigned long long *memory_mb);
+  /*!
+    @brief read the shared conda prefix and environment files a test declares
+    @param test_file emitted test_<rule>.py
+    @param conda_prefix where to store the prefix; empty if none is declared
+    @param conda_envs where to store environment files, relative to the test's workspace
+   */
+  static void read_conda_envs(const boost::filesystem::path &test_file, std::string *conda_prefix,
+                              std::vector<std::string> *conda_envs);
+  /*!
+    @brief compute the key under which a test's pass is recorded
+    @param unit_dir {output-test-dir}/unit
+    @param rule_name name of the tested rule
+    @return SHA-256 of the test's emitted fingerprint, test file, and shared
+    infrastructure; empty if the test was emitted without a fingerprint
+   */
+  static std::string cache_key(const boost::filesystem::path &unit_dir, const std::string &rule_name);
+  /*!
+    @brief read the record of passed tests
+    @param cache_file unit/pass_cache.tsv
+    @param target storage for cache keys, by rule name; empty if there is no record
+   */
+  static void read_pass_cache(const boost::filesystem::path &cache_file, std::map<std::string, std::string> *target);
+  /*!
+    @brief replace the record of passed tests
+    @param cache_file unit/pass_cache.tsv
+    @param cache cache keys, by rule name
+   */
+  static void write_pass_cache(const boost::filesystem::path &cache_file,
+                               const std::map<std::string, std::string> &cache);
+  /*!
+    @brief run a single test, cleaning up its output if it passes
+    @param output_test_dir top-level output directory for all tests
+    @param rule_name name of the tested rule
+    @return outcome of the test
+   */
+  test_result run_test(const boost::filesystem::path &output_test_dir, const std::string &rule_name) const;
+  /*!
+    @brief cores tests may use at once; 0 for every core
+   */
+  unsigned _jobs;
+  /*!
+    @brief memory in MB tests may declare at once; 0 for all physical memory
+   */
+  unsigned long long _memory_mb;
+  /*!
+    @brief wall-clock limit for each test in seconds, or 0 for no limit
+   */
+  double _timeout;
+  /*!
+    @brief program and leading arguments that run a single test
+   */
+  std::vector<std::string> _command;
+  /*!
+    @brief program and leading arguments that create the conda environments of a snakefile
+   */
+  std::vector<std::string> _env_command;
+  /*!
+    @brief whether tests whose fingerprint passed before are skipped
+   */
+  bool _use_cache;
+  /*!
+    @brief optional recipient of per-test spans
+   */
+  boost::shared_ptr<tracer> _tracer;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_TEST_RUNNER_H_
@@ -0,0 +1,464 @@
+/*!
+  \file test_runnerTest.cc
+  \brief implementation of test_runner unit tests for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#include "snakemake_unit_tests/test_runnerTest.h"
+
+void snakemake_unit_tests::test_runnerTest::setUp() {
+  unsigned buffer_size = std::filesystem::temp_directory_path().string().size() + 20;
+  _tmp_dir = new char[buffer_size];
+  strncpy(_tmp_dir, (std::filesystem::temp_directory_path().string() + "/sutTRTXXXXXX").c_str(), buffer_size);
+  char *res = mkdtemp(_tmp_dir);
+  if (!res) {
+    throw std::runtime_error("test_runnerTest mkdtemp failed");
+  }
+}
+
+void snakemake_unit_tests::test_runnerTest::tearDown() {
+  if (_tmp_dir) {
+    std::filesystem::remove_all(std::filesystem::path(_tmp_dir));
+    delete[] _tmp_dir;
+  }
+}
+
+void snakemake_unit_tests::test_runnerTest::install_test(const std::string &rule_name,
+                                                         const std::string &content) const {
+  boost::filesystem::path unit_dir = boost::filesystem::path(_tmp_dir) / "unit";
+  boost::filesystem::create_directories(unit_dir / rule_name);
+  std::ofstream output((unit_dir / ("test_" + rule_name + ".py")).string().c_str());
+  output << content << std::endl;
+  output.close();
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_result_passed() {
+  test_result r;
+  CPPUNIT_ASSERT(r.threads == 1);
+  CPPUNIT_ASSERT(!r.memory_mb);
+  CPPUNIT_ASSERT(!r.cached);
+  CPPUNIT_ASSERT(r.passed());
+  r.result.exit_status = 1;
+  CPPUNIT_ASSERT(!r.passed());
+  r.result.exit_status = 0;
+  r.result.timed_out = true;
+  CPPUNIT_ASSERT(!r.passed());
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_default_constructor() {
+  test_runner tr;
+  CPPUNIT_ASSERT(!tr.get_jobs());
+  CPPUNIT_ASSERT(!tr.get_memory_mb());
+  CPPUNIT_ASSERT(tr.get_timeout() == 0.0);
+  CPPUNIT_ASSERT(tr.get_command().size() == 3);
+  CPPUNIT_ASSERT(!tr.get_command().at(0).compare("pytest"));
+  CPPUNIT_ASSERT(tr.get_env_command().size() == 3);
+  CPPUNIT_ASSERT(!tr.get_env_command().at(2).compare("snakemake"));
+  CPPUNIT_ASSERT(tr.get_use_cache());
+  CPPUNIT_ASSERT(!tr._tracer);
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_copy_constructor() {
+  test_runner tr1;
+  tr1.set_jobs(4);
+  tr1.set_memory_mb(1000);
+  tr1.set_timeout(2.5);
+  tr1.set_command(std::vector<std::string>(1, "true"));
+  tr1.set_env_command(std::vector<std::string>(1, "false"));
+  tr1.set_use_cache(false);
+  tr1.set_tracer(boost::shared_ptr<tracer>(new tracer));
+  test_runner tr2(tr1);
+  CPPUNIT_ASSERT(tr2.get_jobs() == 4);
+  CPPUNIT_ASSERT(tr2.get_memory_mb() == 1000);
+  CPPUNIT_ASSERT(tr2.get_timeout() == 2.5);
+  CPPUNIT_ASSERT(tr2.get_command() == tr1.get_command());
+  CPPUNIT_ASSERT(tr2.get_env_command() == tr1.get_env_command());
+  CPPUNIT_ASSERT(!tr2.get_use_cache());
+  CPPUNIT_ASSERT(tr2._tracer == tr1._tracer);
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_set_command() {
+  test_runner tr;
+  std::vector<std::string> command;
+  command.push_back("python3");
+  command.push_back("-m");
+  command.push_back("pytest");
+  tr.set_command(command);
+  CPPUNIT_ASSERT(tr.get_command() == command);
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_set_command_empty() {
+  test_runner tr;
+  tr.set_command(std::vector<std::string>());
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_set_env_command() {
+  test_runner tr;
+  std::vector<std::string> command;
+  command.push_back("snakemake");
+  tr.set_env_command(command);
+  CPPUNIT_ASSERT(tr.get_env_command() == command);
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_set_env_command_empty() {
+  test_runner tr;
+  tr.set_env_command(std::vector<std::string>());
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_discover_tests() {
+  install_test("rule2", "pass");
+  install_test("rule1", "pass");
+  install_test("rule3", "pass");
+  // infrastructure file without a test directory
+  std::ofstream output((boost::filesystem::path(_tmp_dir) / "unit" / "test_common.py").string().c_str());
+  output.close();
+  test_runner tr;
+  std::map<std::string, bool> include_rules, exclude_rules;
+  std::vector<std::string> rules;
+  tr.discover_tests(_tmp_dir, include_rules, exclude_rules, &rules);
+  CPPUNIT_ASSERT(rules.size() == 3);
+  CPPUNIT_ASSERT(!rules.at(0).compare("rule1"));
+  CPPUNIT_ASSERT(!rules.at(1).compare("rule2"));
+  CPPUNIT_ASSERT(!rules.at(2).compare("rule3"));
+  exclude_rules["rule2"] = true;
+  tr.discover_tests(_tmp_dir, include_rules, exclude_rules, &rules);
+  CPPUNIT_ASSERT(rules.size() == 2);
+  CPPUNIT_ASSERT(!rules.at(1).compare("rule3"));
+  include_rules["rule1"] = true;
+  include_rules["rule2"] = true;
+  tr.discover_tests(_tmp_dir, include_rules, exclude_rules, &rules);
+  CPPUNIT_ASSERT(rules.size() == 1);
+  CPPUNIT_ASSERT(!rules.at(0).compare("rule1"));
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_discover_tests_missing_directory() {
+  test_runner tr;
+  std::vector<std::string> rules;
+  tr.discover_tests(boost::filesystem::path(_tmp_dir) / "absent", std::map<std::string, bool>(),
+                    std::map<std::string, bool>(), &rules);
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_read_requirements() {
+  boost::filesystem::path test_file = boost::filesystem::path(_tmp_dir) / "unit" / "test_rule1.py";
+  unsigned threads = 0;
+  unsigned long long memory_mb = 0;
+  install_test("rule1", "testdir='x'\nthreads=4\nresources={'tmpdir': 'it\\'s', 'mem_mb': '1500', }\n"
+                        "extra_comparison_exclusions=[]\nthreads=8");
+  test_runner::read_requirements(test_file, &threads, &memory_mb);
+  CPPUNIT_ASSERT(threads == 4);
+  CPPUNIT_ASSERT(memory_mb == 1500);
+  install_test("rule1", "threads=2\nresources={'mem_gb': '2', 'mem_mib': '<TBD>', }");
+  test_runner::read_requirements(test_file, &threads, &memory_mb);
+  CPPUNIT_ASSERT(threads == 2);
+  CPPUNIT_ASSERT(memory_mb == 2000);
+  // tests emitted before requirements were recorded
+  install_test("rule1", "pass");
+  test_runner::read_requirements(test_file, &threads, &memory_mb);
+  CPPUNIT_ASSERT(threads == 1);
+  CPPUNIT_ASSERT(!memory_mb);
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_read_conda_envs() {
+  boost::filesystem::path test_file = boost::filesystem::path(_tmp_dir) / "unit" / "test_rule1.py";
+  std::string prefix = "";
+  std::vector<std::string> envs;
+  install_test("rule1", "threads=4\nconda_prefix='/shared/it\\'s'\nconda_envs=['envs/a.yaml', 'envs/b.yml', ]\n"
+                        "extra_comparison_exclusions=[]");
+  test_runner::read_conda_envs(test_file, &prefix, &envs);
+  CPPUNIT_ASSERT(!prefix.compare("/shared/it's"));
+  CPPUNIT_ASSERT(envs.size() == 2);
+  CPPUNIT_ASSERT(!envs.at(0).compare("envs/a.yaml"));
+  CPPUNIT_ASSERT(!envs.at(1).compare("envs/b.yml"));
+  // tests emitted without a shared prefix
+  install_test("rule1", "threads=4");
+  test_runner::read_conda_envs(test_file, &prefix, &envs);
+  CPPUNIT_ASSERT(prefix.empty());
+  CPPUNIT_ASSERT(envs.empty());
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_build_conda_envs() {
+  boost::filesystem::path unit_dir = boost::filesystem::path(_tmp_dir) / "unit";
+  boost::filesystem::path log = boost::filesystem::path(_tmp_dir) / "builds.log";
+  // rule1 and rule2 share an environment under different names; rule3's fails to build;
+  // rule4 uses no shared prefix; rule5's environment file is missing
+  install_test("rule1", "conda_prefix='/prefix'\nconda_envs=['envs/a.yaml', ]");
+  install_test("rule2", "conda_prefix='/prefix'\nconda_envs=['workflow/envs/copy.yaml', ]");
+  install_test("rule3", "conda_prefix='/prefix'\nconda_envs=['envs/a.yaml', 'envs/b.yaml', ]");
+  install_test("rule4", "conda_prefix=''\nconda_envs=['envs/a.yaml', ]");
+  install_test("rule5", "conda_prefix='/prefix'\nconda_envs=['envs/missing.yaml', ]");
+  const char *rules_with_envs[] = {"rule1", "rule2", "rule3", "rule4"};
+  for (unsigned i = 0; i < 4; ++i) {
+    boost::filesystem::path workspace = unit_dir / rules_with_envs[i] / "workspace";
+    boost::filesystem::create_directories(workspace / "envs");
+    boost::filesystem::create_directories(workspace / "workflow" / "envs");
+    std::ofstream output((workspace / "envs" / "a.yaml").string().c_str());
+    output << "dependencies:\n  - python" << std::endl;
+    output.close();
+    output.open((workspace / "workflow" / "envs" / "copy.yaml").string().c_str());
+    output << "dependencies:\n  - python" << std::endl;
+    output.close();
+    output.open((workspace / "envs" / "b.yaml").string().c_str());
+    output << "dependencies:\n  - broken" << std::endl;
+    output.close();
+  }
+  // the fake snakemake records its arguments, and fails for environments that name a broken package
+  std::vector<std::string> command;
+  command.push_back("bash");
+  command.push_back("-c");
+  command.push_back("echo \"$0 $*\" >> " + log.string() + "; ! grep -q broken $(grep -o \"/[^']*\\.yaml\" \"$1\")");
+  test_runner tr;
+  tr.set_env_command(command);
+  tr.set_jobs(2);
+  std::vector<std::string> rules;
+  rules.push_back("rule1");
+  rules.push_back("rule2");
+  rules.push_back("rule3");
+  rules.push_back("rule4");
+  rules.push_back("rule5");
+  std::ostringstream observed;
+  CPPUNIT_ASSERT(tr.build_conda_envs(_tmp_dir, rules, observed) == 1);
+  std::ifstream input(log.string().c_str());
+  std::string line = "";
+  unsigned builds = 0;
+  while (getline(input, line)) {
+    ++builds;
+    CPPUNIT_ASSERT(line.find("--conda-prefix /prefix --conda-create-envs-only") != std::string::npos);
+    CPPUNIT_ASSERT(line.find("--use-conda") != std::string::npos);
+  }
+  input.close();
+  CPPUNIT_ASSERT(builds == 2);
+  CPPUNIT_ASSERT(observed.str().find("BUILT " + (unit_dir / "rule1" / "workspace" / "envs" / "a.yaml").string()) !=
+                 std::string::npos);
+  CPPUNIT_ASSERT(observed.str().find("FAILED " + (unit_dir / "rule3" / "workspace" / "envs" / "b.yaml").string()) !=
+                 std::string::npos);
+  CPPUNIT_ASSERT(observed.str().find("envs/missing.yaml") != std::string::npos);
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_run_tests() {
+  install_test("rule1", "pass");
+  install_test("rule2", "fail");
+  install_test("rule3", "pass");
+  boost::filesystem::path unit_dir = boost::filesystem::path(_tmp_dir) / "unit";
+  // stale output from an earlier failed run
+  boost::filesystem::create_directories(unit_dir / "rule2" / "output" / "stale");
+  // each fake test leaves output, reports its rule, and passes if its file says so
+  std::vector<std::string> command;
+  command.push_back("bash");
+  command.push_back("-c");
+  command.push_back("r=$(basename \"$0\" .py); r=${r#test_}; mkdir \"$r/output\"; echo \"ran $r\"; "
+                    "grep -q pass \"$0\"");
+  test_runner tr;
+  tr.set_command(command);
+  tr.set_jobs(2);
+  tr.set_tracer(boost::shared_ptr<tracer>(new tracer));
+  std::vector<std::string> rules;
+  rules.push_back("rule1");
+  rules.push_back("rule2");
+  rules.push_back("rule3");
+  std::vector<test_result> results;
+  std::ostringstream observed;
+  tr.run_tests(_tmp_dir, rules, false, observed, &results);
+  CPPUNIT_ASSERT(results.size() == 3);
+  CPPUNIT_ASSERT(!results.at(0).rule_name.compare("rule1"));
+  CPPUNIT_ASSERT(results.at(0).passed());
+  CPPUNIT_ASSERT(!results.at(0).output.compare("ran rule1\n"));
+  CPPUNIT_ASSERT(!results.at(1).rule_name.compare("rule2"));
+  CPPUNIT_ASSERT(!results.at(1).passed());
+  CPPUNIT_ASSERT(results.at(1).result.exit_status == 1);
+  CPPUNIT_ASSERT(results.at(2).passed());
+  // passing tests clean up; failing tests keep only this run's output
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unit_dir / "rule1" / "output"));
+  CPPUNIT_ASSERT(boost::filesystem::is_directory(unit_dir / "rule2" / "output"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unit_dir / "rule2" / "output" / "stale"));
+  CPPUNIT_ASSERT(!boost::filesystem::exists(unit_dir / "rule3" / "output"));
+  // only failing output is reported when not verbose
+  CPPUNIT_ASSERT(observed.str().find("FAIL rule2") != std::string::npos);
+  CPPUNIT_ASSERT(observed.str().find("PASS rule1") != std::string::npos);
+  CPPUNIT_ASSERT(observed.str().find("ran rule2") != std::string::npos);
+  CPPUNIT_ASSERT(observed.str().find("ran rule1") == std::string::npos);
+  CPPUNIT_ASSERT(tr._tracer->get_span_count() == 3);
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_run_tests_packing() {
+  std::vector<std::string> command;
+  command.push_back("bash");
+  command.push_back("-c");
+  command.push_back("sleep 0.3");
+  test_runner tr;
+  tr.set_command(command);
+  tr.set_jobs(4);
+  tr.set_memory_mb(1000);
+  std::vector<std::string> rules;
+  rules.push_back("rule1");
+  rules.push_back("rule2");
+  std::vector<test_result> results;
+  std::ostringstream observed;
+  // two 3-thread tests cannot share 4 cores
+  install_test("rule1", "threads=3");
+  install_test("rule2", "threads=3");
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  tr.run_tests(_tmp_dir, rules, false, observed, &results);
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  CPPUNIT_ASSERT(elapsed >= 0.55);
+  CPPUNIT_ASSERT(results.at(0).threads == 3);
+  CPPUNIT_ASSERT(results.at(1).passed());
+  // nor can two tests declaring 600 MB share 1000 MB
+  install_test("rule1", "resources={'mem_mb': '600', }");
+  install_test("rule2", "resources={'mem_mb': '600', }");
+  start = std::chrono::steady_clock::now();
+  tr.run_tests(_tmp_dir, rules, false, observed, &results);
+  elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  CPPUNIT_ASSERT(elapsed >= 0.55);
+  CPPUNIT_ASSERT(results.at(0).memory_mb == 600);
+  // tests larger than the whole budget still run, alone
+  install_test("rule1", "threads=16\nresources={'mem_mb': '4000', }");
+  install_test("rule2", "threads=1");
+  tr.run_tests(_tmp_dir, rules, false, observed, &results);
+  CPPUNIT_ASSERT(results.at(0).threads == 4);
+  CPPUNIT_ASSERT(results.at(0).memory_mb == 1000);
+  CPPUNIT_ASSERT(results.at(0).passed());
+  CPPUNIT_ASSERT(results.at(1).passed());
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_run_tests_timeout() {
+  install_test("rule1", "pass");
+  std::vector<std::string> command;
+  command.push_back("bash");
+  command.push_back("-c");
+  command.push_back("sleep 5");
+  test_runner tr;
+  tr.set_command(command);
+  tr.set_timeout(0.2);
+  std::vector<test_result> results;
+  std::ostringstream observed;
+  tr.run_tests(_tmp_dir, std::vector<std::string>(1, "rule1"), false, observed, &results);
+  CPPUNIT_ASSERT(results.size() == 1);
+  CPPUNIT_ASSERT(results.at(0).result.timed_out);
+  CPPUNIT_ASSERT(!results.at(0).passed());
+  CPPUNIT_ASSERT(results.at(0).result.wall_seconds < 5.0);
+  CPPUNIT_ASSERT(observed.str().find("timed out") != std::string::npos);
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_run_tests_missing_command() {
+  install_test("rule1", "pass");
+  test_runner tr;
+  tr.set_command(std::vector<std::string>(1, "snakemake_unit_tests_no_such_program"));
+  std::vector<test_result> results;
+  std::ostringstream observed;
+  tr.run_tests(_tmp_dir, std::vector<std::string>(1, "rule1"), false, observed, &results);
+  CPPUNIT_ASSERT(results.size() == 1);
+  CPPUNIT_ASSERT(results.at(0).result.exit_status == 127);
+  CPPUNIT_ASSERT(results.at(0).output.find("cannot run") != std::string::npos);
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_run_tests_cached() {
+  boost::filesystem::path unit_dir = boost::filesystem::path(_tmp_dir) / "unit";
+  install_test("rule1", "pass");
+  install_test("rule2", "fail");
+  install_test("rule3", "pass");
+  // rule3 was emitted before tests had fingerprints
+  const char *fingerprinted[] = {"rule1", "rule2"};
+  for (unsigned i = 0; i < 2; ++i) {
+    std::ofstream output((unit_dir / fingerprinted[i] / "fingerprint.txt").string().c_str());
+    output << std::string(64, 'a') << std::endl;
+    output.close();
+  }
+  std::vector<std::string> command;
+  command.push_back("bash");
+  command.push_back("-c");
+  command.push_back("grep -q pass \"$0\"");
+  test_runner tr;
+  tr.set_command(command);
+  std::vector<std::string> rules;
+  rules.push_back("rule1");
+  rules.push_back("rule2");
+  rules.push_back("rule3");
+  std::vector<test_result> results;
+  std::ostringstream observed;
+  tr.run_tests(_tmp_dir, rules, false, observed, &results);
+  CPPUNIT_ASSERT(observed.str().find("CACHED") == std::string::npos);
+  // only the fingerprinted pass is recorded
+  std::map<std::string, std::string> cache;
+  test_runner::read_pass_cache(unit_dir / "pass_cache.tsv", &cache);
+  CPPUNIT_ASSERT(cache.size() == 1);
+  CPPUNIT_ASSERT(!cache["rule1"].compare(test_runner::cache_key(unit_dir, "rule1")));
+  // a second run skips it
+  observed.str("");
+  tr.run_tests(_tmp_dir, rules, false, observed, &results);
+  CPPUNIT_ASSERT(results.at(0).cached && results.at(0).passed());
+  CPPUNIT_ASSERT(!results.at(1).cached && !results.at(1).passed());
+  CPPUNIT_ASSERT(!results.at(2).cached && results.at(2).passed());
+  CPPUNIT_ASSERT(observed.str().find("CACHED rule1") != std::string::npos);
+  CPPUNIT_ASSERT(observed.str().find("PASS rule3") != std::string::npos);
+  // unless the cache is ignored; a failure then removes the record
+  install_test("rule1", "fail");
+  tr.set_use_cache(false);
+  tr.run_tests(_tmp_dir, rules, false, observed, &results);
+  CPPUNIT_ASSERT(!results.at(0).cached && !results.at(0).passed());
+  test_runner::read_pass_cache(unit_dir / "pass_cache.tsv", &cache);
+  CPPUNIT_ASSERT(cache.empty());
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_cache_key() {
+  boost::filesystem::path unit_dir = boost::filesystem::path(_tmp_dir) / "unit";
+  install_test("rule1", "pass");
+  CPPUNIT_ASSERT(test_runner::cache_key(unit_dir, "rule1").empty());
+  std::ofstream output((unit_dir / "rule1" / "fingerprint.txt").string().c_str());
+  output << std::string(64, 'a') << std::endl;
+  output.close();
+  std::string first = test_runner::cache_key(unit_dir, "rule1");
+  CPPUNIT_ASSERT(first.size() == 64);
+  CPPUNIT_ASSERT(!first.compare(test_runner::cache_key(unit_dir, "rule1")));
+  // the test file and shared infrastructure are part of the key
+  install_test("rule1", "pass again");
+  std::string second = test_runner::cache_key(unit_dir, "rule1");
+  CPPUNIT_ASSERT(second.compare(first));
+  output.open((unit_dir / "common.py").string().c_str());
+  output << "# shared" << std::endl;
+  output.close();
+  CPPUNIT_ASSERT(test_runner::cache_key(unit_dir, "rule1").compare(second));
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_pass_cache() {
+  boost::filesystem::path cache_file = boost::filesystem::path(_tmp_dir) / "pass_cache.tsv";
+  std::map<std::string, std::string> cache, observed;
+  test_runner::read_pass_cache(cache_file, &observed);
+  CPPUNIT_ASSERT(observed.empty());
+  cache["rule1"] = std::string(64, 'a');
+  cache["rule2"] = std::string(64, 'b');
+  test_runner::write_pass_cache(cache_file, cache);
+  CPPUNIT_ASSERT(!boost::filesystem::exists(cache_file.string() + ".tmp"));
+  // malformed lines are dropped
+  std::ofstream output(cache_file.string().c_str(), std::ios_base::app);
+  output << "rule3\tshort\nno tab\n";
+  output.close();
+  test_runner::read_pass_cache(cache_file, &observed);
+  CPPUNIT_ASSERT(observed == cache);
+}
+
+void snakemake_unit_tests::test_runnerTest::test_test_runner_report_results() {
+  std::vector<test_result> results(3);
+  results.at(0).rule_name = "rule1";
+  results.at(1).rule_name = "rule2";
+  results.at(1).result.exit_status = 1;
+  results.at(2).rule_name = "rule3";
+  results.at(2).result.timed_out = true;
+  std::ostringstream observed;
+  test_runner::report_results(results, observed);
+  CPPUNIT_ASSERT_EQUAL(std::string("3 tests: 1 passed, 2 failed\n"
+                                   "failed tests:\n"
+                                   "  - rule2 (exit status 1)\n"
+                                   "  - rule3 (timed out)\n"),
+                       observed.str());
+  observed.str("");
+  results.resize(1);
+  test_runner::report_results(results, observed);
+  CPPUNIT_ASSERT_EQUAL(std::string("1 test: 1 passed, 0 failed\n"), observed.str());
+  observed.str("");
+  results.at(0).cached = true;
+  test_runner::report_results(results, observed);
+  CPPUNIT_ASSERT_EQUAL(std::string("1 test: 1 passed (1 cached), 0 failed\n"), observed.str());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::test_runnerTest);
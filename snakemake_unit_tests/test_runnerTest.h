@@ -0,0 +1,92 @@
+/*!
+  \file test_runnerTest.h
+  \brief test_runner test fixture for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_TEST_RUNNERTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_TEST_RUNNERTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "snakemake_unit_tests/test_runner.h"
+
+namespace snakemake_unit_tests {
+class test_runnerTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(test_runnerTest);
+  CPPUNIT_TEST(test_test_result_passed);
+  CPPUNIT_TEST(test_test_runner_default_constructor);
+  CPPUNIT_TEST(test_test_runner_copy_constructor);
+  CPPUNIT_TEST(test_test_runner_set_command);
+  CPPUNIT_TEST_EXCEPTION(test_test_runner_set_command_empty, std::runtime_error);
+  CPPUNIT_TEST(test_test_runner_set_env_command);
+  CPPUNIT_TEST_EXCEPTION(test_test_runner_set_env_command_empty, std::runtime_error);
+  CPPUNIT_TEST(test_test_runner_discover_tests);
+  CPPUNIT_TEST_EXCEPTION(test_test_runner_discover_tests_missing_directory, std::runtime_error);
+  CPPUNIT_TEST(test_test_runner_read_requirements);
+  CPPUNIT_TEST(test_test_runner_read_conda_envs);
+  CPPUNIT_TEST(test_test_runner_build_conda_envs);
+  CPPUNIT_TEST(test_test_runner_run_tests);
+  CPPUNIT_TEST(test_test_runner_run_tests_packing);
+  CPPUNIT_TEST(test_test_runner_run_tests_timeout);
+  CPPUNIT_TEST(test_test_runner_run_tests_missing_command);
+  CPPUNIT_TEST(test_test_runner_run_tests_cached);
+  CPPUNIT_TEST(test_test_runner_cache_key);
+  CPPUNIT_TEST(test_test_runner_pass_cache);
+  CPPUNIT_TEST(test_test_runner_report_results);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_test_result_passed();
+  void test_test_runner_default_constructor();
+  void test_test_runner_copy_constructor();
+  void test_test_runner_set_command();
+  void test_test_runner_set_command_empty();
+  void test_test_runner_set_env_command();
+  void test_test_runner_set_env_command_empty();
+  void test_test_runner_discover_tests();
+  void test_test_runner_discover_tests_missing_directory();
+  void test_test_runner_read_requirements();
+  void test_test_runner_read_conda_envs();
+  void test_test_runner_build_conda_envs();
+  void test_test_runner_run_tests();
+  void test_test_runner_run_tests_packing();
+  void test_test_runner_run_tests_timeout();
+  void test_test_runner_run_tests_missing_command();
+  void test_test_runner_run_tests_cached();
+  void test_test_runner_cache_key();
+  void test_test_runner_pass_cache();
+  void test_test_runner_report_results();
+
+ private:
+  /*!
+    @brief install a fake test for a rule under the temporary directory
+    @param rule_name name of the tested rule
+    @param content content of the test file
+   */
+  void install_test(const std::string &rule_name, const std::string &content) const;
+  char *_tmp_dir;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_TEST_RUNNERTEST_H_
@@ -0,0 +1,110 @@
+/*!
+  \file tracer.cc
+  \brief implementation of Chrome trace event recording
+  \copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#include "snakemake_unit_tests/tracer.h"
+
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "snakemake_unit_tests/utilities.h"
+
+snakemake_unit_tests::tracer::span::span(boost::shared_ptr<tracer> target, const std::string &name,
+                                         const std::string &category)
+    : _target(target), _name(name), _category(category), _start(std::chrono::steady_clock::now()) {}
+
+snakemake_unit_tests::tracer::span::~span() throw() {
+  if (!_target) return;
+  // a failure to record must not disturb unwinding from another error
+  try {
+    _target->add_span(_name, _category, _start, std::chrono::steady_clock::now(), _args);
+  } catch (...) {
+  }
+}
+
+void snakemake_unit_tests::tracer::span::add_arg(const std::string &key, const std::string &value) {
+  if (_target) _args.push_back(std::make_pair(key, value));
+}
+
+snakemake_unit_tests::tracer::tracer() : _start(std::chrono::steady_clock::now()) {
+  _threads[std::this_thread::get_id()] = 1;
+}
+
+snakemake_unit_tests::tracer::tracer(const tracer &obj) {
+  std::lock_guard<std::mutex> guard(obj._lock);
+  _start = obj._start;
+  _events = obj._events;
+  _threads = obj._threads;
+}
+
+unsigned snakemake_unit_tests::tracer::thread_index() {
+  std::map<std::thread::id, unsigned>::const_iterator finder = _threads.find(std::this_thread::get_id());
+  if (finder != _threads.end()) return finder->second;
+  unsigned index = _threads.size() + 1;
+  _threads[std::this_thread::get_id()] = index;
+  return index;
+}
+
+void snakemake_unit_tests::tracer::add_span(const std::string &name, const std::string &category,
+                                            const std::chrono::steady_clock::time_point &start,
+                                            const std::chrono::steady_clock::time_point &end,
+                                            const std::vector<std::pair<std::string, std::string>> &args) {
+  trace_event event;
+  event.name = name;
+  event.category = category;
+  event.start_us = std::chrono::duration_cast<std::chrono::microseconds>(start - _start).count();
+  event.duration_us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+  event.args = args;
+  std::lock_guard<std::mutex> guard(_lock);
+  event.thread = thread_index();
+  _events.push_back(event);
+}
+
+unsigned snakemake_unit_tests::tracer::get_span_count() const {
+  std::lock_guard<std::mutex> guard(_lock);
+  return _events.size();
+}
+
+void snakemake_unit_tests::tracer::report_json(std::ostream &out) const {
+  std::lock_guard<std::mutex> guard(_lock);
+  pid_t pid = getpid();
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  // name each thread, so the viewer labels its track
+  for (std::map<std::thread::id, unsigned>::const_iterator iter = _threads.begin(); iter != _threads.end(); ++iter) {
+    std::string thread_name = iter->second == 1 ? std::string("main") : "worker " + std::to_string(iter->second);
+    out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": " << iter->second
+        << ", \"args\": {\"name\": \"" << thread_name << "\"}},\n";
+  }
+  for (std::vector<trace_event>::const_iterator iter = _events.begin(); iter != _events.end(); ++iter) {
+    out << "{\"name\": \"" << json_escape(iter->name) << "\", \"cat\": \"" << json_escape(iter->category)
+        << "\", \"ph\": \"X\", \"ts\": " << iter->start_us << ", \"dur\": " << iter->duration_us
+        << ", \"pid\": " << pid << ", \"tid\": " << iter->thread;
+    if (!iter->args.empty()) {
+      out << ", \"args\": {";
+      for (std::vector<std::pair<std::string, std::string>>::const_iterator arg = iter->args.begin();
+           arg != iter->args.end(); ++arg) {
+        out << (arg == iter->args.begin() ? "" : ", ") << "\"" << json_escape(arg->first) << "\": \""
+            << json_escape(arg->second) << "\"";
+      }
+      out << "}";
+    }
+    out << "},\n";
+  }
+  // the process name closes the list, so every event above can end with a comma
+  out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid
+      << ", \"args\": {\"name\": \"snakemake_unit_tests\"}}\n]}\n";
+}
+
+void snakemake_unit_tests::tracer::report_json(const std::string &filename) const {
+  std::ostringstream o;
+  report_json(o);
+  std::ofstream output(filename.c_str());
+  if (!output.is_open()) throw std::runtime_error("cannot write trace file \"" + filename + "\"");
+  if (!(output << o.str())) throw std::runtime_error("cannot write trace file \"" + filename + "\"");
+  output.close();
+}
@@ -0,0 +1,184 @@
+/*!
+  @file tracer.h
+  @brief record timed spans of generator activity as Chrome trace events
+  @copyright Released under the MIT License.
+  Copyright 2023 Lightning Auriga
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_TRACER_H_
+#define SNAKEMAKE_UNIT_TESTS_TRACER_H_
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "boost/smart_ptr.hpp"
+
+namespace snakemake_unit_tests {
+/*!
+  @class tracer
+  @brief collect timed spans from any thread, for viewing in a trace viewer
+
+  output is the trace event JSON format read by chrome://tracing and Perfetto.
+  each span is written as a complete ("X") event; threads are numbered in the
+  order they first record a span, with the constructing thread as 1.
+ */
+class tracer {
+ public:
+  /*!
+    @class span
+    @brief record a span from construction to destruction
+   */
+  class span {
+   public:
+    /*!
+      @brief start a span
+      @param target tracer to receive the span; if null, nothing is recorded
+      @param name name of the span
+      @param category category of the span, for filtering in the viewer
+     */
+    span(boost::shared_ptr<tracer> target, const std::string &name, const std::string &category);
+    /*!
+      @brief end the span, recording it with its tracer
+     */
+    ~span() throw();
+    /*!
+      @brief attach a detail to the span
+      @param key name of the detail
+      @param value value of the detail
+     */
+    void add_arg(const std::string &key, const std::string &value);
+
+   private:
+    /*!
+      @brief spans are tied to a scope, and cannot be copied
+     */
+    span(const span &obj);
+    /*!
+      @brief tracer receiving the span
+     */
+    boost::shared_ptr<tracer> _target;
+    /*!
+      @brief name of the span
+     */
+    std::string _name;
+    /*!
+      @brief category of the span
+     */
+    std::string _category;
+    /*!
+      @brief details attached to the span
+     */
+    std::vector<std::pair<std::string, std::string>> _args;
+    /*!
+      @brief when the span started
+     */
+    std::chrono::steady_clock::time_point _start;
+  };
+  /*!
+    @brief default constructor; times are reported relative to construction
+   */
+  tracer();
+  /*!
+    @brief copy constructor
+    @param obj existing tracer
+   */
+  tracer(const tracer &obj);
+  /*!
+    @brief destructor
+   */
+  ~tracer() throw() {}
+  /*!
+    @brief record a span that has finished
+    @param name name of the span
+    @param category category of the span
+    @param start when the span started
+    @param end when the span ended
+    @param args details attached to the span
+
+    safe to call from any thread; the span is attributed to the calling thread
+   */
+  void add_span(const std::string &name, const std::string &category,
+                const std::chrono::steady_clock::time_point &start, const std::chrono::steady_clock::time_point &end,
+                const std::vector<std::pair<std::string, std::string>> &args);
+  /*!
+    @brief get the number of recorded spans
+    @return the number of recorded spans
+   */
+  unsigned get_span_count() const;
+  /*!
+    @brief write all spans as a trace event JSON object
+    @param out stream to which to write
+   */
+  void report_json(std::ostream &out) const;
+  /*!
+    @brief write all spans as a trace event JSON object to a file
+    @param filename name of file to create or truncate
+   */
+  void report_json(const std::string &filename) const;
+
+ private:
+  friend class tracerTest;
+  friend class profilerTest;
+  /*!
+    @brief a single recorded span
+   */
+  struct trace_event {
+    /*!
+      @brief name of the span
+     */
+    std::string name;
+    /*!
+      @brief category of the span
+     */
+    std::string category;
+    /*!
+      @brief start time in microseconds since the tracer was constructed
+     */
+    long long start_us;
+    /*!
+      @brief duration in microseconds
+     */
+    long long duration_us;
+    /*!
+      @brief index of the thread that recorded the span
+     */
+    unsigned thread;
+    /*!
+      @brief details attached to the span
+     */
+    std::vector<std::pair<std::string, std::string>> args;
+  };
+  /*!
+    @brief get the index of the calling thread, assigning one if needed
+    @return index of the calling thread
+
+    must be called with _lock held
+   */
+  unsigned thread_index();
+  /*!
+    @brief when the tracer was constructed
+   */
+  std::chrono::steady_clock::time_point _start;
+  /*!
+    @brief recorded spans, in order of completion
+   */
+  std::vector<trace_event> _events;
+  /*!
+    @brief index assigned to each thread that has recorded a span
+   */
+  std::map<std::thread::id, unsigned> _threads;
+  /*!
+    @brief serialize access from concurrent workers
+   */
+  mutable std::mutex _lock;
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_TRACER_H_
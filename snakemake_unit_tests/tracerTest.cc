@@ -0,0 +1,142 @@
+/*!
+  \file tracerTest.cc
+  \brief implementation of tracer unit tests for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#include "snakemake_unit_tests/tracerTest.h"
+
+void snakemake_unit_tests::tracerTest::setUp() {}
+
+void snakemake_unit_tests::tracerTest::tearDown() {}
+
+void snakemake_unit_tests::tracerTest::test_tracer_default_constructor() {
+  tracer t;
+  CPPUNIT_ASSERT(t._events.empty());
+  // the constructing thread is thread 1
+  CPPUNIT_ASSERT(t._threads.size() == 1u);
+  CPPUNIT_ASSERT(t._threads[std::this_thread::get_id()] == 1u);
+  CPPUNIT_ASSERT_EQUAL(0u, t.get_span_count());
+}
+
+void snakemake_unit_tests::tracerTest::test_tracer_copy_constructor() {
+  tracer t;
+  t.add_span("span1", "cat1", t._start, t._start + std::chrono::milliseconds(5),
+             std::vector<std::pair<std::string, std::string>>());
+  tracer u(t);
+  CPPUNIT_ASSERT(u._start == t._start);
+  CPPUNIT_ASSERT(u._events.size() == 1u);
+  CPPUNIT_ASSERT(!u._events.at(0).name.compare("span1"));
+  CPPUNIT_ASSERT(u._threads == t._threads);
+}
+
+void snakemake_unit_tests::tracerTest::test_tracer_add_span() {
+  tracer t;
+  std::vector<std::pair<std::string, std::string>> args;
+  args.push_back(std::make_pair("rule", "rule1"));
+  t.add_span("span1", "cat1", t._start + std::chrono::microseconds(1500), t._start + std::chrono::microseconds(4000),
+             args);
+  CPPUNIT_ASSERT_EQUAL(1u, t.get_span_count());
+  CPPUNIT_ASSERT(!t._events.at(0).name.compare("span1"));
+  CPPUNIT_ASSERT(!t._events.at(0).category.compare("cat1"));
+  CPPUNIT_ASSERT_EQUAL(1500ll, t._events.at(0).start_us);
+  CPPUNIT_ASSERT_EQUAL(2500ll, t._events.at(0).duration_us);
+  CPPUNIT_ASSERT_EQUAL(1u, t._events.at(0).thread);
+  CPPUNIT_ASSERT(t._events.at(0).args == args);
+}
+
+void snakemake_unit_tests::tracerTest::test_tracer_span() {
+  boost::shared_ptr<tracer> t(new tracer);
+  {
+    tracer::span outer(t, "outer", "cat1");
+    {
+      tracer::span inner(t, "inner", "cat2");
+      inner.add_arg("key", "value");
+    }
+    CPPUNIT_ASSERT_EQUAL(1u, t->get_span_count());
+  }
+  // spans are recorded as they end, so the inner span is first
+  CPPUNIT_ASSERT_EQUAL(2u, t->get_span_count());
+  CPPUNIT_ASSERT(!t->_events.at(0).name.compare("inner"));
+  CPPUNIT_ASSERT(t->_events.at(0).args.size() == 1u);
+  CPPUNIT_ASSERT(!t->_events.at(0).args.at(0).first.compare("key"));
+  CPPUNIT_ASSERT(!t->_events.at(0).args.at(0).second.compare("value"));
+  CPPUNIT_ASSERT(!t->_events.at(1).name.compare("outer"));
+  CPPUNIT_ASSERT(t->_events.at(1).start_us <= t->_events.at(0).start_us);
+  CPPUNIT_ASSERT(t->_events.at(1).start_us + t->_events.at(1).duration_us >=
+                 t->_events.at(0).start_us + t->_events.at(0).duration_us);
+}
+
+void snakemake_unit_tests::tracerTest::test_tracer_span_null_target() {
+  // without a tracer, spans are accepted and discarded
+  tracer::span s(boost::shared_ptr<tracer>(), "span", "cat");
+  s.add_arg("key", "value");
+}
+
+void snakemake_unit_tests::tracerTest::test_tracer_threads() {
+  boost::shared_ptr<tracer> t(new tracer);
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < 4; ++i) {
+    workers.push_back(std::thread([t]() {
+      for (unsigned j = 0; j < 50; ++j) {
+        tracer::span s(t, "work", "worker");
+      }
+    }));
+  }
+  for (std::vector<std::thread>::iterator iter = workers.begin(); iter != workers.end(); ++iter) {
+    iter->join();
+  }
+  CPPUNIT_ASSERT_EQUAL(200u, t->get_span_count());
+  // each worker is numbered after the main thread
+  CPPUNIT_ASSERT(t->_threads.size() == 5u);
+  std::vector<unsigned> per_thread(6, 0);
+  for (unsigned i = 0; i < t->_events.size(); ++i) {
+    CPPUNIT_ASSERT(t->_events.at(i).thread >= 2u && t->_events.at(i).thread <= 5u);
+    ++per_thread.at(t->_events.at(i).thread);
+  }
+  for (unsigned i = 2; i <= 5; ++i) {
+    CPPUNIT_ASSERT_EQUAL(50u, per_thread.at(i));
+  }
+}
+
+void snakemake_unit_tests::tracerTest::test_tracer_report_json() {
+  tracer t;
+  std::vector<std::pair<std::string, std::string>> args;
+  args.push_back(std::make_pair("rule", "rule \"1\""));
+  t.add_span("create_workspace", "workspace", t._start + std::chrono::microseconds(10),
+             t._start + std::chrono::microseconds(30), args);
+  t.add_span("phase", "phase", t._start, t._start + std::chrono::microseconds(100),
+             std::vector<std::pair<std::string, std::string>>());
+  std::ostringstream o;
+  t.report_json(o);
+  std::string pid = std::to_string(getpid());
+  std::string expected =
+      "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n"
+      "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " +
+      pid +
+      ", \"tid\": 1, \"args\": {\"name\": \"main\"}},\n"
+      "{\"name\": \"create_workspace\", \"cat\": \"workspace\", \"ph\": \"X\", \"ts\": 10, \"dur\": 20, \"pid\": " +
+      pid +
+      ", \"tid\": 1, \"args\": {\"rule\": \"rule \\\"1\\\"\"}},\n"
+      "{\"name\": \"phase\", \"cat\": \"phase\", \"ph\": \"X\", \"ts\": 0, \"dur\": 100, \"pid\": " +
+      pid +
+      ", \"tid\": 1},\n"
+      "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " +
+      pid + ", \"args\": {\"name\": \"snakemake_unit_tests\"}}\n]}\n";
+  CPPUNIT_ASSERT(!o.str().compare(expected));
+  // file output has the same content
+  std::string filename = (boost::filesystem::temp_directory_path() /
+                          boost::filesystem::unique_path("sutTRCXXXX-%%%%-%%%%-%%%%"))
+                             .string();
+  t.report_json(filename);
+  std::ifstream input(filename.c_str());
+  CPPUNIT_ASSERT(input.is_open());
+  std::ostringstream observed;
+  observed << input.rdbuf();
+  input.close();
+  boost::filesystem::remove(filename);
+  CPPUNIT_ASSERT(!observed.str().compare(expected));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(snakemake_unit_tests::tracerTest);
@@ -0,0 +1,56 @@
+/*!
+  \file tracerTest.h
+  \brief tracer test fixture for snakemake_unit_tests
+  \author Lightning Auriga
+  \copyright Released under the MIT License. Copyright 2023 Lightning Auriga.
+ */
+
+#ifndef SNAKEMAKE_UNIT_TESTS_TRACERTEST_H_
+#define SNAKEMAKE_UNIT_TESTS_TRACERTEST_H_
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+#include "boost/smart_ptr.hpp"
+#include "snakemake_unit_tests/tracer.h"
+
+namespace snakemake_unit_tests {
+class tracerTest : public CppUnit::TestFixture {
+  // macros to declare suite
+  CPPUNIT_TEST_SUITE(tracerTest);
+  CPPUNIT_TEST(test_tracer_default_constructor);
+  CPPUNIT_TEST(test_tracer_copy_constructor);
+  CPPUNIT_TEST(test_tracer_add_span);
+  CPPUNIT_TEST(test_tracer_span);
+  CPPUNIT_TEST(test_tracer_span_null_target);
+  CPPUNIT_TEST(test_tracer_threads);
+  CPPUNIT_TEST(test_tracer_report_json);
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  // setup/teardown
+  void setUp();
+  void tearDown();
+  // test case methods
+  void test_tracer_default_constructor();
+  void test_tracer_copy_constructor();
+  void test_tracer_add_span();
+  void test_tracer_span();
+  void test_tracer_span_null_target();
+  void test_tracer_threads();
+  void test_tracer_report_json();
+};
+}  // namespace snakemake_unit_tests
+
+#endif  // SNAKEMAKE_UNIT_TESTS_TRACERTEST_H_
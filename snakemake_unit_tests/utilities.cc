@@ -8,18 +8,90 @@
 
 #include "snakemake_unit_tests/utilities.h"
 
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <limits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+extern char **environ;
+
 std::vector<std::string> snakemake_unit_tests::lexical_parse(const std::vector<std::string> &lines, bool verbose) {
+  std::vector<std::string_view> views(lines.begin(), lines.end());
+  std::vector<std::string> results;
+  lexical_parse(views, verbose, [&](const std::vector<lexed_piece> &pieces) {
+    std::string line = "";
+    for (std::vector<lexed_piece>::const_iterator iter = pieces.begin(); iter != pieces.end(); ++iter) {
+      line += iter->text;
+      if (iter->newline) line += "\n";
+    }
+    results.push_back(line);
+  });
+  return results;
+}
+
+namespace {
+/*!
+  \brief remove trailing whitespace from the end of a set of fragments
+  @param pieces fragments of a logical line
+
+  whitespace removal stops at the first retained newline, matching
+  the behavior of the string-based implementation
+ */
+void strip_trailing_whitespace(std::vector<snakemake_unit_tests::lexed_piece> *pieces) {
+  while (!pieces->empty() && !pieces->rbegin()->newline) {
+    std::string_view::size_type last = pieces->rbegin()->text.find_last_not_of(" \t");
+    if (last != std::string_view::npos) {
+      pieces->rbegin()->text = pieces->rbegin()->text.substr(0, last + 1);
+      return;
+    }
+    if (pieces->size() == 1) {
+      pieces->rbegin()->text = pieces->rbegin()->text.substr(0, 0);
+      return;
+    }
+    pieces->pop_back();
+  }
+}
+}  // namespace
+
+void snakemake_unit_tests::lexical_parse(const std::vector<std::string_view> &lines, bool verbose,
+                                         const std::function<void(const std::vector<lexed_piece> &)> &sink) {
   unsigned current_line = 0;
   bool string_open = false, literal_open = false;
-  std::string aggregated_line = "", resolved_line = "";
-  std::vector<std::string> results;
+  // fragments of the logical line currently being assembled
+  std::vector<lexed_piece> pieces;
   quote_type active_quote_type = none;
   unsigned line_counter = 0;
+  // finalize a logical line: only the terminal fragment is stripped of whitespace
+  auto flush = [&](std::string_view resolved_line, unsigned index) {
+    std::string_view::size_type last = resolved_line.find_last_not_of(" \t");
+    lexed_piece piece = {resolved_line.substr(0, last == std::string_view::npos ? 0 : last + 1), index, false};
+    pieces.push_back(piece);
+    sink(pieces);
+    pieces.clear();
+  };
   while (current_line < lines.size()) {
+    const std::string_view &line = lines[current_line];
     if (verbose) {
       ++line_counter;
-      std::cout << "lexical parse: logical line " << line_counter << ": \"" << lines.at(current_line) << "\""
-                << std::endl;
+      std::cout << "lexical parse: logical line " << line_counter << ": \"" << line << "\"" << std::endl;
     }
     // parse current line
     unsigned parse_index = 0;
@@ -27,38 +99,37 @@ std::vector<std::string> snakemake_unit_tests::lexical_parse(const std::vector<s
     // indentation. recall that the files are expected to be run through
     // snakefmt before this code, so we can assume some sanity.
     if (!string_open && !literal_open) {
-      parse_index = lines.at(current_line).find_first_not_of(" \t");
+      parse_index = line.find_first_not_of(" \t");
     }
     bool line_consumed = false;
-    while (parse_index < lines.at(current_line).size()) {
-      if (lines.at(current_line).at(parse_index) == '\\') {
+    while (parse_index < line.size()) {
+      if (line[parse_index] == '\\') {
         // escape. determine context.
         // only care if this is line extension that's not embedded in a string
         // literal
-        if (parse_index == lines.at(current_line).size() - 1 && !string_open && !literal_open) {
+        if (parse_index == line.size() - 1 && !string_open && !literal_open) {
           // this is line extension. add the line to the accumulator but do not
           // flush it make sure to strip the extension character
-          resolved_line = lines.at(current_line).substr(0, lines.at(current_line).size() - 1);
-          aggregated_line += resolved_line;
+          lexed_piece piece = {line.substr(0, line.size() - 1), current_line, false};
+          pieces.push_back(piece);
           ++current_line;
           line_consumed = true;
           break;
         } else {
           // new fix: increment past this position, as it's fine
           // probably increment twice as it's escaping something?
-          if (parse_index < lines.at(current_line).size() - 1)
+          if (parse_index < line.size() - 1)
             parse_index += 2;
           else
             ++parse_index;
         }
-      } else if (lines.at(current_line).at(parse_index) == '\'' || lines.at(current_line).at(parse_index) == '"') {
-        resolve_string_delimiter(lines.at(current_line), &active_quote_type, &parse_index, &string_open, &literal_open);
-      } else if (lines.at(current_line).at(parse_index) == '#') {
+      } else if (line[parse_index] == '\'' || line[parse_index] == '"') {
+        resolve_string_delimiter(line, &active_quote_type, &parse_index, &string_open, &literal_open);
+      } else if (line[parse_index] == '#') {
         // if we're not currently inside a string, this is a comment
         if (!string_open && !literal_open) {
           // this is a comment, terminate the line after removing this
-          resolved_line = lines.at(current_line).substr(0, parse_index);
-          append_resolved_line(resolved_line, &aggregated_line, &results);
+          flush(line.substr(0, parse_index), current_line);
           ++current_line;
           line_consumed = true;
           break;
@@ -68,8 +139,9 @@ std::vector<std::string> snakemake_unit_tests::lexical_parse(const std::vector<s
           ++parse_index;
         }
       } else {
-        // just a standard character, nothing to do
-        ++parse_index;
+        // just a standard character: skip ahead to the next one that matters
+        std::string_view::size_type next = find_lexical_special(line, parse_index);
+        parse_index = next == std::string_view::npos ? line.size() : next;
       }
     }
     if (!line_consumed) {
@@ -77,21 +149,88 @@ std::vector<std::string> snakemake_unit_tests::lexical_parse(const std::vector<s
       // if we are, this line isn't over.
       if (string_open || literal_open) {
         // add to aggregator
-        aggregated_line += lines.at(current_line) + "\n";
+        lexed_piece piece = {line, current_line, true};
+        pieces.push_back(piece);
       } else {
         // finalize the line
-        resolved_line = lines.at(current_line);
-        append_resolved_line(resolved_line, &aggregated_line, &results);
+        flush(line, current_line);
       }
       ++current_line;
     }
   }
-  if (!aggregated_line.empty()) {
-    resolved_line = aggregated_line;
-    aggregated_line = "";
-    append_resolved_line(resolved_line, &aggregated_line, &results);
+  // a trailing line extension with nothing before it leaves no dangling content
+  bool dangling = false;
+  for (std::vector<lexed_piece>::const_iterator iter = pieces.begin(); iter != pieces.end() && !dangling; ++iter) {
+    dangling = !iter->text.empty() || iter->newline;
+  }
+  if (dangling) {
+    // dangling content is stripped as a whole
+    strip_trailing_whitespace(&pieces);
+    sink(pieces);
+  }
+}
+
+void snakemake_unit_tests::as_logical_lines(const std::vector<std::string> &lines, std::vector<logical_line> *target) {
+  if (!target) throw std::runtime_error("null target vector to as_logical_lines");
+  target->clear();
+  target->reserve(lines.size());
+  for (unsigned i = 0; i < lines.size(); ++i) {
+    logical_line line = {lines.at(i), i, 1, false};
+    target->push_back(line);
+  }
+}
+
+std::string_view::size_type snakemake_unit_tests::find_lexical_special_scalar(std::string_view line,
+                                                                              std::string_view::size_type start) {
+  for (std::string_view::size_type i = start; i < line.size(); ++i) {
+    if (line[i] == '\'' || line[i] == '"' || line[i] == '#' || line[i] == '\\') return i;
+  }
+  return std::string_view::npos;
+}
+
+std::string_view::size_type snakemake_unit_tests::find_lexical_special(std::string_view line,
+                                                                       std::string_view::size_type start) {
+  std::string_view::size_type i = start;
+  const char *data = line.data();
+#if defined(__AVX2__)
+  const __m256i tick = _mm256_set1_epi8('\''), quote = _mm256_set1_epi8('"'), hash = _mm256_set1_epi8('#'),
+                slash = _mm256_set1_epi8('\\');
+  for (; i + 32 <= line.size(); i += 32) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, tick), _mm256_cmpeq_epi8(chunk, quote)),
+                                   _mm256_or_si256(_mm256_cmpeq_epi8(chunk, hash), _mm256_cmpeq_epi8(chunk, slash)));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+    if (mask) return i + __builtin_ctz(mask);
+  }
+#endif
+#if defined(__SSE2__)
+  const __m128i tick16 = _mm_set1_epi8('\''), quote16 = _mm_set1_epi8('"'), hash16 = _mm_set1_epi8('#'),
+                slash16 = _mm_set1_epi8('\\');
+  for (; i + 16 <= line.size(); i += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+    __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, tick16), _mm_cmpeq_epi8(chunk, quote16)),
+                                _mm_or_si128(_mm_cmpeq_epi8(chunk, hash16), _mm_cmpeq_epi8(chunk, slash16)));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+    if (mask) return i + __builtin_ctz(mask);
+  }
+#endif
+  // remaining tail, or the entire line without vector support
+  return find_lexical_special_scalar(line, i);
+}
+
+void snakemake_unit_tests::split_physical_lines(std::string_view contents, std::vector<std::string_view> *target) {
+  if (!target) throw std::runtime_error("null target vector to split_physical_lines");
+  target->clear();
+  std::string_view::size_type cur = 0, loc = 0;
+  while (cur < contents.size()) {
+    loc = contents.find('\n', cur);
+    if (loc == std::string_view::npos) {
+      target->push_back(contents.substr(cur));
+      break;
+    }
+    target->push_back(contents.substr(cur, loc - cur));
+    cur = loc + 1;
   }
-  return results;
 }
 
 void snakemake_unit_tests::split_comma_list(const std::string &s, std::vector<std::string> *target) {
@@ -110,7 +249,7 @@ void snakemake_unit_tests::split_comma_list(const std::string &s, std::vector<st
   }
 }
 
-void snakemake_unit_tests::resolve_string_delimiter(const std::string &current_line, quote_type *active_quote_type,
+void snakemake_unit_tests::resolve_string_delimiter(std::string_view current_line, quote_type *active_quote_type,
                                                     unsigned *parse_index, bool *string_open, bool *literal_open) {
   if (!active_quote_type || !parse_index || !string_open || !literal_open) {
     throw std::runtime_error("null pointer provided to resolve_string_delimiter");
@@ -214,6 +353,36 @@ void snakemake_unit_tests::append_resolved_line(const std::string &resolved_line
   results->push_back(candidate);
 }
 
+namespace {
+/*!
+  \brief report a failing subprocess exit status
+  @param status exit status, as reported by waitpid
+  @param fail_on_error whether a failing status should trigger an exception
+  @param emit_error_logging whether captured output should be emitted to std::cerr before throwing
+  @param output captured output of the subprocess, line by line
+ */
+template <class line_container>
+void check_exit_status(int status, bool fail_on_error, bool emit_error_logging, const line_container &output) {
+  if (!fail_on_error || (WIFEXITED(status) && !WEXITSTATUS(status))) return;
+  for (typename line_container::const_iterator iter = output.begin(); iter != output.end() && emit_error_logging;
+       ++iter) {
+    std::cerr << *iter;
+  }
+  if (!WIFEXITED(status)) {
+    throw std::runtime_error(
+        "python subprocess terminated abnormally. this is probably a system configuration "
+        "issue, but may be due to a logic failure in snakemake_unit_tests. please post "
+        "the preceding log output from python3 to an issue in the snakemake_unit_tests "
+        "repository.");
+  }
+  throw std::runtime_error(
+      "python subprocess returned error exit status. this is most likely due to "
+      "a logic error or snakemake feature in your pipeline that is not currently "
+      "supported by snakemake_unit_tests. please post the preceding log output from "
+      "python3 to an issue in the snakemake_unit_tests repository.");
+}
+}  // namespace
+
 std::vector<std::string> snakemake_unit_tests::exec(const std::string &cmd, bool fail_on_error,
                                                     bool emit_error_logging) {
   // https://stackoverflow.com/questions/478898/how-do-i-execute-a-command-and-get-the-output-of-the-command-within-c-using-po
@@ -242,31 +411,571 @@ std::vector<std::string> snakemake_unit_tests::exec(const std::string &cmd, bool
           "please consider posting any log output from python3 "
           "to the snakemake_unit_tests repository for feedback.");
     }
-    if (!WIFEXITED(status) && fail_on_error) {
-      for (std::vector<std::string>::const_iterator iter = result.begin(); iter != result.end() && emit_error_logging;
-           ++iter) {
-        std::cerr << *iter;
+    check_exit_status(status, fail_on_error, emit_error_logging, result);
+    return result;
+  } catch (...) {
+    if (pipe) pclose(pipe);
+    throw;
+  }
+}
+
+namespace {
+/*!
+  \brief one captured output stream of a running subprocess
+ */
+struct captured_stream {
+  /*!
+    \brief read end of the pipe, or -1 once it has been closed
+   */
+  int fd;
+  /*!
+    \brief incomplete final line from the previous read
+   */
+  std::string partial;
+  /*!
+    \brief consumer of complete lines from this stream
+   */
+  const std::function<void(std::string_view)> *callback;
+};
+
+/*!
+  \brief read what is available from a subprocess stream and dispatch complete lines
+  @param stream stream to read; its descriptor is closed and reset at end of file
+  @param buffer scratch buffer for reads
+  @param tail bounded record of recent lines from all streams
+  @param max_tail_lines number of lines to keep in tail
+  @param n_dropped count of lines dropped from the front of tail
+ */
+void drain_stream(captured_stream *stream, std::vector<char> *buffer, std::deque<std::string> *tail,
+                  std::deque<std::string>::size_type max_tail_lines, std::deque<std::string>::size_type *n_dropped) {
+  ssize_t n_read = read(stream->fd, buffer->data(), buffer->size());
+  if (n_read < 0) {
+    if (errno == EINTR || errno == EAGAIN) return;
+    throw std::runtime_error(std::string("cannot read subprocess output: ") + strerror(errno));
+  }
+  if (!n_read) {
+    close(stream->fd);
+    stream->fd = -1;
+    if (!stream->partial.empty()) {
+      (*stream->callback)(stream->partial);
+      tail->push_back(stream->partial);
+      if (tail->size() > max_tail_lines) {
+        tail->pop_front();
+        ++*n_dropped;
       }
-      throw std::runtime_error(
-          "python subprocess terminated abnormally. this is probably a system configuration "
-          "issue, but may be due to a logic failure in snakemake_unit_tests. please post "
-          "the preceding log output from python3 to an issue in the snakemake_unit_tests "
-          "repository.");
+      stream->partial.clear();
     }
-    if (WEXITSTATUS(status) && fail_on_error) {
-      for (std::vector<std::string>::const_iterator iter = result.begin(); iter != result.end() && emit_error_logging;
-           ++iter) {
-        std::cerr << *iter;
-      }
-      throw std::runtime_error(
-          "python subprocess returned error exit status. this is most likely due to "
-          "a logic error or snakemake feature in your pipeline that is not currently "
-          "supported by snakemake_unit_tests. please post the preceding log output from "
-          "python3 to an issue in the snakemake_unit_tests repository.");
+    return;
+  }
+  std::string_view chunk(buffer->data(), n_read);
+  std::string_view::size_type start = 0, newline = 0;
+  while ((newline = chunk.find('\n', start)) != std::string_view::npos) {
+    std::string_view line = chunk.substr(start, newline + 1 - start);
+    if (!stream->partial.empty()) {
+      stream->partial.append(line);
+      line = stream->partial;
+    }
+    (*stream->callback)(line);
+    tail->push_back(std::string(line));
+    if (tail->size() > max_tail_lines) {
+      tail->pop_front();
+      ++*n_dropped;
+    }
+    stream->partial.clear();
+    start = newline + 1;
+  }
+  stream->partial.append(chunk.substr(start));
+}
+
+/*!
+  \brief convert a rusage time to seconds
+  @param t time to convert
+  @return t in seconds
+ */
+double to_seconds(const struct timeval &t) { return static_cast<double>(t.tv_sec) + t.tv_usec / 1000000.0; }
+
+/*!
+  \brief process groups of running timed subprocesses, with 0 marking free slots
+ */
+std::array<std::atomic<pid_t>, 256> forwarded_groups;
+/*!
+  \brief dispositions of SIGINT and SIGTERM before forwarding was installed
+ */
+struct sigaction previous_sigint, previous_sigterm;
+
+/*!
+  \brief pass a termination signal on to timed subprocesses, then act on it as before
+  @param signal_number signal received
+
+  timed subprocesses run in their own process groups, so signals from the terminal
+  no longer reach them directly
+ */
+void forward_termination(int signal_number) {
+  for (unsigned i = 0; i < forwarded_groups.size(); ++i) {
+    pid_t group = forwarded_groups[i].load();
+    if (group) kill(-group, signal_number);
+  }
+  // the signal is blocked until this handler returns, and is then handled the default way
+  sigaction(signal_number, signal_number == SIGINT ? &previous_sigint : &previous_sigterm, 0);
+  raise(signal_number);
+}
+
+/*!
+  \brief forward SIGINT and SIGTERM to timed subprocesses, where this process would be terminated by them
+
+  installed once; a signal this process ignores or handles itself is left alone
+ */
+void install_termination_forwarding() {
+  static std::once_flag installed;
+  std::call_once(installed, []() {
+    struct sigaction action;
+    memset(&action, 0, sizeof(struct sigaction));
+    action.sa_handler = forward_termination;
+    sigemptyset(&action.sa_mask);
+    if (!sigaction(SIGINT, 0, &previous_sigint) && previous_sigint.sa_handler == SIG_DFL) {
+      sigaction(SIGINT, &action, 0);
+    }
+    if (!sigaction(SIGTERM, 0, &previous_sigterm) && previous_sigterm.sa_handler == SIG_DFL) {
+      sigaction(SIGTERM, &action, 0);
+    }
+  });
+}
+
+/*!
+  \brief registration of a process group for signal forwarding, for the lifetime of this object
+ */
+class forwarded_group {
+ public:
+  /*!
+    \brief register a process group, if a slot is free
+    @param group process group to register
+   */
+  explicit forwarded_group(pid_t group) : _slot(0) {
+    for (unsigned i = 0; i < forwarded_groups.size() && group && !_slot; ++i) {
+      pid_t expected = 0;
+      if (forwarded_groups[i].compare_exchange_strong(expected, group)) _slot = &forwarded_groups[i];
     }
+  }
+  /*!
+    \brief release the registered slot
+   */
+  ~forwarded_group() { release(); }
+  /*!
+    \brief stop forwarding to the group, once its leader has been reaped
+   */
+  void release() {
+    if (_slot) _slot->store(0);
+    _slot = 0;
+  }
+
+ private:
+  forwarded_group(const forwarded_group &);
+  forwarded_group &operator=(const forwarded_group &);
+  std::atomic<pid_t> *_slot;
+};
+}  // namespace
+
+snakemake_unit_tests::subprocess_options::subprocess_options()
+    : working_directory(""),
+      fail_on_error(true),
+      emit_error_logging(true),
+      timeout_seconds(0.0),
+      error_log_lines(1000) {}
+
+snakemake_unit_tests::subprocess_result::subprocess_result()
+    : exit_status(0), timed_out(false), wall_seconds(0.0), user_seconds(0.0), system_seconds(0.0), max_rss_kb(0) {}
+
+snakemake_unit_tests::subprocess_result snakemake_unit_tests::run_subprocess(const std::vector<std::string> &args,
+                                                                             const subprocess_options &options) {
+  if (args.empty()) throw std::runtime_error("run_subprocess called without a program");
+  // most recent output, for error reporting
+  typedef std::deque<std::string>::size_type line_count;
+  const line_count max_tail_lines =
+      options.error_log_lines ? options.error_log_lines : std::numeric_limits<line_count>::max();
+  std::deque<std::string> tail;
+  std::deque<std::string>::size_type n_dropped = 0;
+  std::vector<char *> argv;
+  std::vector<std::string> shell_args;
+  const std::vector<std::string> *spawned_args = &args;
+  bool capture_stderr = static_cast<bool>(options.stderr_callback);
+  std::function<void(std::string_view)> discard = [](std::string_view) {};
+  captured_stream streams[2];
+  int out_fds[2] = {-1, -1}, err_fds[2] = {-1, -1};
+  if (pipe(out_fds)) throw std::runtime_error(std::string("cannot create subprocess pipe: ") + strerror(errno));
+  if (capture_stderr && pipe(err_fds)) {
+    int pipe_error = errno;
+    close(out_fds[0]);
+    close(out_fds[1]);
+    throw std::runtime_error(std::string("cannot create subprocess pipe: ") + strerror(pipe_error));
+  }
+  // keep the pipes out of any other concurrently spawned subprocess
+  for (unsigned i = 0; i < 2; ++i) {
+    fcntl(out_fds[i], F_SETFD, FD_CLOEXEC);
+    if (capture_stderr) fcntl(err_fds[i], F_SETFD, FD_CLOEXEC);
+  }
+  posix_spawn_file_actions_t actions;
+  posix_spawnattr_t attributes;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawnattr_init(&attributes);
+  posix_spawn_file_actions_adddup2(&actions, out_fds[1], STDOUT_FILENO);
+  posix_spawn_file_actions_addclose(&actions, out_fds[0]);
+  posix_spawn_file_actions_addclose(&actions, out_fds[1]);
+  if (capture_stderr) {
+    posix_spawn_file_actions_adddup2(&actions, err_fds[1], STDERR_FILENO);
+    posix_spawn_file_actions_addclose(&actions, err_fds[0]);
+    posix_spawn_file_actions_addclose(&actions, err_fds[1]);
+  }
+  if (options.timeout_seconds > 0.0) {
+    // a timed out program is killed along with anything it started
+    install_termination_forwarding();
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attributes, 0);
+  }
+  if (!options.working_directory.empty()) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+    posix_spawn_file_actions_addchdir_np(&actions, options.working_directory.c_str());
+#else
+    // no spawn-time chdir: the shell changes directory, but receives the
+    // directory and arguments as separate words rather than a command string
+    shell_args.push_back("/bin/sh");
+    shell_args.push_back("-c");
+    shell_args.push_back("cd \"$0\" && exec \"$@\"");
+    shell_args.push_back(options.working_directory);
+    shell_args.insert(shell_args.end(), args.begin(), args.end());
+    spawned_args = &shell_args;
+#endif
+  }
+  for (std::vector<std::string>::const_iterator iter = spawned_args->begin(); iter != spawned_args->end(); ++iter) {
+    argv.push_back(const_cast<char *>(iter->c_str()));
+  }
+  argv.push_back(0);
+  std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+  pid_t pid = 0;
+  int spawn_error = posix_spawnp(&pid, argv.at(0), &actions, &attributes, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  posix_spawnattr_destroy(&attributes);
+  close(out_fds[1]);
+  if (capture_stderr) close(err_fds[1]);
+  subprocess_result result;
+  if (spawn_error) {
+    close(out_fds[0]);
+    if (capture_stderr) close(err_fds[0]);
+    // match the shell's report of a program that cannot be run
+    if (options.fail_on_error) {
+      throw std::runtime_error("cannot run \"" + args.at(0) + "\": " + strerror(spawn_error));
+    }
+    result.exit_status = 127;
     return result;
+  }
+  pid_t kill_target = options.timeout_seconds > 0.0 ? -pid : pid;
+  forwarded_group forwarding(options.timeout_seconds > 0.0 ? pid : 0);
+  streams[0].fd = out_fds[0];
+  streams[0].callback = options.stdout_callback ? &options.stdout_callback : &discard;
+  streams[1].fd = capture_stderr ? err_fds[0] : -1;
+  streams[1].callback = &options.stderr_callback;
+  std::chrono::steady_clock::time_point deadline =
+      start_time + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                       std::chrono::duration<double>(options.timeout_seconds));
+  // read through a large buffer, handing complete lines to the callbacks
+  std::vector<char> buffer(65536);
+  struct rusage usage;
+  memset(&usage, 0, sizeof(struct rusage));
+  int status = 0;
+  try {
+    while (streams[0].fd >= 0 || streams[1].fd >= 0) {
+      struct pollfd polled[2];
+      nfds_t n_polled = 0;
+      captured_stream *polled_streams[2];
+      for (unsigned i = 0; i < 2; ++i) {
+        if (streams[i].fd < 0) continue;
+        polled[n_polled].fd = streams[i].fd;
+        polled[n_polled].events = POLLIN;
+        polled[n_polled].revents = 0;
+        polled_streams[n_polled] = &streams[i];
+        ++n_polled;
+      }
+      int wait_ms = -1;
+      if (options.timeout_seconds > 0.0) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now >= deadline) {
+          result.timed_out = true;
+          break;
+        }
+        // round up, so the deadline has passed when poll gives up
+        wait_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count()) + 1;
+      }
+      int n_ready = poll(polled, n_polled, wait_ms);
+      if (n_ready < 0) {
+        if (errno == EINTR) continue;
+        throw std::runtime_error(std::string("cannot poll subprocess output: ") + strerror(errno));
+      }
+      for (nfds_t i = 0; i < n_polled; ++i) {
+        if (polled[i].revents) drain_stream(polled_streams[i], &buffer, &tail, max_tail_lines, &n_dropped);
+      }
+    }
   } catch (...) {
-    if (pipe) pclose(pipe);
+    for (unsigned i = 0; i < 2; ++i) {
+      if (streams[i].fd >= 0) close(streams[i].fd);
+    }
+    kill(kill_target, SIGKILL);
+    while (waitpid(pid, 0, 0) < 0 && errno == EINTR) {
+    }
     throw;
   }
+  if (result.timed_out) {
+    for (unsigned i = 0; i < 2; ++i) {
+      if (streams[i].fd >= 0) close(streams[i].fd);
+    }
+    kill(kill_target, SIGKILL);
+  }
+  // the program can outlive its output streams, if it closed or redirected them:
+  // the deadline holds until it has been reaped
+  pid_t reaped = 0;
+  while (options.timeout_seconds > 0.0 && !result.timed_out) {
+    reaped = wait4(pid, &status, WNOHANG, &usage);
+    if (reaped < 0 && errno != EINTR) {
+      throw std::runtime_error(std::string("cannot wait for subprocess: ") + strerror(errno));
+    }
+    if (reaped > 0) break;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      result.timed_out = true;
+      kill(kill_target, SIGKILL);
+      break;
+    }
+    std::this_thread::sleep_for(
+        std::min<std::chrono::steady_clock::duration>(deadline - now, std::chrono::milliseconds(10)));
+  }
+  while (reaped <= 0) {
+    reaped = wait4(pid, &status, 0, &usage);
+    if (reaped < 0 && errno != EINTR) {
+      throw std::runtime_error(std::string("cannot wait for subprocess: ") + strerror(errno));
+    }
+  }
+  forwarding.release();
+  result.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+  result.user_seconds = to_seconds(usage.ru_utime);
+  result.system_seconds = to_seconds(usage.ru_stime);
+  // linux reports maximum resident set size in kilobytes
+  result.max_rss_kb = usage.ru_maxrss;
+  result.exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+  bool failed = result.timed_out || !WIFEXITED(status) || WEXITSTATUS(status);
+  if (failed && options.fail_on_error && options.emit_error_logging && n_dropped) {
+    std::cerr << "[" << n_dropped << " earlier lines of output not shown]" << std::endl;
+  }
+  if (result.timed_out) {
+    if (options.fail_on_error) {
+      for (std::deque<std::string>::const_iterator iter = tail.begin();
+           iter != tail.end() && options.emit_error_logging; ++iter) {
+        std::cerr << *iter;
+      }
+      throw std::runtime_error("\"" + args.at(0) + "\" did not finish within " +
+                               std::to_string(options.timeout_seconds) + " seconds and was terminated");
+    }
+    return result;
+  }
+  check_exit_status(status, options.fail_on_error, options.emit_error_logging, tail);
+  return result;
+}
+
+int snakemake_unit_tests::exec_streaming(const std::vector<std::string> &args, const std::string &working_directory,
+                                         bool fail_on_error, const std::function<void(std::string_view)> &line_callback,
+                                         bool emit_error_logging) {
+  subprocess_options options;
+  options.working_directory = working_directory;
+  options.fail_on_error = fail_on_error;
+  options.emit_error_logging = emit_error_logging;
+  options.stdout_callback = line_callback;
+  return run_subprocess(args, options).exit_status;
+}
+
+void snakemake_unit_tests::report_subprocess_summary(const std::vector<subprocess_record> &records,
+                                                     const std::string &filename) {
+  std::ofstream output(filename.c_str());
+  if (!output.is_open()) throw std::runtime_error("cannot write subprocess summary file \"" + filename + "\"");
+  output << "label\tworking_directory\texit_status\ttimed_out\twall_seconds\tuser_seconds\tsystem_seconds\tmax_rss_kb"
+         << std::endl;
+  for (std::vector<subprocess_record>::const_iterator iter = records.begin(); iter != records.end(); ++iter) {
+    output << iter->label << '\t' << iter->working_directory << '\t' << iter->result.exit_status << '\t'
+           << (iter->result.timed_out ? "yes" : "no") << '\t' << iter->result.wall_seconds << '\t'
+           << iter->result.user_seconds << '\t' << iter->result.system_seconds << '\t' << iter->result.max_rss_kb
+           << std::endl;
+  }
+  output.close();
+}
+
+void snakemake_unit_tests::report_subprocess_usage(const subprocess_record &record, std::ostream &out) {
+  out << "\t" << record.label << ": exit status " << record.result.exit_status
+      << (record.result.timed_out ? " (timed out)" : "") << ", " << record.result.wall_seconds << "s wall, "
+      << record.result.user_seconds + record.result.system_seconds << "s cpu, " << record.result.max_rss_kb
+      << " KiB max rss" << std::endl;
+}
+
+std::string snakemake_unit_tests::json_escape(const std::string &s) {
+  std::string result = "";
+  result.reserve(s.size());
+  for (std::string::const_iterator iter = s.begin(); iter != s.end(); ++iter) {
+    switch (*iter) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      case '\r':
+        result += "\\r";
+        break;
+      default:
+        if (static_cast<unsigned char>(*iter) < 0x20) {
+          char buffer[7];
+          snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(static_cast<unsigned char>(*iter)));
+          result += buffer;
+        } else {
+          result += *iter;
+        }
+    }
+  }
+  return result;
+}
+
+std::string snakemake_unit_tests::python_escape(const std::string &s) {
+  std::string result = "";
+  result.reserve(s.size());
+  for (std::string::const_iterator iter = s.begin(); iter != s.end(); ++iter) {
+    if (*iter == '\'' || *iter == '\\') result += '\\';
+    result += *iter;
+  }
+  return result;
+}
+
+void snakemake_unit_tests::write_segments(const std::string &filename, const std::vector<std::string_view> &segments) {
+  int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) throw std::runtime_error("cannot create file \"" + filename + "\": " + strerror(errno));
+  std::vector<struct iovec> pending;
+  pending.reserve(segments.size());
+  for (std::vector<std::string_view>::const_iterator iter = segments.begin(); iter != segments.end(); ++iter) {
+    if (iter->empty()) continue;
+    struct iovec entry;
+    entry.iov_base = const_cast<char *>(iter->data());
+    entry.iov_len = iter->size();
+    pending.push_back(entry);
+  }
+  std::vector<struct iovec>::size_type current = 0;
+  while (current < pending.size()) {
+    int batch = static_cast<int>(std::min<std::vector<struct iovec>::size_type>(pending.size() - current, IOV_MAX));
+    ssize_t written = writev(fd, &pending.at(current), batch);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      int error = errno;
+      close(fd);
+      throw std::runtime_error("cannot write to file \"" + filename + "\": " + strerror(error));
+    }
+    // advance past fully written buffers, then trim a partially written one
+    while (current < pending.size() && static_cast<size_t>(written) >= pending.at(current).iov_len) {
+      written -= pending.at(current).iov_len;
+      ++current;
+    }
+    if (written > 0) {
+      pending.at(current).iov_base = static_cast<char *>(pending.at(current).iov_base) + written;
+      pending.at(current).iov_len -= written;
+    }
+  }
+  if (close(fd)) throw std::runtime_error("cannot close file \"" + filename + "\": " + strerror(errno));
+}
+
+bool snakemake_unit_tests::write_segments_if_changed(const std::string &filename,
+                                                     const std::vector<std::string_view> &segments) {
+  std::string_view::size_type total = 0;
+  for (std::vector<std::string_view>::const_iterator iter = segments.begin(); iter != segments.end(); ++iter) {
+    total += iter->size();
+  }
+  struct stat status;
+  if (!stat(filename.c_str(), &status) && S_ISREG(status.st_mode) &&
+      static_cast<std::string_view::size_type>(status.st_size) == total) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd >= 0) {
+      bool identical = true;
+      std::vector<char> buffer(65536);
+      std::vector<std::string_view>::const_iterator segment = segments.begin();
+      std::string_view::size_type offset = 0;
+      while (identical) {
+        ssize_t n_read = read(fd, buffer.data(), buffer.size());
+        if (n_read < 0 && errno == EINTR) continue;
+        if (n_read <= 0) {
+          // a read error is treated as a difference, and the file is rewritten
+          identical = !n_read && segment == segments.end();
+          break;
+        }
+        // walk the segments in step with the file contents
+        ssize_t consumed = 0;
+        while (identical && consumed < n_read) {
+          while (segment != segments.end() && offset == segment->size()) {
+            ++segment;
+            offset = 0;
+          }
+          if (segment == segments.end()) {
+            identical = false;
+            break;
+          }
+          std::string_view::size_type length =
+              std::min<std::string_view::size_type>(segment->size() - offset, n_read - consumed);
+          identical = !memcmp(segment->data() + offset, buffer.data() + consumed, length);
+          offset += length;
+          consumed += length;
+        }
+        while (segment != segments.end() && offset == segment->size()) {
+          ++segment;
+          offset = 0;
+        }
+      }
+      close(fd);
+      if (identical) return false;
+    }
+  }
+  write_segments(filename, segments);
+  return true;
+}
+
+void snakemake_unit_tests::run_in_parallel(unsigned n_tasks, unsigned n_threads,
+                                           const std::function<void(unsigned)> &task) {
+  if (!n_threads) {
+    n_threads = std::thread::hardware_concurrency();
+  }
+  if (n_threads > n_tasks) n_threads = n_tasks;
+  // trivial case: don't bother with thread creation
+  if (n_threads <= 1) {
+    for (unsigned i = 0; i < n_tasks; ++i) {
+      task(i);
+    }
+    return;
+  }
+  std::atomic<unsigned> next_task(0);
+  std::atomic<bool> failed(false);
+  std::exception_ptr first_error;
+  std::mutex error_lock;
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < n_threads; ++i) {
+    workers.push_back(std::thread([&]() {
+      unsigned index = 0;
+      while (!failed && (index = next_task++) < n_tasks) {
+        try {
+          task(index);
+        } catch (...) {
+          std::lock_guard<std::mutex> guard(error_lock);
+          if (!first_error) first_error = std::current_exception();
+          failed = true;
+        }
+      }
+    }));
+  }
+  for (std::vector<std::thread>::iterator iter = workers.begin(); iter != workers.end(); ++iter) {
+    iter->join();
+  }
+  if (first_error) std::rethrow_exception(first_error);
 }
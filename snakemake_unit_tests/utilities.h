@@ -10,10 +10,16 @@
 #define SNAKEMAKE_UNIT_TESTS_UTILITIES_H_
 
 #include <array>
+#include <atomic>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 #include "boost/regex.hpp"
@@ -36,7 +42,7 @@ typedef enum { single_tick, single_quote, triple_tick, triple_quote, none } quot
   @param literal_open whether there is a currently active triple
   delimiter literal
  */
-void resolve_string_delimiter(const std::string &current_line, quote_type *active_quote_type, unsigned *parse_index,
+void resolve_string_delimiter(std::string_view current_line, quote_type *active_quote_type, unsigned *parse_index,
                               bool *string_open, bool *literal_open);
 /*!
   \brief add a processed line to a set of processed line
@@ -58,6 +64,90 @@ void append_resolved_line(const std::string &resolved_line, std::string *aggrega
   was known to break in certain toxic corner cases
  */
 std::vector<std::string> lexical_parse(const std::vector<std::string> &lines, bool verbose = false);
+/*!
+  \brief find the next character that the lexer must inspect
+  @param line physical line being lexed
+  @param start index at which to start searching
+  @return index of the next quote, comment, or escape character at or
+  after start, or std::string_view::npos if there is none
+
+  uses AVX2 or SSE2 comparisons when the build target supports them,
+  and find_lexical_special_scalar otherwise
+ */
+std::string_view::size_type find_lexical_special(std::string_view line, std::string_view::size_type start);
+/*!
+  \brief reference implementation of find_lexical_special
+  @param line physical line being lexed
+  @param start index at which to start searching
+  @return index of the next quote, comment, or escape character at or
+  after start, or std::string_view::npos if there is none
+ */
+std::string_view::size_type find_lexical_special_scalar(std::string_view line, std::string_view::size_type start);
+/*!
+  \brief a contiguous fragment of a physical line contributing to a logical line
+ */
+struct lexed_piece {
+  /*!
+    \brief fragment content; always begins at the start of its physical line
+   */
+  std::string_view text;
+  /*!
+    \brief index of the physical line containing the fragment
+   */
+  unsigned line;
+  /*!
+    \brief whether a newline follows the fragment in the logical line
+   */
+  bool newline;
+};
+/*!
+  \brief a single logical line of snakemake code, as reported by the lexer
+ */
+struct logical_line {
+  /*!
+    \brief line content, with comments and trailing whitespace removed
+   */
+  std::string_view text;
+  /*!
+    \brief index of the first physical line contributing to this line
+   */
+  unsigned first_physical_line;
+  /*!
+    \brief number of physical lines contributing to this line
+   */
+  unsigned n_physical_lines;
+  /*!
+    \brief whether the content could not be expressed as a view of the
+    source, due to backslash line extension or a missing final newline
+   */
+  bool synthesized;
+};
+/*!
+  \brief prune superfluous content from snakemake content lines, without copying
+  @param lines all physical lines from file
+  @param verbose whether to emit verbose logging output to cout
+  @param sink function called with the fragments of each logical line, in order
+
+  this is the state machine behind both lexical_parse interfaces. the fragment
+  vector passed to the sink is reused between calls, and is only valid for the
+  duration of the call.
+ */
+void lexical_parse(const std::vector<std::string_view> &lines, bool verbose,
+                   const std::function<void(const std::vector<lexed_piece> &)> &sink);
+/*!
+  \brief express already-lexed lines as logical lines
+  @param lines lexed lines, one per logical line
+  @param target vector in which to store views of each line
+
+  views refer to the input strings, which must outlive the target
+ */
+void as_logical_lines(const std::vector<std::string> &lines, std::vector<logical_line> *target);
+/*!
+  \brief split a buffer into physical lines, as std::getline would
+  @param contents buffer to split
+  @param target vector in which to store views of each line, excluding newlines
+ */
+void split_physical_lines(std::string_view contents, std::vector<std::string_view> *target);
 /*!
   @brief take a comma/space delimited list of filenames and break them up into a
   vector
@@ -78,6 +168,189 @@ https://stackoverflow.com/questions/478898/how-do-i-execute-a-command-and-get-th
 */
 std::vector<std::string> exec(const std::string &cmd, bool fail_on_error, bool emit_error_logging = true);
 
+/*!
+  @brief settings for running a program with run_subprocess
+ */
+struct subprocess_options {
+  /*!
+    @brief default constructor: current directory, no timeout, fail on error, last 1000 lines logged
+   */
+  subprocess_options();
+  /*!
+    @brief directory in which to run the program, or empty for the current directory
+   */
+  std::string working_directory;
+  /*!
+    @brief whether a failing exit status or timeout should trigger immediate exception
+   */
+  bool fail_on_error;
+  /*!
+    @brief whether recent output should be emitted to std::cerr before such an exception
+   */
+  bool emit_error_logging;
+  /*!
+    @brief wall-clock seconds after which the program is killed, or 0 for no limit
+   */
+  double timeout_seconds;
+  /*!
+    @brief number of most recent output lines kept for error logging, or 0 to keep all of them
+   */
+  unsigned error_log_lines;
+  /*!
+    @brief called with each line of standard output, including its newline; may be empty
+   */
+  std::function<void(std::string_view)> stdout_callback;
+  /*!
+    @brief called with each line of standard error; if empty, standard error is inherited
+   */
+  std::function<void(std::string_view)> stderr_callback;
+};
+
+/*!
+  @brief outcome and resource use of a program run with run_subprocess
+ */
+struct subprocess_result {
+  /*!
+    @brief default constructor: successful, instantaneous run
+   */
+  subprocess_result();
+  /*!
+    @brief exit status of the program; 128 plus the signal number if it was killed by a signal
+   */
+  int exit_status;
+  /*!
+    @brief whether the program was killed for exceeding its timeout
+   */
+  bool timed_out;
+  /*!
+    @brief elapsed time from spawn to reaping
+   */
+  double wall_seconds;
+  /*!
+    @brief user CPU time of the program and its waited-for descendants
+   */
+  double user_seconds;
+  /*!
+    @brief system CPU time of the program and its waited-for descendants
+   */
+  double system_seconds;
+  /*!
+    @brief largest resident set size of the program or any waited-for descendant, in KiB
+   */
+  long max_rss_kb;
+};
+
+/*!
+  @brief a labelled subprocess run, for reporting
+ */
+struct subprocess_record {
+  /*!
+    @brief what the run was for
+   */
+  std::string label;
+  /*!
+    @brief directory the program ran in
+   */
+  std::string working_directory;
+  /*!
+    @brief outcome and resource use of the run
+   */
+  subprocess_result result;
+};
+
+/*!
+@brief run a program directly, without a shell, capturing its output streams concurrently
+@param args program name, searched for in PATH, followed by its arguments
+@param options working directory, timeout, error handling and output consumers
+@return exit status, timeout state and resource use of the program
+
+standard output and, when requested, standard error are multiplexed with poll so that
+neither pipe can fill and stall the program. output is not accumulated; only a tail of
+options.error_log_lines lines is kept for error reporting, which notes how many earlier
+lines it leaves out. with a timeout, the program runs in its own process group and the
+whole group is killed when the deadline passes, even if the program has closed its output
+streams. such a group is not in the terminal's foreground, so SIGINT and SIGTERM received
+by this process are forwarded to it before terminating this process.
+*/
+subprocess_result run_subprocess(const std::vector<std::string> &args, const subprocess_options &options);
+
+/*!
+@brief run a program directly, without a shell, and stream its standard output
+@param args program name, searched for in PATH, followed by its arguments
+@param working_directory directory in which to run the program, or empty for the current directory
+@param fail_on_error whether a failing exit status should trigger immediate exception
+@param line_callback called with each line of output, including its newline, as it arrives
+@param emit_error_logging whether, in the case that the program returns an error code,
+the most recent output should be emitted to std::cerr
+@return exit status of the program; 128 plus the signal number if it was killed by a signal
+
+this is run_subprocess without a timeout; standard error is inherited from this process.
+*/
+int exec_streaming(const std::vector<std::string> &args, const std::string &working_directory, bool fail_on_error,
+                   const std::function<void(std::string_view)> &line_callback, bool emit_error_logging = true);
+
+/*!
+  @brief write resource use of subprocess runs as a tab-delimited table
+  @param records runs to report, in order
+  @param filename name of file to create or truncate
+ */
+void report_subprocess_summary(const std::vector<subprocess_record> &records, const std::string &filename);
+
+/*!
+  @brief describe resource use of a subprocess run on a single line
+  @param record run to describe
+  @param out stream to which to write the description
+ */
+void report_subprocess_usage(const subprocess_record &record, std::ostream &out);
+
+/*!
+  @brief escape a string for use inside a JSON string literal
+  @param s string to escape
+  @return s with quotes, backslashes and control characters escaped
+ */
+std::string json_escape(const std::string &s);
+
+/*!
+  @brief escape a string for use inside a single-quoted python string literal
+  @param s string to escape; expected to be a single line
+  @return s with single quotes and backslashes escaped
+ */
+std::string python_escape(const std::string &s);
+
+/*!
+  @brief write a sequence of buffers to a file with gathered writes
+  @param filename name of file to create or truncate
+  @param segments buffers to write, in order
+
+  empty buffers are skipped. the file is written with writev, in batches
+  of at most IOV_MAX buffers, retrying after partial writes.
+ */
+void write_segments(const std::string &filename, const std::vector<std::string_view> &segments);
+
+/*!
+  @brief write a sequence of buffers to a file, unless the file already has that content
+  @param filename name of file to create or replace
+  @param segments buffers to write, in order
+  @return whether the file was written
+
+  existing files are compared by size and then content, without loading
+  them into memory, so that unchanged files keep their modification times
+ */
+bool write_segments_if_changed(const std::string &filename, const std::vector<std::string_view> &segments);
+
+/*!
+  @brief run a set of independent tasks on a small pool of worker threads
+  @param n_tasks number of tasks; each task is identified by its index
+  @param n_threads maximum number of worker threads; 0 selects the
+  hardware concurrency reported by the system
+  @param task function called exactly once per task index
+
+  tasks are claimed in index order, but may complete in any order. if any
+  task throws, remaining unclaimed tasks are skipped, and the first captured
+  exception is rethrown in the calling thread once all workers have joined.
+ */
+void run_in_parallel(unsigned n_tasks, unsigned n_threads, const std::function<void(unsigned)> &task);
+
 }  // namespace snakemake_unit_tests
 
 #endif  // SNAKEMAKE_UNIT_TESTS_UTILITIES_H_